@@ -6,6 +6,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -24,11 +25,47 @@ Refer to https://skyzh.github.io/mini-lsm/week1-03-block.html for memory layout
 |key_len (2B)|key(keylen)|val_len(2B)|val(vallen)|tranc_id(8B)| ... |
 ---------------------------------------------------------------------
 
+Format v2 (BlockFormat::V2) 对 key 做前缀压缩:
+每条 entry 只保存与前一个 key 不同的部分, 每 restart_interval 条 entry
+设置一个重启点, 重启点处的 entry 保存完整的 key (shared_len = 0)
+
+-----------------------------------------------------------------------------
+|   Data Section   |     Restart Section      |            Extra            |
+-----------------------------------------------------------------------------
+|Entry#1|...|Entry#N|Restart#1|...|Restart#R|num_restarts(2B)|num_elements(2B)|
+-----------------------------------------------------------------------------
+
+-------------------------------------------------------------------------------
+|                                 Entry #1                              | ... |
+-------------------------------------------------------------------------|-----|
+|shared_len(2B)|unshared_len(2B)|key_delta|val_len(2B)|val|tranc_id(8B)| ... |
+-------------------------------------------------------------------------------
+
+Restart 为重启点 entry 在 Data Section 中的偏移 (2B)
+v2 不在磁盘上保存每条 entry 的偏移, 解码时顺序扫描一次重建 offsets
+
+v2 可选地在 Restart Section 之后附加哈希索引, 此时 num_restarts 的最高位置 1:
+-----------------------------------------------------------------------------
+| ... |Restart#R|Bucket#1|...|Bucket#B|num_buckets(2B)|num_restarts(2B)| ... |
+-----------------------------------------------------------------------------
+每个 bucket 1B, 保存 crc32c(key) % B 对应的 key 首个版本所在的重启点编号,
+255 表示没有 key, 254 表示多个 key 冲突 (退回二分查找)
+重启点超过 253 个的 block 不生成哈希索引
+
+解码右值时直接接管传入的缓冲区, 截断到 Data Section 后作为 data 使用,
+不会再拷贝一次; key 和 value 通过 string_view 访问, 只有调用方需要持有数据时
+(get_entry_at, BlockIterator 解引用) 才拷贝
 */
 
 namespace tiny_lsm {
 class BlockIterator;
 
+// 块的编码格式, 由 SST 的 footer 记录, 读取时传给 Block::decode
+enum class BlockFormat : uint8_t {
+  V1 = 1, // 每条 entry 保存完整的 key
+  V2 = 2, // key 前缀压缩 + 重启点
+};
+
 class Block : public std::enable_shared_from_this<Block> {
   friend BlockIterator;
 
@@ -36,6 +73,16 @@ private:
   std::vector<uint8_t> data;
   std::vector<uint16_t> offsets;
   size_t capacity;
+  BlockFormat format_ = BlockFormat::V1;
+  // v2: 每隔多少条 entry 设置一个重启点, 以及各重启点的偏移
+  size_t restart_interval_ = 16;
+  std::vector<uint16_t> restarts;
+  std::string last_key_; // v2: 上一条 entry 的完整 key, 仅构建时使用
+  // v2 哈希索引: 构建时记录每个 key 的 (crc32c, 重启点编号), 编码时生成 bucket
+  // hash_util_ratio_ 为 key 数与 bucket 数之比, 0 表示不生成
+  double hash_util_ratio_ = 0;
+  std::vector<std::pair<uint32_t, uint8_t>> hash_entries_;
+  std::vector<uint8_t> hash_buckets_; // 解码得到的 bucket, 为空表示没有索引
 
   struct Entry {
     std::string key;
@@ -45,22 +92,60 @@ private:
   Entry get_entry_at(size_t offset) const;
   std::string get_key_at(size_t offset) const;
   std::string get_value_at(size_t offset) const;
+  // 返回指向块内数据的视图, 生命周期不超过 Block
+  // v2 非重启点的 key 需要拼接共享前缀, 此时还原到 buf 中并返回指向 buf 的视图
+  std::string_view get_key_view_at(size_t offset, std::string &buf) const;
+  std::string_view get_value_view_at(size_t offset) const;
   uint64_t get_tranc_id_at(size_t offset) const;
   int compare_key_at(size_t offset, const std::string &target) const;
 
   // 根据id的可见性调整位置
   int adjust_idx_by_tranc_id(size_t idx, uint64_t tranc_id);
 
-  bool is_same_key(size_t idx, const std::string &target_key) const;
+  // v2 格式的实现
+  bool add_entry_v2_(const std::string &key, const std::string &value,
+                     uint64_t tranc_id, bool force_write);
+  std::vector<uint8_t> encode_v2_(bool with_hash) const;
+  static std::shared_ptr<Block> decode_v2_(std::vector<uint8_t> encoded,
+                                           bool with_hash);
+  // 重启点直接返回块内的视图, 否则从 offset 之前最近的重启点开始逐条还原到 buf
+  std::string_view get_key_view_at_v2_(size_t offset, std::string &buf) const;
+  // 跳过 entry 的 key 部分, 返回 val_len 所在的偏移
+  size_t value_pos_v2_(size_t offset) const;
+  std::optional<size_t> get_idx_binary_v2_(const std::string &key,
+                                           uint64_t tranc_id);
+  // 最后一个 key 小于目标的重启点, 不存在时为 0
+  size_t restart_before_v2_(const std::string &key) const;
+  // 从第 restart 个重启点开始顺序扫描, 返回第一个 key 不小于目标的索引
+  size_t scan_from_restart_v2_(size_t restart, const std::string &key,
+                               bool &equal) const;
+  // 从第 restart 个重启点开始顺序查找 key 对 tranc_id 可见的最新版本
+  std::optional<size_t> seek_from_restart_v2_(size_t restart,
+                                              const std::string &key,
+                                              uint64_t tranc_id);
+  // 编码时写入的 bucket, 不生成索引时为空
+  std::vector<uint8_t> hash_buckets_to_encode_() const;
+  size_t hash_index_size_() const;
 
 public:
   Block() = default;
   Block(size_t capacity);
+  // hash_util_ratio > 0 时 (仅 v2) 在 block 末尾附加哈希索引
+  Block(size_t capacity, BlockFormat format, size_t restart_interval = 16,
+        double hash_util_ratio = 0);
   // ! 这里的编码函数不包括 hash
   std::vector<uint8_t> encode(bool with_hash = true);
   // ! 这里的解码函数可指定切片是否包括 hash
+  // format 必须与编码时使用的格式一致
   static std::shared_ptr<Block> decode(const std::vector<uint8_t> &encoded,
-                                       bool with_hash = true);
+                                       bool with_hash = true,
+                                       BlockFormat format = BlockFormat::V1);
+  // 接管 encoded 的内存, 避免拷贝 Data Section (读取 SST 时使用)
+  static std::shared_ptr<Block> decode(std::vector<uint8_t> &&encoded,
+                                       bool with_hash = true,
+                                       BlockFormat format = BlockFormat::V1);
+  BlockFormat get_format() const;
+  bool has_hash_index() const;
   std::string get_first_key();
   size_t get_offset_at(size_t idx) const;
   bool add_entry(const std::string &key, const std::string &value,
@@ -70,9 +155,16 @@ public:
 
   size_t size() const;
   size_t cur_size() const;
+  // 块在内存中实际占用的字节数 (包括容器预留的容量), 用于块缓存按字节计费
+  size_t memory_usage() const;
   bool is_empty() const;
   std::optional<size_t> get_idx_binary(const std::string &key,
                                        uint64_t tranc_id);
+  // 第一个 key 不小于目标的 entry 的索引, 不存在时返回 size()
+  // 不考虑事务 id, 用于索引块等每个 key 只有一个版本的场景
+  size_t lower_bound(const std::string &key) const;
+  std::string get_key_by_idx(size_t idx) const;
+  std::string_view get_value_view_by_idx(size_t idx) const;
 
   // 按照谓词返回迭代器, 左闭右开
   std::optional<
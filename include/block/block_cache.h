@@ -18,6 +18,7 @@ struct CacheItem {
   int block_id;
   std::shared_ptr<Block> cache_block;
   uint64_t access_count; // 访问时间戳
+  size_t charge;         // 计入缓存的字节数
 };
 
 // 自定义哈希函数
@@ -42,7 +43,10 @@ struct pair_equal {
 // 定义缓存池
 class BlockCache {
 public:
+  // capacity 为缓存的块数上限
   BlockCache(size_t capacity, size_t k);
+  // capacity_bytes 为缓存的字节数上限, 两个上限任一达到即开始淘汰
+  BlockCache(size_t capacity, size_t k, size_t capacity_bytes);
   ~BlockCache();
 
   // 获取缓存项
@@ -54,8 +58,16 @@ public:
   // 获取缓存命中率
   double hit_rate() const;
 
+  // 缓存实际占用的内存, 包括块本身以及链表和哈希表节点的开销
+  size_t memory_usage() const;
+
+  // 按淘汰顺序释放至少 bytes 字节 (或清空缓存), 返回实际释放的字节数
+  size_t shrink(size_t bytes);
+
 private:
   size_t capacity_;          // 缓存容量
+  size_t capacity_bytes_;    // 缓存字节数上限, 0 表示不限制
+  size_t usage_bytes_ = 0;   // 当前缓存的字节数
   size_t k_;                 // LRU-K 中的 K 值
   mutable std::mutex mutex_; // 互斥锁保护缓存池
 
@@ -71,6 +83,9 @@ private:
   // 更新缓存项的访问时间
   void update_access_count(std::list<CacheItem>::iterator it);
 
+  // 淘汰一个缓存项, 返回释放的字节数, 需持有 mutex_
+  size_t evict_one();
+
   // 记录请求数和命中数
   mutable size_t total_requests_ = 0;
   mutable size_t hit_requests_ = 0;
@@ -6,6 +6,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace tiny_lsm {
@@ -36,11 +37,18 @@ public:
   bool operator==(const BlockIterator &other) const;
   bool operator!=(const BlockIterator &other) const;
   value_type operator*() const;
+  // 不拷贝的访问方式, 视图在迭代器移动或 Block 释放后失效
+  std::string_view key_view() const;
+  std::string_view value_view() const;
   bool is_end();
   uint64_t get_cur_tranc_id() const;
 
 private:
   void update_current() const;
+  // 当前位置的 key: v1 指向块内, v2 指向 key_buf_ (顺序前进时按增量推进)
+  std::string_view current_key_() const;
+  // current_index 处的 key 是否与前一条 (prev_key) 相同, 不拷贝
+  bool is_same_as_current_(std::string_view prev_key);
   // 跳过当前不可见事务的id (如果开启了事务功能)
   void skip_by_tranc_id();
 
@@ -50,5 +58,7 @@ private:
   uint64_t tranc_id_;                             // 当前事务 id
   mutable std::optional<value_type> cached_value; // 缓存当前值
   bool keep_all_versions_ = false;
+  mutable std::string key_buf_; // v2: 第 key_idx_ 条 entry 的完整 key
+  mutable size_t key_idx_ = SIZE_MAX; // SIZE_MAX 表示 key_buf_ 尚未还原
 };
 } // namespace tiny_lsm
@@ -35,10 +35,74 @@ private:
   // --- Bloom Filter ---
   int bloom_filter_expected_size_;
   double bloom_filter_expected_error_rate_;
+  // SST 过滤器每个 key 的位数, 按 build 时实际的 key 数分配
+  double bloom_filter_bits_per_key_;
+  // 各层 SST 使用的过滤器: bloom / fuse8 / fuse16, 超出列表的层使用最后一项
+  std::vector<std::string> bloom_filter_type_per_level_;
+  // 各层布隆过滤器每个 key 的位数, 为空时使用 bloom_filter_bits_per_key_
+  std::vector<double> bloom_filter_bits_per_key_per_level_;
+  // 按 Monkey 在各层之间分配过滤器内存, 平均为 bloom_filter_bits_per_key_
+  bool bloom_filter_monkey_;
+  // 加入 SST 过滤器的 key 前缀 (utils/prefix_extractor.h), none 表示不加入
+  std::string bloom_filter_prefix_extractor_;
 
   // --- WiscKey ---
   size_t wisckey_value_threshold_ = 0;
 
+  // --- MemTable ---
+  std::string lsm_memtable_rep_;
+  double lsm_memtable_bloom_size_ratio_;
+  long long lsm_memtable_hash_bucket_count_;
+  bool lsm_memtable_inplace_update_;
+
+  // --- Block Format ---
+  int lsm_block_format_version_;
+  int lsm_block_restart_interval_;
+  // 各层的 block 大小和重启间隔, 为空时使用 LSM_BLOCK_SIZE / LSM_BLOCK_RESTART_INTERVAL,
+  // 超出列表的层使用最后一项
+  std::vector<int> lsm_block_size_per_level_;
+  std::vector<int> lsm_block_restart_interval_per_level_;
+  // v2 block 哈希索引的 key 数 / bucket 数, 0 表示不生成
+  double lsm_block_hash_index_util_ratio_;
+
+  // --- SST Index ---
+  bool lsm_index_partitioned_;
+  int lsm_index_partition_size_;
+  // 为每个 SST 构建范围过滤器 (utils/range_filter.h), 保留的额外后缀字节数
+  bool lsm_index_range_filter_;
+  int lsm_index_range_filter_suffix_bytes_;
+
+  // --- IO ---
+  bool lsm_io_mmap_reads_;
+  // 批量读取 block 使用的异步读引擎: io_uring / threadpool / sync
+  std::string lsm_io_engine_;
+  int lsm_io_queue_depth_;
+  int lsm_io_threads_;
+  // 顺序扫描的预读窗口 (block 数), 从 initial 开始翻倍到 max, max 为 0 时不预读
+  int lsm_io_readahead_initial_blocks_;
+  int lsm_io_readahead_max_blocks_;
+  bool lsm_io_readahead_fill_cache_;
+  long long lsm_io_write_buffer_size_;
+
+  // --- Compression ---
+  // 各层使用的压缩算法, 超出列表的层使用最后一项
+  std::vector<std::string> lsm_compression_per_level_;
+  double lsm_compression_max_ratio_;
+
+  // --- Memory Budget ---
+  long long lsm_block_cache_capacity_bytes_;
+  long long lsm_memory_budget_;
+
+  // --- Background Flush ---
+  bool lsm_background_flush_;
+  int lsm_slowdown_immutable_memtables_;
+  int lsm_stop_immutable_memtables_;
+  int lsm_slowdown_delay_us_;
+
+  // --- Compaction ---
+  int lsm_compaction_max_subcompactions_;
+  long long lsm_compaction_min_subcompaction_bytes_;
+
   // Private method to set default values
   void setDefaultValues();
 
@@ -76,9 +140,60 @@ public:
 
   int getBloomFilterExpectedSize() const;
   double getBloomFilterExpectedErrorRate() const;
+  double getBloomFilterBitsPerKey() const;
+  const std::vector<double> &getBloomFilterBitsPerKeyPerLevel() const;
+  const std::vector<std::string> &getBloomFilterTypePerLevel() const;
+  // level 层的 SST 使用的过滤器名
+  const std::string &getBloomFilterTypeForLevel(size_t level) const;
+  const std::string &getBloomFilterPrefixExtractor() const;
+  // level 层布隆过滤器每个 key 的位数 (不考虑 Monkey)
+  double getBloomFilterBitsPerKeyForLevel(size_t level) const;
+  bool getBloomFilterMonkey() const;
 
   size_t getWisckeyValueThreshold() const;
 
+  const std::string &getLsmMemtableRep() const;
+  double getLsmMemtableBloomSizeRatio() const;
+  long long getLsmMemtableHashBucketCount() const;
+  bool getLsmMemtableInplaceUpdate() const;
+
+  int getLsmBlockFormatVersion() const;
+  int getLsmBlockRestartInterval() const;
+  const std::vector<int> &getLsmBlockSizePerLevel() const;
+  int getLsmBlockSizeForLevel(size_t level) const;
+  int getLsmBlockRestartIntervalForLevel(size_t level) const;
+  double getLsmBlockHashIndexUtilRatio() const;
+
+  bool getLsmIndexPartitioned() const;
+  int getLsmIndexPartitionSize() const;
+  bool getLsmIndexRangeFilter() const;
+  int getLsmIndexRangeFilterSuffixBytes() const;
+
+  bool getLsmIoMmapReads() const;
+  const std::string &getLsmIoEngine() const;
+  int getLsmIoQueueDepth() const;
+  int getLsmIoThreads() const;
+  int getLsmIoReadaheadInitialBlocks() const;
+  int getLsmIoReadaheadMaxBlocks() const;
+  bool getLsmIoReadaheadFillCache() const;
+  long long getLsmIoWriteBufferSize() const;
+
+  const std::vector<std::string> &getLsmCompressionPerLevel() const;
+  // level 层的 SST 使用的压缩算法名
+  const std::string &getLsmCompressionForLevel(size_t level) const;
+  double getLsmCompressionMaxRatio() const;
+
+  long long getLsmBlockCacheCapacityBytes() const;
+  long long getLsmMemoryBudget() const;
+
+  bool getLsmBackgroundFlush() const;
+  int getLsmSlowdownImmutableMemtables() const;
+  int getLsmStopImmutableMemtables() const;
+  int getLsmSlowdownDelayUs() const;
+
+  int getLsmCompactionMaxSubcompactions() const;
+  long long getLsmCompactionMinSubcompactionBytes() const;
+
   static const TomlConfig &
   getInstance(const std::string &config_path = "config.toml");
 
@@ -86,5 +201,26 @@ public:
   void modify_lsm_tol_mem_size_limit(long long one);
   void modify_lsm_per_mem_size_limit(long long one);
   void modify_lsm_block_size(int one);
+  void modify_lsm_memtable_rep(const std::string &one);
+  void modify_lsm_memtable_bloom_size_ratio(double one);
+  void modify_lsm_memtable_hash_bucket_count(long long one);
+  void modify_lsm_memtable_inplace_update(bool one);
+  void modify_lsm_block_format_version(int one);
+  void modify_lsm_block_hash_index_util_ratio(double one);
+  void modify_lsm_index_partitioned(bool one);
+  void modify_lsm_index_range_filter(bool one);
+  void modify_lsm_io_mmap_reads(bool one);
+  void modify_lsm_io_readahead_max_blocks(int one);
+  void modify_lsm_io_write_buffer_size(long long one);
+  void modify_lsm_compression_per_level(const std::vector<std::string> &one);
+  void modify_bloom_filter_type_per_level(const std::vector<std::string> &one);
+  void modify_bloom_filter_prefix_extractor(const std::string &one);
+  void modify_bloom_filter_bits_per_key_per_level(const std::vector<double> &one);
+  void modify_bloom_filter_monkey(bool one);
+  void modify_lsm_block_size_per_level(const std::vector<int> &one);
+  void modify_lsm_memory_budget(long long one);
+  void modify_lsm_background_flush(bool one);
+  void modify_lsm_compaction_max_subcompactions(int one);
+  void modify_lsm_stop_immutable_memtables(int one);
 };
 } // namespace tiny_lsm
\ No newline at end of file
@@ -11,12 +11,15 @@ namespace tiny_lsm {
 
 enum class IteratorType {
   SkipListIterator,
+  ArenaSkipListIterator,
   MemTableIterator,
+  MemTableMergeIterator,
   SstIterator,
   HeapIterator,
   TwoMergeIterator,
   ConcactIterator,
   LevelIterator,
+  BoundedIterator,
 };
 
 class BaseIterator {
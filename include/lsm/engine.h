@@ -5,12 +5,18 @@
 #include "compact.h"
 #include "transaction.h"
 #include "two_merge_iterator.h"
+#include "utils/memory_budget.h"
 #include "vlog/vlog.h"
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <deque>
+#include <exception>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -28,11 +34,13 @@ public:
   std::shared_ptr<BlockCache> block_cache;
   std::shared_ptr<VLog> vlog_;
   std::weak_ptr<TranManager> tran_manager;
-  size_t next_sst_id = 0;
+  // 并行的 subcompaction 会同时分配 sst_id
+  std::atomic<size_t> next_sst_id{0};
   size_t cur_max_level = 0;
 
 public:
-  LSMEngine(std::string path);
+  LSMEngine(std::string path,
+            MemTableRepType memtable_rep = default_memtable_rep_type());
   ~LSMEngine();
 
   std::optional<std::pair<std::string, uint64_t>> get(const std::string &key,
@@ -55,14 +63,22 @@ public:
   uint64_t remove(const std::string &key, uint64_t tranc_id);
   uint64_t remove_batch(const std::vector<std::string> &keys,
                         uint64_t tranc_id);
+  // 重放一个事务的 WAL 记录, 连续的 put 合并为一次 put_batch
+  uint64_t replay(const std::vector<Record> &records);
   void clear();
   uint64_t flush();
 
   std::string get_sst_path(size_t sst_id, size_t target_level);
 
+  // sst_filter 非空时只查询它返回 true 的 SST
   std::optional<std::pair<TwoMergeIterator, TwoMergeIterator>>
   lsm_iters_monotony_predicate(
-      uint64_t tranc_id, std::function<int(const std::string &)> predicate);
+      uint64_t tranc_id, std::function<int(const std::string &)> predicate,
+      std::function<bool(const std::shared_ptr<SST> &)> sst_filter = nullptr);
+
+  // 以 prefix 开头的所有 key, 跳过 SST::may_contain_prefix 为 false 的 SST
+  std::optional<std::pair<TwoMergeIterator, TwoMergeIterator>>
+  prefix_iter(const std::string &prefix, uint64_t tranc_id);
 
   Level_Iterator begin(uint64_t tranc_id);
   Level_Iterator end();
@@ -71,7 +87,23 @@ public:
 
   void set_tran_manager(std::shared_ptr<TranManager> tran_manager);
 
+  // 唤醒后台刷盘线程, 将冻结表写入 SST
+  void schedule_flush();
+  // 写入 memtable 前调用: 冻结表积压过多时减速或阻塞, 等待后台刷盘追上
+  // 后台刷盘失败后抛出该错误 (同时重新调度刷盘), 直到某次刷盘成功
+  void make_room_for_write();
+  bool background_flush_enabled() const;
+
 private:
+  void flush_worker_();
+  void stop_flush_worker_();
+  // 内存预算要求提前刷盘, 即使冻结表为空也会刷出活跃表
+  void request_flush_();
+  void register_memory_budget_();
+  void unregister_memory_budget_();
+  // 活跃表每增长一个检查步长才查询一次内存预算, 避免每次写入都轮询所有消费者
+  void check_memory_budget_();
+
   void full_compact(size_t src_level);
   std::vector<std::shared_ptr<SST>>
   full_l0_l1_compact(std::vector<size_t> &l0_ids, std::vector<size_t> &l1_ids);
@@ -83,6 +115,25 @@ private:
   std::vector<std::shared_ptr<SST>> gen_sst_from_iter(BaseIterator &iter,
                                                       size_t target_sst_size,
                                                       size_t target_level);
+
+  bool background_flush_ = false;
+  std::thread flush_thread_;
+  std::mutex flush_mtx_;
+  std::condition_variable flush_cv_; // 唤醒后台刷盘线程
+  std::condition_variable stall_cv_; // 唤醒被阻塞的写线程
+  bool flush_pending_ = false;
+  bool force_flush_ = false;
+  bool stop_flush_ = false;
+  // 后台线程正在刷盘
+  bool flushing_ = false;
+  // 最近一次后台刷盘的错误, 刷盘成功后清除; 冻结表仍保留在 memtable 中
+  std::exception_ptr flush_error_;
+
+  std::shared_ptr<MemoryBudget> memory_budget_;
+  uint64_t memtable_consumer_id_ = 0;
+  uint64_t cache_consumer_id_ = 0;
+  // 上一次检查内存预算时活跃表的大小
+  std::atomic<size_t> budget_checked_size_{0};
 };
 
 class LSM {
@@ -91,7 +142,8 @@ private:
   std::shared_ptr<TranManager> tran_manager_;
 
 public:
-  LSM(std::string path);
+  LSM(std::string path,
+      MemTableRepType memtable_rep = default_memtable_rep_type());
   ~LSM();
 
   std::optional<std::string> get(const std::string &key);
@@ -110,6 +162,10 @@ public:
   std::optional<std::pair<TwoMergeIterator, TwoMergeIterator>>
   lsm_iters_monotony_predicate(
       uint64_t tranc_id, std::function<int(const std::string &)> predicate);
+  // 前缀查询, tranc_id 为 0 时读取最新版本
+  // 过滤器中有 key 前缀 (BLOOM_FILTER_PREFIX_EXTRACTOR) 的 SST 可以被跳过
+  std::optional<std::pair<TwoMergeIterator, TwoMergeIterator>>
+  prefix_iter(const std::string &prefix, uint64_t tranc_id = 0);
   void clear();
   void flush();
   void flush_all();
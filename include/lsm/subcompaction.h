@@ -0,0 +1,73 @@
+#pragma once
+
+#include "iterator/iterator.h"
+#include "sst/sst.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace tiny_lsm {
+
+// 一个 subcompaction 负责的 key 区间 [lower, upper), 为空表示无界
+struct KeyRange {
+  std::optional<std::string> lower;
+  std::optional<std::string> upper;
+
+  bool contains(const std::string &key) const;
+  // 区间与 [first, last] 是否相交, 用于挑选需要读取的输入 SST
+  bool overlaps(const std::string &first, const std::string &last) const;
+};
+
+// 只输出 inner 中位于 range 内的元素
+// 构造时跳过小于 lower 的元素 (inner 应尽量已经 seek 到 lower 附近),
+// 遇到不小于 upper 的 key 即视为结束, 不再推进 inner
+// 同一个 key 的所有版本总是落在同一个区间内
+class BoundedIterator : public BaseIterator {
+public:
+  BoundedIterator(std::shared_ptr<BaseIterator> inner, KeyRange range);
+
+  virtual BaseIterator &operator++() override;
+  virtual bool operator==(const BaseIterator &other) const override;
+  virtual bool operator!=(const BaseIterator &other) const override;
+  virtual value_type operator*() const override;
+  virtual IteratorType get_type() const override;
+  virtual uint64_t get_tranc_id() const override;
+  virtual bool is_end() const override;
+  virtual bool is_valid() const override;
+
+private:
+  std::shared_ptr<BaseIterator> inner_;
+  KeyRange range_;
+};
+
+/**
+ * 把一次 compaction 按 key 区间切分为多个可以并行执行的 subcompaction
+ * - 候选切分点为每个输入 SST 的首 key 和均匀抽样的 block 首 key
+ *   (分区索引时为 block 的分隔符), 都来自常驻内存的索引, 不读取 data block
+ * - 每个候选点代表它所在 SST 中到下一个候选点之间的数据, 权重为
+ *   sst_size / 该 SST 的候选点数; 按累计权重的等分点选取切分点,
+ *   使各个区间的输入字节数大致相同
+ * - 区间数不超过 max_jobs, 且每个区间的输入不少于 min_bytes_per_job
+ * 返回升序的切分点, k 个切分点对应 k + 1 个区间 (见 ranges_from_boundaries)
+ */
+std::vector<std::string>
+plan_subcompactions(const std::vector<std::shared_ptr<SST>> &inputs,
+                    size_t max_jobs, size_t min_bytes_per_job);
+
+// 切分点 [c1, ..., ck] 对应的区间 (-inf, c1), [c1, c2), ..., [ck, +inf)
+std::vector<KeyRange>
+ranges_from_boundaries(const std::vector<std::string> &boundaries);
+
+// 每个区间调用一次 job (第一个区间在当前线程, 其余各用一个线程), 全部完成后
+// 按区间的顺序拼接输出, 因此结果与单线程按顺序合并时的 SST 顺序相同
+// 任意一个 job 抛出异常时, 等待其余 job 结束, 删除它们已经生成的 SST,
+// 再重新抛出第一个异常
+std::vector<std::shared_ptr<SST>> run_subcompactions(
+    const std::vector<KeyRange> &ranges,
+    const std::function<std::vector<std::shared_ptr<SST>>(const KeyRange &)>
+        &job);
+} // namespace tiny_lsm
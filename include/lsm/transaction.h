@@ -1,6 +1,7 @@
 #pragma once
 
 #include "utils/files.h"
+#include "utils/snapshot_list.h"
 #include "wal/wal.h"
 #include <atomic>
 #include <map>
@@ -58,6 +59,9 @@ public:
   enum IsolationLevel isolation_level_;
 
 private:
+  // 事务的读快照, 提交或终止时释放; 事务对象被丢弃时随之释放
+  std::shared_ptr<Snapshot> snapshot_;
+
   std::unordered_map<std::string,
                      std::optional<std::pair<std::string, uint64_t>>>
       read_map_;
@@ -75,6 +79,14 @@ public:
   std::shared_ptr<TranContext> new_tranc(const IsolationLevel &isolation_level);
 
   uint64_t getNextTransactionId();
+
+  // 不开启事务的读操作 (LSM::get 等) 使用的快照, 读操作结束时释放返回值即可
+  std::shared_ptr<Snapshot> begin_read();
+  // 所有进行中的事务、读操作和迭代器可能使用的最小事务 id, 之后分配的 id 都不小于它
+  uint64_t get_oldest_snapshot_tranc_id();
+  // 读快照的登记表, memtable 的迭代器也在其中登记
+  std::shared_ptr<SnapshotList> get_snapshot_list();
+
   uint64_t get_max_flushed_tranc_id();
   uint64_t get_checkpoint_tranc_id();
   std::set<uint64_t>& get_flushed_tranc_ids();
@@ -99,7 +111,9 @@ private:
   std::string data_dir_;
   // std::atomic<bool> flush_thread_running_ = true;
   std::atomic<uint64_t> nextTransactionId_ = 1;
-  std::map<uint64_t, std::shared_ptr<TranContext>> activeTrans_;
+  std::shared_ptr<SnapshotList> snapshots_ = std::make_shared<SnapshotList>();
+  // 不持有事务对象, 调用方丢弃未结束的事务时它的快照随之释放
+  std::map<uint64_t, std::weak_ptr<TranContext>> activeTrans_;
   std::map<uint64_t, TransactionState> readyToFlushTrancIds_;
   std::set<uint64_t> flushedTrancIds_;
   FileObj tranc_id_file_;
@@ -1,7 +1,8 @@
 #pragma once
 
 #include "iterator/iterator.h"
-#include "skiplist/skiplist.h"
+#include "memtable/memtable_merge_iterator.h"
+#include "memtable/memtable_rep.h"
 #include <cstddef>
 #include <functional>
 #include <iostream>
@@ -29,24 +30,35 @@ private:
   void put_(const std::string &key, const std::string &value,
             uint64_t tranc_id);
 
-  SkipListIterator get_(const std::string &key, uint64_t tranc_id);
+  MemTableIterator get_(const std::string &key, uint64_t tranc_id);
 
-  SkipListIterator cur_get_(const std::string &key, uint64_t tranc_id);
+  MemTableIterator cur_get_(const std::string &key, uint64_t tranc_id);
 
-  SkipListIterator frozen_get_(const std::string &key, uint64_t tranc_id);
+  MemTableIterator frozen_get_(const std::string &key, uint64_t tranc_id);
 
   void remove_(const std::string &key, uint64_t tranc_id);
   void frozen_cur_table_(); // _ 表示不需要锁的版本
 
+  // tranc_id 的写入能否直接覆盖活跃表中 key 的旧版本
+  bool can_overwrite_(uint64_t tranc_id) const;
+
+  // 构造迭代器并登记 tranc_id 处的读快照, 迭代器存活期间该快照可见的版本不会被覆盖
+  // 调用方需持有 cur_mtx 读锁, 保证登记前游标读到的记录不被覆盖
+  MemTableMergeIterator
+  make_iterator_(std::vector<MemTableMergeIterator::Source> sources,
+                 uint64_t tranc_id);
+
 public:
   MemTable();
+  // 活跃表和冻结表都使用 rep_type 指定的存储结构
+  explicit MemTable(MemTableRepType rep_type);
   ~MemTable();
 
   void put(const std::string &key, const std::string &value, uint64_t tranc_id);
   void put_batch(const std::vector<std::pair<std::string, std::string>> &kvs,
                  uint64_t tranc_id);
 
-  SkipListIterator get(const std::string &key, uint64_t tranc_id);
+  MemTableIterator get(const std::string &key, uint64_t tranc_id);
   std::vector<
       std::pair<std::string, std::optional<std::pair<std::string, uint64_t>>>>
   get_batch(const std::vector<std::string> &keys, uint64_t tranc_id);
@@ -62,20 +74,37 @@ public:
   size_t get_cur_size();
   size_t get_frozen_size();
   size_t get_total_size();
-  HeapIterator begin(uint64_t tranc_id);
-  HeapIterator iters_preffix(const std::string &preffix, uint64_t tranc_id);
-
-  std::optional<std::pair<HeapIterator, HeapIterator>>
+  size_t get_frozen_count(); // 等待刷盘的冻结表数量
+  size_t get_memory_usage(); // 所有表实际占用的内存, 包括节点和分配器开销
+  // 迭代器在各表上惰性归并, 遍历期间持有各表的引用, 不拷贝记录
+  // 迭代器不能比 MemTable 存活更久
+  MemTableMergeIterator begin(uint64_t tranc_id);
+  MemTableMergeIterator iters_preffix(const std::string &preffix,
+                                      uint64_t tranc_id);
+
+  std::optional<std::pair<MemTableMergeIterator, MemTableMergeIterator>>
   iters_monotony_predicate(uint64_t tranc_id,
                            std::function<int(const std::string &)> predicate);
 
-  HeapIterator end();
+  MemTableMergeIterator end();
+
+  MemTableRepType get_rep_type() const;
+
+  // 设置快照水位: 返回所有进行中的读写可能使用的最小事务 id, 返回 0 表示未知
+  // 水位大于写入的 tranc_id 时, 没有读者能看到 key 的旧版本, put 可以原地覆盖
+  // 未设置时 (如单独使用 LSMEngine 手动指定事务 id) 总是插入新版本
+  void set_snapshot_watermark(std::function<uint64_t()> watermark);
+  // 设置读快照的登记表, 迭代器在其中登记自己的快照 (水位应包含其中的最小 id)
+  void set_snapshot_list(std::shared_ptr<SnapshotList> snapshots);
 
 private:
-  std::shared_ptr<SkipList> current_table;
-  std::list<std::shared_ptr<SkipList>> frozen_tables;
+  MemTableRepType rep_type_;
+  std::shared_ptr<MemTableRep> current_table;
+  std::list<std::shared_ptr<MemTableRep>> frozen_tables;
   size_t frozen_bytes;
   std::shared_mutex frozen_mtx; // 冻结表的锁
   std::shared_mutex cur_mtx;    // 活跃表的锁
+  std::function<uint64_t()> snapshot_watermark_;
+  std::shared_ptr<SnapshotList> snapshots_;
 };
 } // namespace tiny_lsm
\ No newline at end of file
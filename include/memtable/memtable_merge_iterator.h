@@ -0,0 +1,85 @@
+#pragma once
+
+#include "iterator/iterator.h"
+#include "memtable/memtable_rep.h"
+#include "utils/snapshot_list.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <shared_mutex>
+#include <vector>
+
+namespace tiny_lsm {
+
+// ************************ MemTableMergeIterator ************************
+// 活跃表和冻结表上的惰性 k 路归并迭代器:
+// 每张表只保留一个游标, 堆中最多同时存放每张表的一条记录,
+// 推进时才从对应的表读取下一条, 读取 n 个 key 只需要 O(n log k) 次操作,
+// 而不是在构造时把所有可见记录拷贝进 HeapIterator
+// 过滤规则与 HeapIterator 相同: 跳过事务不可见的版本, 同一个 key 只返回最新的
+// 可见版本, skip_delete 时跳过已删除的 key; 提交标记 (空 key) 不会被返回
+// 活跃表在迭代期间仍可写入, 游标之后新写入的记录可能被遍历到,
+// 其可见性同样由 max_tranc_id 过滤
+class MemTableMergeIterator : public BaseIterator {
+public:
+  // 一张表上待遍历的范围 [cur, end), end 为空迭代器时遍历到表尾
+  struct Source {
+    std::shared_ptr<MemTableRep> table; // 持有表, 表被刷盘移除后游标仍然有效
+    MemTableIterator cur;
+    MemTableIterator end;
+    // 表仍可能被写入 (活跃表) 时推进游标需要加的读锁, 冻结表为 nullptr
+    // 锁属于 MemTable, 因此迭代器不能比 MemTable 存活更久
+    std::shared_mutex *mtx = nullptr;
+  };
+
+  MemTableMergeIterator(bool skip_delete = true,
+                        bool keep_all_versions = false);
+  // sources 中越靠前的表越新, key 和 tranc_id 都相同时优先返回
+  MemTableMergeIterator(std::vector<Source> sources, uint64_t max_tranc_id,
+                        bool skip_delete = true,
+                        bool keep_all_versions = false);
+
+  // 拷贝出的迭代器拥有独立的游标, 可以分别推进
+  MemTableMergeIterator(const MemTableMergeIterator &other);
+  MemTableMergeIterator &operator=(const MemTableMergeIterator &other);
+  MemTableMergeIterator(MemTableMergeIterator &&other) = default;
+  MemTableMergeIterator &operator=(MemTableMergeIterator &&other) = default;
+
+  // 遍历期间持有读快照, 阻止活跃表把快照可见的旧版本原地覆盖
+  // 拷贝出的迭代器共享同一个快照
+  void hold_snapshot(std::shared_ptr<const Snapshot> snapshot);
+
+  pointer operator->() const;
+  virtual value_type operator*() const override;
+  BaseIterator &operator++() override;
+  virtual bool operator==(const BaseIterator &other) const override;
+  virtual bool operator!=(const BaseIterator &other) const override;
+
+  virtual IteratorType get_type() const override;
+  virtual uint64_t get_tranc_id() const override;
+  virtual bool is_end() const override;
+  virtual bool is_valid() const override;
+
+private:
+  // 读取 sources_[idx] 的下一条记录放入堆中, advance 为 true 时先推进游标
+  // 提交标记会被跳过, 到达 end 时不放入任何记录
+  void fill_(size_t idx, bool advance);
+  // 弹出堆顶, 并从其来源表补充下一条记录
+  void pop_top_();
+  bool top_value_legal_() const;
+  // 跳过事务不可见和已删除的记录, 直到堆顶合法
+  void skip_illegal_();
+
+private:
+  std::vector<Source> sources_;
+  std::priority_queue<SearchItem, std::vector<SearchItem>,
+                      std::greater<SearchItem>>
+      items_;
+  mutable std::shared_ptr<value_type> current_;
+  uint64_t max_tranc_id_ = 0;
+  bool skip_delete_;
+  bool keep_all_versions_ = false;
+  std::shared_ptr<const Snapshot> snapshot_;
+};
+} // namespace tiny_lsm
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "iterator/iterator.h"
+#include "skiplist/arena_skiplist.h"
+#include "skiplist/skiplist.h"
+#include "utils/dynamic_bloom.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace tiny_lsm {
+
+// 活跃表和冻结表的底层存储结构, 由引擎构造 MemTable 时选择
+enum class MemTableRepType {
+  SkipList,      // 默认实现, 即 Lab1 中的 SkipList
+  ArenaSkipList, // Arena 分配的无锁跳表, 支持多线程并发写入
+  SortedVector,  // 写入只追加, 读取或冻结时才排序, 适合批量导入
+  HashLinkList,  // 哈希桶 + 链表, 点查 O(1), 适合 Redis GET/SET 类负载
+  ART,           // 自适应基数树, 适合拥有长公共前缀的 key
+};
+
+// 解析配置文件中的 LSM_MEMTABLE_REP, 无法识别时返回 SkipList
+MemTableRepType memtable_rep_type_from_string(const std::string &name);
+std::string memtable_rep_type_to_string(MemTableRepType type);
+// 配置文件中指定的默认类型
+MemTableRepType default_memtable_rep_type();
+
+// ************************ MemTableRepIterator ************************
+// 单张表的迭代器接口, 在 BaseIterator 的基础上补充逐字段访问
+class MemTableRepIterator : public BaseIterator {
+public:
+  virtual std::string get_key() const = 0;
+  virtual std::string get_value() const = 0;
+  // 复制出一个独立推进的迭代器
+  virtual std::shared_ptr<MemTableRepIterator> clone() const = 0;
+};
+
+// ************************ MemTableIterator ************************
+// 与具体存储结构无关的迭代器, MemTable 和各个 MemTableRep 的查询接口都返回它
+// 其语义与 SkipListIterator 一致: is_valid() 要求 key 非空, 空迭代器即 end
+class MemTableIterator : public BaseIterator {
+public:
+  MemTableIterator() = default;
+  explicit MemTableIterator(std::shared_ptr<MemTableRepIterator> impl)
+      : impl_(std::move(impl)) {}
+
+  virtual BaseIterator &operator++() override;
+  virtual bool operator==(const BaseIterator &other) const override;
+  virtual bool operator!=(const BaseIterator &other) const override;
+  virtual value_type operator*() const override;
+  virtual IteratorType get_type() const override;
+  virtual bool is_end() const override;
+  virtual bool is_valid() const override;
+  std::string get_key() const;
+  std::string get_value() const;
+  uint64_t get_tranc_id() const override;
+
+  // 拷贝构造的迭代器共享同一个游标, 需要各自推进时使用 clone
+  MemTableIterator clone() const;
+
+private:
+  std::shared_ptr<MemTableRepIterator> impl_;
+};
+
+// ************************ MemTableRep ************************
+
+class MemTableRep {
+public:
+  // 按 LSM_MEMTABLE_BLOOM_SIZE_RATIO 创建布隆过滤器, 比例为 0 时不创建
+  MemTableRep();
+  virtual ~MemTableRep() = default;
+
+  virtual MemTableRepType get_type() const = 0;
+
+  // 插入键值对, 相同 key 和 tranc_id 的写入覆盖旧值
+  virtual void put(const std::string &key, const std::string &value,
+                   uint64_t tranc_id) = 0;
+
+  // 批量插入同一事务的键值对, 默认逐个调用 put
+  // kvs 按 key 有序时, SkipListRep 会复用上一次的插入位置
+  virtual void
+  put_batch(const std::vector<std::pair<std::string, std::string>> &kvs,
+            uint64_t tranc_id);
+
+  // 原地覆盖 key 的最新版本 (要求其 tranc_id 小于 tranc_id), 而不是插入新版本
+  // 调用方需保证没有读者还需要看到旧版本; 不支持或 key 不存在时返回 false
+  virtual bool overwrite(const std::string & /*key*/,
+                         const std::string & /*value*/,
+                         uint64_t /*tranc_id*/) {
+    return false;
+  }
+
+  // 事务 id 为0 表示没有开启事务, 否则只能查找事务 id 小于等于 tranc_id 的值
+  virtual MemTableIterator get(const std::string &key, uint64_t tranc_id) = 0;
+
+  using FlushVisitor = std::function<void(
+      const std::string &key, const std::string &value, uint64_t tranc_id)>;
+
+  // 按 key 升序, 相同 key 按 tranc_id 降序依次访问全部版本, 供 flush_last 使用
+  // 每条记录直接交给 visit (如 SSTBuilder::add), 不会复制整张表
+  virtual void flush_to(const FlushVisitor &visit) = 0;
+
+  // 与 flush_to 的顺序相同, 返回全部版本的副本
+  std::vector<std::tuple<std::string, std::string, uint64_t>> flush();
+
+  // 键值对的总大小 (key + value + tranc_id)
+  virtual size_t get_size() = 0;
+
+  // 实际占用的内存, 包括节点、索引结构和分配器的开销, 用于内存预算
+  virtual size_t memory_usage() = 0;
+
+  virtual MemTableIterator begin() = 0;
+  virtual MemTableIterator end() = 0;
+  virtual MemTableIterator begin_preffix(const std::string &preffix) = 0;
+  virtual MemTableIterator end_preffix(const std::string &preffix) = 0;
+
+  // 返回 [第一个满足谓词的位置, 最后一个满足谓词的下一个位置)
+  virtual std::optional<std::pair<MemTableIterator, MemTableIterator>>
+  iters_monotony_predicate(
+      std::function<int(const std::string &)> predicate) = 0;
+
+  // 表被冻结后调用一次, 此后不会再有写入
+  virtual void freeze() {}
+
+  // 为 true 时 put 可以与其他 put 并发执行, MemTable 只需要加读锁
+  virtual bool concurrent_put() const { return false; }
+
+  // 返回 false 时表中一定没有该 key, 各个 get() 会先调用它跳过查找
+  bool may_contain(const std::string &key) const;
+
+protected:
+  // put 在写入存储结构之前调用, 可以与其他写入并发执行
+  void bloom_add_(const std::string &key);
+  size_t bloom_memory_usage_() const;
+
+private:
+  std::unique_ptr<DynamicBloom> bloom_;
+};
+
+std::shared_ptr<MemTableRep> new_memtable_rep(MemTableRepType type);
+
+// ************************ SkipListRep ************************
+
+class SkipListRep : public MemTableRep {
+public:
+  MemTableRepType get_type() const override {
+    return MemTableRepType::SkipList;
+  }
+  void put(const std::string &key, const std::string &value,
+           uint64_t tranc_id) override;
+  void put_batch(const std::vector<std::pair<std::string, std::string>> &kvs,
+                 uint64_t tranc_id) override;
+  bool overwrite(const std::string &key, const std::string &value,
+                 uint64_t tranc_id) override;
+  MemTableIterator get(const std::string &key, uint64_t tranc_id) override;
+  void flush_to(const FlushVisitor &visit) override;
+  size_t get_size() override;
+  size_t memory_usage() override;
+  MemTableIterator begin() override;
+  MemTableIterator end() override;
+  MemTableIterator begin_preffix(const std::string &preffix) override;
+  MemTableIterator end_preffix(const std::string &preffix) override;
+  std::optional<std::pair<MemTableIterator, MemTableIterator>>
+  iters_monotony_predicate(
+      std::function<int(const std::string &)> predicate) override;
+
+private:
+  SkipList table_;
+  size_t entry_count_ = 0; // 写入次数, 用于估算节点开销
+};
+
+// ************************ ArenaSkipListRep ************************
+
+class ArenaSkipListRep : public MemTableRep {
+public:
+  MemTableRepType get_type() const override {
+    return MemTableRepType::ArenaSkipList;
+  }
+  void put(const std::string &key, const std::string &value,
+           uint64_t tranc_id) override;
+  MemTableIterator get(const std::string &key, uint64_t tranc_id) override;
+  void flush_to(const FlushVisitor &visit) override;
+  size_t get_size() override;
+  size_t memory_usage() override;
+  MemTableIterator begin() override;
+  MemTableIterator end() override;
+  MemTableIterator begin_preffix(const std::string &preffix) override;
+  MemTableIterator end_preffix(const std::string &preffix) override;
+  std::optional<std::pair<MemTableIterator, MemTableIterator>>
+  iters_monotony_predicate(
+      std::function<int(const std::string &)> predicate) override;
+  bool concurrent_put() const override { return true; }
+
+private:
+  ArenaSkipList table_;
+};
+
+// ************************ SortedViewRep ************************
+// SortedVector / HashLinkList / ART 共用的基类:
+// 写入的记录追加到 storage_ 中 (std::deque 保证已有元素地址不变),
+// 有序访问时才构建有序视图, 并在两次构建之间只对新增的记录排序后归并
+
+struct MemTableRepEntry {
+  std::string key_;
+  std::string value_;
+  uint64_t tranc_id_;
+  uint64_t seq_;                      // 写入序号, 越大越新
+  MemTableRepEntry *next_ = nullptr; // 哈希桶链表 / ART 叶子的版本链
+};
+
+// 有序视图: 每个 (key, tranc_id) 只保留最新写入的记录,
+// 按 key 升序、tranc_id 降序排列
+struct SortedView {
+  std::shared_ptr<const std::deque<MemTableRepEntry>> storage; // 保证记录有效
+  std::vector<const MemTableRepEntry *> entries;
+};
+
+class SortedViewRep : public MemTableRep {
+public:
+  SortedViewRep();
+
+  MemTableIterator get(const std::string &key, uint64_t tranc_id) override;
+  void flush_to(const FlushVisitor &visit) override;
+  size_t get_size() override;
+  size_t memory_usage() override;
+  MemTableIterator begin() override;
+  MemTableIterator end() override;
+  MemTableIterator begin_preffix(const std::string &preffix) override;
+  MemTableIterator end_preffix(const std::string &preffix) override;
+  std::optional<std::pair<MemTableIterator, MemTableIterator>>
+  iters_monotony_predicate(
+      std::function<int(const std::string &)> predicate) override;
+  void freeze() override;
+
+  // 返回当前的有序视图, 有新写入时会先增量构建
+  std::shared_ptr<const SortedView> sorted_view();
+
+  // 点查时尚未归并的记录超过该数量才构建视图, 否则直接扫描这些记录,
+  // 避免读写交替时每次点查都要排序归并
+  static constexpr size_t kMaxUnsortedTail = 256;
+
+protected:
+  // 追加一条记录, 调用方需保证没有并发的读写
+  MemTableRepEntry *append_(const std::string &key, const std::string &value,
+                            uint64_t tranc_id);
+
+  // 由最新写入的记录构造点查结果
+  MemTableIterator make_entry_iter_(const MemTableRepEntry *entry) const;
+
+  // 构建包含 storage_ 全部记录的有序视图, 默认实现为增量排序后归并
+  virtual std::shared_ptr<const SortedView> build_view_();
+
+protected:
+  std::shared_ptr<std::deque<MemTableRepEntry>> storage_;
+  uint64_t next_seq_ = 1;
+  size_t size_bytes_ = 0;
+  size_t entry_bytes_ = 0; // 记录本身及其字符串堆内存
+
+  std::mutex view_mtx_; // 多个读线程可能同时触发视图构建
+  std::shared_ptr<const SortedView> view_;
+  size_t viewed_count_ = 0; // 已经归并进 view_ 的记录数
+};
+
+// ************************ SortedVectorRep ************************
+// 写入 O(1) 追加, 有序访问或冻结时才排序, 适合批量导入
+class SortedVectorRep : public SortedViewRep {
+public:
+  MemTableRepType get_type() const override {
+    return MemTableRepType::SortedVector;
+  }
+  void put(const std::string &key, const std::string &value,
+           uint64_t tranc_id) override;
+};
+
+// ************************ HashLinkListRep ************************
+// 按 key 哈希到固定数量的桶, 每个桶是一条单链表 (最新写入在前)
+// 点查只扫描一个桶, 有序访问退化为构建有序视图
+class HashLinkListRep : public SortedViewRep {
+public:
+  // 桶的数量取自配置 LSM_MEMTABLE_HASH_BUCKET_COUNT
+  HashLinkListRep();
+  explicit HashLinkListRep(size_t bucket_count);
+
+  MemTableRepType get_type() const override {
+    return MemTableRepType::HashLinkList;
+  }
+  void put(const std::string &key, const std::string &value,
+           uint64_t tranc_id) override;
+  MemTableIterator get(const std::string &key, uint64_t tranc_id) override;
+  size_t memory_usage() override;
+
+private:
+  std::vector<MemTableRepEntry *> buckets_;
+};
+
+// ************************ ArtRep ************************
+// 自适应基数树 (Adaptive Radix Tree), 节点按子节点数量在 4/16/48/256
+// 四种容量间自动升级, 并对单链路径做前缀压缩
+// 点查的代价与 key 长度相关而与表的大小无关; 树的中序遍历天然有序,
+// 因此构建有序视图时不需要排序
+class ArtRep : public SortedViewRep {
+public:
+  ArtRep();
+  ~ArtRep() override;
+
+  MemTableRepType get_type() const override { return MemTableRepType::ART; }
+  void put(const std::string &key, const std::string &value,
+           uint64_t tranc_id) override;
+  MemTableIterator get(const std::string &key, uint64_t tranc_id) override;
+  size_t memory_usage() override;
+
+protected:
+  std::shared_ptr<const SortedView> build_view_() override;
+
+public:
+  struct Node;
+
+private:
+  std::unique_ptr<Node> root_;
+  size_t node_bytes_ = 0; // 所有树节点占用的内存
+};
+} // namespace tiny_lsm
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace tiny_lsm {
+
+// ************************ Arena ************************
+// 每个 memtable 独享的内存池:
+// 节点从大块内存中切分, 不单独释放, 随 Arena 析构一次性归还
+// 快路径只有一次 fetch_add, 只有当前内存块耗尽需要换块时才加锁
+class Arena {
+public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024; // 默认内存块大小 64KB
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+  explicit Arena(size_t block_size = kDefaultBlockSize);
+  ~Arena();
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  // 分配 bytes 字节, 返回地址按 kAlignment 对齐, 线程安全
+  char *allocate(size_t bytes);
+
+  // Arena 向系统申请的总内存 (包括块内尚未使用的部分和块头开销)
+  size_t memory_usage() const;
+
+private:
+  struct ArenaBlock {
+    std::unique_ptr<char[]> data;
+    size_t size;
+    std::atomic<size_t> used; // 可能超过 size, 超过的部分视为已废弃
+    ArenaBlock(size_t sz) : data(new char[sz]), size(sz), used(0) {}
+  };
+
+  // 申请一个新的内存块, 需持有 mutex_
+  ArenaBlock *new_block_(size_t size);
+
+  size_t block_size_;
+  std::atomic<ArenaBlock *> current_;
+  std::vector<std::unique_ptr<ArenaBlock>> blocks_;
+  std::atomic<size_t> memory_usage_;
+  std::mutex mutex_; // 仅保护 blocks_ 和换块操作
+};
+} // namespace tiny_lsm
@@ -0,0 +1,162 @@
+#pragma once
+#include "iterator/iterator.h"
+#include "skiplist/arena.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace tiny_lsm {
+
+// ************************ ArenaSkipListNode ************************
+// 节点整体从 Arena 中分配, 内存布局:
+// | tranc_id | seq | key_len | value_len | height | next_[height] | key | value |
+// key 和 value 直接内联在节点之后, 不再单独分配 std::string
+struct ArenaSkipListNode {
+  uint64_t tranc_id_; // 事务 id
+  uint64_t seq_; // 插入序号, key 和 tranc_id 都相同时, 序号越大越新
+  uint32_t key_len_;
+  uint32_t value_len_;
+  int height_;
+  std::atomic<ArenaSkipListNode *> next_[1]; // 实际长度为 height_
+
+  std::string_view key() const {
+    return std::string_view(payload(), key_len_);
+  }
+  std::string_view value() const {
+    return std::string_view(payload() + key_len_, value_len_);
+  }
+
+  ArenaSkipListNode *next(int level) const {
+    return next_[level].load(std::memory_order_acquire);
+  }
+  void set_next(int level, ArenaSkipListNode *node) {
+    next_[level].store(node, std::memory_order_release);
+  }
+  bool cas_next(int level, ArenaSkipListNode *expected,
+                ArenaSkipListNode *node) {
+    return next_[level].compare_exchange_strong(expected, node,
+                                                std::memory_order_acq_rel);
+  }
+
+  static size_t alloc_size(int height, size_t key_len, size_t value_len) {
+    return offsetof(ArenaSkipListNode, next_) +
+           sizeof(std::atomic<ArenaSkipListNode *>) * height + key_len +
+           value_len;
+  }
+
+private:
+  const char *payload() const {
+    return reinterpret_cast<const char *>(&next_[height_]);
+  }
+};
+
+// ************************ ArenaSkipListIterator ************************
+
+class ArenaSkipListIterator : public BaseIterator {
+public:
+  // 迭代器持有 Arena 的引用, 保证迭代器有效期间节点内存不会被释放
+  ArenaSkipListIterator(ArenaSkipListNode *node, std::shared_ptr<Arena> arena)
+      : current(node), arena_(std::move(arena)) {}
+
+  // 空迭代器构造函数
+  ArenaSkipListIterator() : current(nullptr), arena_(nullptr) {}
+
+  virtual BaseIterator &operator++() override;
+  virtual bool operator==(const BaseIterator &other) const override;
+  virtual bool operator!=(const BaseIterator &other) const override;
+  virtual value_type operator*() const override;
+  virtual IteratorType get_type() const override;
+  virtual bool is_end() const override;
+  virtual bool is_valid() const override;
+  std::string get_key() const;
+  std::string get_value() const;
+  uint64_t get_tranc_id() const override;
+
+private:
+  ArenaSkipListNode *current;
+  std::shared_ptr<Arena> arena_;
+};
+
+// ************************ ArenaSkipList ************************
+// 基于 Arena 的无锁并发跳表:
+// - 多个写线程可以并发 put, 各层 next 指针通过 CAS 插入
+// - 读线程不需要加锁, 只依赖 next 指针的 acquire/release 语义
+// - 节点一经插入不会被修改或删除, 相同 key 和 tranc_id 的重复写入会插入更新的
+//   版本 (seq 更大) 并遮蔽旧版本, 迭代时只返回最新的版本
+class ArenaSkipList {
+public:
+  ArenaSkipList(int max_lvl = 16,
+                size_t arena_block_size = Arena::kDefaultBlockSize);
+
+  // 插入键值对, 线程安全, 可以与其他 put 和读操作并发执行
+  // 这里不对 tranc_id 进行检查，由上层保证 tranc_id 的合法性
+  void put(const std::string &key, const std::string &value,
+           uint64_t tranc_id);
+
+  // 查找键对应的值
+  // 事务 id 为0 表示没有开启事务, 否则只能查找事务 id 小于等于 tranc_id 的值
+  ArenaSkipListIterator get(const std::string &key, uint64_t tranc_id) const;
+
+  // 将跳表数据刷出，返回有序键值对列表
+  std::vector<std::tuple<std::string, std::string, uint64_t>> flush() const;
+  // 按顺序把每个节点的 (key, value, tranc_id) 交给 visit, 不复制整张表
+  void flush_to(
+      const std::function<void(const std::string &, const std::string &,
+                               uint64_t)> &visit) const;
+
+  // 跳表中键值对的总大小, 与 SkipList::get_size 的口径一致
+  size_t get_size() const;
+
+  // Arena 实际占用的内存, 包括节点头和对齐的开销
+  size_t memory_usage() const;
+
+  ArenaSkipListIterator begin() const;
+  ArenaSkipListIterator begin_preffix(const std::string &preffix) const;
+
+  ArenaSkipListIterator end() const;
+  ArenaSkipListIterator end_preffix(const std::string &preffix) const;
+
+  // 返回 [第一个满足谓词的位置, 最后一个满足谓词的下一个位置)
+  // 谓词语义与 SkipList::iters_monotony_predicate 相同
+  std::optional<std::pair<ArenaSkipListIterator, ArenaSkipListIterator>>
+  iters_monotony_predicate(
+      std::function<int(const std::string &)> predicate) const;
+
+private:
+  int random_level() const;
+
+  ArenaSkipListNode *new_node(const std::string &key, const std::string &value,
+                              uint64_t tranc_id, uint64_t seq, int height);
+
+  // 比较节点与 (key, tranc_id, seq) 的顺序: key 升序, tranc_id 降序, seq 降序
+  static bool node_less(const ArenaSkipListNode *node, std::string_view key,
+                        uint64_t tranc_id, uint64_t seq);
+
+  // 找到第一个不满足 before 的节点
+  // before 需要是单调的: 满足 before 的节点都排在不满足的节点之前
+  ArenaSkipListNode *
+  find_first(const std::function<bool(const ArenaSkipListNode *)> &before) const;
+
+  // 在 level 层从 start 开始找到 node 的插入位置
+  void find_splice_for_level(const ArenaSkipListNode *node, int level,
+                             ArenaSkipListNode *start,
+                             ArenaSkipListNode **out_prev,
+                             ArenaSkipListNode **out_next) const;
+
+private:
+  std::shared_ptr<Arena> arena_;
+  ArenaSkipListNode *head; // 头节点不存储实际数据
+  int max_level;
+  std::atomic<int> current_level;
+  std::atomic<size_t> size_bytes;
+  std::atomic<uint64_t> next_seq;
+};
+} // namespace tiny_lsm
@@ -99,6 +99,7 @@ private:
   int max_level;     // 跳表的最大层级数，限制跳表的高度
   int current_level; // 跳表当前的实际层级数，动态变化
   size_t size_bytes = 0; // 跳表当前占用的内存大小（字节数），用于跟踪内存使用
+  uint64_t epoch_ = 1; // 删除或清空节点时递增, 使已有的插入提示失效
   // std::shared_mutex rw_mutex; // ! 目前看起来这个锁是冗余的, 在上层控制即可,
   // 后续考虑是否需要细粒度的锁
 
@@ -108,6 +109,18 @@ private:
 
 private:
   int random_level(); // 生成新节点的随机层级数
+  int hint_level_();  // put_hint 使用的层级数, 范围为 [1, max_level]
+
+public:
+  // 有序插入的提示, 记录上一次 put_hint 插入位置在各层的前驱节点
+  // 下一次插入的 key 不小于上一次时, 从这些前驱出发查找 (finger search),
+  // 有序批量插入的均摊代价接近 O(1); 否则自动退化为从 head 开始查找
+  // 提示只属于一个跳表, 且使用期间需要由上层保证没有并发写入
+  struct InsertHint {
+    const SkipList *owner_ = nullptr;
+    uint64_t epoch_ = 0;
+    std::vector<std::shared_ptr<SkipListNode>> prev_;
+  };
 
 public:
   SkipList(int max_lvl = 16); // 构造函数，初始化跳表
@@ -134,6 +147,16 @@ public:
   // 这里不对 tranc_id 进行检查，由上层保证 tranc_id 的合法性
   void put(const std::string &key, const std::string &value, uint64_t tranc_id);
 
+  // 与 put 语义相同, 利用并更新 hint 中记录的前驱节点, 用于有序的批量写入
+  void put_hint(const std::string &key, const std::string &value,
+                uint64_t tranc_id, InsertHint &hint);
+
+  // 将 key 最新版本的节点原地改写为 (value, tranc_id), 不插入新节点
+  // 仅当最新版本的 tranc_id 小于 tranc_id 时成功, 排序不会因此改变
+  // 调用方需保证没有读者还需要看到被覆盖的旧版本
+  bool overwrite(const std::string &key, const std::string &value,
+                 uint64_t tranc_id);
+
   // 查找键对应的值
   // 事务 id 为0 表示没有开启事务
   // 否则只能查找事务 id 小于等于 tranc_id 的值
@@ -146,6 +169,10 @@ public:
   // 将跳表数据刷出，返回有序键值对列表
   // value 为 真实 value 和 tranc_id 的二元组
   std::vector<std::tuple<std::string, std::string, uint64_t>> flush();
+  // 按顺序把每个节点的 (key, value, tranc_id) 交给 visit, 不复制整张表
+  void flush_to(
+      const std::function<void(const std::string &, const std::string &,
+                               uint64_t)> &visit);
 
   size_t get_size();
 
@@ -2,6 +2,7 @@
 
 #include "sst.h"
 #include "sst_iterator.h"
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -13,10 +14,17 @@ private:
   std::vector<std::shared_ptr<SST>> ssts;
   uint64_t max_tranc_id_;
   bool keep_all_versions_ = false;
+  // 顺序跨过 SST 边界后, 后台把下一个 SST 的第一个 block 读入块缓存
+  std::shared_ptr<std::future<void>> next_sst_prefetch_;
+
+  void prefetch_next_sst_();
 
 public:
   ConcactIterator(std::vector<std::shared_ptr<SST>> ssts, uint64_t tranc_id,
                   bool keep_all_versions = false);
+  // 从第一个不小于 key 的位置开始, 用于按 key 区间执行的 subcompaction
+  ConcactIterator(std::vector<std::shared_ptr<SST>> ssts, const std::string &key,
+                  uint64_t tranc_id, bool keep_all_versions = false);
 
   std::string key();
   std::string value();
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "utils/compression.h"
+#include "utils/key_filter.h"
+#include <cstddef>
+#include <vector>
+
+namespace tiny_lsm {
+
+/**
+ * 一层 SST 的构建参数, 由 SSTBuilder::set_level_options 应用
+ * - 各项按 *_PER_LEVEL 配置, 未配置的层使用全局值
+ * - 开启 BLOOM_FILTER_MONKEY 时 bits_per_key 由 monkey_bits_per_key 按各层的
+ *   key 数计算: 所有层的平均值不变, 小的层 (查询最先访问, 每次未命中都要经过)
+ *   分到更多的位, 最大的层分到更少; 使用 binary fuse 的层按固定大小扣除预算
+ */
+struct LevelOptions {
+  size_t block_size;
+  size_t restart_interval;
+  // 布隆过滤器每个 key 的位数, 至少为 1; binary fuse 过滤器忽略该项
+  double bits_per_key;
+  CompressionType compression;
+  FilterFormat filter;
+
+  // level 层的参数, num_levels 为当前 LSM 的层数 (Monkey 需要)
+  static LevelOptions for_level(size_t level, size_t num_levels);
+};
+
+/**
+ * Monkey (Dayan et al., SIGMOD 2017): 总位数为 avg_bits_per_key * sum(level_keys)
+ * 时, 使各层假阳性率之和 (即一次未命中的查询期望多读的 block 数) 最小的分配
+ * 最优解中各层的假阳性率与该层的 key 数成正比, 每层的位数为
+ *   bits_i = -ln(c * n_i) / ln(2)^2
+ * 算出的位数低于 min_bits 的层固定为 min_bits (为 0 时即不分配, 假阳性率为 1),
+ * 剩余的位数在其他层之间重新分配, 因此钳制后总位数仍然不变
+ * fixed_bits[i] >= 0 的层使用大小固定的过滤器 (如 binary fuse), 不参与优化:
+ * 它的位数从总预算中扣除, 假阳性率是与分配无关的常数项
+ * 返回各层每个 key 的位数
+ */
+std::vector<double> monkey_bits_per_key(const std::vector<double> &level_keys,
+                                        double avg_bits_per_key,
+                                        const std::vector<double> &fixed_bits = {},
+                                        double min_bits = 0);
+
+// 大小固定的过滤器每个 key 约占的位数, 布隆过滤器返回 -1 (大小由 bits_per_key 决定)
+double fixed_filter_bits_per_key(FilterFormat format);
+} // namespace tiny_lsm
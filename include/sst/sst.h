@@ -3,12 +3,21 @@
 #include "block/block.h"
 #include "block/block_cache.h"
 #include "block/blockmeta.h"
+#include "sst/level_options.h"
+#include "sst/sst_index.h"
+#include "sst/table_properties.h"
 #include "utils/bloom_filter.h"
+#include "utils/buffered_file_writer.h"
+#include "utils/key_filter.h"
+#include "utils/prefix_extractor.h"
+#include "utils/range_filter.h"
+#include "utils/compression.h"
 #include "utils/files.h"
 #include "vlog/vlog.h"
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -52,6 +61,49 @@ class SstIterator;
  *   [max_tranc_id: uint64]  @ size-10
  *   [storage_mode: uint8 ]  @ size-2   (0=inline, 1=WiscKey)
  *   [magic       : uint8 ]  @ size-1   (0x4B constant)
+ *
+ * Footer layout (versioned), 所有新写入的 SST 使用该格式:
+ *   [meta_offset  : uint32]  @ +0
+ *   [bloom_offset : uint32]  @ +4
+ *   [min_tranc_id : uint64]  @ +8
+ *   [max_tranc_id : uint64]  @ +16
+ *   [storage_mode : uint8 ]  @ +24     (0=inline, 1=WiscKey)
+ *   [block_format : uint8 ]  @ +25     (BlockFormat, 1=v1, 2=v2)
+ *   [index_type   : uint8 ]  @ +26     (SstIndexType, 0=BlockMeta, 1=分区索引)
+ *   [filter_format: uint8 ]  @ +27     (FilterFormat, 1=分块布隆过滤器,
+ *                                       2/3=8/16 位 binary fuse 过滤器)
+ *   [sections     : uint8 ]  @ +28     (SST 中附加段的标记, 见下)
+ *   [properties_offset: uint32] @ +29  (Properties Section 的起始偏移)
+ *   [properties_size  : uint32] @ +33  (Properties Section 的字节数)
+ *   [footer_size  : uint8 ]  @ size-2  (整个 footer 的字节数, 当前为 39)
+ *   [magic        : uint8 ]  @ size-1  (0x4C constant)
+ * +N 为相对 footer 起点 (size - footer_size) 的偏移. 新的字段追加在 sections 之后、
+ * footer_size 之前, 读取时只解析认识的字段, 因此扩展 footer 不需要新的 magic
+ * 前两种 footer 的 SST 中的 data block 均为 v1 格式, 过滤器为 FilterFormat::LegacyBloom
+ * index_type 为 1 时 Meta Section 保存分区索引 (见 sst/sst_index.h)
+ *
+ * sections 带有 SECTION_PREFIX_EXTRACTOR (0x01) 时, Filter Section 在过滤器的编码之后
+ * 记录前缀提取器的名字, 此时过滤器中还有 key 的前缀:
+ * ----------------------------------------------------------
+ * | filter | extractor_name | extractor_name_len (16) |
+ * ----------------------------------------------------------
+ * sections 带有 SECTION_RANGE_FILTER (0x02) 时, Filter Section 末尾还有范围过滤器
+ * (utils/range_filter.h):
+ * ------------------------------------------------------------------------------
+ * | filter | [extractor_name | extractor_name_len (16)] | range_filter | range_filter_len (32) |
+ * ------------------------------------------------------------------------------
+ * sections 带有 SECTION_PROPERTIES (0x04) 时, Filter Section 之后是单独的
+ * Properties Section, 保存统计信息 (sst/table_properties.h), 位置由 footer 中的
+ * properties_offset / properties_size 给出, 此时 Filter Section 到 properties_offset 为止:
+ * ----------------------------------------------------------------------------
+ * | Block Section | Meta Section | Filter Section | Properties Section | Footer |
+ * ----------------------------------------------------------------------------
+ *
+ * versioned footer 的 SST 中, 每个 data block 在 Block::encode 的结果之后
+ * 带有压缩 trailer (见 utils/compression.h), 压缩算法可以逐块不同:
+ * ------------------------------------------------
+ * | payload | raw_size (32) | codec (8)          |
+ * ------------------------------------------------
  */
 
 class SST : public std::enable_shared_from_this<SST> {
@@ -69,7 +121,7 @@ private:
   size_t sst_id;
   std::string first_key;
   std::string last_key;
-  std::shared_ptr<BloomFilter> bloom_filter;
+  std::shared_ptr<KeyFilter> bloom_filter;
   std::shared_ptr<BlockCache> block_cache;
   uint64_t min_tranc_id_ = UINT64_MAX;
   uint64_t max_tranc_id_ = 0;
@@ -78,6 +130,26 @@ private:
   uint8_t storage_mode_ = 0; // 0=inline, 1=WiscKey
   std::shared_ptr<VLog> vlog_;
 
+  // data block 的编码格式, 由 footer 决定
+  BlockFormat block_format_ = BlockFormat::V1;
+  // data block 是否带有压缩 trailer (versioned footer)
+  bool block_trailer_ = false;
+  // 分区索引, 非空时 meta_entries 为空, block 的位置和范围都由它查询
+  std::shared_ptr<PartitionedIndex> index_;
+  // bloom_filter 的编码格式, 由 footer 决定
+  FilterFormat filter_format_ = FilterFormat::LegacyBloom;
+  // 构建时使用的前缀提取器, 为空时过滤器中只有完整的 key
+  std::shared_ptr<PrefixExtractor> prefix_extractor_;
+  // LSM_INDEX_RANGE_FILTER 开启时构建的范围过滤器, 为空时只按 first_key / last_key 判断
+  std::shared_ptr<RangeFilter> range_filter_;
+  // 构建时记录的统计信息, 之前写入的 SST 没有统计信息, 为空
+  std::shared_ptr<const TableProperties> properties_;
+
+  // block 在文件中的位置和 (磁盘上的) 大小
+  BlockHandle block_handle_(size_t block_idx);
+  // 去掉压缩 trailer (如果有) 后解码
+  std::shared_ptr<Block> decode_block_(std::vector<uint8_t> &&stored) const;
+
 public:
   // 从文件中打开sst (vlog defaults to nullptr for backward compat)
   static std::shared_ptr<SST> open(size_t sst_id, FileObj file,
@@ -88,15 +160,43 @@ public:
   // 根据索引读取block
   std::shared_ptr<Block> read_block(int64_t block_idx);
 
+  // 批量读取 block, 返回值与 block_idxs 一一对应
+  // 未命中块缓存的 block 一次性提交给异步读引擎 (LSM_IO_ENGINE)
+  // fill_cache 为 true 时读到的 block 放入块缓存, 大范围扫描可以绕过缓存
+  std::vector<std::shared_ptr<Block>>
+  read_blocks(const std::vector<size_t> &block_idxs, bool fill_cache = true);
+
   // 找到key所在的block的idx
   int64_t find_block_idx(const std::string &key);
 
+  // 第一个可能含有不小于 key 的记录的 block (last_key 或分隔符 >= key),
+  // 与 find_block_idx 不同, 不查询过滤器, key 不在 SST 中时也返回它之后的 block
+  // key 大于 SST 中所有 key 时返回 -1
+  int64_t lower_bound_block_idx(const std::string &key);
+
   // 根据key返回迭代器
   SstIterator get(const std::string &key, uint64_t tranc_id);
 
   // 返回sst中block的数量
   size_t num_blocks() const;
 
+  // 均匀抽样最多 max_samples 个 block 的边界 key, 升序
+  // 来自 meta_entries 的 block 首 key 或分区索引的分隔符, 不读取 data block
+  // 用于把 compaction 切分为按 key 区间并行的 subcompaction
+  std::vector<std::string> sample_block_keys(size_t max_samples);
+
+  // 返回 false 时 SST 中一定没有以 prefix 开头的 key
+  // 先比较 key 范围, 再用过滤器中的前缀 (见 PrefixExtractor::transform_prefix)
+  bool may_contain_prefix(const std::string &prefix) const;
+
+  // 返回 false 时 SST 中一定没有满足单调谓词 predicate 的 key
+  // (约定同 sst_iters_monotony_predicate), 先比较 key 范围, 再查询范围过滤器
+  bool may_match(const std::function<int(const std::string &)> &predicate) const;
+
+  // 构建时记录的统计信息 (记录数, 删除标记数, key/value 字节数等), 不读取 data block
+  // 不带统计信息的旧 SST 返回 nullptr
+  std::shared_ptr<const TableProperties> get_table_properties() const;
+
   // 返回sst的首key
   std::string get_first_key() const;
 
@@ -115,6 +215,15 @@ public:
   // Returns true if this SST uses WiscKey value separation
   bool is_wisckey() const;
 
+  BlockFormat get_block_format() const;
+
+  // 常驻内存的块索引 (meta_entries 或分区索引的 top-level) 占用的字节数
+  size_t index_memory_usage() const;
+
+  // 设置文件的访问模式, 仅对 mmap 打开的 SST 生效
+  // 打开时为 Random, 作为 compaction 输入时改为 Sequential
+  void advise(FileAccess access);
+
   std::optional<std::pair<SstIterator, SstIterator>>
   iters_monotony_predicate(std::function<bool(const std::string &)> predicate);
 
@@ -130,9 +239,26 @@ private:
   std::string first_key;
   std::string last_key;
   std::vector<BlockMeta> meta_entries;
+  // 未调用 open 时, 完成的 block 和 build 时的元数据都累积在 data 中,
+  // 由 build 一次写入文件; 调用 open 后改为追加到 writer_, data 保持为空
   std::vector<uint8_t> data;
+  std::unique_ptr<BufferedFileWriter> writer_;
   size_t block_size;
-  std::shared_ptr<BloomFilter> bloom_filter;
+  // 开启过滤器时记录每个 key 的 BloomFilter::key_hash (相同 key 只记录一次),
+  // build 时按实际的 key 数和 BLOOM_FILTER_BITS_PER_KEY 创建过滤器
+  bool has_bloom_;
+  double bloom_bits_per_key_;
+  std::vector<uint64_t> key_hashes_;
+  // 过滤器的类型, 默认为 L0 的配置 (BLOOM_FILTER_TYPE_PER_LEVEL)
+  FilterFormat filter_format_;
+  // BLOOM_FILTER_PREFIX_EXTRACTOR, 非空时 key 的前缀也记录到 key_hashes_
+  // 相同前缀的 key 是连续的, 只在前缀变化时记录
+  std::shared_ptr<PrefixExtractor> prefix_extractor_;
+  std::string last_prefix_;
+  // LSM_INDEX_RANGE_FILTER 开启时, 所有 key 按顺序加入范围过滤器
+  std::optional<RangeFilterBuilder> range_filter_builder_;
+  // 随 add 累计, build 时写入文件
+  TableProperties properties_;
   uint64_t min_tranc_id_ = UINT64_MAX;
   uint64_t max_tranc_id_ = 0;
 
@@ -141,6 +267,20 @@ private:
   std::shared_ptr<VLog> vlog_;
   size_t wisckey_threshold_ = 0;
 
+  // 新 block 使用的格式, 写入 footer (LSM_BLOCK_FORMAT_VERSION)
+  BlockFormat block_format_;
+  size_t restart_interval_;
+  // v2 block 的哈希索引 (LSM_BLOCK_HASH_INDEX_UTIL_RATIO), 0 表示不生成
+  double hash_util_ratio_;
+  // 新 block 使用的压缩算法, 默认为 L0 的配置
+  CompressionType compression_;
+  double compression_max_ratio_;
+  // 开启 LSM_INDEX_PARTITIONED 时构建分区索引, 代替 meta_entries 写入文件
+  std::optional<PartitionedIndexBuilder> index_builder_;
+
+  // 已完成的 block 的总大小, 即下一个 block 在文件中的偏移
+  size_t data_size_() const;
+
 public:
   // 创建一个sst构建器, 指定目标block的大小 (inline mode)
   SSTBuilder(size_t block_size, bool has_bloom);
@@ -149,13 +289,31 @@ public:
   SSTBuilder(size_t block_size, bool has_bloom,
              std::shared_ptr<VLog> vlog, size_t wisckey_threshold);
 
+  // 设置之后完成的 block 使用的压缩算法
+  void set_compression(CompressionType type);
+  // LSM_COMPRESSION_PER_LEVEL 中 level 层的压缩算法
+  static CompressionType compression_for_level(size_t level);
+  // 设置 build 时创建的过滤器类型
+  void set_filter_format(FilterFormat format);
+  // BLOOM_FILTER_TYPE_PER_LEVEL 中 level 层的过滤器
+  static FilterFormat filter_for_level(size_t level);
+  // 应用一层的构建参数 (block 大小, 重启间隔, 过滤器和压缩算法)
+  // 只能在第一次 add 之前调用, 否则抛出 std::logic_error
+  void set_level_options(const LevelOptions &options);
+
+  // 流式构建: 之后完成的 block 立即追加写入 path (经过 LSM_IO_WRITE_BUFFER_SIZE
+  // 大小的写缓冲区), 构建过程占用的内存与 SST 的大小无关
+  // 只能在第一次 add 之前调用, build 的 path 必须与之相同;
+  // builder 在 build 之前被销毁时删除未写完的文件
+  void open(const std::string &path);
+
   // 添加一个key-value对
   void add(const std::string &key, const std::string &value, uint64_t tranc_id);
   // 估计sst的大小
   size_t estimated_size() const;
   // 实际的大小（也就是 已经放进的大小和未放进去的data大小）
   size_t real_size() const;
-  // 完成当前block的构建, 即将block写入data, 并创建新的block
+  // 完成当前block的构建, 即将block写入data (或 writer_), 并创建新的block
   void finish_block();
   // 构建sst, 将sst写入文件并返回SST描述类
   std::shared_ptr<SST> build(size_t sst_id, const std::string &path,
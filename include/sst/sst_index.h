@@ -0,0 +1,129 @@
+#pragma once
+
+#include "block/block.h"
+#include "block/block_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * 分区索引 (index_type = 1) 代替 BlockMeta 数组保存在 Meta Section 中:
+ * ------------------------------------------------------------------------
+ * | partition | ... | partition |    top-level index    | top_offset (32) |
+ * ------------------------------------------------------------------------
+ * partition 是一个 v2 格式的 Block (带 CRC32C), 每条 entry 对应一个 data block:
+ *   key   = 分隔符, 满足 last_key(i) <= sep(i) < first_key(i + 1),
+ *           取满足条件的最短字符串, 最后一个 block 的分隔符为其 last_key
+ *   value = | offset (32) | size (32) |
+ *   tranc_id = 0
+ * top-level index 常驻内存, 每个 partition 一项:
+ * ---------------------------------------------------------------------------
+ * | num_blocks (32) | first_key_len (16) | first_key | num_partitions (32) |
+ * | sep_len (16) | sep | offset (32) | size (32) | first_block (32) | ...   |
+ * | crc32c (32)                                                            |
+ * ---------------------------------------------------------------------------
+ * 其中 sep 为 partition 中最后一个分隔符, first_block 为 partition 中第一个
+ * data block 的编号; top_offset 为 top-level index 在文件中的偏移
+ * partition 按需读取并放入块缓存, block_id 为 -1 - partition 编号
+ */
+
+namespace tiny_lsm {
+
+// SST 的 Meta Section 中保存的索引类型, 记录在 footer 中
+enum class SstIndexType : uint8_t {
+  Flat = 0,        // BlockMeta 数组, 打开 SST 时全部解码
+  Partitioned = 1, // 分区索引, 只有 top-level 常驻内存
+};
+
+// data block 在文件中的位置
+struct BlockHandle {
+  uint32_t offset = 0;
+  uint32_t size = 0;
+};
+
+// 返回最短的 s, 满足 a <= s < b, 要求 a < b
+std::string shortest_separator(const std::string &a, const std::string &b);
+
+class PartitionedIndexBuilder {
+public:
+  // partition_size 为每个 partition 编码后的目标字节数
+  explicit PartitionedIndexBuilder(size_t partition_size);
+
+  // 按顺序添加每个 data block
+  void add_block(const std::string &first_key, const std::string &last_key,
+                 BlockHandle handle);
+  // 将索引追加到 out 的末尾, out 的起始位置位于文件的 base_offset 处
+  // (流式构建时 out 只包含尚未写入文件的部分)
+  void finish(std::vector<uint8_t> &out, size_t base_offset = 0);
+  size_t num_blocks() const;
+
+private:
+  void add_separator_(const std::string &separator, BlockHandle handle);
+  void cut_partition_();
+
+  struct Partition {
+    std::vector<uint8_t> encoded;
+    std::string last_separator;
+    uint32_t first_block;
+  };
+
+  size_t partition_size_;
+  size_t num_blocks_ = 0;
+  std::string first_key_;
+  // 上一个 block 的分隔符需要等到下一个 block 的 first_key 才能确定
+  std::optional<std::pair<std::string, BlockHandle>> pending_;
+  Block current_;
+  std::string current_last_;
+  uint32_t current_first_block_ = 0;
+  std::vector<Partition> partitions_;
+};
+
+class PartitionedIndex {
+public:
+  using ReadFn = std::function<std::vector<uint8_t>(size_t offset,
+                                                    size_t length)>;
+
+  // 读取 [begin, end) 范围内的分区索引, 只有 top-level index 常驻内存
+  static std::shared_ptr<PartitionedIndex>
+  open(ReadFn read, size_t begin, size_t end, size_t sst_id,
+       std::shared_ptr<BlockCache> block_cache);
+
+  size_t num_blocks() const;
+  size_t num_partitions() const;
+  const std::string &first_key() const;
+  const std::string &last_key() const;
+
+  // 第一个分隔符不小于 key 的 block, 即唯一可能包含 key 的 block
+  // key 大于所有 block 时返回 -1
+  int64_t find_block_idx(const std::string &key);
+  BlockHandle block_handle(size_t block_idx);
+  // block 中所有 key 都不大于它的分隔符
+  std::string block_separator(size_t block_idx);
+
+  // 常驻内存的字节数 (不包括块缓存中的 partition)
+  size_t memory_usage() const;
+
+private:
+  struct TopEntry {
+    std::string separator;
+    BlockHandle handle;
+    uint32_t first_block;
+  };
+
+  // 返回 block_idx 所在 partition 的编号
+  size_t partition_of_(size_t block_idx) const;
+  std::shared_ptr<Block> read_partition_(size_t partition_idx);
+
+  ReadFn read_;
+  size_t sst_id_ = 0;
+  std::shared_ptr<BlockCache> block_cache_;
+  uint32_t num_blocks_ = 0;
+  std::string first_key_;
+  std::vector<TopEntry> top_;
+};
+} // namespace tiny_lsm
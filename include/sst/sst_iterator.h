@@ -1,5 +1,6 @@
 #pragma once
 #include "block/block_iterator.h"
+#include "sst/sst_readahead.h"
 #include <cstddef>
 #include <functional>
 #include <memory>
@@ -31,8 +32,12 @@ private:
   std::shared_ptr<BlockIterator> m_block_it;
   mutable std::optional<value_type> cached_value; // 缓存当前值
   bool keep_all_versions_ = false;
+  // 顺序扫描的预读, 第一次跨过 block 边界时创建, seek 时丢弃
+  std::shared_ptr<BlockReadahead> readahead_;
 
   void update_current() const;
+  // 读取 m_block_idx 处的 block, 用于 operator++ 跨过 block 边界
+  std::shared_ptr<Block> read_next_block_();
   void set_block_idx(size_t idx);
   void set_block_it(std::shared_ptr<BlockIterator> it);
 
@@ -49,8 +54,16 @@ public:
   iters_monotony_predicate(std::shared_ptr<SST> sst, uint64_t tranc_id,
                            std::function<bool(const std::string &)> predicate);
 
+  // 从第一个不小于 key 的记录开始的迭代器, 用于区间扫描和 subcompaction
+  // seek 只用于点查: key 不存在时直接为 end
+  static SstIterator lower_bound(std::shared_ptr<SST> sst, const std::string &key,
+                                 uint64_t tranc_id,
+                                 bool keep_all_versions = false);
+
   void seek_first();
   void seek(const std::string &key);
+  // 移动到第一个不小于 key 的记录, 不查询过滤器
+  void seek_lower_bound(const std::string &key);
   std::string key();
   std::string value();
 
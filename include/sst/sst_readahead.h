@@ -0,0 +1,70 @@
+#pragma once
+
+#include "block/block.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace tiny_lsm {
+
+/**
+ * 顺序扫描的自适应预读, 每个 SstIterator 一个
+ * 连续 kSequentialTrigger 次访问相邻的 block 后开始预读: 在后台线程中调用
+ * read (即 SST::read_blocks) 一次读取后续 window 个 block (提交给异步读引擎),
+ * 预读的 block 保存在自己的缓冲区中, 不依赖块缓存是否淘汰它们
+ * 剩余的预读 block 不足半个窗口时发起下一批, 每批之后窗口翻倍, 直到 max_blocks
+ * 访问不连续时 (seek) 丢弃缓冲区并把窗口恢复为 initial_blocks
+ */
+class BlockReadahead {
+public:
+  static constexpr size_t kSequentialTrigger = 2;
+
+  // 批量读取 block, 第二个参数为是否放入块缓存
+  using ReadFn = std::function<std::vector<std::shared_ptr<Block>>(
+      const std::vector<size_t> &block_idxs, bool fill_cache)>;
+
+  // last_block_idx 为迭代器当前所在的 block, 之后访问 last_block_idx + 1 视为顺序
+  // fill_cache 为 false 时预读的 block 不放入块缓存 (如 compaction 的输入)
+  BlockReadahead(ReadFn read, size_t num_blocks, int64_t last_block_idx,
+                 size_t initial_blocks, size_t max_blocks, bool fill_cache);
+  ~BlockReadahead();
+
+  BlockReadahead(const BlockReadahead &) = delete;
+  BlockReadahead &operator=(const BlockReadahead &) = delete;
+
+  // 返回 block_idx 对应的 block, 命中预读缓冲区时不需要 IO
+  std::shared_ptr<Block> get(size_t block_idx);
+
+  // 下一批预读的 block 数
+  size_t window() const;
+  // 由预读缓冲区提供的 block 数
+  size_t hits() const;
+
+private:
+  void reset_(size_t block_idx);
+  // 等待在途的预读完成并放入缓冲区, wait 为 false 时只收集已经完成的
+  void collect_(bool wait);
+  void maybe_prefetch_(size_t block_idx);
+
+  ReadFn read_;
+  size_t num_blocks_;
+  size_t initial_blocks_;
+  size_t max_blocks_;
+  bool fill_cache_;
+
+  int64_t last_block_idx_;
+  size_t sequential_ = 0;
+  size_t window_;
+  // 下一个尚未预读 (也不在途) 的 block
+  size_t next_prefetch_ = 0;
+  std::map<size_t, std::shared_ptr<Block>> buffer_;
+  std::future<std::vector<std::shared_ptr<Block>>> inflight_;
+  size_t inflight_begin_ = 0;
+  size_t inflight_end_ = 0;
+  size_t hits_ = 0;
+};
+} // namespace tiny_lsm
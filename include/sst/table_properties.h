@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tiny_lsm {
+
+/**
+ * SST 的统计信息, 由 SSTBuilder 在 add 时累计, build 时写入单独的 Properties Section,
+ * 位置记录在 footer 中, 打开 SST 时随 footer 一起读取, 之后不需要读取任何 data block
+ * 用于 compaction 挑选输入、估算数据量和容量统计
+ * 编码格式:
+ * ---------------------------------------------------------------------------
+ * | num_fields (8) | field (64) * num_fields | num_buckets (8) |
+ * | bucket (64) * num_buckets | crc32c (32) |
+ * ---------------------------------------------------------------------------
+ * field 依次为 num_entries, num_tombstones, raw_key_bytes, raw_value_bytes,
+ * num_distinct_keys, num_wisckey_values; 以后新增的字段追加在末尾,
+ * 解码时缺少的字段为 0, 不认识的字段被忽略
+ */
+struct TableProperties {
+  // 长度为 0 / 1 / [2, 4) / [4, 8) / ... / [32768, 65536) 的 key 各占一个桶
+  static constexpr size_t kKeySizeBuckets = 17;
+
+  // 记录数, 包括同一个 key 的所有版本和事务标记 (空 key)
+  uint64_t num_entries = 0;
+  // value 为空的记录 (删除标记), 不包括事务标记
+  uint64_t num_tombstones = 0;
+  uint64_t raw_key_bytes = 0;
+  // 用户写入的 value 的大小, 分离到 vlog 中的 value 按原始大小计算
+  uint64_t raw_value_bytes = 0;
+  // 不同 key 的数量 (同一个 key 的多个版本只计一次)
+  uint64_t num_distinct_keys = 0;
+  // value 分离到 vlog 中的记录数 (WiscKey)
+  uint64_t num_wisckey_values = 0;
+  std::array<uint64_t, kKeySizeBuckets> key_size_histogram{};
+
+  // 按 SST 中的顺序记录一条记录, new_key 表示 key 与上一条不同,
+  // wisckey 表示 value 写入了 vlog
+  void add(const std::string &key, size_t value_size, bool new_key,
+           bool wisckey);
+
+  // 累加另一个 SST 的统计信息, 用于按层或整个引擎汇总
+  // (不同 SST 中的相同 key 在 num_distinct_keys 中会重复计算)
+  void merge(const TableProperties &other);
+
+  // key_size 所在的桶, 超过 65535 的长度计入最后一个桶
+  static size_t key_size_bucket(size_t key_size);
+
+  double average_key_size() const;
+  double average_value_size() const;
+
+  std::vector<uint8_t> encode() const;
+  static TableProperties decode(const std::vector<uint8_t> &data);
+
+  // 单行的可读形式, 用于日志
+  std::string to_string() const;
+};
+} // namespace tiny_lsm
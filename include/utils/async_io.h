@@ -0,0 +1,46 @@
+// include/utils/async_io.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiny_lsm {
+
+// 一次读请求, 完成后 data 为 [offset, offset + length) 的内容
+struct ReadRequest {
+  int fd = -1;
+  uint64_t offset = 0;
+  size_t length = 0;
+  std::vector<uint8_t> data;
+  // 0 表示成功, 否则为 errno (读到文件末尾时为 EIO)
+  int error = 0;
+};
+
+// 异步读引擎: 一批请求同时提交给内核, 全部完成后返回
+// 批量查询, 迭代器预读和 compaction 读取输入时一次提交多个 block,
+// NVMe 上队列越深, 吞吐越接近设备的 IOPS 上限, 而不是受限于单次读取的延迟
+// 所有实现都是线程安全的, 多个线程可以同时提交各自的批次
+class AsyncIoEngine {
+public:
+  virtual ~AsyncIoEngine() = default;
+
+  // 提交 requests 中的所有请求并等待完成, 请求之间的完成顺序不确定
+  // 单个请求失败只设置它的 error, 不影响其他请求
+  virtual void read_batch(std::vector<ReadRequest> &requests) = 0;
+
+  virtual std::string name() const = 0;
+
+  // kind 为 "io_uring" / "threadpool" / "sync"
+  // queue_depth 为 io_uring 中同时在途的请求数, threads 为线程池的线程数
+  // 内核不支持 io_uring (或被 seccomp 禁用) 时退化为线程池
+  static std::unique_ptr<AsyncIoEngine>
+  create(const std::string &kind, size_t queue_depth, size_t threads);
+};
+
+// 当前内核是否可以创建 io_uring
+bool io_uring_supported();
+} // namespace tiny_lsm
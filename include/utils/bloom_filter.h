@@ -2,44 +2,83 @@
 
 #pragma once
 
+#include "utils/key_filter.h"
 #include <cmath>
 #include <cstdint>
 #include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace tiny_lsm {
 
-class BloomFilter {
+/**
+ * 分块布隆过滤器 (split block bloom filter):
+ * - 位数组由 256 bit 的 block 组成, 每个 block 为 8 个 32 位的 lane,
+ *   一个 key 只访问一个 block (不跨缓存行), 在每个 lane 中各置一位
+ * - key 只计算一次 64 位哈希 (hash64): 高 32 位选 block, 低 32 位分别乘以
+ *   8 个奇数常量得到每个 lane 中的位, 8 个 lane 的计算互相独立, 支持 AVX2 时
+ *   一条指令完成
+ * - 大小由 bits_per_key 和实际的 key 数决定, SSTBuilder 在 build 时才创建过滤器
+ * 编码格式 (FilterFormat::BlockedBloom):
+ * ------------------------------------------------------------------
+ * | num_blocks (32) | num_keys (32) | blocks (32 * num_blocks) | crc32c (32) |
+ * ------------------------------------------------------------------
+ */
+class BloomFilter : public KeyFilter {
 public:
-  // 构造函数，初始化布隆过滤器
-  // expected_elements: 预期插入的元素数量
-  // false_positive_rate: 允许的假阳性率
   BloomFilter();
+  // 预期插入 expected_elements 个元素, 假阳性率约为 false_positive_rate
   BloomFilter(size_t expected_elements, double false_positive_rate);
 
-  BloomFilter(size_t expected_elements, double false_positive_rate,
-              size_t num_bits);
+  // 由 key_hash 的结果构建, 每个 key 约占 bits_per_key 位
+  // 10 bits/key 时假阳性率约为 1%
+  static BloomFilter build(const std::vector<uint64_t> &key_hashes,
+                           double bits_per_key);
+
+  // 添加和查询使用的哈希, 调用方可以预先计算
+  static uint64_t key_hash(std::string_view key);
 
   void add(const std::string &key);
 
   // 如果key可能存在于布隆过滤器中，返回true；否则返回false
-  bool possibly_contains(const std::string &key) const;
+  bool possibly_contains(const std::string &key) const override;
+  bool possibly_contains_hash(uint64_t hash) const;
 
   // 清空布隆过滤器
   void clear();
 
-  std::vector<uint8_t> encode();
-  static BloomFilter decode(const std::vector<uint8_t> &data);
+  FilterFormat format() const override;
+  // 位数组的字节数
+  size_t size_bytes() const override;
+
+  std::vector<uint8_t> encode() override;
+  static BloomFilter
+  decode(const std::vector<uint8_t> &data,
+         FilterFormat format = FilterFormat::BlockedBloom);
 
 private:
+  static constexpr size_t kLanes = 8;
+  static constexpr size_t kBitsPerBlock = kLanes * 32;
+
+  void init_blocks_(size_t num_bits);
+  void insert_hash_(uint64_t hash);
+
+  FilterFormat format_ = FilterFormat::BlockedBloom;
+
+  // BlockedBloom: 每 kLanes 个 uint32_t 为一个 block
+  std::vector<uint32_t> blocks_;
+  size_t num_blocks_ = 0;
+  size_t num_keys_ = 0;
+
+  // LegacyBloom
   // 布隆过滤器的位数组大小
-  size_t expected_elements_;
+  size_t expected_elements_ = 0;
   // 允许的假阳性率
-  double false_positive_rate_;
-  size_t num_bits_;
+  double false_positive_rate_ = 0;
+  size_t num_bits_ = 0;
   // 哈希函数的数量
-  size_t num_hashes_;
+  size_t num_hashes_ = 0;
   // 布隆过滤器的位数组
   std::vector<bool> bits_;
 
@@ -54,4 +93,4 @@ private:
 
   size_t hash(const std::string &key, size_t idx) const;
 };
-} // namespace tiny_lsm
\ No newline at end of file
+} // namespace tiny_lsm
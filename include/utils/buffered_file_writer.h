@@ -0,0 +1,53 @@
+// include/utils/buffered_file_writer.h
+
+#pragma once
+
+#include "utils/std_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiny_lsm {
+
+/**
+ * 只追加的带缓冲文件写入, 用于流式构建 SST
+ * - append 的数据先放入固定大小的缓冲区, 缓冲区满时一次写入文件,
+ *   写入过程中占用的内存不超过 buffer_size (单次 append 超过缓冲区时直接写入)
+ * - offset() 为已经 append 的总字节数 (包括还在缓冲区中的), 即下一次写入的偏移
+ * - finish() 写出剩余数据并同步到磁盘, 之后不能再写入
+ * - 在 finish 之前析构 (如构建过程中抛出异常) 时删除未写完的文件
+ * - 任何一次写入或同步失败都抛出 std::runtime_error, 不会留下静默截断的文件
+ */
+class BufferedFileWriter {
+public:
+  // 创建 (或清空) path, buffer_size 为 0 时使用 LSM_IO_WRITE_BUFFER_SIZE
+  explicit BufferedFileWriter(const std::string &path, size_t buffer_size = 0);
+  ~BufferedFileWriter();
+
+  BufferedFileWriter(const BufferedFileWriter &) = delete;
+  BufferedFileWriter &operator=(const BufferedFileWriter &) = delete;
+
+  void append(const uint8_t *data, size_t size);
+  void append(const std::vector<uint8_t> &buf);
+
+  size_t offset() const;
+  const std::string &path() const;
+
+  void finish();
+  bool finished() const;
+
+private:
+  // 将缓冲区写入文件
+  void flush_();
+
+  std::string path_;
+  std::unique_ptr<StdFile> file_;
+  std::vector<uint8_t> buffer_;
+  size_t buffer_size_;
+  // 已经写入文件的字节数
+  size_t file_offset_ = 0;
+  bool finished_ = false;
+};
+} // namespace tiny_lsm
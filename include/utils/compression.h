@@ -0,0 +1,72 @@
+// include/utils/compression.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiny_lsm {
+
+// 压缩算法的 id, 会写入每个 block 的 trailer, 已分配的值不能修改
+// 自定义的编解码器可以使用未分配的 id
+enum class CompressionType : uint8_t {
+  None = 0,
+  LZ = 1, // 内置的 LZ77 类算法, 格式与 LZ4 block 类似
+};
+
+// 编解码器接口, 实现需要是无状态的, 可以被多个线程同时调用
+class CompressionCodec {
+public:
+  virtual ~CompressionCodec() = default;
+  virtual CompressionType type() const = 0;
+  // 配置文件中使用的名字
+  virtual std::string name() const = 0;
+  // 压缩 [src, src + len), 结果追加到 out 的末尾
+  virtual void compress(const uint8_t *src, size_t len,
+                        std::vector<uint8_t> &out) const = 0;
+  // 解压 [src, src + len), 结果追加到 out 的末尾
+  // raw_size 为压缩前的长度, 数据损坏时返回 false
+  virtual bool decompress(const uint8_t *src, size_t len, size_t raw_size,
+                          std::vector<uint8_t> &out) const = 0;
+};
+
+class LZCodec : public CompressionCodec {
+public:
+  CompressionType type() const override;
+  std::string name() const override;
+  void compress(const uint8_t *src, size_t len,
+                std::vector<uint8_t> &out) const override;
+  bool decompress(const uint8_t *src, size_t len, size_t raw_size,
+                  std::vector<uint8_t> &out) const override;
+};
+
+// 注册自定义的编解码器, 会覆盖相同 id 的编解码器
+// 需要在打开任何 SST 之前调用, 注册本身不是线程安全的
+void register_compression_codec(std::shared_ptr<CompressionCodec> codec);
+// 未注册的 id 返回 nullptr, None 没有编解码器
+std::shared_ptr<CompressionCodec> get_compression_codec(CompressionType type);
+
+std::string compression_type_to_string(CompressionType type);
+// "none" 返回 None, 未注册的名字抛出 std::invalid_argument
+CompressionType compression_type_from_string(const std::string &name);
+
+/**
+ * 带压缩 trailer 的 block:
+ * ------------------------------------------------
+ * |   payload   | raw_size (32) | codec (8)      |
+ * ------------------------------------------------
+ * payload 为压缩后的数据, codec 为 None 时即原始数据
+ * 压缩后的大小超过 raw_size * max_ratio 时 (压缩收益太小) 直接保存原始数据
+ */
+std::vector<uint8_t> compress_block(const std::vector<uint8_t> &raw,
+                                    CompressionType type, double max_ratio);
+// 数据损坏或编解码器未注册时抛出 std::runtime_error
+std::vector<uint8_t> decompress_block(const std::vector<uint8_t> &stored);
+// 未压缩的 block 直接截断 stored 并返回, 不拷贝
+std::vector<uint8_t> decompress_block(std::vector<uint8_t> &&stored);
+// 读取 trailer 中记录的编解码器
+CompressionType block_compression_type(const std::vector<uint8_t> &stored);
+} // namespace tiny_lsm
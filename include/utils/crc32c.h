@@ -0,0 +1,33 @@
+// include/utils/crc32c.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace tiny_lsm {
+
+// CRC32C (Castagnoli, 多项式 0x1EDC6F41) 校验和, 用于 data block, WAL 记录
+// 和 VLog 记录
+// x86 上使用 SSE4.2 的 crc32 指令 (运行时检测), ARMv8 上使用 CRC 扩展,
+// 其余平台使用查表实现, 三者结果一致
+
+// 在 crc 的基础上继续计算 [data, data + len) 的校验和, 可以分段计算:
+// crc32c_extend(crc32c(a), b) == crc32c(a + b)
+uint32_t crc32c_extend(uint32_t crc, const uint8_t *data, size_t len);
+
+inline uint32_t crc32c(const uint8_t *data, size_t len) {
+  return crc32c_extend(0, data, len);
+}
+
+inline uint32_t crc32c(std::string_view data) {
+  return crc32c(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+// 查表实现, 用于不支持硬件指令的平台, 以及测试硬件实现的正确性
+uint32_t crc32c_extend_portable(uint32_t crc, const uint8_t *data, size_t len);
+
+// 当前平台是否使用了硬件指令
+bool crc32c_hw_accelerated();
+} // namespace tiny_lsm
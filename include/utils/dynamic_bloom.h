@@ -0,0 +1,44 @@
+// include/utils/dynamic_bloom.h
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace tiny_lsm {
+
+// 内存中的布隆过滤器, 用于 memtable 的点查:
+// - 位数组按缓存行 (512 bit) 分块, 一个 key 的全部探测都落在同一块内,
+//   每次查询最多一次缓存未命中
+// - 写入使用原子 fetch_or, 可以与其他写入和查询并发执行, 无需加锁
+// - 大小在构造时确定, 不支持编码到磁盘 (SST 使用 BloomFilter)
+class DynamicBloom {
+public:
+  // total_bits 会向上取整到缓存行的整数倍
+  explicit DynamicBloom(size_t total_bits, uint32_t num_probes = 6);
+
+  void add(std::string_view key);
+
+  // 返回 false 时 key 一定没有被 add 过
+  bool may_contain(std::string_view key) const;
+
+  size_t memory_usage() const;
+
+private:
+  static constexpr uint32_t kBitsPerBlock = 512;
+
+  struct alignas(64) Block {
+    std::atomic<uint64_t> words[kBitsPerBlock / 64];
+  };
+
+  static uint64_t hash(std::string_view key);
+  size_t block_index(uint64_t h) const;
+
+  size_t num_blocks_;
+  uint32_t num_probes_;
+  std::unique_ptr<Block[]> blocks_;
+};
+} // namespace tiny_lsm
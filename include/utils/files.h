@@ -2,19 +2,45 @@
 
 #include "mmap_file.h"
 #include "std_file.h"
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace tiny_lsm {
 
+class AsyncIoEngine;
 class Cursor;
 
+// 只读映射文件的访问模式, 对应 madvise 的提示
+enum class FileAccess {
+  Normal,
+  Random,     // 点查: 关闭内核预读
+  Sequential, // 顺序扫描 (如 compaction 的输入): 加大预读, 读过的页尽早回收
+};
+
 class FileObj {
 private:
   std::unique_ptr<StdFile> m_file;
+#ifndef _WIN32
+  // 只读映射, 非空时所有读取直接从映射中复制, 不经过 fstream
+  std::unique_ptr<MmapFile> m_mmap;
+  // 供 read_batch 使用的只读 fd, 异步读引擎直接对它发起 pread / io_uring 读
+  // 第一次通过引擎批量读取时才打开, WAL / VLog 等只顺序读写的文件不会占用它
+  std::atomic<int> m_read_fd{-1};
+#endif
+  std::string m_path;
+
+  // 只读映射的文件不允许写入
+  bool writable_() const;
+#ifndef _WIN32
+  // 返回只读 fd, 尚未打开时打开 (多个线程可以同时调用), 失败时返回 -1
+  int read_fd_();
+  void close_read_fd_();
+#endif
 
 public:
   FileObj();
@@ -39,9 +65,28 @@ public:
   static FileObj create_and_write(const std::string &path,
                                   std::vector<uint8_t> buf);
   static FileObj open(const std::string &path, bool create = false);
+  // 只读打开并映射到内存, 用于 SST 等写入后不再修改的文件
+  // 映射后的读取不需要系统调用, 多个线程可以同时读取
+  // 不支持 mmap 的平台退化为 open(path, false)
+  static FileObj open_mmap(const std::string &path);
+
+  bool is_mmapped() const;
+  // 设置映射的访问模式 (madvise), 未映射时忽略
+  void advise(FileAccess access);
+  // 映射中 [offset, offset + length) 的只读指针, 未映射时返回 nullptr
+  const uint8_t *mapped_data(size_t offset, size_t length) const;
 
   // 读取方法
   std::vector<uint8_t> read_to_slice(size_t offset, size_t length);
+  // 批量读取多个 (offset, length) 区间, 返回值与 ranges 一一对应
+  // engine 非空时优先: 即使文件已经映射, 也通过 engine 一次提交所有读请求
+  // (SST 在 LSM_IO_ENGINE 为 io_uring / threadpool 时传入引擎, 为 sync 时传入空);
+  // engine 为空时, 映射的文件先对所有区间 MADV_WILLNEED, 让内核并发读入缺页,
+  // 再逐个复制, 未映射的文件逐个读取
+  // 只读 fd 看不到 fstream 中尚未 flush 的写入, 只应用于写完的文件 (如 SST)
+  std::vector<std::vector<uint8_t>>
+  read_batch(const std::vector<std::pair<size_t, size_t>> &ranges,
+             AsyncIoEngine *engine);
   uint8_t read_uint8(size_t offset);
   uint16_t read_uint16(size_t offset);
   uint32_t read_uint32(size_t offset);
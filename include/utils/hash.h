@@ -0,0 +1,19 @@
+// include/utils/hash.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace tiny_lsm {
+
+// 64 位非加密哈希 (XXH64 的单轮变体), 一次遍历, 不分配内存
+// 用于 SST 的布隆过滤器, 结果写入磁盘, 因此与平台和标准库实现无关
+uint64_t hash64(const uint8_t *data, size_t len, uint64_t seed = 0);
+
+inline uint64_t hash64(std::string_view data, uint64_t seed = 0) {
+  return hash64(reinterpret_cast<const uint8_t *>(data.data()), data.size(),
+                seed);
+}
+} // namespace tiny_lsm
@@ -0,0 +1,49 @@
+// include/utils/key_filter.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tiny_lsm {
+
+// SST 中过滤器的编码格式, 记录在 SST 的 footer 中
+enum class FilterFormat : uint8_t {
+  // 旧格式: std::vector<bool> 位数组 + 两个 std::hash, 只用于读取旧 SST
+  LegacyBloom = 0,
+  // 分块布隆过滤器 (utils/bloom_filter.h)
+  BlockedBloom = 1,
+  // binary fuse 过滤器 (utils/binary_fuse_filter.h), 8 / 16 位指纹
+  BinaryFuse8 = 2,
+  BinaryFuse16 = 3,
+};
+
+// SST 过滤器的公共接口, SST 构建完成后不再修改
+class KeyFilter {
+public:
+  virtual ~KeyFilter() = default;
+
+  virtual FilterFormat format() const = 0;
+  // 返回 false 时 key 一定不在 SST 中
+  virtual bool possibly_contains(const std::string &key) const = 0;
+  // 常驻内存的字节数
+  virtual size_t size_bytes() const = 0;
+  virtual std::vector<uint8_t> encode() = 0;
+
+  // 由 BloomFilter::key_hash 的结果构建 format 格式的过滤器
+  // bits_per_key 只对布隆过滤器生效, binary fuse 的大小由指纹位数决定
+  static std::shared_ptr<KeyFilter> build(FilterFormat format,
+                                          const std::vector<uint64_t> &key_hashes,
+                                          double bits_per_key);
+  static std::shared_ptr<KeyFilter> decode(const std::vector<uint8_t> &data,
+                                           FilterFormat format);
+};
+
+// 配置中使用的名字: bloom / fuse8 / fuse16
+std::string filter_format_to_string(FilterFormat format);
+// 未知的名字抛出 std::invalid_argument
+FilterFormat filter_format_from_string(const std::string &name);
+} // namespace tiny_lsm
@@ -0,0 +1,71 @@
+// include/utils/memory_budget.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace tiny_lsm {
+
+// 进程级的内存预算:
+// memtable 和块缓存作为消费者注册到预算中, 预算按需拉取各消费者的实际内存占用
+// (包括节点、容器和分配器的开销), 超出上限时先收缩块缓存, 仍不够再要求
+// memtable 提前刷盘
+class MemoryBudget {
+public:
+  enum class ConsumerType {
+    BlockCache, // 可以同步释放内存
+    MemTable,   // 只能异步刷盘释放内存
+  };
+
+  // 返回当前占用的字节数
+  using UsageFn = std::function<size_t()>;
+  // 请求释放 bytes 字节, 返回同步释放的字节数; 异步释放 (如触发刷盘) 返回 0
+  using ReclaimFn = std::function<size_t(size_t bytes)>;
+
+  // limit 为 0 表示不限制
+  explicit MemoryBudget(size_t limit = 0);
+
+  // 进程内所有 LSM 实例共享的预算
+  static std::shared_ptr<MemoryBudget> global();
+
+  // 注册消费者, 返回用于注销的 id
+  // 回调在预算的锁内执行, 因此回调中不能再访问预算, 消费者也不能在持有
+  // 自身锁的同时调用预算的接口
+  uint64_t add_consumer(const std::string &name, ConsumerType type,
+                        UsageFn usage, ReclaimFn reclaim);
+  // 注销后保证不会再有该消费者的回调在执行
+  void remove_consumer(uint64_t id);
+
+  size_t usage() const;
+  size_t usage(ConsumerType type) const;
+  size_t limit() const;
+  void set_limit(size_t limit);
+  bool exceeded() const;
+
+  // 超出预算时回收内存, 返回回收后仍然超出的字节数
+  // 1. 按占用从大到小收缩块缓存
+  // 2. 仍然超出时, 按占用从大到小要求 memtable 刷盘, 直到预计释放量足够
+  size_t reclaim();
+
+private:
+  struct Consumer {
+    std::string name;
+    ConsumerType type;
+    UsageFn usage;
+    ReclaimFn reclaim;
+  };
+
+  size_t usage_locked_(const ConsumerType *type) const;
+
+  mutable std::mutex mutex_;
+  size_t limit_;
+  uint64_t next_id_ = 1;
+  std::map<uint64_t, Consumer> consumers_;
+};
+} // namespace tiny_lsm
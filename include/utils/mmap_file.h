@@ -31,6 +31,18 @@ public:
   // 打开文件并映射到内存
   bool open(const std::string &filename, bool create = false);
 
+  // 只读打开并映射 (PROT_READ), 映射后的读取不需要系统调用, 可以并发进行
+  bool open_readonly(const std::string &filename);
+
+  // 对 [offset, offset + length) 调用 madvise, length 为 0 表示到文件末尾
+  // advice 为 MADV_RANDOM / MADV_SEQUENTIAL / MADV_WILLNEED 等
+  bool advise(int advice, size_t offset = 0, size_t length = 0);
+
+  // 返回映射中 offset 处的指针, 调用方保证不越界
+  const uint8_t *view(size_t offset) const {
+    return static_cast<const uint8_t *>(mapped_data_) + offset;
+  }
+
   // 创建文件
   bool create(const std::string &filename, const std::vector<uint8_t> &buf);
 
@@ -44,7 +56,7 @@ public:
   bool write(size_t offset, const void *data, size_t size);
 
   // 读取数据
-  std::vector<uint8_t> read(size_t offset, size_t length);
+  std::vector<uint8_t> read(size_t offset, size_t length) const;
 
   // 同步到磁盘
   bool sync();
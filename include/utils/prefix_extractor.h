@@ -0,0 +1,45 @@
+// include/utils/prefix_extractor.h
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace tiny_lsm {
+
+/**
+ * 前缀提取器: SSTBuilder 把每个 key 的前缀也加入 SST 的过滤器,
+ * 前缀查询 (LSM::prefix_iter) 用过滤器跳过一定不含该前缀的 SST
+ * 配置 (BLOOM_FILTER_PREFIX_EXTRACTOR):
+ * - none: 不提取前缀
+ * - fixed:N: key 的前 N 个字节, 短于 N 的 key 没有前缀
+ * - capped:N: key 的前 N 个字节, 短于 N 的 key 整个作为前缀
+ * - redis: 集合与有序集合的 key (REDIS_SET_PREFIX / REDIS_SORTED_SET_PREFIX
+ *   开头) 取到类型前缀之后的第一个 '_' (含), 即 "REDIS_SET_<key>_",
+ *   其余 key 没有前缀. 哈希表的字段列表存放在 REDIS_HASH_VALUE_<key> 中,
+ *   以 REDIS_FIELD_SEPARATOR ('$') 分隔, HKEYS 不做前缀扫描, 因此
+ *   REDIS_FIELD_<key>_<field> 不提取前缀
+ * 提取器的名字写入 SST, 修改配置后旧 SST 仍按写入时的提取器查询
+ */
+class PrefixExtractor {
+public:
+  virtual ~PrefixExtractor() = default;
+
+  // 写入 SST 的名字, 即配置中的写法
+  virtual std::string name() const = 0;
+
+  // key 加入过滤器的前缀, key 不在定义域内时返回 nullopt
+  virtual std::optional<std::string_view>
+  transform(std::string_view key) const = 0;
+
+  // 所有以 prefix 开头的 key 共有的 transform 结果
+  // 无法确定时返回 nullopt, 此时过滤器不能排除 SST
+  virtual std::optional<std::string_view>
+  transform_prefix(std::string_view prefix) const = 0;
+
+  // spec 为 "none" 时返回 nullptr, 无法解析时抛出 std::invalid_argument
+  static std::shared_ptr<PrefixExtractor> create(const std::string &spec);
+};
+} // namespace tiny_lsm
@@ -0,0 +1,92 @@
+// include/utils/range_filter.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tiny_lsm {
+
+/**
+ * 范围过滤器 (SuRF-Base 的截断 trie 语义): 回答 "[lower, upper) 中是否可能有 key"
+ * - 每个 key 只保存能与相邻 key 区分的最短前缀, 再多保留 suffix_bytes 个字节
+ *   (SuRF-Real), 截断后的前缀代表所有以它开头的 key
+ * - 截断只会把 key 扩大为一个区间, 因此不会漏报; 查询区间落在两个相邻前缀
+ *   之间时可以排除, 范围越短越容易排除
+ * - 前缀按顺序做前缀压缩 (与 v2 block 相同), 每 kRestartInterval 个前缀一个
+ *   重启点, 查询时在重启点上二分, 再顺序扫描一组
+ * 编码格式:
+ * -----------------------------------------------------------------------------
+ * | entries | restarts (32 * R) | num_restarts (32) | num_entries (32) | crc32c |
+ * -----------------------------------------------------------------------------
+ * entry: | header (8) | [shared (varint) | unshared (varint)] | key_delta |
+ * header 最低位表示前缀是否被截断, shared < 15 且 unshared < 8 时长度直接保存在
+ * header 中 (shared << 4 | unshared << 1), 否则 header 高 4 位为 15, 长度在其后
+ */
+class RangeFilter {
+public:
+  static constexpr size_t kRestartInterval = 16;
+
+  // 按 predicate 的约定 (0: 命中, >0: 在范围之前, <0: 在范围之后, 需单调)
+  // 判断是否可能有 key 命中, 返回 false 时一定没有
+  bool may_match(const std::function<int(const std::string &)> &predicate) const;
+  // [lower, upper) 中是否可能有 key
+  bool may_contain_range(const std::string &lower,
+                         const std::string &upper) const;
+
+  size_t num_entries() const;
+  // 常驻内存的字节数 (即编码的大小)
+  size_t size_bytes() const;
+
+  const std::vector<uint8_t> &encode() const;
+  // 校验失败时抛出 std::runtime_error
+  static RangeFilter decode(std::vector<uint8_t> data);
+
+private:
+  struct Entry {
+    std::string key;
+    bool truncated;
+  };
+
+  // 解码从 offset 开始的一个 entry, prev 为上一个 entry 的 key
+  size_t decode_entry_(size_t offset, const std::string &prev,
+                       Entry &entry) const;
+  // entry 代表的 key 是否全部在范围之前
+  static bool before_(const Entry &entry,
+                      const std::function<int(const std::string &)> &predicate);
+
+  std::vector<uint8_t> data_;
+  // 各重启点的偏移, decode 时从 data_ 中读出
+  std::vector<uint32_t> restarts_;
+  size_t entries_end_ = 0;
+  uint32_t num_entries_ = 0;
+};
+
+// 按顺序接收 key 并构建 RangeFilter, 只保存最近的两个 key
+class RangeFilterBuilder {
+public:
+  explicit RangeFilterBuilder(size_t suffix_bytes);
+
+  // key 必须递增, 与上一个 key 相同时忽略
+  void add(std::string_view key);
+  std::vector<uint8_t> finish();
+
+private:
+  // key 与相邻 key 的最长公共前缀为 lcp
+  void emit_(const std::string &key, size_t lcp);
+
+  size_t suffix_bytes_;
+  std::string cur_key_;
+  bool has_cur_ = false;
+  size_t lcp_prev_ = 0;
+
+  std::string last_entry_;
+  std::vector<uint8_t> data_;
+  std::vector<uint32_t> restarts_;
+  uint32_t num_entries_ = 0;
+};
+} // namespace tiny_lsm
@@ -0,0 +1,60 @@
+// include/utils/snapshot_list.h
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+
+namespace tiny_lsm {
+
+class SnapshotList;
+
+// 已登记的读快照, 析构时自动注销
+// 读操作 (点查、迭代器、事务) 在整个生命周期内持有它,
+// 即使中途抛出异常或被丢弃也不会让水位永远停留在它的 id
+class Snapshot {
+  friend class SnapshotList;
+
+public:
+  Snapshot(const Snapshot &) = delete;
+  Snapshot &operator=(const Snapshot &) = delete;
+  ~Snapshot();
+
+  uint64_t tranc_id() const;
+
+private:
+  Snapshot(std::weak_ptr<SnapshotList> list, uint64_t tranc_id,
+           std::multiset<uint64_t>::iterator pos);
+
+  std::weak_ptr<SnapshotList> list_;
+  uint64_t tranc_id_;
+  std::multiset<uint64_t>::iterator pos_;
+};
+
+// 所有进行中的读快照, memtable 据此判断旧版本是否还可能被读到
+class SnapshotList : public std::enable_shared_from_this<SnapshotList> {
+  friend class Snapshot;
+
+public:
+  // 登记一个已知 id 的快照 (如调用方指定 tranc_id 的迭代器)
+  std::shared_ptr<Snapshot> acquire(uint64_t tranc_id);
+  // 在锁内分配 id 并登记, 与 oldest() 互斥:
+  // oldest() 要么看到这个快照, 要么这个快照的 id 晚于此前分配的所有 id
+  std::shared_ptr<Snapshot>
+  acquire(const std::function<uint64_t()> &allocate_id);
+
+  // 最小的已登记快照 id, 没有快照时为空
+  std::optional<uint64_t> oldest() const;
+  size_t size() const;
+
+private:
+  void release_(std::multiset<uint64_t>::iterator pos);
+
+  mutable std::mutex mutex_;
+  std::multiset<uint64_t> ids_;
+};
+} // namespace tiny_lsm
@@ -43,6 +43,10 @@ public:
   bool operator!=(const Record &other) const;
 
 private:
+  // 每条记录末尾的 CRC32C 校验和, operation_type 字节的最高位标记其存在
+  static constexpr uint8_t CHECKSUM_FLAG = 0x80;
+  static constexpr uint16_t CHECKSUM_SIZE = sizeof(uint32_t);
+
   uint64_t tranc_id_;
   OperationType operation_type_;
   std::string key_;
@@ -1,5 +1,7 @@
 #include "block/block.h"
 #include "block/block_iterator.h"
+#include "utils/crc32c.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -8,23 +10,64 @@
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace tiny_lsm {
+namespace {
+// 哈希索引 bucket 的特殊取值
+constexpr uint8_t kHashNoEntry = 255;
+constexpr uint8_t kHashCollision = 254;
+constexpr size_t kHashMaxRestarts = 253;
+// num_restarts 的最高位标记是否存在哈希索引
+constexpr uint16_t kHashIndexFlag = 0x8000;
+
+size_t num_hash_buckets(size_t num_keys, double util_ratio) {
+  size_t n = static_cast<size_t>(num_keys / util_ratio);
+  // 奇数个 bucket, 取模时高位也能参与
+  return std::clamp<size_t>(n, 1, UINT16_MAX - 1) | 1;
+}
+} // namespace
+
 Block::Block(size_t capacity) : capacity(capacity) {}
 
+Block::Block(size_t capacity, BlockFormat format, size_t restart_interval,
+             double hash_util_ratio)
+    : capacity(capacity), format_(format),
+      restart_interval_(restart_interval == 0 ? 1 : restart_interval),
+      hash_util_ratio_(format == BlockFormat::V2 && hash_util_ratio > 0
+                           ? hash_util_ratio
+                           : 0) {}
+
+BlockFormat Block::get_format() const { return format_; }
+
+bool Block::has_hash_index() const { return hash_index_size_() > 0; }
+
 std::vector<uint8_t> Block::encode(bool with_hash) {
+  if (format_ == BlockFormat::V2) {
+    return encode_v2_(with_hash);
+  }
   // TODO: Lab 3.1 编码单个类实例形成一段字节数组
   // ? 格式: [data段] + [offsets数组, 每项uint16_t] + [元素个数 uint16_t]
-  // ? 若 with_hash == true, 末尾额外追加 uint32_t 的 CRC 校验值
+  // ? 若 with_hash == true, 末尾额外追加 uint32_t 的 CRC32C 校验值 (utils/crc32c.h)
   // ? CRC 覆盖除自身之外的所有字节
   return {};
 }
 
 std::shared_ptr<Block> Block::decode(const std::vector<uint8_t> &encoded,
-                                     bool with_hash) {
+                                     bool with_hash, BlockFormat format) {
+  return decode(std::vector<uint8_t>(encoded), with_hash, format);
+}
+
+std::shared_ptr<Block> Block::decode(std::vector<uint8_t> &&encoded,
+                                     bool with_hash, BlockFormat format) {
+  if (format == BlockFormat::V2) {
+    return decode_v2_(std::move(encoded), with_hash);
+  }
   // TODO: Lab 3.1 解码字节数组形成类实例
   // ? 从末尾读取元素个数, 若 with_hash 为 true 先校验 CRC
-  // ? 然后依次读取 offsets 和 data 段
+  // ? 然后读取 offsets 段
+  // ? data 段直接接管 encoded 的内存: std::move 后 resize 截断到 data 段的长度,
+  // ? 不要再逐字节拷贝
   return nullptr;
 }
 
@@ -33,6 +76,15 @@ std::string Block::get_first_key() {
     return "";
   }
 
+  if (format_ == BlockFormat::V2) {
+    // 第一条 entry 是重启点, key 完整保存在 shared_len 和 unshared_len 之后
+    uint16_t unshared_len;
+    memcpy(&unshared_len, data.data() + sizeof(uint16_t), sizeof(uint16_t));
+    return std::string(
+        reinterpret_cast<const char *>(data.data() + 2 * sizeof(uint16_t)),
+        unshared_len);
+  }
+
   // 读取第一个key的长度（前2字节）
   uint16_t key_len;
   memcpy(&key_len, data.data(), sizeof(uint16_t));
@@ -52,6 +104,9 @@ size_t Block::get_offset_at(size_t idx) const {
 
 bool Block::add_entry(const std::string &key, const std::string &value,
                       uint64_t tranc_id, bool force_write) {
+  if (format_ == BlockFormat::V2) {
+    return add_entry_v2_(key, value, tranc_id, force_write);
+  }
   // TODO: Lab 3.1 添加一个键值对到block中
   // ? 每条 entry 格式: [key_len:uint16_t][key][value_len:uint16_t][value][tranc_id:uint64_t]
   // ? 若 !force_write 且当前容量不足则返回 false
@@ -61,19 +116,53 @@ bool Block::add_entry(const std::string &key, const std::string &value,
 
 // 从指定偏移量获取entry的key
 std::string Block::get_key_at(size_t offset) const {
-  // TODO: Lab 3.1 从指定偏移量获取entry的key
-  // ? 读取 data[offset] 处的 uint16_t key_len, 再取后续 key_len 个字节
-  return "";
+  std::string buf;
+  auto key = get_key_view_at(offset, buf);
+  if (key.data() == buf.data()) {
+    return buf;
+  }
+  return std::string(key);
 }
 
 // 从指定偏移量获取entry的value
 std::string Block::get_value_at(size_t offset) const {
-  // TODO: Lab 3.1 从指定偏移量获取entry的value
-  // ? 先跳过 key_len + key, 再读取 uint16_t value_len, 最后取 value
-  return "";
+  return std::string(get_value_view_at(offset));
+}
+
+std::string_view Block::get_key_view_at(size_t offset, std::string &buf) const {
+  if (format_ == BlockFormat::V2) {
+    return get_key_view_at_v2_(offset, buf);
+  }
+  // TODO: Lab 3.1 从指定偏移量获取entry的key, 不拷贝
+  // ? 读取 data[offset] 处的 uint16_t key_len, 返回指向后续 key_len 个字节的视图
+  // ? v1 的 key 完整保存在块内, 不需要使用 buf
+  return {};
+}
+
+std::string_view Block::get_value_view_at(size_t offset) const {
+  if (format_ == BlockFormat::V2) {
+    size_t pos = value_pos_v2_(offset);
+    uint16_t value_len;
+    memcpy(&value_len, data.data() + pos, sizeof(uint16_t));
+    return std::string_view(
+        reinterpret_cast<const char *>(data.data() + pos + sizeof(uint16_t)),
+        value_len);
+  }
+  // TODO: Lab 3.1 从指定偏移量获取entry的value, 不拷贝
+  // ? 先跳过 key_len + key, 再读取 uint16_t value_len, 返回指向 value 的视图
+  return {};
 }
 
 uint64_t Block::get_tranc_id_at(size_t offset) const {
+  if (format_ == BlockFormat::V2) {
+    size_t pos = value_pos_v2_(offset);
+    uint16_t value_len;
+    memcpy(&value_len, data.data() + pos, sizeof(uint16_t));
+    uint64_t tranc_id;
+    memcpy(&tranc_id, data.data() + pos + sizeof(uint16_t) + value_len,
+           sizeof(uint64_t));
+    return tranc_id;
+  }
   // TODO: Lab 3.1 从指定偏移量获取entry的tranc_id
   // ? 先跳过 key 和 value, 读取末尾的 uint64_t tranc_id
   return 0;
@@ -81,8 +170,8 @@ uint64_t Block::get_tranc_id_at(size_t offset) const {
 
 // 比较指定偏移量处的key与目标key
 int Block::compare_key_at(size_t offset, const std::string &target) const {
-  std::string key = get_key_at(offset);
-  return key.compare(target);
+  std::string buf;
+  return get_key_view_at(offset, buf).compare(target);
 }
 
 // 相同的key连续分布, 且相同的key的事务id从大到小排布
@@ -95,13 +184,6 @@ int Block::adjust_idx_by_tranc_id(size_t idx, uint64_t tranc_id) {
   return -1;
 }
 
-bool Block::is_same_key(size_t idx, const std::string &target_key) const {
-  if (idx >= offsets.size()) {
-    return false; // 索引超出范围
-  }
-  return get_key_at(offsets[idx]) == target_key;
-}
-
 // 使用二分查找获取value
 // 要求在插入数据时有序插入
 std::optional<std::string> Block::get_value_binary(const std::string &key,
@@ -116,12 +198,41 @@ std::optional<std::string> Block::get_value_binary(const std::string &key,
 
 std::optional<size_t> Block::get_idx_binary(const std::string &key,
                                             uint64_t tranc_id) {
+  if (format_ == BlockFormat::V2) {
+    return get_idx_binary_v2_(key, tranc_id);
+  }
   // TODO: Lab 3.1 使用二分查找获取key对应的索引
   // ? 在 offsets 数组上做二分查找, 利用 compare_key_at 比较
   // ? 找到后调用 adjust_idx_by_tranc_id 进行事务可见性修正
   return std::nullopt;
 }
 
+size_t Block::lower_bound(const std::string &key) const {
+  if (format_ == BlockFormat::V2 && !restarts.empty()) {
+    bool equal;
+    return scan_from_restart_v2_(restart_before_v2_(key), key, equal);
+  }
+  size_t left = 0;
+  size_t right = offsets.size();
+  while (left < right) {
+    size_t mid = left + (right - left) / 2;
+    if (compare_key_at(offsets[mid], key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+std::string Block::get_key_by_idx(size_t idx) const {
+  return get_key_at(get_offset_at(idx));
+}
+
+std::string_view Block::get_value_view_by_idx(size_t idx) const {
+  return get_value_view_at(get_offset_at(idx));
+}
+
 std::optional<
     std::pair<std::shared_ptr<BlockIterator>, std::shared_ptr<BlockIterator>>>
 Block::iters_preffix(uint64_t tranc_id, const std::string &preffix) {
@@ -161,9 +272,22 @@ Block::Entry Block::get_entry_at(size_t offset) const {
 size_t Block::size() const { return offsets.size(); }
 
 size_t Block::cur_size() const {
+  if (format_ == BlockFormat::V2) {
+    // 只有重启点的偏移会被编码, 另加 num_restarts 和 num_elements
+    return data.size() + restarts.size() * sizeof(uint16_t) +
+           2 * sizeof(uint16_t) + hash_index_size_();
+  }
   return data.size() + offsets.size() * sizeof(uint16_t) + sizeof(uint16_t);
 }
 
+size_t Block::memory_usage() const {
+  return sizeof(Block) + data.capacity() +
+         offsets.capacity() * sizeof(uint16_t) +
+         restarts.capacity() * sizeof(uint16_t) + last_key_.capacity() +
+         hash_entries_.capacity() * sizeof(std::pair<uint32_t, uint8_t>) +
+         hash_buckets_.capacity();
+}
+
 bool Block::is_empty() const { return offsets.empty(); }
 
 BlockIterator Block::begin(uint64_t tranc_id) {
@@ -177,4 +301,355 @@ BlockIterator Block::end() {
   // ? 返回指向末尾 (offsets.size()) 的迭代器
   return BlockIterator(nullptr, 0, 0);
 }
+
+// **************************************************
+// Format v2: 前缀压缩 + 重启点
+// **************************************************
+
+bool Block::add_entry_v2_(const std::string &key, const std::string &value,
+                          uint64_t tranc_id, bool force_write) {
+  bool is_restart = offsets.size() % restart_interval_ == 0;
+  size_t shared = 0;
+  if (!is_restart) {
+    size_t max_shared = std::min(key.size(), last_key_.size());
+    while (shared < max_shared && key[shared] == last_key_[shared]) {
+      shared++;
+    }
+  }
+  size_t unshared = key.size() - shared;
+  size_t entry_size = 3 * sizeof(uint16_t) + unshared + value.size() +
+                      sizeof(uint64_t) +
+                      (is_restart ? sizeof(uint16_t) : 0); // 重启点的偏移
+  // 空块总是接受第一条 entry, 否则超大的 entry 永远无法写入
+  if (!force_write && !offsets.empty() && cur_size() + entry_size > capacity) {
+    return false;
+  }
+
+  size_t offset = data.size();
+  if (offset > UINT16_MAX) {
+    throw std::runtime_error("block offset exceeds uint16 range");
+  }
+  if (is_restart) {
+    restarts.push_back(static_cast<uint16_t>(offset));
+  }
+  if (hash_util_ratio_ > 0 && (offsets.empty() || key != last_key_)) {
+    // 只记录每个 key 的首个版本 (事务 id 最大), 查找时从它所在的重启点开始
+    size_t restart = std::min(restarts.size() - 1, kHashMaxRestarts);
+    hash_entries_.emplace_back(crc32c(key), static_cast<uint8_t>(restart));
+  }
+  offsets.push_back(static_cast<uint16_t>(offset));
+
+  uint16_t shared_len = static_cast<uint16_t>(shared);
+  uint16_t unshared_len = static_cast<uint16_t>(unshared);
+  uint16_t value_len = static_cast<uint16_t>(value.size());
+  data.resize(offset + entry_size - (is_restart ? sizeof(uint16_t) : 0));
+  uint8_t *ptr = data.data() + offset;
+  memcpy(ptr, &shared_len, sizeof(uint16_t));
+  ptr += sizeof(uint16_t);
+  memcpy(ptr, &unshared_len, sizeof(uint16_t));
+  ptr += sizeof(uint16_t);
+  memcpy(ptr, key.data() + shared, unshared);
+  ptr += unshared;
+  memcpy(ptr, &value_len, sizeof(uint16_t));
+  ptr += sizeof(uint16_t);
+  memcpy(ptr, value.data(), value.size());
+  ptr += value.size();
+  memcpy(ptr, &tranc_id, sizeof(uint64_t));
+
+  last_key_ = key;
+  return true;
+}
+
+std::vector<uint8_t> Block::encode_v2_(bool with_hash) const {
+  std::vector<uint8_t> encoded(data);
+  size_t pos = encoded.size();
+  encoded.resize(pos + cur_size() - data.size() +
+                 (with_hash ? sizeof(uint32_t) : 0));
+  uint8_t *ptr = encoded.data() + pos;
+
+  memcpy(ptr, restarts.data(), restarts.size() * sizeof(uint16_t));
+  ptr += restarts.size() * sizeof(uint16_t);
+  uint16_t num_restarts = static_cast<uint16_t>(restarts.size());
+  auto buckets = hash_buckets_to_encode_();
+  if (!buckets.empty()) {
+    memcpy(ptr, buckets.data(), buckets.size());
+    ptr += buckets.size();
+    uint16_t num_buckets = static_cast<uint16_t>(buckets.size());
+    memcpy(ptr, &num_buckets, sizeof(uint16_t));
+    ptr += sizeof(uint16_t);
+    num_restarts |= kHashIndexFlag;
+  }
+  memcpy(ptr, &num_restarts, sizeof(uint16_t));
+  ptr += sizeof(uint16_t);
+  uint16_t num_elements = static_cast<uint16_t>(offsets.size());
+  memcpy(ptr, &num_elements, sizeof(uint16_t));
+  ptr += sizeof(uint16_t);
+
+  if (with_hash) {
+    uint32_t crc = crc32c(encoded.data(), ptr - encoded.data());
+    memcpy(ptr, &crc, sizeof(uint32_t));
+  }
+  return encoded;
+}
+
+std::shared_ptr<Block> Block::decode_v2_(std::vector<uint8_t> encoded,
+                                         bool with_hash) {
+  size_t hash_size = with_hash ? sizeof(uint32_t) : 0;
+  if (encoded.size() < 2 * sizeof(uint16_t) + hash_size) {
+    throw std::runtime_error("Encoded data too small");
+  }
+  size_t body_size = encoded.size() - hash_size;
+  if (with_hash) {
+    uint32_t stored_crc;
+    memcpy(&stored_crc, encoded.data() + body_size, sizeof(uint32_t));
+    if (crc32c(encoded.data(), body_size) != stored_crc) {
+      throw std::runtime_error("Block checksum verification failed");
+    }
+  }
+
+  uint16_t num_elements, num_restarts;
+  memcpy(&num_elements, encoded.data() + body_size - sizeof(uint16_t),
+         sizeof(uint16_t));
+  memcpy(&num_restarts, encoded.data() + body_size - 2 * sizeof(uint16_t),
+         sizeof(uint16_t));
+  auto block = std::make_shared<Block>(0, BlockFormat::V2);
+  size_t tail_size = 2 * sizeof(uint16_t);
+  if (num_restarts & kHashIndexFlag) {
+    num_restarts &= ~kHashIndexFlag;
+    uint16_t num_buckets;
+    if (body_size < tail_size + sizeof(uint16_t)) {
+      throw std::runtime_error("Invalid block hash index");
+    }
+    memcpy(&num_buckets, encoded.data() + body_size - 3 * sizeof(uint16_t),
+           sizeof(uint16_t));
+    tail_size += sizeof(uint16_t) + num_buckets;
+    if (num_buckets == 0 || body_size < tail_size) {
+      throw std::runtime_error("Invalid block hash index");
+    }
+    auto buckets_begin = encoded.begin() + (body_size - tail_size);
+    block->hash_buckets_.assign(buckets_begin, buckets_begin + num_buckets);
+  }
+  size_t restarts_size = num_restarts * sizeof(uint16_t);
+  if (body_size < tail_size + restarts_size) {
+    throw std::runtime_error("Invalid block restart section");
+  }
+  size_t data_size = body_size - tail_size - restarts_size;
+
+  block->restarts.resize(num_restarts);
+  memcpy(block->restarts.data(), encoded.data() + data_size, restarts_size);
+  // 缩小 vector 不会重新分配, data 直接复用传入的缓冲区
+  block->data = std::move(encoded);
+  block->data.resize(data_size);
+
+  // 顺序扫描一次, 重建每条 entry 的偏移
+  block->offsets.reserve(num_elements);
+  size_t pos = 0;
+  for (uint16_t i = 0; i < num_elements; i++) {
+    if (pos + 2 * sizeof(uint16_t) > data_size) {
+      throw std::runtime_error("Invalid block entry");
+    }
+    block->offsets.push_back(static_cast<uint16_t>(pos));
+    uint16_t unshared_len, value_len;
+    memcpy(&unshared_len, block->data.data() + pos + sizeof(uint16_t),
+           sizeof(uint16_t));
+    pos += 2 * sizeof(uint16_t) + unshared_len;
+    if (pos + sizeof(uint16_t) > data_size) {
+      throw std::runtime_error("Invalid block entry");
+    }
+    memcpy(&value_len, block->data.data() + pos, sizeof(uint16_t));
+    pos += sizeof(uint16_t) + value_len + sizeof(uint64_t);
+    if (pos > data_size) {
+      throw std::runtime_error("Invalid block entry");
+    }
+  }
+  if (pos != data_size || (num_elements > 0 && num_restarts == 0)) {
+    throw std::runtime_error("Invalid block data section");
+  }
+  block->capacity = block->cur_size();
+  return block;
+}
+
+std::string_view Block::get_key_view_at_v2_(size_t offset,
+                                            std::string &buf) const {
+  uint16_t shared_len, unshared_len, value_len;
+  memcpy(&shared_len, data.data() + offset, sizeof(uint16_t));
+  if (shared_len == 0) {
+    // 重启点 (或与前一个 key 没有公共前缀), key 完整保存在块内
+    memcpy(&unshared_len, data.data() + offset + sizeof(uint16_t),
+           sizeof(uint16_t));
+    return std::string_view(reinterpret_cast<const char *>(
+                                data.data() + offset + 2 * sizeof(uint16_t)),
+                            unshared_len);
+  }
+
+  // 最近的不超过 offset 的重启点
+  auto it = std::upper_bound(restarts.begin(), restarts.end(), offset);
+  size_t pos = it == restarts.begin() ? 0 : *(it - 1);
+
+  buf.clear();
+  while (true) {
+    memcpy(&shared_len, data.data() + pos, sizeof(uint16_t));
+    memcpy(&unshared_len, data.data() + pos + sizeof(uint16_t),
+           sizeof(uint16_t));
+    buf.resize(shared_len);
+    buf.append(reinterpret_cast<const char *>(data.data() + pos +
+                                              2 * sizeof(uint16_t)),
+               unshared_len);
+    if (pos >= offset) {
+      return buf;
+    }
+    pos += 2 * sizeof(uint16_t) + unshared_len;
+    memcpy(&value_len, data.data() + pos, sizeof(uint16_t));
+    pos += sizeof(uint16_t) + value_len + sizeof(uint64_t);
+  }
+}
+
+size_t Block::value_pos_v2_(size_t offset) const {
+  uint16_t unshared_len;
+  memcpy(&unshared_len, data.data() + offset + sizeof(uint16_t),
+         sizeof(uint16_t));
+  return offset + 2 * sizeof(uint16_t) + unshared_len;
+}
+
+std::optional<size_t> Block::get_idx_binary_v2_(const std::string &key,
+                                                uint64_t tranc_id) {
+  if (offsets.empty()) {
+    return std::nullopt;
+  }
+
+  // 0. 哈希索引直接定位到重启点, 冲突时退回二分查找
+  if (!hash_buckets_.empty()) {
+    uint8_t bucket = hash_buckets_[crc32c(key) % hash_buckets_.size()];
+    if (bucket == kHashNoEntry) {
+      return std::nullopt;
+    }
+    if (bucket < restarts.size()) {
+      return seek_from_restart_v2_(bucket, key, tranc_id);
+    }
+  }
+
+  return seek_from_restart_v2_(restart_before_v2_(key), key, tranc_id);
+}
+
+size_t Block::restart_before_v2_(const std::string &key) const {
+  // 在重启点上二分, 找到最后一个 key 小于目标的重启点
+  // 重启点的 key 是完整的, 可以直接比较
+  // 相同的 key 可能跨越重启点, 所以从严格小于目标的重启点开始扫描
+  size_t left = 0;
+  size_t right = restarts.size();
+  while (left < right) {
+    size_t mid = left + (right - left) / 2;
+    uint16_t unshared_len;
+    memcpy(&unshared_len, data.data() + restarts[mid] + sizeof(uint16_t),
+           sizeof(uint16_t));
+    std::string_view restart_key(
+        reinterpret_cast<const char *>(data.data() + restarts[mid] +
+                                       2 * sizeof(uint16_t)),
+        unshared_len);
+    if (restart_key < key) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left == 0 ? 0 : left - 1;
+}
+
+size_t Block::scan_from_restart_v2_(size_t restart, const std::string &key,
+                                    bool &equal) const {
+  size_t idx = std::lower_bound(offsets.begin(), offsets.end(),
+                                restarts[restart]) -
+               offsets.begin();
+
+  // 从重启点开始顺序还原 key, 直到不小于目标
+  std::string cur_key;
+  equal = false;
+  for (; idx < offsets.size(); idx++) {
+    size_t pos = offsets[idx];
+    uint16_t shared_len, unshared_len;
+    memcpy(&shared_len, data.data() + pos, sizeof(uint16_t));
+    memcpy(&unshared_len, data.data() + pos + sizeof(uint16_t),
+           sizeof(uint16_t));
+    cur_key.resize(shared_len);
+    cur_key.append(reinterpret_cast<const char *>(data.data() + pos +
+                                                  2 * sizeof(uint16_t)),
+                   unshared_len);
+    int cmp = cur_key.compare(key);
+    if (cmp >= 0) {
+      equal = cmp == 0;
+      break;
+    }
+  }
+  return idx;
+}
+
+std::optional<size_t> Block::seek_from_restart_v2_(size_t restart,
+                                                   const std::string &key,
+                                                   uint64_t tranc_id) {
+  bool equal;
+  size_t idx = scan_from_restart_v2_(restart, key, equal);
+  if (!equal) {
+    return std::nullopt;
+  }
+  // 第一个匹配的 entry 是该 key 事务 id 最大的版本, 相同 key 的版本连续排布
+  // 且事务 id 从大到小, 顺序向后找到第一个可见的版本即可
+  if (tranc_id == 0) {
+    return idx;
+  }
+  for (; idx < offsets.size(); idx++) {
+    size_t pos = offsets[idx];
+    uint16_t shared_len, unshared_len;
+    memcpy(&shared_len, data.data() + pos, sizeof(uint16_t));
+    memcpy(&unshared_len, data.data() + pos + sizeof(uint16_t),
+           sizeof(uint16_t));
+    // 与前一条 key 相同: 非重启点时 shared_len 等于 key 长度,
+    // 重启点时完整保存的 key 等于目标
+    bool same_key =
+        shared_len + unshared_len == key.size() &&
+        std::string_view(key).substr(shared_len) ==
+            std::string_view(reinterpret_cast<const char *>(
+                                 data.data() + pos + 2 * sizeof(uint16_t)),
+                             unshared_len);
+    if (!same_key) {
+      break;
+    }
+    if (get_tranc_id_at(pos) <= tranc_id) {
+      return idx;
+    }
+  }
+  return std::nullopt;
+}
+
+std::vector<uint8_t> Block::hash_buckets_to_encode_() const {
+  if (!hash_buckets_.empty()) {
+    return hash_buckets_;
+  }
+  if (hash_entries_.empty() || restarts.size() > kHashMaxRestarts) {
+    return {};
+  }
+  size_t num_buckets =
+      num_hash_buckets(hash_entries_.size(), hash_util_ratio_);
+  std::vector<uint8_t> buckets(num_buckets, kHashNoEntry);
+  for (auto &[hash, restart] : hash_entries_) {
+    uint8_t &bucket = buckets[hash % num_buckets];
+    if (bucket == kHashNoEntry) {
+      bucket = restart;
+    } else if (bucket != restart) {
+      // 同一个重启点内的冲突不影响查找, 否则只能退回二分查找
+      bucket = kHashCollision;
+    }
+  }
+  return buckets;
+}
+
+size_t Block::hash_index_size_() const {
+  if (!hash_buckets_.empty()) {
+    return hash_buckets_.size() + sizeof(uint16_t);
+  }
+  if (hash_entries_.empty() || restarts.size() > kHashMaxRestarts) {
+    return 0;
+  }
+  return num_hash_buckets(hash_entries_.size(), hash_util_ratio_) +
+         sizeof(uint16_t);
+}
 } // namespace tiny_lsm
@@ -7,8 +7,17 @@
 #include <unordered_map>
 
 namespace tiny_lsm {
+// 每个缓存项在块之外的开销: 链表节点、哈希表节点和 shared_ptr 控制块
+static constexpr size_t kCacheItemOverhead =
+    sizeof(CacheItem) + 2 * sizeof(void *) +
+    sizeof(std::pair<std::pair<int, int>, std::list<CacheItem>::iterator>) +
+    sizeof(void *) + 16;
+
 BlockCache::BlockCache(size_t capacity, size_t k)
-    : capacity_(capacity), k_(k) {}
+    : BlockCache(capacity, k, 0) {}
+
+BlockCache::BlockCache(size_t capacity, size_t k, size_t capacity_bytes)
+    : capacity_(capacity), capacity_bytes_(capacity_bytes), k_(k) {}
 
 BlockCache::~BlockCache() = default;
 
@@ -33,31 +42,29 @@ void BlockCache::put(int sst_id, int block_id, std::shared_ptr<Block> block) {
   auto key = std::make_pair(sst_id, block_id);
   auto it = cache_map_.find(key);
 
+  size_t charge = (block ? block->memory_usage() : 0) + kCacheItemOverhead;
+
   if (it != cache_map_.end()) {
     // 更新已有缓存项
     // ! 照理说 Block 类的数据是不可变的，这里的更新分支应该不会存在,
     // 只是debug用
+    usage_bytes_ = usage_bytes_ - it->second->charge + charge;
     it->second->cache_block = block;
+    it->second->charge = charge;
     update_access_count(it->second);
   } else {
-    // 插入新缓存项
-    if (cache_map_.size() >= capacity_) {
-      // 移除最久未使用的缓存项
-      if (!cache_list_less_k.empty()) {
-        // 优先从 cache_list_less_k 中移除
-        cache_map_.erase(std::make_pair(cache_list_less_k.back().sst_id,
-                                        cache_list_less_k.back().block_id));
-        cache_list_less_k.pop_back();
-      } else {
-        cache_map_.erase(std::make_pair(cache_list_greater_k.back().sst_id,
-                                        cache_list_greater_k.back().block_id));
-        cache_list_greater_k.pop_back();
-      }
+    // 插入新缓存项, 块数或字节数超限时移除最久未使用的缓存项
+    while (!cache_map_.empty() &&
+           (cache_map_.size() >= capacity_ ||
+            (capacity_bytes_ != 0 &&
+             usage_bytes_ + charge > capacity_bytes_))) {
+      evict_one();
     }
 
-    CacheItem item = {sst_id, block_id, block, 1};
+    CacheItem item = {sst_id, block_id, block, 1, charge};
     cache_list_less_k.push_front(item);
     cache_map_[key] = cache_list_less_k.begin();
+    usage_bytes_ += charge;
   }
 }
 
@@ -68,6 +75,32 @@ double BlockCache::hit_rate() const {
              : static_cast<double>(hit_requests_) / total_requests_;
 }
 
+size_t BlockCache::memory_usage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return usage_bytes_;
+}
+
+size_t BlockCache::shrink(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t freed = 0;
+  while (freed < bytes && !cache_map_.empty()) {
+    freed += evict_one();
+  }
+  return freed;
+}
+
+size_t BlockCache::evict_one() {
+  // 优先从 cache_list_less_k 中移除
+  auto &list =
+      cache_list_less_k.empty() ? cache_list_greater_k : cache_list_less_k;
+  auto &victim = list.back();
+  size_t charge = victim.charge;
+  cache_map_.erase(std::make_pair(victim.sst_id, victim.block_id));
+  list.pop_back();
+  usage_bytes_ -= charge;
+  return charge;
+}
+
 void BlockCache::update_access_count(std::list<CacheItem>::iterator it) {
   ++it->access_count;
   if (it->access_count < k_) {
@@ -1,6 +1,7 @@
 #include "block/block_iterator.h"
 #include "block/block.h"
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
 
@@ -39,21 +40,14 @@ BlockIterator::pointer BlockIterator::operator->() const {
 
 BlockIterator &BlockIterator::operator++() {
   if (block && current_index < block->size()) {
-    auto prev_idx = current_index;
-    auto prev_offset = block->get_offset_at(prev_idx);
-    auto prev_entry = block->get_entry_at(prev_offset);
+    // v1 的视图指向块内; v2 的视图指向 key_buf_, 在下面推进时保持不变
+    std::string_view prev_key = current_key_();
 
     ++current_index;
 
-    // 跳过相同的key
+    // 跳过相同的key, 可能会连续出现多个key, 但由不同事务创建
     if (!keep_all_versions_) {
-      while (block && current_index < block->size()) {
-        auto cur_offset = block->get_offset_at(current_index);
-        auto cur_entry = block->get_entry_at(cur_offset);
-        if (cur_entry.key != prev_entry.key) {
-          break;
-        }
-        // 可能会连续出现多个key, 但由不同事务创建, 同样的key直接跳过
+      while (current_index < block->size() && is_same_as_current_(prev_key)) {
         ++current_index;
       }
     }
@@ -85,14 +79,24 @@ BlockIterator::value_type BlockIterator::operator*() const {
   }
 
   // 使用缓存避免重复解析
-  if (!cached_value.has_value()) {
-    size_t offset = block->get_offset_at(current_index);
-    cached_value =
-        std::make_pair(block->get_key_at(offset), block->get_value_at(offset));
-  }
+  update_current();
   return *cached_value;
 }
 
+std::string_view BlockIterator::key_view() const {
+  if (!block || current_index >= block->size()) {
+    throw std::out_of_range("Iterator out of range");
+  }
+  return current_key_();
+}
+
+std::string_view BlockIterator::value_view() const {
+  if (!block || current_index >= block->size()) {
+    throw std::out_of_range("Iterator out of range");
+  }
+  return block->get_value_view_at(block->get_offset_at(current_index));
+}
+
 bool BlockIterator::is_end() { return current_index == block->offsets.size(); }
 
 uint64_t BlockIterator::get_cur_tranc_id() const {
@@ -105,10 +109,63 @@ uint64_t BlockIterator::get_cur_tranc_id() const {
 
 void BlockIterator::update_current() const {
   if (!cached_value && current_index < block->offsets.size()) {
-    size_t offset = block->get_offset_at(current_index);
+    // 调用方需要持有数据, 此时才拷贝
     cached_value =
-        std::make_pair(block->get_key_at(offset), block->get_value_at(offset));
+        std::make_pair(std::string(current_key_()),
+                       std::string(block->get_value_view_at(
+                           block->get_offset_at(current_index))));
+  }
+}
+
+std::string_view BlockIterator::current_key_() const {
+  size_t offset = block->get_offset_at(current_index);
+  if (block->format_ != BlockFormat::V2) {
+    // v1 的 key 完整保存在块内
+    return block->get_key_view_at(offset, key_buf_);
+  }
+  if (key_idx_ > current_index) {
+    // key_buf_ 尚未初始化 (或位于当前位置之后), 从最近的重启点还原
+    auto key = block->get_key_view_at(offset, key_buf_);
+    if (key.data() != key_buf_.data()) {
+      key_buf_.assign(key);
+    }
+    key_idx_ = current_index;
+  }
+  // 顺序前进时逐条应用 shared/unshared 增量
+  while (key_idx_ < current_index) {
+    ++key_idx_;
+    const uint8_t *entry = block->data.data() + block->offsets[key_idx_];
+    uint16_t shared_len, unshared_len;
+    memcpy(&shared_len, entry, sizeof(uint16_t));
+    memcpy(&unshared_len, entry + sizeof(uint16_t), sizeof(uint16_t));
+    key_buf_.resize(shared_len);
+    key_buf_.append(reinterpret_cast<const char *>(entry) +
+                        2 * sizeof(uint16_t),
+                    unshared_len);
+  }
+  return key_buf_;
+}
+
+bool BlockIterator::is_same_as_current_(std::string_view prev_key) {
+  size_t offset = block->get_offset_at(current_index);
+  if (block->format_ != BlockFormat::V2) {
+    return block->get_key_view_at(offset, key_buf_) == prev_key;
+  }
+  // prev_key 即 key_buf_ 中第 current_index - 1 条的 key,
+  // 相同时 key_buf_ 不需要修改, 直接视为已推进到当前位置
+  const uint8_t *entry = block->data.data() + offset;
+  uint16_t shared_len, unshared_len;
+  memcpy(&shared_len, entry, sizeof(uint16_t));
+  memcpy(&unshared_len, entry + sizeof(uint16_t), sizeof(uint16_t));
+  if (shared_len + unshared_len != prev_key.size() ||
+      prev_key.substr(shared_len) !=
+          std::string_view(reinterpret_cast<const char *>(entry) +
+                               2 * sizeof(uint16_t),
+                           unshared_len)) {
+    return false;
   }
+  key_idx_ = current_index;
+  return true;
 }
 
 void BlockIterator::skip_by_tranc_id() {
@@ -1,10 +1,65 @@
 #include "config/config.h"
 #include "spdlog/spdlog.h"
 #include <iostream>
+#include <sstream>
 #include <toml.hpp>
 
 namespace tiny_lsm {
 
+// "none, none, lz" -> {"none", "none", "lz"}
+static std::vector<std::string> split_name_list(const std::string &list) {
+  std::vector<std::string> names;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    auto begin = item.find_first_not_of(" \t");
+    auto end = item.find_last_not_of(" \t");
+    if (begin != std::string::npos) {
+      names.push_back(item.substr(begin, end - begin + 1));
+    }
+  }
+  return names;
+}
+
+static std::string join_name_list(const std::vector<std::string> &names) {
+  std::string list;
+  for (size_t i = 0; i < names.size(); ++i) {
+    list += (i == 0 ? "" : ",") + names[i];
+  }
+  return list;
+}
+
+// "12, 10, 8" -> {12, 10, 8}, 无法解析时抛出异常
+template <typename T>
+static std::vector<T> split_number_list(const std::string &list) {
+  std::vector<T> numbers;
+  for (const auto &name : split_name_list(list)) {
+    numbers.push_back(static_cast<T>(std::stod(name)));
+  }
+  return numbers;
+}
+
+template <typename T>
+static std::string join_number_list(const std::vector<T> &numbers) {
+  std::vector<std::string> names;
+  for (auto number : numbers) {
+    std::ostringstream oss;
+    oss << number;
+    names.push_back(oss.str());
+  }
+  return join_name_list(names);
+}
+
+// level 层的值, 超出列表的层使用最后一项, 列表为空时使用 fallback
+template <typename T>
+static T value_for_level(const std::vector<T> &per_level, size_t level,
+                         T fallback) {
+  if (per_level.empty()) {
+    return fallback;
+  }
+  return per_level[std::min(level, per_level.size() - 1)];
+}
+
 // Private helper to set all default values
 void TomlConfig::setDefaultValues() {
   // --- LSM Core ---
@@ -30,9 +85,61 @@ void TomlConfig::setDefaultValues() {
   // --- Bloom Filter ---
   bloom_filter_expected_size_ = 65536;
   bloom_filter_expected_error_rate_ = 0.1;
+  bloom_filter_bits_per_key_ = 10;
+  bloom_filter_type_per_level_ = {"bloom", "bloom", "fuse8"};
+  bloom_filter_prefix_extractor_ = "none";
+  bloom_filter_bits_per_key_per_level_.clear();
+  bloom_filter_monkey_ = false;
 
   // --- WiscKey ---
   wisckey_value_threshold_ = 0;
+
+  // --- MemTable ---
+  lsm_memtable_rep_ = "skiplist";
+  lsm_memtable_bloom_size_ratio_ = 0.02;
+  lsm_memtable_hash_bucket_count_ = 8192;
+  lsm_memtable_inplace_update_ = true;
+
+  // --- Block Format ---
+  lsm_block_format_version_ = 2;
+  lsm_block_restart_interval_ = 16;
+  lsm_block_size_per_level_.clear();
+  lsm_block_restart_interval_per_level_.clear();
+  lsm_block_hash_index_util_ratio_ = 0.75;
+
+  // --- SST Index ---
+  lsm_index_partitioned_ = false;
+  lsm_index_partition_size_ = 4096;
+  lsm_index_range_filter_ = false;
+  lsm_index_range_filter_suffix_bytes_ = 1;
+
+  // --- IO ---
+  lsm_io_mmap_reads_ = true;
+  lsm_io_engine_ = "io_uring";
+  lsm_io_queue_depth_ = 64;
+  lsm_io_threads_ = 8;
+  lsm_io_readahead_initial_blocks_ = 2;
+  lsm_io_readahead_max_blocks_ = 64;
+  lsm_io_readahead_fill_cache_ = true;
+  lsm_io_write_buffer_size_ = 1024 * 1024;
+
+  // --- Compression ---
+  lsm_compression_per_level_ = {"none", "none", "lz"};
+  lsm_compression_max_ratio_ = 0.875;
+
+  // --- Memory Budget ---
+  lsm_block_cache_capacity_bytes_ = 0;
+  lsm_memory_budget_ = 0;
+
+  // --- Background Flush ---
+  lsm_background_flush_ = true;
+  lsm_slowdown_immutable_memtables_ = 8;
+  lsm_stop_immutable_memtables_ = 12;
+  lsm_slowdown_delay_us_ = 1000;
+
+  // --- Compaction ---
+  lsm_compaction_max_subcompactions_ = 4;
+  lsm_compaction_min_subcompaction_bytes_ = 16777216;
 }
 
 //////////////////////////////////////////////////////////////////
@@ -46,6 +153,91 @@ void TomlConfig::modify_lsm_block_size(int one) { lsm_block_size_ = one; }
 void TomlConfig::modify_lsm_per_mem_size_limit(long long one) {
   lsm_per_mem_size_limit_ = one;
 }
+
+void TomlConfig::modify_lsm_memtable_rep(const std::string &one) {
+  lsm_memtable_rep_ = one;
+}
+
+void TomlConfig::modify_lsm_memtable_bloom_size_ratio(double one) {
+  lsm_memtable_bloom_size_ratio_ = one;
+}
+
+void TomlConfig::modify_lsm_memtable_hash_bucket_count(long long one) {
+  lsm_memtable_hash_bucket_count_ = one;
+}
+
+void TomlConfig::modify_lsm_memtable_inplace_update(bool one) {
+  lsm_memtable_inplace_update_ = one;
+}
+
+void TomlConfig::modify_lsm_block_format_version(int one) {
+  lsm_block_format_version_ = one;
+}
+
+void TomlConfig::modify_lsm_block_hash_index_util_ratio(double one) {
+  lsm_block_hash_index_util_ratio_ = one;
+}
+
+void TomlConfig::modify_lsm_index_partitioned(bool one) {
+  lsm_index_partitioned_ = one;
+}
+
+void TomlConfig::modify_lsm_index_range_filter(bool one) {
+  lsm_index_range_filter_ = one;
+}
+
+void TomlConfig::modify_lsm_io_mmap_reads(bool one) { lsm_io_mmap_reads_ = one; }
+
+void TomlConfig::modify_lsm_io_readahead_max_blocks(int one) {
+  lsm_io_readahead_max_blocks_ = one;
+}
+
+void TomlConfig::modify_lsm_io_write_buffer_size(long long one) {
+  lsm_io_write_buffer_size_ = one;
+}
+
+void TomlConfig::modify_lsm_compression_per_level(
+    const std::vector<std::string> &one) {
+  lsm_compression_per_level_ = one;
+}
+
+void TomlConfig::modify_bloom_filter_type_per_level(
+    const std::vector<std::string> &one) {
+  bloom_filter_type_per_level_ = one;
+}
+
+void TomlConfig::modify_bloom_filter_prefix_extractor(const std::string &one) {
+  bloom_filter_prefix_extractor_ = one;
+}
+
+void TomlConfig::modify_bloom_filter_bits_per_key_per_level(
+    const std::vector<double> &one) {
+  bloom_filter_bits_per_key_per_level_ = one;
+}
+
+void TomlConfig::modify_bloom_filter_monkey(bool one) {
+  bloom_filter_monkey_ = one;
+}
+
+void TomlConfig::modify_lsm_block_size_per_level(const std::vector<int> &one) {
+  lsm_block_size_per_level_ = one;
+}
+
+void TomlConfig::modify_lsm_memory_budget(long long one) {
+  lsm_memory_budget_ = one;
+}
+
+void TomlConfig::modify_lsm_background_flush(bool one) {
+  lsm_background_flush_ = one;
+}
+
+void TomlConfig::modify_lsm_compaction_max_subcompactions(int one) {
+  lsm_compaction_max_subcompactions_ = one;
+}
+
+void TomlConfig::modify_lsm_stop_immutable_memtables(int one) {
+  lsm_stop_immutable_memtables_ = one;
+}
 //////////////////////////////////////////////////////////////////
 
 // Constructor implementation
@@ -123,6 +315,38 @@ bool TomlConfig::loadFromFile(const std::string &filePath) {
 
     bloom_filter_expected_error_rate_ =
         bloom_config.at("BLOOM_FILTER_EXPECTED_ERROR_RATE").as_floating();
+    try {
+      bloom_filter_bits_per_key_ =
+          bloom_config.at("BLOOM_FILTER_BITS_PER_KEY").as_floating();
+    } catch (...) {
+      // Key missing — keep default
+    }
+    try {
+      auto per_level = split_name_list(
+          bloom_config.at("BLOOM_FILTER_TYPE_PER_LEVEL").as_string());
+      if (!per_level.empty()) {
+        bloom_filter_type_per_level_ = per_level;
+      }
+    } catch (...) {
+      // Key missing — keep default
+    }
+    try {
+      bloom_filter_prefix_extractor_ =
+          bloom_config.at("BLOOM_FILTER_PREFIX_EXTRACTOR").as_string();
+    } catch (...) {
+      // Key missing — keep default
+    }
+    try {
+      bloom_filter_bits_per_key_per_level_ = split_number_list<double>(
+          bloom_config.at("BLOOM_FILTER_BITS_PER_KEY_PER_LEVEL").as_string());
+    } catch (...) {
+      // Key missing — keep default
+    }
+    try {
+      bloom_filter_monkey_ = bloom_config.at("BLOOM_FILTER_MONKEY").as_boolean();
+    } catch (...) {
+      // Key missing — keep default
+    }
 
     // --- Load WiscKey ---
     try {
@@ -133,6 +357,172 @@ bool TomlConfig::loadFromFile(const std::string &filePath) {
       // Section missing — keep default of 0 (disabled)
     }
 
+    // --- Load MemTable ---
+    try {
+      auto memtable_config = config["lsm"]["memtable"];
+      lsm_memtable_rep_ = memtable_config.at("LSM_MEMTABLE_REP").as_string();
+    } catch (...) {
+      // Section missing — keep default skiplist
+    }
+    try {
+      auto memtable_config = config["lsm"]["memtable"];
+      lsm_memtable_bloom_size_ratio_ =
+          memtable_config.at("LSM_MEMTABLE_BLOOM_SIZE_RATIO").as_floating();
+    } catch (...) {
+      // Key missing — keep default
+    }
+    try {
+      auto memtable_config = config["lsm"]["memtable"];
+      lsm_memtable_hash_bucket_count_ =
+          memtable_config.at("LSM_MEMTABLE_HASH_BUCKET_COUNT").as_integer();
+    } catch (...) {
+      // Key missing — keep default
+    }
+    try {
+      auto memtable_config = config["lsm"]["memtable"];
+      lsm_memtable_inplace_update_ =
+          memtable_config.at("LSM_MEMTABLE_INPLACE_UPDATE").as_boolean();
+    } catch (...) {
+      // Key missing — keep default
+    }
+
+    // --- Load Block Format ---
+    try {
+      auto block_config = config["lsm"]["block"];
+      lsm_block_format_version_ =
+          block_config.at("LSM_BLOCK_FORMAT_VERSION").as_integer();
+      lsm_block_restart_interval_ =
+          block_config.at("LSM_BLOCK_RESTART_INTERVAL").as_integer();
+    } catch (...) {
+      // Section missing — keep defaults
+    }
+    try {
+      auto block_config = config["lsm"]["block"];
+      lsm_block_size_per_level_ = split_number_list<int>(
+          block_config.at("LSM_BLOCK_SIZE_PER_LEVEL").as_string());
+      lsm_block_restart_interval_per_level_ = split_number_list<int>(
+          block_config.at("LSM_BLOCK_RESTART_INTERVAL_PER_LEVEL").as_string());
+    } catch (...) {
+      // Keys missing — keep defaults
+    }
+    try {
+      lsm_block_hash_index_util_ratio_ =
+          config["lsm"]["block"]
+              .at("LSM_BLOCK_HASH_INDEX_UTIL_RATIO")
+              .as_floating();
+    } catch (...) {
+      // Key missing — keep default
+    }
+
+    // --- Load SST Index ---
+    try {
+      auto index_config = config["lsm"]["index"];
+      lsm_index_partitioned_ =
+          index_config.at("LSM_INDEX_PARTITIONED").as_boolean();
+      lsm_index_partition_size_ =
+          index_config.at("LSM_INDEX_PARTITION_SIZE").as_integer();
+    } catch (...) {
+      // Section missing — keep defaults
+    }
+    try {
+      auto index_config = config["lsm"]["index"];
+      lsm_index_range_filter_ =
+          index_config.at("LSM_INDEX_RANGE_FILTER").as_boolean();
+      lsm_index_range_filter_suffix_bytes_ =
+          index_config.at("LSM_INDEX_RANGE_FILTER_SUFFIX_BYTES").as_integer();
+    } catch (...) {
+      // Keys missing — keep defaults
+    }
+
+    // --- Load IO ---
+    try {
+      auto io_config = config["lsm"]["io"];
+      lsm_io_mmap_reads_ = io_config.at("LSM_IO_MMAP_READS").as_boolean();
+    } catch (...) {
+      // Section missing — keep defaults
+    }
+    try {
+      auto io_config = config["lsm"]["io"];
+      lsm_io_engine_ = io_config.at("LSM_IO_ENGINE").as_string();
+      lsm_io_queue_depth_ = io_config.at("LSM_IO_QUEUE_DEPTH").as_integer();
+      lsm_io_threads_ = io_config.at("LSM_IO_THREADS").as_integer();
+    } catch (...) {
+      // Keys missing — keep defaults
+    }
+    try {
+      auto io_config = config["lsm"]["io"];
+      lsm_io_readahead_initial_blocks_ =
+          io_config.at("LSM_IO_READAHEAD_INITIAL_BLOCKS").as_integer();
+      lsm_io_readahead_max_blocks_ =
+          io_config.at("LSM_IO_READAHEAD_MAX_BLOCKS").as_integer();
+      lsm_io_readahead_fill_cache_ =
+          io_config.at("LSM_IO_READAHEAD_FILL_CACHE").as_boolean();
+    } catch (...) {
+      // Keys missing — keep defaults
+    }
+    try {
+      lsm_io_write_buffer_size_ =
+          config["lsm"]["io"].at("LSM_IO_WRITE_BUFFER_SIZE").as_integer();
+    } catch (...) {
+      // Key missing — keep default
+    }
+
+    // --- Load Compression ---
+    try {
+      auto compression_config = config["lsm"]["compression"];
+      auto per_level = split_name_list(
+          compression_config.at("LSM_COMPRESSION_PER_LEVEL").as_string());
+      if (!per_level.empty()) {
+        lsm_compression_per_level_ = per_level;
+      }
+      lsm_compression_max_ratio_ =
+          compression_config.at("LSM_COMPRESSION_MAX_RATIO").as_floating();
+    } catch (...) {
+      // Section missing — keep defaults
+    }
+
+    // --- Load Memory Budget ---
+    try {
+      lsm_block_cache_capacity_bytes_ =
+          cache_config.at("LSM_BLOCK_CACHE_CAPACITY_BYTES").as_integer();
+    } catch (...) {
+      // Key missing — keep default
+    }
+    try {
+      auto memory_config = config["lsm"]["memory"];
+      lsm_memory_budget_ = memory_config.at("LSM_MEMORY_BUDGET").as_integer();
+    } catch (...) {
+      // Section missing — keep default of 0 (unlimited)
+    }
+
+    // --- Load Background Flush ---
+    try {
+      auto flush_config = config["lsm"]["flush"];
+      lsm_background_flush_ =
+          flush_config.at("LSM_BACKGROUND_FLUSH").as_boolean();
+      lsm_slowdown_immutable_memtables_ =
+          flush_config.at("LSM_SLOWDOWN_IMMUTABLE_MEMTABLES").as_integer();
+      lsm_stop_immutable_memtables_ =
+          flush_config.at("LSM_STOP_IMMUTABLE_MEMTABLES").as_integer();
+      lsm_slowdown_delay_us_ =
+          flush_config.at("LSM_SLOWDOWN_DELAY_US").as_integer();
+    } catch (...) {
+      // Section missing — keep defaults
+    }
+
+    // --- Load Compaction ---
+    try {
+      auto compaction_config = config["lsm"]["compaction"];
+      lsm_compaction_max_subcompactions_ =
+          compaction_config.at("LSM_COMPACTION_MAX_SUBCOMPACTIONS")
+              .as_integer();
+      lsm_compaction_min_subcompaction_bytes_ =
+          compaction_config.at("LSM_COMPACTION_MIN_SUBCOMPACTION_BYTES")
+              .as_integer();
+    } catch (...) {
+      // Section missing — keep defaults
+    }
+
     spdlog::info("Configuration loaded successfully from {}", filePath);
     return true;
 
@@ -191,11 +581,138 @@ int TomlConfig::getBloomFilterExpectedSize() const {
 double TomlConfig::getBloomFilterExpectedErrorRate() const {
   return bloom_filter_expected_error_rate_;
 }
+double TomlConfig::getBloomFilterBitsPerKey() const {
+  return bloom_filter_bits_per_key_;
+}
+const std::vector<double> &
+TomlConfig::getBloomFilterBitsPerKeyPerLevel() const {
+  return bloom_filter_bits_per_key_per_level_;
+}
+const std::vector<std::string> &TomlConfig::getBloomFilterTypePerLevel() const {
+  return bloom_filter_type_per_level_;
+}
+const std::string &TomlConfig::getBloomFilterTypeForLevel(size_t level) const {
+  static const std::string bloom = "bloom";
+  if (bloom_filter_type_per_level_.empty()) {
+    return bloom;
+  }
+  return bloom_filter_type_per_level_[std::min(
+      level, bloom_filter_type_per_level_.size() - 1)];
+}
+const std::string &TomlConfig::getBloomFilterPrefixExtractor() const {
+  return bloom_filter_prefix_extractor_;
+}
+double TomlConfig::getBloomFilterBitsPerKeyForLevel(size_t level) const {
+  return value_for_level(bloom_filter_bits_per_key_per_level_, level,
+                         bloom_filter_bits_per_key_);
+}
+bool TomlConfig::getBloomFilterMonkey() const { return bloom_filter_monkey_; }
 
 size_t TomlConfig::getWisckeyValueThreshold() const {
   return wisckey_value_threshold_;
 }
 
+const std::string &TomlConfig::getLsmMemtableRep() const {
+  return lsm_memtable_rep_;
+}
+double TomlConfig::getLsmMemtableBloomSizeRatio() const {
+  return lsm_memtable_bloom_size_ratio_;
+}
+long long TomlConfig::getLsmMemtableHashBucketCount() const {
+  return lsm_memtable_hash_bucket_count_;
+}
+bool TomlConfig::getLsmMemtableInplaceUpdate() const {
+  return lsm_memtable_inplace_update_;
+}
+
+int TomlConfig::getLsmBlockFormatVersion() const {
+  return lsm_block_format_version_;
+}
+int TomlConfig::getLsmBlockRestartInterval() const {
+  return lsm_block_restart_interval_;
+}
+const std::vector<int> &TomlConfig::getLsmBlockSizePerLevel() const {
+  return lsm_block_size_per_level_;
+}
+int TomlConfig::getLsmBlockSizeForLevel(size_t level) const {
+  return value_for_level(lsm_block_size_per_level_, level, lsm_block_size_);
+}
+int TomlConfig::getLsmBlockRestartIntervalForLevel(size_t level) const {
+  return value_for_level(lsm_block_restart_interval_per_level_, level,
+                         lsm_block_restart_interval_);
+}
+double TomlConfig::getLsmBlockHashIndexUtilRatio() const {
+  return lsm_block_hash_index_util_ratio_;
+}
+
+bool TomlConfig::getLsmIndexPartitioned() const {
+  return lsm_index_partitioned_;
+}
+int TomlConfig::getLsmIndexPartitionSize() const {
+  return lsm_index_partition_size_;
+}
+bool TomlConfig::getLsmIndexRangeFilter() const {
+  return lsm_index_range_filter_;
+}
+int TomlConfig::getLsmIndexRangeFilterSuffixBytes() const {
+  return lsm_index_range_filter_suffix_bytes_;
+}
+
+bool TomlConfig::getLsmIoMmapReads() const { return lsm_io_mmap_reads_; }
+const std::string &TomlConfig::getLsmIoEngine() const { return lsm_io_engine_; }
+int TomlConfig::getLsmIoQueueDepth() const { return lsm_io_queue_depth_; }
+int TomlConfig::getLsmIoThreads() const { return lsm_io_threads_; }
+int TomlConfig::getLsmIoReadaheadInitialBlocks() const {
+  return lsm_io_readahead_initial_blocks_;
+}
+int TomlConfig::getLsmIoReadaheadMaxBlocks() const {
+  return lsm_io_readahead_max_blocks_;
+}
+bool TomlConfig::getLsmIoReadaheadFillCache() const {
+  return lsm_io_readahead_fill_cache_;
+}
+long long TomlConfig::getLsmIoWriteBufferSize() const {
+  return lsm_io_write_buffer_size_;
+}
+
+const std::vector<std::string> &TomlConfig::getLsmCompressionPerLevel() const {
+  return lsm_compression_per_level_;
+}
+const std::string &TomlConfig::getLsmCompressionForLevel(size_t level) const {
+  static const std::string none = "none";
+  if (lsm_compression_per_level_.empty()) {
+    return none;
+  }
+  return lsm_compression_per_level_[std::min(
+      level, lsm_compression_per_level_.size() - 1)];
+}
+double TomlConfig::getLsmCompressionMaxRatio() const {
+  return lsm_compression_max_ratio_;
+}
+
+long long TomlConfig::getLsmBlockCacheCapacityBytes() const {
+  return lsm_block_cache_capacity_bytes_;
+}
+long long TomlConfig::getLsmMemoryBudget() const { return lsm_memory_budget_; }
+
+bool TomlConfig::getLsmBackgroundFlush() const { return lsm_background_flush_; }
+int TomlConfig::getLsmSlowdownImmutableMemtables() const {
+  return lsm_slowdown_immutable_memtables_;
+}
+int TomlConfig::getLsmStopImmutableMemtables() const {
+  return lsm_stop_immutable_memtables_;
+}
+int TomlConfig::getLsmSlowdownDelayUs() const {
+  return lsm_slowdown_delay_us_;
+}
+
+int TomlConfig::getLsmCompactionMaxSubcompactions() const {
+  return lsm_compaction_max_subcompactions_;
+}
+long long TomlConfig::getLsmCompactionMinSubcompactionBytes() const {
+  return lsm_compaction_min_subcompaction_bytes_;
+}
+
 const TomlConfig &TomlConfig::getInstance(const std::string &config_path) {
   // 静态实例确保只创建一次
   static const TomlConfig instance([&]() -> std::string {
@@ -238,6 +755,8 @@ bool TomlConfig::saveToFile(const std::string &filePath) {
     config["lsm"]["cache"]["LSM_BLOCK_CACHE_CAPACITY"] =
         lsm_block_cache_capacity_;
     config["lsm"]["cache"]["LSM_BLOCK_CACHE_K"] = lsm_block_cache_k_;
+    config["lsm"]["cache"]["LSM_BLOCK_CACHE_CAPACITY_BYTES"] =
+        lsm_block_cache_capacity_bytes_;
 
     // --- Redis Headers/Separators ---
     config["redis"]["REDIS_EXPIRE_HEADER"] = redis_expire_header_;
@@ -256,6 +775,81 @@ bool TomlConfig::saveToFile(const std::string &filePath) {
         bloom_filter_expected_size_;
     config["bloom_filter"]["BLOOM_FILTER_EXPECTED_ERROR_RATE"] =
         bloom_filter_expected_error_rate_;
+    config["bloom_filter"]["BLOOM_FILTER_BITS_PER_KEY"] =
+        bloom_filter_bits_per_key_;
+    config["bloom_filter"]["BLOOM_FILTER_TYPE_PER_LEVEL"] =
+        join_name_list(bloom_filter_type_per_level_);
+    config["bloom_filter"]["BLOOM_FILTER_PREFIX_EXTRACTOR"] =
+        bloom_filter_prefix_extractor_;
+    config["bloom_filter"]["BLOOM_FILTER_BITS_PER_KEY_PER_LEVEL"] =
+        join_number_list(bloom_filter_bits_per_key_per_level_);
+    config["bloom_filter"]["BLOOM_FILTER_MONKEY"] = bloom_filter_monkey_;
+
+    // --- MemTable ---
+    config["lsm"]["memtable"]["LSM_MEMTABLE_REP"] = lsm_memtable_rep_;
+    config["lsm"]["memtable"]["LSM_MEMTABLE_BLOOM_SIZE_RATIO"] =
+        lsm_memtable_bloom_size_ratio_;
+    config["lsm"]["memtable"]["LSM_MEMTABLE_HASH_BUCKET_COUNT"] =
+        lsm_memtable_hash_bucket_count_;
+    config["lsm"]["memtable"]["LSM_MEMTABLE_INPLACE_UPDATE"] =
+        lsm_memtable_inplace_update_;
+
+    // --- Block Format ---
+    config["lsm"]["block"]["LSM_BLOCK_FORMAT_VERSION"] =
+        lsm_block_format_version_;
+    config["lsm"]["block"]["LSM_BLOCK_RESTART_INTERVAL"] =
+        lsm_block_restart_interval_;
+    config["lsm"]["block"]["LSM_BLOCK_SIZE_PER_LEVEL"] =
+        join_number_list(lsm_block_size_per_level_);
+    config["lsm"]["block"]["LSM_BLOCK_RESTART_INTERVAL_PER_LEVEL"] =
+        join_number_list(lsm_block_restart_interval_per_level_);
+    config["lsm"]["block"]["LSM_BLOCK_HASH_INDEX_UTIL_RATIO"] =
+        lsm_block_hash_index_util_ratio_;
+
+    // --- SST Index ---
+    config["lsm"]["index"]["LSM_INDEX_PARTITIONED"] = lsm_index_partitioned_;
+    config["lsm"]["index"]["LSM_INDEX_PARTITION_SIZE"] =
+        lsm_index_partition_size_;
+    config["lsm"]["index"]["LSM_INDEX_RANGE_FILTER"] = lsm_index_range_filter_;
+    config["lsm"]["index"]["LSM_INDEX_RANGE_FILTER_SUFFIX_BYTES"] =
+        lsm_index_range_filter_suffix_bytes_;
+
+    // --- IO ---
+    config["lsm"]["io"]["LSM_IO_MMAP_READS"] = lsm_io_mmap_reads_;
+    config["lsm"]["io"]["LSM_IO_ENGINE"] = lsm_io_engine_;
+    config["lsm"]["io"]["LSM_IO_QUEUE_DEPTH"] = lsm_io_queue_depth_;
+    config["lsm"]["io"]["LSM_IO_THREADS"] = lsm_io_threads_;
+    config["lsm"]["io"]["LSM_IO_READAHEAD_INITIAL_BLOCKS"] =
+        lsm_io_readahead_initial_blocks_;
+    config["lsm"]["io"]["LSM_IO_READAHEAD_MAX_BLOCKS"] =
+        lsm_io_readahead_max_blocks_;
+    config["lsm"]["io"]["LSM_IO_READAHEAD_FILL_CACHE"] =
+        lsm_io_readahead_fill_cache_;
+    config["lsm"]["io"]["LSM_IO_WRITE_BUFFER_SIZE"] =
+        lsm_io_write_buffer_size_;
+
+    // --- Compression ---
+    config["lsm"]["compression"]["LSM_COMPRESSION_PER_LEVEL"] =
+        join_name_list(lsm_compression_per_level_);
+    config["lsm"]["compression"]["LSM_COMPRESSION_MAX_RATIO"] =
+        lsm_compression_max_ratio_;
+
+    // --- Memory Budget ---
+    config["lsm"]["memory"]["LSM_MEMORY_BUDGET"] = lsm_memory_budget_;
+
+    // --- Background Flush ---
+    config["lsm"]["flush"]["LSM_BACKGROUND_FLUSH"] = lsm_background_flush_;
+    config["lsm"]["flush"]["LSM_SLOWDOWN_IMMUTABLE_MEMTABLES"] =
+        lsm_slowdown_immutable_memtables_;
+    config["lsm"]["flush"]["LSM_STOP_IMMUTABLE_MEMTABLES"] =
+        lsm_stop_immutable_memtables_;
+    config["lsm"]["flush"]["LSM_SLOWDOWN_DELAY_US"] = lsm_slowdown_delay_us_;
+
+    // --- Compaction ---
+    config["lsm"]["compaction"]["LSM_COMPACTION_MAX_SUBCOMPACTIONS"] =
+        lsm_compaction_max_subcompactions_;
+    config["lsm"]["compaction"]["LSM_COMPACTION_MIN_SUBCOMPACTION_BYTES"] =
+        lsm_compaction_min_subcompaction_bytes_;
 
     // 写入到文件
     std::ofstream outFile(filePath);
@@ -3,12 +3,14 @@
 #include "consts.h"
 #include "logger/logger.h"
 #include "lsm/level_iterator.h"
+#include "lsm/subcompaction.h"
 #include "spdlog/spdlog.h"
 #include "sst/concact_iterator.h"
 #include "sst/sst.h"
 #include "sst/sst_iterator.h"
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
 #include <iostream>
@@ -16,28 +18,45 @@
 #include <mutex>
 #include <optional>
 #include <stdexcept>
+#include <thread>
 #include <utility>
 #include <vector>
 
 namespace tiny_lsm {
 
 // *********************** LSMEngine ***********************
-LSMEngine::LSMEngine(std::string path) : data_dir(path) {
+LSMEngine::LSMEngine(std::string path, MemTableRepType memtable_rep)
+    : data_dir(path), memtable(memtable_rep) {
   // TODO: Lab 4.2 引擎初始化
   // ? 1. 初始化日志: init_spdlog_file()
-  // ? 2. 初始化 block_cache (容量和 K 值从 TomlConfig 读取)
+  // ? 2. 初始化 block_cache (块数容量、K 值和字节上限 LsmBlockCacheCapacityBytes
+  // ?    从 TomlConfig 读取)
   // ? 3. 若目录不存在则创建
   // ? 4. 初始化 VLog: vlog_ = VLog::open(data_dir + "/vlog.data")
   // ? 5. 遍历目录加载所有已存在的 SST 文件:
   // ?    - 文件名格式: sst_{id}.{level}
   // ?    - 调用 SST::open 并记录到 ssts 和 level_sst_ids
+  // ?      LSM_IO_MMAP_READS 开启时用 FileObj::open_mmap(path) 打开文件,
+  // ?      否则用 FileObj::open(path, false)
   // ?    - 维护 next_sst_id 和 cur_max_level
   // ? 6. next_sst_id 自增
   // ? 7. 对各层 sst_id_list 排序; L0 层需要 reverse (越大的 id 越新, 优先查询)
   init_spdlog_file();
+
+  register_memory_budget_();
+
+  // 加载完成后再启动后台刷盘线程
+  background_flush_ = TomlConfig::getInstance().getLsmBackgroundFlush();
+  if (background_flush_) {
+    flush_thread_ = std::thread(&LSMEngine::flush_worker_, this);
+  }
 }
 
-LSMEngine::~LSMEngine() = default;
+LSMEngine::~LSMEngine() {
+  // 先注销, 保证预算不会再回调到正在析构的引擎
+  unregister_memory_budget_();
+  stop_flush_worker_();
+}
 
 std::optional<std::pair<std::string, uint64_t>>
 LSMEngine::get(const std::string &key, uint64_t tranc_id) {
@@ -56,6 +75,8 @@ LSMEngine::get_batch(const std::vector<std::string> &keys, uint64_t tranc_id) {
   // ? 1. 先从 memtable 批量查询: memtable.get_batch(keys, tranc_id)
   // ? 2. 若有未命中项, 加读锁后依次查 L0 各 SST 文件
   // ? 3. 若仍有未命中, 对各高层 SST 做二分查找补全结果
+  // ?    同一个 SST 中的多个 key 先用 find_block_idx 求出各自的 block,
+  // ?    再调用 sst->read_blocks(block_idxs) 一次提交所有未缓存 block 的读请求
   return {};
 }
 
@@ -69,8 +90,10 @@ LSMEngine::sst_get_(const std::string &key, uint64_t tranc_id) {
 uint64_t LSMEngine::put(const std::string &key, const std::string &value,
                         uint64_t tranc_id) {
   // TODO: Lab 4.1 插入
+  // ? 先调用 make_room_for_write(), 冻结表积压过多时会在这里减速或阻塞
   // ? 调用 memtable.put(key, value, tranc_id)
-  // ? 若 memtable 总大小 >= LsmTolMemSizeLimit 则调用 flush() 并返回其结果
+  // ? 若开启了后台刷盘: 存在冻结表时调用 schedule_flush(), 直接返回 0
+  // ? 否则若 memtable 总大小 >= LsmTolMemSizeLimit 则调用 flush() 并返回其结果
   // ? 否则返回 0
   return 0;
 }
@@ -79,28 +102,67 @@ uint64_t LSMEngine::put_batch(
     const std::vector<std::pair<std::string, std::string>> &kvs,
     uint64_t tranc_id) {
   // TODO: Lab 4.1 批量插入
+  // ? 先调用 make_room_for_write()
   // ? 调用 memtable.put_batch(kvs, tranc_id)
-  // ? 若超限则 flush() 并返回其结果
+  // ? 后台刷盘时调用 schedule_flush() 并返回 0, 否则若超限则 flush() 并返回其结果
   return 0;
 }
 
 uint64_t LSMEngine::remove(const std::string &key, uint64_t tranc_id) {
   // TODO: Lab 4.1 删除
   // ? 在 LSM 中，删除实际上是插入一个空值
+  // ? 先调用 make_room_for_write()
   // ? 调用 memtable.remove(key, tranc_id)
-  // ? 若超限则 flush() 并返回其结果
+  // ? 后台刷盘时调用 schedule_flush() 并返回 0, 否则若超限则 flush() 并返回其结果
   return 0;
 }
 
 uint64_t LSMEngine::remove_batch(const std::vector<std::string> &keys,
                                  uint64_t tranc_id) {
   // TODO: Lab 4.1 批量删除
+  // ? 先调用 make_room_for_write()
   // ? 调用 memtable.remove_batch(keys, tranc_id)
-  // ? 若超限则 flush() 并返回其结果
+  // ? 后台刷盘时调用 schedule_flush() 并返回 0, 否则若超限则 flush() 并返回其结果
   return 0;
 }
 
+uint64_t LSMEngine::replay(const std::vector<Record> &records) {
+  uint64_t max_flushed = 0;
+  std::vector<std::pair<std::string, std::string>> kvs;
+  uint64_t batch_tranc_id = 0;
+  auto flush_batch = [&]() {
+    if (!kvs.empty()) {
+      max_flushed = std::max(max_flushed, put_batch(kvs, batch_tranc_id));
+      kvs.clear();
+    }
+  };
+
+  for (auto &record : records) {
+    switch (record.getOperationType()) {
+    case OperationType::OP_PUT:
+      if (!kvs.empty() && batch_tranc_id != record.getTrancId()) {
+        flush_batch();
+      }
+      batch_tranc_id = record.getTrancId();
+      kvs.emplace_back(record.getKey(), record.getValue());
+      break;
+    case OperationType::OP_DELETE:
+      // 删除需要排在它之前的 put 之后生效
+      flush_batch();
+      max_flushed = std::max(max_flushed,
+                             remove(record.getKey(), record.getTrancId()));
+      break;
+    default:
+      break;
+    }
+  }
+  flush_batch();
+  return max_flushed;
+}
+
 void LSMEngine::clear() {
+  // 先拿到 ssts_mtx, 等待正在进行的后台刷盘结束, 之后的刷盘只会看到空的 memtable
+  std::unique_lock<std::shared_mutex> lock(ssts_mtx);
   memtable.clear();
   level_sst_ids.clear();
   ssts.clear();
@@ -137,7 +199,10 @@ uint64_t LSMEngine::flush() {
   // ? 4. 构造 SSTBuilder:
   // ?    - 若 WiscKey 阈值 > 0 且 vlog_ 存在, 使用 WiscKey 模式的构造函数
   // ?    - 否则使用普通模式
+  // ?    然后调用 set_level_options(LevelOptions::for_level(0, cur_max_level + 1))
   // ? 5. 调用 memtable.flush_last() 生成 SST 文件
+  // ?    (flush_last 会 builder.open(sst_path) 后逐条写入, 不复制 memtable)
+  // ?    (后台刷盘与 LSM::flush_all 可能并发调用 flush, 返回 nullptr 时直接返回 0)
   // ? 6. 更新 ssts 和 level_sst_ids[0] (push_front 保证新的在前)
   // ? 7. 将 flushed_tranc_ids 通知给 tran_manager
   // ? 8. 返回新 SST 的 max_tranc_id
@@ -154,16 +219,32 @@ std::string LSMEngine::get_sst_path(size_t sst_id, size_t target_level) {
 
 std::optional<std::pair<TwoMergeIterator, TwoMergeIterator>>
 LSMEngine::lsm_iters_monotony_predicate(
-    uint64_t tranc_id, std::function<int(const std::string &)> predicate) {
+    uint64_t tranc_id, std::function<int(const std::string &)> predicate,
+    [[maybe_unused]] std::function<bool(const std::shared_ptr<SST> &)>
+        sst_filter) {
   // TODO: Lab 4.7 谓词查询
   // ? 1. 从 memtable 查询: memtable.iters_monotony_predicate(tranc_id, predicate)
+  // ?    结果用 make_shared<MemTableMergeIterator>(std::move(res->first)) 包装
   // ? 2. 遍历所有 SST, 对每个 SST 调用 sst_iters_monotony_predicate
+  // ?    若 sst_filter 非空且对该 SST 返回 false, 直接跳过 (不读取任何 block)
   // ?    将所有结果合并到 item_vec (注意过滤事务可见性和相同 key 只保留最新版本)
   // ? 3. 构造 TwoMergeIterator 合并 memtable 结果和 sst 结果
   // ? 4. 若均为空返回 nullopt
   return std::nullopt;
 }
 
+std::optional<std::pair<TwoMergeIterator, TwoMergeIterator>>
+LSMEngine::prefix_iter(const std::string &prefix, uint64_t tranc_id) {
+  return lsm_iters_monotony_predicate(
+      tranc_id,
+      [prefix](const std::string &key) {
+        return -key.compare(0, prefix.size(), prefix);
+      },
+      [prefix](const std::shared_ptr<SST> &sst) {
+        return sst->may_contain_prefix(prefix);
+      });
+}
+
 Level_Iterator LSMEngine::begin(uint64_t tranc_id) {
   // TODO: Lab 4.7
   // ? 返回 Level_Iterator(shared_from_this(), tranc_id)
@@ -180,6 +261,9 @@ void LSMEngine::full_compact(size_t src_level) {
   // TODO: Lab 4.5 负责完成整个 full compact
   // ? 1. 递归判断下一级 level 是否需要 compact (level_sst_ids[src_level+1].size() >= ratio)
   // ? 2. 根据 src_level 是否为 0 分别调用 full_l0_l1_compact 或 full_common_compact
+  // ?    合并前对输入 SST 调用 advise(FileAccess::Sequential), 它们之后只会被顺序读取
+  // ?    输入由 keep_all_versions 的 SstIterator 顺序读取, 迭代器自带预读
+  // ?    (BlockReadahead, 批量调用 read_blocks), 且预读的 block 不进入块缓存
   // ? 3. 删除旧 SST 文件并从 ssts/level_sst_ids 中移除记录
   // ? 4. 将新的 SST 加入 level_sst_ids[src_level+1] 并排序
   // ? 5. 更新 cur_max_level
@@ -192,6 +276,16 @@ LSMEngine::full_l0_l1_compact(std::vector<size_t> &l0_ids,
   // ? L0 各 SST 的 key 有重叠, 需要先通过 SstIterator::merge_sst_iterator 合并
   // ? 再用 TwoMergeIterator 与 L1 的 ConcactIterator 合并
   // ? 最后调用 gen_sst_from_iter 生成新的 SST 文件 (目标大小 = PerMemSizeLimit * SstLevelRatio)
+  // ? 按 key 区间并行:
+  // ?   plan_subcompactions(全部输入, LsmCompactionMaxSubcompactions,
+  // ?   LsmCompactionMinSubcompactionBytes) 得到切分点, ranges_from_boundaries 转为区间,
+  // ?   run_subcompactions 对每个区间 range 执行上面的合并:
+  // ?   - 只使用 range.overlaps(first_key, last_key) 的输入 SST
+  // ?   - L0 用 SstIterator::lower_bound(sst, *range.lower, ...), L1 用
+  // ?     ConcactIterator(ssts, *range.lower, ...), 都定位到第一个 >= lower 的 key
+  // ?     (不能用 SstIterator(sst, key, ...): 它是点查, lower 通常不在该 SST 中)
+  // ?   - 合并结果用 BoundedIterator(iter, range) 截断后交给 gen_sst_from_iter
+  // ?   各区间的输出按区间顺序拼接, 与单线程合并的结果相同
   return {};
 }
 
@@ -201,6 +295,9 @@ LSMEngine::full_common_compact(std::vector<size_t> &lx_ids,
   // TODO: Lab 4.5 负责完成其他相邻 level 的 full compact
   // ? Lx 和 Ly 都是有序不重叠的 SST, 直接用 ConcactIterator 遍历
   // ? 通过 TwoMergeIterator 合并后调用 gen_sst_from_iter
+  // ? 与 full_l0_l1_compact 相同, 通过 run_subcompactions 按 key 区间并行,
+  // ? 每个区间的 ConcactIterator 使用 ConcactIterator(ssts, *range.lower, ...) 构造,
+  // ? 从第一个 >= lower 的 key 开始 (lower 不需要出现在输入 SST 中)
   return {};
 }
 
@@ -208,11 +305,18 @@ std::vector<std::shared_ptr<SST>>
 LSMEngine::gen_sst_from_iter(BaseIterator &iter, size_t target_sst_size,
                              size_t target_level) {
   // TODO: Lab 4.5 实现从迭代器构造新的 SST
+  // ? 构造 SSTBuilder 后调用
+  // ? set_level_options(LevelOptions::for_level(target_level, cur_max_level + 1)),
+  // ? 应用该层的 block 大小, 重启间隔, 过滤器 (及 Monkey 分配的位数) 和压缩算法
+  // ? 再分配 sst_id 并调用 builder.open(get_sst_path(sst_id, target_level)),
+  // ? 完成的 block 直接写入文件, 内存占用不随 target_sst_size 增长
   // ? 循环从迭代器取 key-value 写入 SSTBuilder
   // ? 当 estimated_size >= target_sst_size 时 (注意不能在相同 key 的不同版本之间切分)
-  // ?   调用 builder.build() 生成 SST 并重置 builder
+  // ?   调用 builder.build() (path 与 open 时相同) 生成 SST 并重置 builder
   // ? 迭代结束后若 builder 非空则再次 build
   // ? 注意: WiscKey 模式下需使用带 vlog 参数的 SSTBuilder 构造函数
+  // ? 多个 subcompaction 会并发调用本函数: 只通过 next_sst_id++ (原子) 分配 id,
+  // ? 不修改 ssts / level_sst_ids, 由 full_compact 在合并完成后统一更新
   return {};
 }
 
@@ -228,18 +332,241 @@ size_t LSMEngine::get_sst_size(size_t level) {
 
 void LSMEngine::set_tran_manager(std::shared_ptr<TranManager> tran_manager) {
   this->tran_manager = tran_manager;
+  if (TomlConfig::getInstance().getLsmMemtableInplaceUpdate()) {
+    // 由事务管理器提供快照水位, 没有读者需要旧版本时 memtable 可以原地覆盖
+    std::weak_ptr<TranManager> weak_manager = tran_manager;
+    memtable.set_snapshot_watermark([weak_manager]() -> uint64_t {
+      auto manager = weak_manager.lock();
+      return manager ? manager->get_oldest_snapshot_tranc_id() : 0;
+    });
+    // memtable 的迭代器 (LSM::begin, 谓词和前缀查询) 在同一张表中登记快照
+    memtable.set_snapshot_list(tran_manager->get_snapshot_list());
+  }
+}
+
+void LSMEngine::schedule_flush() {
+  if (!background_flush_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(flush_mtx_);
+    flush_pending_ = true;
+  }
+  flush_cv_.notify_one();
+}
+
+bool LSMEngine::background_flush_enabled() const { return background_flush_; }
+
+void LSMEngine::make_room_for_write() {
+  check_memory_budget_();
+
+  if (!background_flush_) {
+    bool force = false;
+    {
+      std::lock_guard<std::mutex> lock(flush_mtx_);
+      std::swap(force, force_flush_);
+    }
+    if (force) {
+      flush();
+    }
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(flush_mtx_);
+    if (flush_error_) {
+      // 冻结表没有丢失, 重新尝试刷盘; 在成功之前拒绝写入, 避免冻结表无限积压
+      flush_pending_ = true;
+      flush_cv_.notify_one();
+      std::rethrow_exception(flush_error_);
+    }
+  }
+  auto &config = TomlConfig::getInstance();
+  size_t stop_trigger =
+      static_cast<size_t>(config.getLsmStopImmutableMemtables());
+  size_t slowdown_trigger =
+      static_cast<size_t>(config.getLsmSlowdownImmutableMemtables());
+
+  size_t frozen_count = memtable.get_frozen_count();
+  if (frozen_count >= stop_trigger) {
+    // 冻结表已经积压到上限, 阻塞写线程直到后台刷盘追上
+    spdlog::warn("LSMEngine--make_room_for_write(): {} frozen memtables, "
+                 "stalling writes",
+                 frozen_count);
+    schedule_flush();
+    std::unique_lock<std::mutex> lock(flush_mtx_);
+    stall_cv_.wait(lock, [&] {
+      return stop_flush_ || flush_error_ ||
+             memtable.get_frozen_count() < stop_trigger;
+    });
+    if (flush_error_) {
+      std::rethrow_exception(flush_error_);
+    }
+  } else if (frozen_count >= slowdown_trigger) {
+    // 每次写入固定延迟, 把刷盘的代价平摊到多次写入上, 而不是让某一次写入阻塞
+    schedule_flush();
+    std::this_thread::sleep_for(
+        std::chrono::microseconds(config.getLsmSlowdownDelayUs()));
+  }
+}
+
+void LSMEngine::check_memory_budget_() {
+  if (!memory_budget_ || memory_budget_->limit() == 0) {
+    return;
+  }
+  // 检查步长为单个 memtable 上限的 1/16
+  size_t step = (std::max)(
+      static_cast<size_t>(TomlConfig::getInstance().getLsmPerMemSizeLimit()) /
+          16,
+      static_cast<size_t>(4096));
+  size_t cur_size = memtable.get_cur_size();
+  size_t checked = budget_checked_size_.load();
+  if (cur_size < checked) {
+    // 活跃表已被冻结, 从新表开始计算
+    budget_checked_size_.store(cur_size);
+    return;
+  }
+  if (cur_size - checked < step ||
+      !budget_checked_size_.compare_exchange_strong(checked, cur_size)) {
+    // 未达到步长, 或者其他写线程已经在这一步中检查过
+    return;
+  }
+  {
+    // 已经请求或正在进行的刷盘会释放内存, 不需要再次回收
+    std::lock_guard<std::mutex> lock(flush_mtx_);
+    if (force_flush_ || flushing_) {
+      return;
+    }
+  }
+  // 进程级内存预算超限: 先收缩块缓存, 仍超限时要求 memtable 提前刷盘
+  // 被选中刷盘的可能是同一进程中其他 LSM 实例的 memtable
+  if (memory_budget_->exceeded()) {
+    memory_budget_->reclaim();
+  }
+}
+
+void LSMEngine::flush_worker_() {
+  spdlog::info("LSMEngine--flush_worker_(): Background flush thread started");
+
+  while (true) {
+    bool force = false;
+    {
+      std::unique_lock<std::mutex> lock(flush_mtx_);
+      flush_cv_.wait(lock, [&] { return stop_flush_ || flush_pending_; });
+      if (stop_flush_) {
+        break;
+      }
+      flush_pending_ = false;
+      std::swap(force, force_flush_);
+      flushing_ = true;
+    }
+
+    if (force && memtable.get_frozen_count() == 0 &&
+        memtable.get_cur_size() > 0) {
+      // 提前刷盘: 先冻结活跃表, 再按正常流程刷出
+      memtable.frozen_cur_table();
+    }
+
+    // 只刷冻结表, 活跃表继续接收写入
+    size_t frozen_count = memtable.get_frozen_count();
+    while (frozen_count > 0) {
+      try {
+        flush();
+      } catch (const std::exception &e) {
+        // flush_last 失败时冻结表仍在 memtable 中, 数据仍然可读;
+        // 把错误交给写线程, 下一次 schedule_flush 时重试
+        spdlog::error("LSMEngine--flush_worker_(): Flush failed: {}",
+                      e.what());
+        std::lock_guard<std::mutex> lock(flush_mtx_);
+        flush_error_ = std::current_exception();
+        stall_cv_.notify_all();
+        break;
+      }
+      {
+        // 持锁通知, 避免写线程在检查条件和进入等待之间错过唤醒
+        std::lock_guard<std::mutex> lock(flush_mtx_);
+        flush_error_ = nullptr;
+        stall_cv_.notify_all();
+      }
+      size_t remain = memtable.get_frozen_count();
+      if (remain >= frozen_count) {
+        // 没有进展 (或期间又冻结了新表), 交给下一次 schedule_flush
+        break;
+      }
+      frozen_count = remain;
+    }
+    std::lock_guard<std::mutex> lock(flush_mtx_);
+    flushing_ = false;
+  }
+
+  spdlog::info("LSMEngine--flush_worker_(): Background flush thread stopped");
+}
+
+void LSMEngine::stop_flush_worker_() {
+  {
+    std::lock_guard<std::mutex> lock(flush_mtx_);
+    stop_flush_ = true;
+  }
+  flush_cv_.notify_all();
+  stall_cv_.notify_all();
+  if (flush_thread_.joinable()) {
+    flush_thread_.join();
+  }
+}
+
+void LSMEngine::request_flush_() {
+  {
+    std::lock_guard<std::mutex> lock(flush_mtx_);
+    force_flush_ = true;
+    flush_pending_ = true;
+  }
+  flush_cv_.notify_one();
+}
+
+void LSMEngine::register_memory_budget_() {
+  memory_budget_ = MemoryBudget::global();
+  auto limit = TomlConfig::getInstance().getLsmMemoryBudget();
+  if (limit > 0) {
+    memory_budget_->set_limit(static_cast<size_t>(limit));
+  }
+
+  memtable_consumer_id_ = memory_budget_->add_consumer(
+      data_dir + "/memtable", MemoryBudget::ConsumerType::MemTable,
+      [this]() { return memtable.get_memory_usage(); },
+      [this](size_t) -> size_t {
+        // 刷盘是异步的, 不计入同步释放量
+        request_flush_();
+        return 0;
+      });
+  cache_consumer_id_ = memory_budget_->add_consumer(
+      data_dir + "/block_cache", MemoryBudget::ConsumerType::BlockCache,
+      [this]() -> size_t {
+        return block_cache ? block_cache->memory_usage() : 0;
+      },
+      [this](size_t bytes) -> size_t {
+        return block_cache ? block_cache->shrink(bytes) : 0;
+      });
+}
+
+void LSMEngine::unregister_memory_budget_() {
+  if (!memory_budget_) {
+    return;
+  }
+  memory_budget_->remove_consumer(memtable_consumer_id_);
+  memory_budget_->remove_consumer(cache_consumer_id_);
+  memory_budget_ = nullptr;
 }
 
 // *********************** LSM ***********************
-LSM::LSM(std::string path)
-    : engine(std::make_shared<LSMEngine>(path)),
+LSM::LSM(std::string path, MemTableRepType memtable_rep)
+    : engine(std::make_shared<LSMEngine>(path, memtable_rep)),
       tran_manager_(std::make_shared<TranManager>(path)) {
   // TODO: Lab 5.5 控制WAL重放与组件的初始化
   // ? 1. 绑定 tran_manager 与 engine: 互相 set
   // ? 2. 调用 tran_manager_->check_recover() 获取需要重放的事务记录
   // ? 3. 遍历返回的 map<tranc_id, records>:
   // ?    - 若该 tranc_id 已在 flushed_tranc_ids 中则跳过 (已刷盘无需重放)
-  // ?    - 否则根据 record.getOperationType() 调用 engine->put() 或 engine->remove()
+  // ?    - 否则调用 engine->replay(records) 重放该事务的写入
+  // ?      (连续的 put 会合并为 put_batch, 有序时跳表可以复用插入位置)
   // ? 4. 调用 tran_manager_->init_new_wal() 开启新的 WAL 文件准备接收新写入
 }
 
@@ -249,8 +576,9 @@ LSM::~LSM() {
 }
 
 std::optional<std::string> LSM::get(const std::string &key) {
-  auto tranc_id = tran_manager_->getNextTransactionId();
-  auto res = engine->get(key, tranc_id);
+  // 快照在返回时释放, 查询抛出异常也不会遗留
+  auto snapshot = tran_manager_->begin_read();
+  auto res = engine->get(key, snapshot->tranc_id());
 
   if (res.has_value()) {
     return res.value().first;
@@ -261,10 +589,10 @@ std::optional<std::string> LSM::get(const std::string &key) {
 std::vector<std::pair<std::string, std::optional<std::string>>>
 LSM::get_batch(const std::vector<std::string> &keys) {
   // 1. 获取事务ID
-  auto tranc_id = tran_manager_->getNextTransactionId();
+  auto snapshot = tran_manager_->begin_read();
 
   // 2. 调用 engine 的批量查询接口
-  auto batch_results = engine->get_batch(keys, tranc_id);
+  auto batch_results = engine->get_batch(keys, snapshot->tranc_id());
 
   // 3. 构造最终结果
   std::vector<std::pair<std::string, std::optional<std::string>>> results;
@@ -322,6 +650,11 @@ LSM::lsm_iters_monotony_predicate(
   return engine->lsm_iters_monotony_predicate(tranc_id, predicate);
 }
 
+std::optional<std::pair<TwoMergeIterator, TwoMergeIterator>>
+LSM::prefix_iter(const std::string &prefix, uint64_t tranc_id) {
+  return engine->prefix_iter(prefix, tranc_id);
+}
+
 // 开启一个事务
 std::shared_ptr<TranContext>
 LSM::begin_tran(const IsolationLevel &isolation_level) {
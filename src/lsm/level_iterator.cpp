@@ -14,11 +14,9 @@ Level_Iterator::Level_Iterator(std::shared_ptr<LSMEngine> engine,
   // 成员变量获取sst读锁
 
   // 1. 获取内存部分迭代器
-  // TODO: 这里最好修改 memtable.begin 使其返回一个指针, 避免多余的内存拷贝
-  auto mem_iter = engine_->memtable.begin(max_tranc_id_);
-  std::shared_ptr<HeapIterator> mem_iter_ptr = std::make_shared<HeapIterator>();
-  *mem_iter_ptr = mem_iter;
-  iter_vec.push_back(mem_iter_ptr);
+  // 内存表迭代器在遍历时才读取记录, 移动构造不会拷贝记录
+  iter_vec.push_back(std::make_shared<MemTableMergeIterator>(
+      engine_->memtable.begin(max_tranc_id_)));
 
   // 2. 获取 L0 层的迭代器
   std::vector<SearchItem> item_vec;
@@ -0,0 +1,204 @@
+#include "lsm/subcompaction.h"
+#include "spdlog/spdlog.h"
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <utility>
+
+namespace tiny_lsm {
+
+// *************************** KeyRange ***************************
+
+bool KeyRange::contains(const std::string &key) const {
+  return (!lower || key >= *lower) && (!upper || key < *upper);
+}
+
+bool KeyRange::overlaps(const std::string &first,
+                        const std::string &last) const {
+  return (!lower || last >= *lower) && (!upper || first < *upper);
+}
+
+// *************************** BoundedIterator ***************************
+
+BoundedIterator::BoundedIterator(std::shared_ptr<BaseIterator> inner,
+                                 KeyRange range)
+    : inner_(std::move(inner)), range_(std::move(range)) {
+  if (range_.lower) {
+    while (inner_->is_valid() && !inner_->is_end() &&
+           (**inner_).first < *range_.lower) {
+      ++(*inner_);
+    }
+  }
+}
+
+BaseIterator &BoundedIterator::operator++() {
+  if (!is_end()) {
+    ++(*inner_);
+  }
+  return *this;
+}
+
+bool BoundedIterator::operator==(const BaseIterator &other) const {
+  if (other.get_type() != IteratorType::BoundedIterator) {
+    return false;
+  }
+  auto &other2 = dynamic_cast<const BoundedIterator &>(other);
+  if (is_end() && other2.is_end()) {
+    return true;
+  }
+  if (is_end() || other2.is_end()) {
+    return false;
+  }
+  return inner_ == other2.inner_;
+}
+
+bool BoundedIterator::operator!=(const BaseIterator &other) const {
+  return !(*this == other);
+}
+
+BaseIterator::value_type BoundedIterator::operator*() const {
+  return **inner_;
+}
+
+IteratorType BoundedIterator::get_type() const {
+  return IteratorType::BoundedIterator;
+}
+
+uint64_t BoundedIterator::get_tranc_id() const {
+  return inner_->get_tranc_id();
+}
+
+bool BoundedIterator::is_end() const {
+  if (inner_->is_end() || !inner_->is_valid()) {
+    return true;
+  }
+  return range_.upper && (**inner_).first >= *range_.upper;
+}
+
+bool BoundedIterator::is_valid() const { return !is_end(); }
+
+// *************************** 切分 ***************************
+
+namespace {
+// 每个 SST 最多抽样的 block 数, 足以把一个 SST 切成多段
+constexpr size_t kSamplesPerSst = 16;
+} // namespace
+
+std::vector<std::string>
+plan_subcompactions(const std::vector<std::shared_ptr<SST>> &inputs,
+                    size_t max_jobs, size_t min_bytes_per_job) {
+  size_t total_bytes = 0;
+  for (auto &sst : inputs) {
+    total_bytes += sst->sst_size();
+  }
+  size_t jobs = max_jobs;
+  if (min_bytes_per_job > 0) {
+    jobs = (std::min)(jobs, total_bytes / min_bytes_per_job);
+  }
+  if (jobs <= 1) {
+    return {};
+  }
+
+  // (候选切分点, 权重)
+  std::vector<std::pair<std::string, double>> candidates;
+  for (auto &sst : inputs) {
+    auto keys = sst->sample_block_keys(kSamplesPerSst);
+    keys.push_back(sst->get_first_key());
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    double weight = static_cast<double>(sst->sst_size()) / keys.size();
+    for (auto &key : keys) {
+      candidates.emplace_back(std::move(key), weight);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+
+  std::vector<std::string> boundaries;
+  double step = static_cast<double>(total_bytes) / jobs;
+  double next_cut = step;
+  double acc = 0;
+  for (auto &[key, weight] : candidates) {
+    // 切分点是下一个区间的起点, 最小的 key 不能作为切分点 (第一个区间为空)
+    if (acc >= next_cut && key != candidates.front().first &&
+        (boundaries.empty() || key != boundaries.back())) {
+      boundaries.push_back(key);
+      if (boundaries.size() + 1 >= jobs) {
+        break;
+      }
+      while (next_cut <= acc) {
+        next_cut += step;
+      }
+    }
+    acc += weight;
+  }
+
+  spdlog::debug("plan_subcompactions: {} inputs, {} bytes, {} subcompactions",
+                inputs.size(), total_bytes, boundaries.size() + 1);
+  return boundaries;
+}
+
+std::vector<KeyRange>
+ranges_from_boundaries(const std::vector<std::string> &boundaries) {
+  std::vector<KeyRange> ranges;
+  ranges.reserve(boundaries.size() + 1);
+  std::optional<std::string> lower;
+  for (auto &boundary : boundaries) {
+    ranges.push_back({lower, boundary});
+    lower = boundary;
+  }
+  ranges.push_back({lower, std::nullopt});
+  return ranges;
+}
+
+std::vector<std::shared_ptr<SST>> run_subcompactions(
+    const std::vector<KeyRange> &ranges,
+    const std::function<std::vector<std::shared_ptr<SST>>(const KeyRange &)>
+        &job) {
+  if (ranges.empty()) {
+    return {};
+  }
+
+  std::vector<std::future<std::vector<std::shared_ptr<SST>>>> futures;
+  futures.reserve(ranges.size() - 1);
+  for (size_t i = 1; i < ranges.size(); i++) {
+    futures.push_back(
+        std::async(std::launch::async, [&job, &range = ranges[i]] {
+          return job(range);
+        }));
+  }
+
+  std::vector<std::vector<std::shared_ptr<SST>>> outputs(ranges.size());
+  std::exception_ptr error;
+  try {
+    outputs[0] = job(ranges[0]);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // 即使已经出错也要等待所有 job, 它们引用了 ranges 和 job
+  for (size_t i = 0; i < futures.size(); i++) {
+    try {
+      outputs[i + 1] = futures[i].get();
+    } catch (...) {
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error) {
+    // 部分区间的输出不完整, 已经生成的 SST 都不会被使用
+    for (auto &output : outputs) {
+      for (auto &sst : output) {
+        sst->del_sst();
+      }
+    }
+    std::rethrow_exception(error);
+  }
+
+  std::vector<std::shared_ptr<SST>> result;
+  for (auto &output : outputs) {
+    result.insert(result.end(), output.begin(), output.end());
+  }
+  return result;
+}
+} // namespace tiny_lsm
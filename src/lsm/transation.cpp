@@ -406,6 +406,14 @@ void TranManager::add_ready_to_flush_tranc_id(uint64_t tranc_id,
                                               TransactionState state) {
   std::unique_lock lock(mutex_);
   readyToFlushTrancIds_[tranc_id] = state;
+  // 事务已经提交或终止, 不再持有快照
+  auto it = activeTrans_.find(tranc_id);
+  if (it != activeTrans_.end()) {
+    if (auto context = it->second.lock()) {
+      context->snapshot_.reset();
+    }
+    activeTrans_.erase(it);
+  }
 }
 
 void TranManager::add_flushed_tranc_id(uint64_t tranc_id) {
@@ -432,6 +440,21 @@ uint64_t TranManager::getNextTransactionId() {
   return nextTransactionId_.fetch_add(1);
 }
 
+std::shared_ptr<Snapshot> TranManager::begin_read() {
+  return snapshots_->acquire([this]() { return getNextTransactionId(); });
+}
+
+uint64_t TranManager::get_oldest_snapshot_tranc_id() {
+  // 先读取下一个 id 再查看登记表: 之后登记的快照在锁内分配 id, 不会小于它
+  uint64_t next_id = nextTransactionId_.load();
+  auto oldest = snapshots_->oldest();
+  return oldest ? (std::min)(*oldest, next_id) : next_id;
+}
+
+std::shared_ptr<SnapshotList> TranManager::get_snapshot_list() {
+  return snapshots_;
+}
+
 std::set<uint64_t> &TranManager::get_flushed_tranc_ids() {
   return flushedTrancIds_;
 }
@@ -455,15 +478,25 @@ TranManager::new_tranc(const IsolationLevel &isolation_level) {
   // 获取锁
   std::unique_lock<std::mutex> lock(mutex_);
 
-  auto tranc_id = getNextTransactionId();
-  activeTrans_[tranc_id] = std::make_shared<TranContext>(
-      tranc_id, engine_, shared_from_this(), isolation_level);
+  // 事务 id 即快照 id, 分配和登记在同一把锁内完成
+  auto snapshot =
+      snapshots_->acquire([this]() { return getNextTransactionId(); });
+  auto tranc_id = snapshot->tranc_id();
+  auto context = std::make_shared<TranContext>(tranc_id, engine_,
+                                               shared_from_this(),
+                                               isolation_level);
+  context->snapshot_ = std::move(snapshot);
+  // 清理被丢弃的事务
+  while (!activeTrans_.empty() && activeTrans_.begin()->second.expired()) {
+    activeTrans_.erase(activeTrans_.begin());
+  }
+  activeTrans_[tranc_id] = context;
 
   spdlog::debug("TranManager--new_tranc(): Created transaction ID={} with "
                 "isolation level={}",
                 tranc_id, static_cast<int>(isolation_level));
 
-  return activeTrans_[tranc_id];
+  return context;
 }
 std::string TranManager::get_tranc_id_file_path() {
   if (data_dir_.empty()) {
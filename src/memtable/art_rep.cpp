@@ -0,0 +1,386 @@
+#include "memtable/memtable_rep.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace tiny_lsm {
+
+// ************************ ART 节点 ************************
+// 所有节点共用的头部:
+// - prefix_: 压缩后的路径, 从父节点的分支字节之后开始
+// - leaf_: 恰好在此节点结束的 key 的版本链, 最新写入在前
+// 子节点按分支字节有序排列, 因此先访问 leaf_ 再按字节顺序访问子节点即为中序遍历
+struct ArtRep::Node {
+  enum Kind : uint8_t { N4, N16, N48, N256 };
+
+  explicit Node(Kind kind) : kind_(kind) {}
+  virtual ~Node() = default;
+
+  Kind kind_;
+  uint16_t count_ = 0;
+  std::string prefix_;
+  MemTableRepEntry *leaf_ = nullptr;
+};
+
+namespace {
+
+using Node = ArtRep::Node;
+
+// Node4 和 Node16 使用有序的 key 数组, 只是容量不同
+template <int Cap, Node::Kind K> struct ArtNodeN : public Node {
+  ArtNodeN() : Node(K) {}
+  uint8_t keys_[Cap];
+  std::unique_ptr<Node> children_[Cap];
+};
+
+using ArtNode4 = ArtNodeN<4, Node::N4>;
+using ArtNode16 = ArtNodeN<16, Node::N16>;
+
+struct ArtNode48 : public Node {
+  static constexpr uint8_t kEmpty = 0xFF;
+  ArtNode48() : Node(N48) { memset(index_, kEmpty, sizeof(index_)); }
+  uint8_t index_[256]; // 分支字节 -> children_ 的下标
+  std::unique_ptr<Node> children_[48];
+};
+
+struct ArtNode256 : public Node {
+  ArtNode256() : Node(N256) {}
+  std::unique_ptr<Node> children_[256];
+};
+
+template <typename T> T *as(Node *node) { return static_cast<T *>(node); }
+
+// 一次堆分配在请求大小之外的额外开销 (glibc malloc 的块头)
+constexpr size_t kMallocOverhead = 16;
+
+size_t node_size(Node::Kind kind) {
+  switch (kind) {
+  case Node::N4:
+    return sizeof(ArtNode4) + kMallocOverhead;
+  case Node::N16:
+    return sizeof(ArtNode16) + kMallocOverhead;
+  case Node::N48:
+    return sizeof(ArtNode48) + kMallocOverhead;
+  case Node::N256:
+    return sizeof(ArtNode256) + kMallocOverhead;
+  }
+  return 0;
+}
+
+void copy_header(Node *dst, Node *src) {
+  dst->prefix_ = std::move(src->prefix_);
+  dst->leaf_ = src->leaf_;
+}
+
+std::unique_ptr<Node> *find_child(Node *node, uint8_t byte) {
+  switch (node->kind_) {
+  case Node::N4: {
+    auto n = as<ArtNode4>(node);
+    for (int i = 0; i < n->count_; i++) {
+      if (n->keys_[i] == byte) {
+        return &n->children_[i];
+      }
+    }
+    return nullptr;
+  }
+  case Node::N16: {
+    auto n = as<ArtNode16>(node);
+    auto end = n->keys_ + n->count_;
+    auto it = std::lower_bound(n->keys_, end, byte);
+    if (it != end && *it == byte) {
+      return &n->children_[it - n->keys_];
+    }
+    return nullptr;
+  }
+  case Node::N48: {
+    auto n = as<ArtNode48>(node);
+    if (n->index_[byte] == ArtNode48::kEmpty) {
+      return nullptr;
+    }
+    return &n->children_[n->index_[byte]];
+  }
+  case Node::N256: {
+    auto n = as<ArtNode256>(node);
+    return n->children_[byte] ? &n->children_[byte] : nullptr;
+  }
+  }
+  return nullptr;
+}
+
+// 在有序 key 数组中插入一个子节点, 调用方保证容量足够
+template <typename T>
+void insert_sorted(T *n, uint8_t byte, std::unique_ptr<Node> child) {
+  int pos = std::lower_bound(n->keys_, n->keys_ + n->count_, byte) - n->keys_;
+  for (int i = n->count_; i > pos; i--) {
+    n->keys_[i] = n->keys_[i - 1];
+    n->children_[i] = std::move(n->children_[i - 1]);
+  }
+  n->keys_[pos] = byte;
+  n->children_[pos] = std::move(child);
+  n->count_++;
+}
+
+// 添加一个子节点, 节点已满时先升级为更大的节点, 因此需要传入节点所在的位置
+// 节点升级引起的内存变化累加到 node_bytes
+void add_child(std::unique_ptr<Node> &ref, uint8_t byte,
+               std::unique_ptr<Node> child, size_t &node_bytes) {
+  Node *node = ref.get();
+  switch (node->kind_) {
+  case Node::N4: {
+    auto n = as<ArtNode4>(node);
+    if (n->count_ < 4) {
+      insert_sorted(n, byte, std::move(child));
+      return;
+    }
+    auto grown = std::make_unique<ArtNode16>();
+    node_bytes += node_size(Node::N16) - node_size(Node::N4);
+    copy_header(grown.get(), n);
+    for (int i = 0; i < n->count_; i++) {
+      grown->keys_[i] = n->keys_[i];
+      grown->children_[i] = std::move(n->children_[i]);
+    }
+    grown->count_ = n->count_;
+    insert_sorted(grown.get(), byte, std::move(child));
+    ref = std::move(grown);
+    return;
+  }
+  case Node::N16: {
+    auto n = as<ArtNode16>(node);
+    if (n->count_ < 16) {
+      insert_sorted(n, byte, std::move(child));
+      return;
+    }
+    auto grown = std::make_unique<ArtNode48>();
+    node_bytes += node_size(Node::N48) - node_size(Node::N16);
+    copy_header(grown.get(), n);
+    for (int i = 0; i < n->count_; i++) {
+      grown->index_[n->keys_[i]] = static_cast<uint8_t>(i);
+      grown->children_[i] = std::move(n->children_[i]);
+    }
+    grown->count_ = n->count_;
+    ref = std::move(grown);
+    add_child(ref, byte, std::move(child), node_bytes);
+    return;
+  }
+  case Node::N48: {
+    auto n = as<ArtNode48>(node);
+    if (n->count_ < 48) {
+      // 没有删除操作, children_ 总是紧凑地占用前 count_ 个位置
+      n->index_[byte] = static_cast<uint8_t>(n->count_);
+      n->children_[n->count_] = std::move(child);
+      n->count_++;
+      return;
+    }
+    auto grown = std::make_unique<ArtNode256>();
+    node_bytes += node_size(Node::N256) - node_size(Node::N48);
+    copy_header(grown.get(), n);
+    for (int b = 0; b < 256; b++) {
+      if (n->index_[b] != ArtNode48::kEmpty) {
+        grown->children_[b] = std::move(n->children_[n->index_[b]]);
+      }
+    }
+    grown->count_ = n->count_;
+    ref = std::move(grown);
+    add_child(ref, byte, std::move(child), node_bytes);
+    return;
+  }
+  case Node::N256: {
+    auto n = as<ArtNode256>(node);
+    n->children_[byte] = std::move(child);
+    n->count_++;
+    return;
+  }
+  }
+}
+
+std::unique_ptr<Node> new_leaf_node(std::string prefix,
+                                    MemTableRepEntry *entry,
+                                    size_t &node_bytes) {
+  node_bytes += node_size(Node::N4);
+  auto node = std::make_unique<ArtNode4>();
+  node->prefix_ = std::move(prefix);
+  node->leaf_ = entry;
+  return node;
+}
+
+void push_version(Node *node, MemTableRepEntry *entry) {
+  entry->next_ = node->leaf_;
+  node->leaf_ = entry;
+}
+
+// 将一个 key 的版本链按 tranc_id 降序追加到 out, 相同 tranc_id 只保留最新写入
+void collect_versions(const MemTableRepEntry *head,
+                      std::vector<const MemTableRepEntry *> &out) {
+  size_t start = out.size();
+  for (auto e = head; e != nullptr; e = e->next_) {
+    out.push_back(e);
+  }
+  // 版本链按 seq 降序, 稳定排序后相同 tranc_id 中 seq 最大的排在最前
+  std::stable_sort(out.begin() + start, out.end(),
+                   [](const MemTableRepEntry *a, const MemTableRepEntry *b) {
+                     return a->tranc_id_ > b->tranc_id_;
+                   });
+  auto last = std::unique(
+      out.begin() + start, out.end(),
+      [](const MemTableRepEntry *a, const MemTableRepEntry *b) {
+        return a->tranc_id_ == b->tranc_id_;
+      });
+  out.erase(last, out.end());
+}
+
+void traverse(const Node *node, std::vector<const MemTableRepEntry *> &out) {
+  if (node->leaf_) {
+    collect_versions(node->leaf_, out);
+  }
+  switch (node->kind_) {
+  case Node::N4: {
+    auto n = static_cast<const ArtNode4 *>(node);
+    for (int i = 0; i < n->count_; i++) {
+      traverse(n->children_[i].get(), out);
+    }
+    break;
+  }
+  case Node::N16: {
+    auto n = static_cast<const ArtNode16 *>(node);
+    for (int i = 0; i < n->count_; i++) {
+      traverse(n->children_[i].get(), out);
+    }
+    break;
+  }
+  case Node::N48: {
+    auto n = static_cast<const ArtNode48 *>(node);
+    for (int b = 0; b < 256; b++) {
+      if (n->index_[b] != ArtNode48::kEmpty) {
+        traverse(n->children_[n->index_[b]].get(), out);
+      }
+    }
+    break;
+  }
+  case Node::N256: {
+    auto n = static_cast<const ArtNode256 *>(node);
+    for (int b = 0; b < 256; b++) {
+      if (n->children_[b]) {
+        traverse(n->children_[b].get(), out);
+      }
+    }
+    break;
+  }
+  }
+}
+} // namespace
+
+// ************************ ArtRep ************************
+
+ArtRep::ArtRep()
+    : root_(std::make_unique<ArtNode4>()), node_bytes_(node_size(Node::N4)) {}
+
+ArtRep::~ArtRep() = default;
+
+void ArtRep::put(const std::string &key, const std::string &value,
+                 uint64_t tranc_id) {
+  auto entry = append_(key, value, tranc_id);
+
+  std::unique_ptr<Node> *ref = &root_;
+  size_t depth = 0;
+  while (true) {
+    Node *node = ref->get();
+
+    // 1. 比较压缩路径, 不完全匹配时在分叉处拆分出新的父节点
+    const std::string &prefix = node->prefix_;
+    size_t match = 0;
+    while (match < prefix.size() && depth + match < key.size() &&
+           prefix[match] == key[depth + match]) {
+      match++;
+    }
+    if (match < prefix.size()) {
+      auto parent = std::make_unique<ArtNode4>();
+      node_bytes_ += node_size(Node::N4);
+      parent->prefix_ = prefix.substr(0, match);
+      uint8_t old_byte = static_cast<uint8_t>(prefix[match]);
+      node->prefix_ = prefix.substr(match + 1);
+      depth += match;
+
+      std::unique_ptr<Node> parent_ref = std::move(parent);
+      add_child(parent_ref, old_byte, std::move(*ref), node_bytes_);
+      if (depth == key.size()) {
+        push_version(parent_ref.get(), entry);
+      } else {
+        add_child(parent_ref, static_cast<uint8_t>(key[depth]),
+                  new_leaf_node(key.substr(depth + 1), entry, node_bytes_),
+                  node_bytes_);
+      }
+      *ref = std::move(parent_ref);
+      return;
+    }
+    depth += prefix.size();
+
+    // 2. key 恰好在此节点结束
+    if (depth == key.size()) {
+      push_version(node, entry);
+      return;
+    }
+
+    // 3. 沿分支字节向下, 不存在时直接挂上剩余部分作为压缩路径
+    uint8_t byte = static_cast<uint8_t>(key[depth]);
+    auto child = find_child(node, byte);
+    if (!child) {
+      add_child(*ref, byte,
+                new_leaf_node(key.substr(depth + 1), entry, node_bytes_),
+                node_bytes_);
+      return;
+    }
+    ref = child;
+    depth++;
+  }
+}
+
+MemTableIterator ArtRep::get(const std::string &key, uint64_t tranc_id) {
+  if (!may_contain(key)) {
+    return MemTableIterator{};
+  }
+  const Node *node = root_.get();
+  size_t depth = 0;
+  while (node) {
+    const std::string &prefix = node->prefix_;
+    if (key.size() - depth < prefix.size() ||
+        key.compare(depth, prefix.size(), prefix) != 0) {
+      return MemTableIterator{};
+    }
+    depth += prefix.size();
+    if (depth == key.size()) {
+      break;
+    }
+    auto child = find_child(const_cast<Node *>(node),
+                            static_cast<uint8_t>(key[depth]));
+    node = child ? child->get() : nullptr;
+    depth++;
+  }
+  if (!node) {
+    return MemTableIterator{};
+  }
+
+  // 版本链中越靠前越新, tranc_id 相同时保留先遇到的记录
+  uint64_t visible_id = tranc_id == 0 ? UINT64_MAX : tranc_id;
+  const MemTableRepEntry *best = nullptr;
+  for (auto e = node->leaf_; e != nullptr; e = e->next_) {
+    if (e->tranc_id_ <= visible_id && (!best || e->tranc_id_ > best->tranc_id_)) {
+      best = e;
+    }
+  }
+  return make_entry_iter_(best);
+}
+
+size_t ArtRep::memory_usage() {
+  return SortedViewRep::memory_usage() + node_bytes_;
+}
+
+std::shared_ptr<const SortedView> ArtRep::build_view_() {
+  // 中序遍历即为有序结果, 不需要排序
+  auto view = std::make_shared<SortedView>();
+  view->storage = storage_;
+  view->entries.reserve(storage_->size());
+  traverse(root_.get(), view->entries);
+  return view;
+}
+} // namespace tiny_lsm
@@ -2,7 +2,7 @@
 #include "config/config.h"
 #include "consts.h"
 #include "iterator/iterator.h"
-#include "skiplist/skiplist.h"
+#include "memtable/memtable_rep.h"
 #include "sst/sst.h"
 #include "spdlog/spdlog.h"
 #include <algorithm>
@@ -20,8 +20,11 @@ namespace tiny_lsm {
 class BlockCache;
 
 // MemTable implementation using PIMPL idiom
-MemTable::MemTable() : frozen_bytes(0) {
-  current_table = std::make_shared<SkipList>();
+MemTable::MemTable() : MemTable(default_memtable_rep_type()) {}
+
+MemTable::MemTable(MemTableRepType rep_type)
+    : rep_type_(rep_type), frozen_bytes(0) {
+  current_table = new_memtable_rep(rep_type_);
 }
 MemTable::~MemTable() = default;
 
@@ -29,12 +32,16 @@ void MemTable::put_(const std::string &key, const std::string &value,
                     uint64_t tranc_id) {
   // TODO: Lab2.1 无锁版本的 put
   // ? 直接调用 current_table 的 put 方法
+  // ? 若 can_overwrite_(tranc_id), 先尝试 current_table->overwrite(),
+  // ? 成功时说明旧版本已被原地覆盖, 不需要再插入新版本
 }
 
 void MemTable::put(const std::string &key, const std::string &value,
                    uint64_t tranc_id) {
   // TODO: Lab2.1 有锁版本的 put
   // ? 加 cur_mtx 写锁后调用 put_()
+  // ? 若 current_table->concurrent_put() 为 true, 可以只加 cur_mtx 读锁,
+  // ? 让多个写线程并发插入; 冻结前需要释放读锁并重新加写锁
   // ? 若 current_table 超过 LsmPerMemSizeLimit, 还需加 frozen_mtx 写锁并调用 frozen_cur_table_()
 }
 
@@ -42,35 +49,38 @@ void MemTable::put_batch(
     const std::vector<std::pair<std::string, std::string>> &kvs,
     uint64_t tranc_id) {
   // TODO: Lab2.1 有锁版本的 put_batch
-  // ? 加 cur_mtx 写锁后遍历 kvs 依次调用 put_()
+  // ? 加 cur_mtx 写锁后调用 current_table->put_batch(kvs, tranc_id)
+  // ? (kvs 按 key 有序时 SkipList 会复用上一次的插入位置, 不必逐个从头查找)
   // ? 结束后若超限则冻结当前表
 }
 
-SkipListIterator MemTable::cur_get_(const std::string &key, uint64_t tranc_id) {
+MemTableIterator MemTable::cur_get_(const std::string &key, uint64_t tranc_id) {
   // 检查当前活跃的memtable
   // TODO: Lab2.1 从活跃跳表中查询
   // ? 调用 current_table->get(), 找到则返回; 未找到则返回空迭代器
-  return SkipListIterator{};
+  return MemTableIterator{};
 }
 
-SkipListIterator MemTable::frozen_get_(const std::string &key,
+MemTableIterator MemTable::frozen_get_(const std::string &key,
                                        uint64_t tranc_id) {
   // TODO: Lab2.1 从冻结跳表中查询
   // ? 遍历 frozen_tables (注意顺序：越靠前越新), 找到即返回
   // ? tranc_id 直接传递到 get() 即可
-  return SkipListIterator{};
+  // ? 各表的 get() 会先查询布隆过滤器 (may_contain), 不含该 key 的表
+  // ? 只需几次哈希探测即可跳过, 无需遍历整张表
+  return MemTableIterator{};
 }
 
-SkipListIterator MemTable::get(const std::string &key, uint64_t tranc_id) {
+MemTableIterator MemTable::get(const std::string &key, uint64_t tranc_id) {
   // TODO: Lab2.1 查询, 建议复用 cur_get_ 和 frozen_get_
   // ? 先加 cur_mtx 读锁查活跃表, 未命中则释放锁后加 frozen_mtx 读锁查冻结表
-  return SkipListIterator{};
+  return MemTableIterator{};
 }
 
-SkipListIterator MemTable::get_(const std::string &key, uint64_t tranc_id) {
+MemTableIterator MemTable::get_(const std::string &key, uint64_t tranc_id) {
   // TODO: Lab2.1 查询, 无锁版本
   // ? 直接调用 cur_get_ 和 frozen_get_
-  return SkipListIterator{};
+  return MemTableIterator{};
 }
 
 std::vector<
@@ -129,6 +139,7 @@ MemTable::get_batch(const std::vector<std::string> &keys, uint64_t tranc_id) {
 void MemTable::remove_(const std::string &key, uint64_t tranc_id) {
   // TODO: Lab2.1 无锁版本的remove
   // ? 在 LSM 中, 删除操作是写入空值, 调用 current_table->put(key, "", tranc_id)
+  // ? 与 put_ 相同, 可以先尝试 overwrite (墓碑仍然保留, 可以遮蔽 SST 中的旧值)
 }
 
 void MemTable::remove(const std::string &key, uint64_t tranc_id) {
@@ -150,7 +161,7 @@ void MemTable::clear() {
   std::unique_lock<std::shared_mutex> lock1(cur_mtx);
   std::unique_lock<std::shared_mutex> lock2(frozen_mtx);
   frozen_tables.clear();
-  current_table->clear();
+  current_table = new_memtable_rep(rep_type_);
 }
 
 // 将最老的 memtable 写入 SST, 并返回控制类
@@ -161,7 +172,9 @@ MemTable::flush_last(SSTBuilder &builder, std::string &sst_path, size_t sst_id,
   spdlog::debug("MemTable--flush_last(): Starting to flush memtable to SST{}",
                 sst_id);
 
-  // 由于 flush 后需要移除最老的 memtable, 因此需要加写锁
+  // 可能需要冻结活跃表, 与写入和 clear 相同, 先加 cur_mtx 再加 frozen_mtx
+  // 由于 flush 后需要移除最老的 memtable, frozen_mtx 需要加写锁
+  std::unique_lock<std::shared_mutex> cur_lock(cur_mtx);
   std::unique_lock<std::shared_mutex> lock(frozen_mtx);
 
   uint64_t max_tranc_id = 0;
@@ -176,28 +189,39 @@ MemTable::flush_last(SSTBuilder &builder, std::string &sst_path, size_t sst_id,
       return nullptr;
     }
     // 将当前表加入到frozen_tables头部
+    current_table->freeze();
     frozen_tables.push_front(current_table);
     frozen_bytes += current_table->get_size();
     // 创建新的空表作为当前表
-    current_table = std::make_shared<SkipList>();
+    current_table = new_memtable_rep(rep_type_);
   }
+  // 之后只访问冻结表, 不再阻塞写入
+  cur_lock.unlock();
 
   // 将最老的 memtable 写入 SST
-  std::shared_ptr<SkipList> table = frozen_tables.back();
-  frozen_tables.pop_back();
-  frozen_bytes -= table->get_size();
-
-  std::vector<std::tuple<std::string, std::string, uint64_t>> flush_data =
-      table->flush();
-  for (auto &[k, v, t] : flush_data) {
+  // SST 构建成功后才移除该表: 失败时 (如磁盘写满) 表仍留在 frozen_tables 中,
+  // 数据仍然可读, 之后可以重试
+  std::shared_ptr<MemTableRep> table = frozen_tables.back();
+
+  // 完成的 block 直接写入 sst_path, 记录逐条从表中交给 builder,
+  // 刷盘时额外占用的内存只有写缓冲区和当前 block
+  // 事务提交标记先记录在本地, SST 构建成功后才交给调用方
+  std::vector<uint64_t> table_tranc_ids;
+  builder.open(sst_path);
+  table->flush_to([&](const std::string &k, const std::string &v,
+                      uint64_t t) {
     if (k == "" && v == "") {
-      flushed_tranc_ids.push_back(t);
+      table_tranc_ids.push_back(t);
     }
     max_tranc_id = (std::max)(t, max_tranc_id);
     min_tranc_id = (std::min)(t, min_tranc_id);
     builder.add(k, v, t);
-  }
+  });
   auto sst = builder.build(sst_id, sst_path, block_cache);
+  frozen_tables.pop_back();
+  frozen_bytes -= table->get_size();
+  flushed_tranc_ids.insert(flushed_tranc_ids.end(), table_tranc_ids.begin(),
+                           table_tranc_ids.end());
 
   spdlog::info("MemTable--flush_last(): SST{} built successfully at '{}'",
                sst_id, sst_path);
@@ -207,8 +231,9 @@ MemTable::flush_last(SSTBuilder &builder, std::string &sst_path, size_t sst_id,
 
 void MemTable::frozen_cur_table_() {
   // TODO: Lab2.1 冻结活跃表（无锁版本）
+  // ? 调用 current_table->freeze() 通知其不再写入 (如 SortedVectorRep 在此排序)
   // ? 将 current_table 移入 frozen_tables 头部, 并更新 frozen_bytes
-  // ? 创建新的空 SkipList 作为 current_table
+  // ? 调用 new_memtable_rep(rep_type_) 创建新的空表作为 current_table
 }
 
 void MemTable::frozen_cur_table() {
@@ -216,6 +241,40 @@ void MemTable::frozen_cur_table() {
   // ? 加 cur_mtx 和 frozen_mtx 写锁后调用 frozen_cur_table_()
 }
 
+MemTableRepType MemTable::get_rep_type() const { return rep_type_; }
+
+void MemTable::set_snapshot_watermark(std::function<uint64_t()> watermark) {
+  std::unique_lock<std::shared_mutex> lock(cur_mtx);
+  snapshot_watermark_ = std::move(watermark);
+}
+
+void MemTable::set_snapshot_list(std::shared_ptr<SnapshotList> snapshots) {
+  std::unique_lock<std::shared_mutex> lock(cur_mtx);
+  snapshots_ = std::move(snapshots);
+}
+
+MemTableMergeIterator
+MemTable::make_iterator_(std::vector<MemTableMergeIterator::Source> sources,
+                         uint64_t tranc_id) {
+  // tranc_id 为 0 时读取最新版本, 不需要保留旧版本
+  std::shared_ptr<Snapshot> snapshot;
+  if (snapshots_ && tranc_id != 0) {
+    snapshot = snapshots_->acquire(tranc_id);
+  }
+  MemTableMergeIterator iter(std::move(sources), tranc_id);
+  iter.hold_snapshot(std::move(snapshot));
+  return iter;
+}
+
+bool MemTable::can_overwrite_(uint64_t tranc_id) const {
+  // 旧版本只对 [旧 tranc_id, tranc_id) 之间的快照可见,
+  // 水位大于 tranc_id 说明这样的快照不存在, 之后的读者也只会使用更大的 id
+  if (tranc_id == 0 || !snapshot_watermark_) {
+    return false;
+  }
+  return snapshot_watermark_() > tranc_id;
+}
+
 size_t MemTable::get_cur_size() {
   std::shared_lock<std::shared_mutex> slock(cur_mtx);
   return current_table->get_size();
@@ -226,43 +285,61 @@ size_t MemTable::get_frozen_size() {
   return frozen_bytes;
 }
 
+size_t MemTable::get_frozen_count() {
+  std::shared_lock<std::shared_mutex> slock(frozen_mtx);
+  return frozen_tables.size();
+}
+
+size_t MemTable::get_memory_usage() {
+  std::shared_lock<std::shared_mutex> slock1(cur_mtx);
+  std::shared_lock<std::shared_mutex> slock2(frozen_mtx);
+  size_t usage = current_table->memory_usage();
+  for (auto &table : frozen_tables) {
+    usage += table->memory_usage();
+  }
+  return usage;
+}
+
 size_t MemTable::get_total_size() {
   std::shared_lock<std::shared_mutex> slock1(cur_mtx);
   std::shared_lock<std::shared_mutex> slock2(frozen_mtx);
   return get_frozen_size() + get_cur_size();
 }
 
-// TODO: 需要进一步判断这里的 HeapIterator 能否跳过删除元素
-HeapIterator MemTable::begin(uint64_t tranc_id) {
+MemTableMergeIterator MemTable::begin(uint64_t tranc_id) {
   // TODO: Lab2.2 MemTable 的迭代器
-  // ? 加 cur_mtx 和 frozen_mtx 读锁, 遍历所有表收集 SearchItem
-  // ? 每个 item 包含 key, value, table_idx, 0, tranc_id
-  // ? 过滤 tranc_id 不可见的记录 (tranc_id != 0 && iter.get_tranc_id() > tranc_id)
-  // ? 返回 HeapIterator(item_vec, tranc_id)
+  // ? 加 cur_mtx 和 frozen_mtx 读锁, 为每张表构造一个
+  // ? MemTableMergeIterator::Source{table, table->begin(), table->end(), mtx}
+  // ? 活跃表放在最前面, mtx 为 &cur_mtx (迭代期间仍可能被写入);
+  // ? 冻结表按从新到旧的顺序排列, mtx 为 nullptr
+  // ? 返回 make_iterator_(sources, tranc_id) (在读锁内调用, 会登记读快照),
+  // ? 记录在遍历时才读取
   return {};
 }
 
-HeapIterator MemTable::end() {
+MemTableMergeIterator MemTable::end() {
   // TODO: Lab2.2 MemTable 的迭代器
-  // ? 加读锁后返回空 HeapIterator
-  return HeapIterator{};
+  // ? 返回空的 MemTableMergeIterator
+  return MemTableMergeIterator{};
 }
 
-HeapIterator MemTable::iters_preffix(const std::string &preffix,
-                                     uint64_t tranc_id) {
+MemTableMergeIterator MemTable::iters_preffix(const std::string &preffix,
+                                              uint64_t tranc_id) {
   // TODO: Lab2.3 MemTable 的前缀迭代器
-  // ? 加读锁, 对所有表调用 begin_preffix/end_preffix 遍历前缀范围
-  // ? 过滤事务可见性, 同 key 只保留最新版本
+  // ? 同 begin, 但每张表的 Source 范围为
+  // ? [table->begin_preffix(preffix), table->end_preffix(preffix))
+  // ? 事务可见性和同 key 只保留最新版本由 MemTableMergeIterator 处理
   return {};
 }
 
-std::optional<std::pair<HeapIterator, HeapIterator>>
+std::optional<std::pair<MemTableMergeIterator, MemTableMergeIterator>>
 MemTable::iters_monotony_predicate(
     uint64_t tranc_id, std::function<int(const std::string &)> predicate) {
   // TODO: Lab2.3 MemTable 的谓词查询迭代器起始范围
-  // ? 加读锁, 对所有表调用 iters_monotony_predicate 获取结果
-  // ? 过滤事务可见性, 同 key 只保留最新版本
-  // ? 若结果为空返回 nullopt; 否则返回 make_pair(HeapIterator(item_vec, tranc_id, true), HeapIterator{})
+  // ? 加读锁, 对所有表调用 iters_monotony_predicate 获取 [begin, end) 范围,
+  // ? 有结果的表构造 Source (顺序与 begin 相同)
+  // ? 在读锁内调用 make_iterator_(sources, tranc_id), 若 is_end() 返回 nullopt
+  // ? 否则返回 make_pair(iter, MemTableMergeIterator{})
   return std::nullopt;
 }
 } // namespace tiny_lsm
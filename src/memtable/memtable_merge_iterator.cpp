@@ -0,0 +1,176 @@
+#include "memtable/memtable_merge_iterator.h"
+#include <mutex>
+#include <utility>
+
+namespace tiny_lsm {
+
+MemTableMergeIterator::MemTableMergeIterator(bool skip_delete,
+                                             bool keep_all_versions)
+    : skip_delete_(skip_delete), keep_all_versions_(keep_all_versions) {}
+
+MemTableMergeIterator::MemTableMergeIterator(std::vector<Source> sources,
+                                             uint64_t max_tranc_id,
+                                             bool skip_delete,
+                                             bool keep_all_versions)
+    : sources_(std::move(sources)), max_tranc_id_(max_tranc_id),
+      skip_delete_(skip_delete), keep_all_versions_(keep_all_versions) {
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    fill_(i, false);
+  }
+  skip_illegal_();
+}
+
+MemTableMergeIterator::MemTableMergeIterator(const MemTableMergeIterator &other)
+    : sources_(other.sources_), items_(other.items_),
+      max_tranc_id_(other.max_tranc_id_), skip_delete_(other.skip_delete_),
+      keep_all_versions_(other.keep_all_versions_),
+      snapshot_(other.snapshot_) {
+  for (size_t i = 0; i < sources_.size(); ++i) {
+    std::shared_lock<std::shared_mutex> lock;
+    if (sources_[i].mtx) {
+      lock = std::shared_lock<std::shared_mutex>(*sources_[i].mtx);
+    }
+    sources_[i].cur = other.sources_[i].cur.clone();
+  }
+}
+
+MemTableMergeIterator &
+MemTableMergeIterator::operator=(const MemTableMergeIterator &other) {
+  if (this != &other) {
+    MemTableMergeIterator copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+void MemTableMergeIterator::hold_snapshot(
+    std::shared_ptr<const Snapshot> snapshot) {
+  snapshot_ = std::move(snapshot);
+}
+
+void MemTableMergeIterator::fill_(size_t idx, bool advance) {
+  auto &src = sources_[idx];
+  std::shared_lock<std::shared_mutex> lock;
+  if (src.mtx) {
+    lock = std::shared_lock<std::shared_mutex>(*src.mtx);
+  }
+  if (advance && !src.cur.is_end()) {
+    ++src.cur;
+  }
+  while (!src.cur.is_end() && src.cur != src.end) {
+    if (src.cur.is_valid()) {
+      items_.emplace(src.cur.get_key(), src.cur.get_value(),
+                     static_cast<int>(idx), 0, src.cur.get_tranc_id());
+      return;
+    }
+    // 空 key 是事务的提交标记, 不属于用户数据
+    ++src.cur;
+  }
+}
+
+void MemTableMergeIterator::pop_top_() {
+  size_t idx = static_cast<size_t>(items_.top().idx_);
+  items_.pop();
+  fill_(idx, true);
+}
+
+bool MemTableMergeIterator::top_value_legal_() const {
+  if (items_.empty()) {
+    return true;
+  }
+  if (max_tranc_id_ != 0 && items_.top().tranc_id_ > max_tranc_id_) {
+    // 事务id不可见
+    return false;
+  }
+  return !skip_delete_ || !items_.top().value_.empty();
+}
+
+void MemTableMergeIterator::skip_illegal_() {
+  while (!top_value_legal_()) {
+    // 1. 先跳过事务 id 不可见的部分
+    while (max_tranc_id_ != 0 && !items_.empty() &&
+           items_.top().tranc_id_ > max_tranc_id_) {
+      pop_top_();
+    }
+
+    if (!skip_delete_) {
+      continue;
+    }
+    // 2. 跳过标记为删除的元素, 同一个 key 更旧的版本同样不可见
+    while (!items_.empty() && items_.top().value_.empty()) {
+      auto del_key = items_.top().key_;
+      if (!keep_all_versions_) {
+        while (!items_.empty() && items_.top().key_ == del_key) {
+          pop_top_();
+        }
+      } else {
+        pop_top_();
+      }
+    }
+  }
+}
+
+MemTableMergeIterator::pointer MemTableMergeIterator::operator->() const {
+  if (items_.empty()) {
+    current_.reset();
+  } else {
+    current_ = std::make_shared<value_type>(items_.top().key_,
+                                            items_.top().value_);
+  }
+  return current_.get();
+}
+
+MemTableMergeIterator::value_type MemTableMergeIterator::operator*() const {
+  return std::make_pair(items_.top().key_, items_.top().value_);
+}
+
+BaseIterator &MemTableMergeIterator::operator++() {
+  if (items_.empty()) {
+    return *this;
+  }
+
+  auto old_key = items_.top().key_;
+  pop_top_();
+
+  // 同一个 key 更旧的版本不再返回
+  if (!keep_all_versions_) {
+    while (!items_.empty() && items_.top().key_ == old_key) {
+      pop_top_();
+    }
+  }
+
+  skip_illegal_();
+  return *this;
+}
+
+bool MemTableMergeIterator::operator==(const BaseIterator &other) const {
+  if (other.get_type() != IteratorType::MemTableMergeIterator) {
+    return false;
+  }
+  auto &other2 = dynamic_cast<const MemTableMergeIterator &>(other);
+  if (items_.empty() || other2.items_.empty()) {
+    return items_.empty() && other2.items_.empty();
+  }
+  return items_.top().key_ == other2.items_.top().key_ &&
+         items_.top().value_ == other2.items_.top().value_;
+}
+
+bool MemTableMergeIterator::operator!=(const BaseIterator &other) const {
+  return !(*this == other);
+}
+
+IteratorType MemTableMergeIterator::get_type() const {
+  return IteratorType::MemTableMergeIterator;
+}
+
+uint64_t MemTableMergeIterator::get_tranc_id() const {
+  if (keep_all_versions_ && !items_.empty()) {
+    return items_.top().tranc_id_;
+  }
+  return max_tranc_id_;
+}
+
+bool MemTableMergeIterator::is_end() const { return items_.empty(); }
+
+bool MemTableMergeIterator::is_valid() const { return !items_.empty(); }
+} // namespace tiny_lsm
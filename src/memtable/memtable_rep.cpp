@@ -0,0 +1,662 @@
+#include "memtable/memtable_rep.h"
+#include "config/config.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+MemTableRepType memtable_rep_type_from_string(const std::string &name) {
+  if (name == "skiplist") {
+    return MemTableRepType::SkipList;
+  } else if (name == "arena_skiplist") {
+    return MemTableRepType::ArenaSkipList;
+  } else if (name == "sorted_vector") {
+    return MemTableRepType::SortedVector;
+  } else if (name == "hash_linklist") {
+    return MemTableRepType::HashLinkList;
+  } else if (name == "art") {
+    return MemTableRepType::ART;
+  }
+  spdlog::warn("Unknown memtable rep '{}', fallback to skiplist", name);
+  return MemTableRepType::SkipList;
+}
+
+std::string memtable_rep_type_to_string(MemTableRepType type) {
+  switch (type) {
+  case MemTableRepType::SkipList:
+    return "skiplist";
+  case MemTableRepType::ArenaSkipList:
+    return "arena_skiplist";
+  case MemTableRepType::SortedVector:
+    return "sorted_vector";
+  case MemTableRepType::HashLinkList:
+    return "hash_linklist";
+  case MemTableRepType::ART:
+    return "art";
+  }
+  return "skiplist";
+}
+
+MemTableRepType default_memtable_rep_type() {
+  return memtable_rep_type_from_string(
+      TomlConfig::getInstance().getLsmMemtableRep());
+}
+
+std::shared_ptr<MemTableRep> new_memtable_rep(MemTableRepType type) {
+  switch (type) {
+  case MemTableRepType::SkipList:
+    return std::make_shared<SkipListRep>();
+  case MemTableRepType::ArenaSkipList:
+    return std::make_shared<ArenaSkipListRep>();
+  case MemTableRepType::SortedVector:
+    return std::make_shared<SortedVectorRep>();
+  case MemTableRepType::HashLinkList:
+    return std::make_shared<HashLinkListRep>();
+  case MemTableRepType::ART:
+    return std::make_shared<ArtRep>();
+  }
+  return std::make_shared<SkipListRep>();
+}
+
+// ************************ MemTableRep ************************
+
+MemTableRep::MemTableRep() {
+  auto &config = TomlConfig::getInstance();
+  double ratio = config.getLsmMemtableBloomSizeRatio();
+  if (ratio > 0) {
+    size_t bits = static_cast<size_t>(
+        static_cast<double>(config.getLsmPerMemSizeLimit()) * 8 * ratio);
+    bloom_ = std::make_unique<DynamicBloom>(bits);
+  }
+}
+
+void MemTableRep::put_batch(
+    const std::vector<std::pair<std::string, std::string>> &kvs,
+    uint64_t tranc_id) {
+  for (auto &[k, v] : kvs) {
+    put(k, v, tranc_id);
+  }
+}
+
+std::vector<std::tuple<std::string, std::string, uint64_t>>
+MemTableRep::flush() {
+  std::vector<std::tuple<std::string, std::string, uint64_t>> data;
+  flush_to([&data](const std::string &key, const std::string &value,
+                   uint64_t tranc_id) {
+    data.emplace_back(key, value, tranc_id);
+  });
+  return data;
+}
+
+bool MemTableRep::may_contain(const std::string &key) const {
+  return !bloom_ || bloom_->may_contain(key);
+}
+
+void MemTableRep::bloom_add_(const std::string &key) {
+  if (bloom_) {
+    bloom_->add(key);
+  }
+}
+
+size_t MemTableRep::bloom_memory_usage_() const {
+  return bloom_ ? bloom_->memory_usage() : 0;
+}
+
+// ************************ MemTableIterator ************************
+
+BaseIterator &MemTableIterator::operator++() {
+  if (impl_) {
+    ++(*impl_);
+  }
+  return *this;
+}
+
+bool MemTableIterator::operator==(const BaseIterator &other) const {
+  if (other.get_type() != IteratorType::MemTableIterator) {
+    return false;
+  }
+  auto &other2 = dynamic_cast<const MemTableIterator &>(other);
+  if (is_end() || other2.is_end()) {
+    return is_end() && other2.is_end();
+  }
+  return *impl_ == *other2.impl_;
+}
+
+bool MemTableIterator::operator!=(const BaseIterator &other) const {
+  return !(*this == other);
+}
+
+MemTableIterator::value_type MemTableIterator::operator*() const {
+  if (!impl_) {
+    throw std::runtime_error("Dereferencing invalid iterator");
+  }
+  return **impl_;
+}
+
+IteratorType MemTableIterator::get_type() const {
+  return IteratorType::MemTableIterator;
+}
+
+bool MemTableIterator::is_end() const { return !impl_ || impl_->is_end(); }
+
+bool MemTableIterator::is_valid() const { return impl_ && impl_->is_valid(); }
+
+std::string MemTableIterator::get_key() const { return impl_->get_key(); }
+
+std::string MemTableIterator::get_value() const { return impl_->get_value(); }
+
+MemTableIterator MemTableIterator::clone() const {
+  return impl_ ? MemTableIterator(impl_->clone()) : MemTableIterator{};
+}
+
+uint64_t MemTableIterator::get_tranc_id() const {
+  return impl_->get_tranc_id();
+}
+
+// ************************ 内存估算 ************************
+
+// 一次堆分配在请求大小之外的额外开销 (glibc malloc 的块头)
+static constexpr size_t kMallocOverhead = 16;
+
+static size_t string_heap_bytes(const std::string &s) {
+  // 短字符串存储在对象内部 (SSO), 不占用额外的堆内存
+  auto begin = reinterpret_cast<const char *>(&s);
+  if (s.data() >= begin && s.data() < begin + sizeof(std::string)) {
+    return 0;
+  }
+  return s.capacity() + 1 + kMallocOverhead;
+}
+
+// ************************ 跳表适配器 ************************
+
+// 将 SkipListIterator / ArenaSkipListIterator 适配为 MemTableRepIterator
+template <typename Iter> class RepIteratorAdapter : public MemTableRepIterator {
+public:
+  explicit RepIteratorAdapter(Iter it) : it_(std::move(it)) {}
+
+  BaseIterator &operator++() override {
+    ++it_;
+    return *this;
+  }
+  bool operator==(const BaseIterator &other) const override {
+    auto other2 = dynamic_cast<const RepIteratorAdapter<Iter> *>(&other);
+    return other2 && it_ == other2->it_;
+  }
+  bool operator!=(const BaseIterator &other) const override {
+    return !(*this == other);
+  }
+  value_type operator*() const override { return *it_; }
+  IteratorType get_type() const override { return it_.get_type(); }
+  bool is_end() const override { return it_.is_end(); }
+  bool is_valid() const override { return it_.is_valid(); }
+  std::string get_key() const override { return it_.get_key(); }
+  std::string get_value() const override { return it_.get_value(); }
+  uint64_t get_tranc_id() const override { return it_.get_tranc_id(); }
+  std::shared_ptr<MemTableRepIterator> clone() const override {
+    return std::make_shared<RepIteratorAdapter<Iter>>(*this);
+  }
+
+private:
+  Iter it_;
+};
+
+template <typename Iter> static MemTableIterator wrap_iter(Iter it) {
+  return MemTableIterator(
+      std::make_shared<RepIteratorAdapter<Iter>>(std::move(it)));
+}
+
+template <typename Iter>
+static std::optional<std::pair<MemTableIterator, MemTableIterator>>
+wrap_iters(std::optional<std::pair<Iter, Iter>> res) {
+  if (!res.has_value()) {
+    return std::nullopt;
+  }
+  return std::make_pair(wrap_iter(std::move(res->first)),
+                        wrap_iter(std::move(res->second)));
+}
+
+void SkipListRep::put(const std::string &key, const std::string &value,
+                      uint64_t tranc_id) {
+  bloom_add_(key);
+  table_.put(key, value, tranc_id);
+  entry_count_++;
+}
+
+void SkipListRep::put_batch(
+    const std::vector<std::pair<std::string, std::string>> &kvs,
+    uint64_t tranc_id) {
+  // 无序的 key 会使提示失效并退化为普通查找, 因此无需预先检查是否有序
+  SkipList::InsertHint hint;
+  for (auto &[k, v] : kvs) {
+    bloom_add_(k);
+    table_.put_hint(k, v, tranc_id, hint);
+    entry_count_++;
+  }
+}
+
+bool SkipListRep::overwrite(const std::string &key, const std::string &value,
+                            uint64_t tranc_id) {
+  // 事务提交标记不能被覆盖, flush_last 依赖它记录已刷盘的事务
+  if (key.empty()) {
+    return false;
+  }
+  return table_.overwrite(key, value, tranc_id);
+}
+
+MemTableIterator SkipListRep::get(const std::string &key, uint64_t tranc_id) {
+  if (!may_contain(key)) {
+    return MemTableIterator{};
+  }
+  return wrap_iter(table_.get(key, tranc_id));
+}
+
+void SkipListRep::flush_to(const FlushVisitor &visit) {
+  table_.flush_to(visit);
+}
+
+size_t SkipListRep::get_size() { return table_.get_size(); }
+
+size_t SkipListRep::memory_usage() {
+  // SkipList 不记录节点数量, 按写入次数估算 (覆盖写入会使估算偏大):
+  // 节点本身 + make_shared 控制块 + 平均 2 层的 forward_/backward_ 指针
+  // + 节点和两个指针数组共 3 次堆分配, key 和 value 按两次堆分配计算
+  constexpr size_t kAvgLevel = 2;
+  constexpr size_t kNodeOverhead =
+      sizeof(SkipListNode) + 16 +
+      kAvgLevel * (sizeof(std::shared_ptr<SkipListNode>) +
+                   sizeof(std::weak_ptr<SkipListNode>)) +
+      5 * kMallocOverhead;
+  return table_.get_size() + entry_count_ * kNodeOverhead +
+         bloom_memory_usage_();
+}
+
+MemTableIterator SkipListRep::begin() { return wrap_iter(table_.begin()); }
+
+MemTableIterator SkipListRep::end() { return wrap_iter(table_.end()); }
+
+MemTableIterator SkipListRep::begin_preffix(const std::string &preffix) {
+  return wrap_iter(table_.begin_preffix(preffix));
+}
+
+MemTableIterator SkipListRep::end_preffix(const std::string &preffix) {
+  return wrap_iter(table_.end_preffix(preffix));
+}
+
+std::optional<std::pair<MemTableIterator, MemTableIterator>>
+SkipListRep::iters_monotony_predicate(
+    std::function<int(const std::string &)> predicate) {
+  return wrap_iters(table_.iters_monotony_predicate(predicate));
+}
+
+void ArenaSkipListRep::put(const std::string &key, const std::string &value,
+                           uint64_t tranc_id) {
+  bloom_add_(key);
+  table_.put(key, value, tranc_id);
+}
+
+MemTableIterator ArenaSkipListRep::get(const std::string &key,
+                                       uint64_t tranc_id) {
+  if (!may_contain(key)) {
+    return MemTableIterator{};
+  }
+  return wrap_iter(table_.get(key, tranc_id));
+}
+
+void ArenaSkipListRep::flush_to(const FlushVisitor &visit) {
+  table_.flush_to(visit);
+}
+
+size_t ArenaSkipListRep::get_size() { return table_.get_size(); }
+
+size_t ArenaSkipListRep::memory_usage() {
+  return table_.memory_usage() + bloom_memory_usage_();
+}
+
+MemTableIterator ArenaSkipListRep::begin() { return wrap_iter(table_.begin()); }
+
+MemTableIterator ArenaSkipListRep::end() { return wrap_iter(table_.end()); }
+
+MemTableIterator ArenaSkipListRep::begin_preffix(const std::string &preffix) {
+  return wrap_iter(table_.begin_preffix(preffix));
+}
+
+MemTableIterator ArenaSkipListRep::end_preffix(const std::string &preffix) {
+  return wrap_iter(table_.end_preffix(preffix));
+}
+
+std::optional<std::pair<MemTableIterator, MemTableIterator>>
+ArenaSkipListRep::iters_monotony_predicate(
+    std::function<int(const std::string &)> predicate) {
+  return wrap_iters(table_.iters_monotony_predicate(predicate));
+}
+
+// ************************ SortedViewRep ************************
+
+// key 升序, tranc_id 降序, seq 降序
+static bool entry_less(const MemTableRepEntry *a, const MemTableRepEntry *b) {
+  int cmp = a->key_.compare(b->key_);
+  if (cmp != 0) {
+    return cmp < 0;
+  }
+  if (a->tranc_id_ != b->tranc_id_) {
+    return a->tranc_id_ > b->tranc_id_;
+  }
+  return a->seq_ > b->seq_;
+}
+
+// 在有序视图上迭代, 持有视图本身, 因此不受后续写入和视图重建的影响
+class SortedViewIterator : public MemTableRepIterator {
+public:
+  SortedViewIterator(std::shared_ptr<const SortedView> view, size_t idx)
+      : view_(std::move(view)), idx_(idx) {}
+
+  BaseIterator &operator++() override {
+    if (idx_ < view_->entries.size()) {
+      idx_++;
+    }
+    return *this;
+  }
+  bool operator==(const BaseIterator &other) const override {
+    auto other2 = dynamic_cast<const SortedViewIterator *>(&other);
+    if (!other2) {
+      return false;
+    }
+    if (is_end() || other2->is_end()) {
+      return is_end() && other2->is_end();
+    }
+    return entry() == other2->entry();
+  }
+  bool operator!=(const BaseIterator &other) const override {
+    return !(*this == other);
+  }
+  value_type operator*() const override {
+    if (is_end()) {
+      throw std::runtime_error("Dereferencing invalid iterator");
+    }
+    return {entry()->key_, entry()->value_};
+  }
+  IteratorType get_type() const override {
+    return IteratorType::MemTableIterator;
+  }
+  bool is_end() const override { return idx_ >= view_->entries.size(); }
+  bool is_valid() const override {
+    return !is_end() && !entry()->key_.empty();
+  }
+  std::string get_key() const override { return entry()->key_; }
+  std::string get_value() const override { return entry()->value_; }
+  uint64_t get_tranc_id() const override { return entry()->tranc_id_; }
+  std::shared_ptr<MemTableRepIterator> clone() const override {
+    return std::make_shared<SortedViewIterator>(*this);
+  }
+
+private:
+  const MemTableRepEntry *entry() const { return view_->entries[idx_]; }
+
+  std::shared_ptr<const SortedView> view_;
+  size_t idx_;
+};
+
+// 点查结果: 只包含一条记录, 自增后即到达末尾
+class SingleEntryIterator : public MemTableRepIterator {
+public:
+  SingleEntryIterator(std::shared_ptr<const std::deque<MemTableRepEntry>> pin,
+                      const MemTableRepEntry *entry)
+      : pin_(std::move(pin)), entry_(entry) {}
+
+  BaseIterator &operator++() override {
+    entry_ = nullptr;
+    return *this;
+  }
+  bool operator==(const BaseIterator &other) const override {
+    auto other2 = dynamic_cast<const SingleEntryIterator *>(&other);
+    return other2 && entry_ == other2->entry_;
+  }
+  bool operator!=(const BaseIterator &other) const override {
+    return !(*this == other);
+  }
+  value_type operator*() const override {
+    if (!entry_) {
+      throw std::runtime_error("Dereferencing invalid iterator");
+    }
+    return {entry_->key_, entry_->value_};
+  }
+  IteratorType get_type() const override {
+    return IteratorType::MemTableIterator;
+  }
+  bool is_end() const override { return entry_ == nullptr; }
+  bool is_valid() const override { return entry_ && !entry_->key_.empty(); }
+  std::string get_key() const override { return entry_->key_; }
+  std::string get_value() const override { return entry_->value_; }
+  uint64_t get_tranc_id() const override { return entry_->tranc_id_; }
+  std::shared_ptr<MemTableRepIterator> clone() const override {
+    return std::make_shared<SingleEntryIterator>(*this);
+  }
+
+private:
+  std::shared_ptr<const std::deque<MemTableRepEntry>> pin_;
+  const MemTableRepEntry *entry_;
+};
+
+SortedViewRep::SortedViewRep()
+    : storage_(std::make_shared<std::deque<MemTableRepEntry>>()),
+      view_(std::make_shared<SortedView>()) {}
+
+MemTableRepEntry *SortedViewRep::append_(const std::string &key,
+                                         const std::string &value,
+                                         uint64_t tranc_id) {
+  bloom_add_(key);
+  storage_->push_back(MemTableRepEntry{key, value, tranc_id, next_seq_++});
+  auto &entry = storage_->back();
+  size_bytes_ += key.size() + value.size() + sizeof(uint64_t);
+  entry_bytes_ += sizeof(MemTableRepEntry) + string_heap_bytes(entry.key_) +
+                  string_heap_bytes(entry.value_);
+  return &entry;
+}
+
+MemTableIterator
+SortedViewRep::make_entry_iter_(const MemTableRepEntry *entry) const {
+  if (!entry) {
+    return MemTableIterator{};
+  }
+  return MemTableIterator(
+      std::make_shared<SingleEntryIterator>(storage_, entry));
+}
+
+std::shared_ptr<const SortedView> SortedViewRep::build_view_() {
+  // 只对上次构建之后新增的记录排序, 再与旧视图归并
+  std::vector<const MemTableRepEntry *> fresh;
+  fresh.reserve(storage_->size() - viewed_count_);
+  for (size_t i = viewed_count_; i < storage_->size(); i++) {
+    fresh.push_back(&(*storage_)[i]);
+  }
+  std::sort(fresh.begin(), fresh.end(), entry_less);
+
+  auto view = std::make_shared<SortedView>();
+  view->storage = storage_;
+  view->entries.reserve(view_->entries.size() + fresh.size());
+  std::merge(view_->entries.begin(), view_->entries.end(), fresh.begin(),
+             fresh.end(), std::back_inserter(view->entries), entry_less);
+
+  // 相同 (key, tranc_id) 只保留 seq 最大的记录, 它在排序后位于最前
+  auto last = std::unique(view->entries.begin(), view->entries.end(),
+                          [](const MemTableRepEntry *a,
+                             const MemTableRepEntry *b) {
+                            return a->tranc_id_ == b->tranc_id_ &&
+                                   a->key_ == b->key_;
+                          });
+  view->entries.erase(last, view->entries.end());
+  return view;
+}
+
+std::shared_ptr<const SortedView> SortedViewRep::sorted_view() {
+  std::lock_guard<std::mutex> lock(view_mtx_);
+  if (viewed_count_ != storage_->size()) {
+    view_ = build_view_();
+    viewed_count_ = storage_->size();
+  }
+  return view_;
+}
+
+MemTableIterator SortedViewRep::get(const std::string &key,
+                                    uint64_t tranc_id) {
+  if (!may_contain(key)) {
+    return MemTableIterator{};
+  }
+  uint64_t visible_id = tranc_id == 0 ? UINT64_MAX : tranc_id;
+  std::shared_ptr<const SortedView> view;
+  const MemTableRepEntry *tail_best = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(view_mtx_);
+    if (storage_->size() - viewed_count_ > kMaxUnsortedTail) {
+      view_ = build_view_();
+      viewed_count_ = storage_->size();
+    }
+    // 尚未归并的记录越靠后越新, tranc_id 相同时保留最后一条
+    for (size_t i = viewed_count_; i < storage_->size(); i++) {
+      auto &e = (*storage_)[i];
+      if (e.key_ == key && e.tranc_id_ <= visible_id &&
+          (!tail_best || e.tranc_id_ >= tail_best->tranc_id_)) {
+        tail_best = &e;
+      }
+    }
+    view = view_;
+  }
+
+  // 第一个 key 相同且 tranc_id <= visible_id 的记录
+  auto it = std::lower_bound(
+      view->entries.begin(), view->entries.end(), key,
+      [&](const MemTableRepEntry *e, const std::string &k) {
+        int cmp = e->key_.compare(k);
+        return cmp < 0 || (cmp == 0 && e->tranc_id_ > visible_id);
+      });
+  if (it == view->entries.end() || (*it)->key_ != key ||
+      (tail_best && tail_best->tranc_id_ >= (*it)->tranc_id_)) {
+    // 未归并的记录比视图中相同 tranc_id 的记录更新
+    return make_entry_iter_(tail_best);
+  }
+  return MemTableIterator(std::make_shared<SortedViewIterator>(
+      view, it - view->entries.begin()));
+}
+
+void SortedViewRep::flush_to(const FlushVisitor &visit) {
+  auto view = sorted_view();
+  for (auto e : view->entries) {
+    visit(e->key_, e->value_, e->tranc_id_);
+  }
+}
+
+size_t SortedViewRep::get_size() { return size_bytes_; }
+
+size_t SortedViewRep::memory_usage() {
+  std::lock_guard<std::mutex> lock(view_mtx_);
+  return entry_bytes_ +
+         view_->entries.capacity() * sizeof(const MemTableRepEntry *) +
+         bloom_memory_usage_();
+}
+
+MemTableIterator SortedViewRep::begin() {
+  return MemTableIterator(
+      std::make_shared<SortedViewIterator>(sorted_view(), 0));
+}
+
+MemTableIterator SortedViewRep::end() { return MemTableIterator{}; }
+
+MemTableIterator SortedViewRep::begin_preffix(const std::string &preffix) {
+  auto view = sorted_view();
+  auto it = std::lower_bound(
+      view->entries.begin(), view->entries.end(), preffix,
+      [](const MemTableRepEntry *e, const std::string &p) {
+        return e->key_ < p;
+      });
+  return MemTableIterator(std::make_shared<SortedViewIterator>(
+      view, it - view->entries.begin()));
+}
+
+MemTableIterator SortedViewRep::end_preffix(const std::string &preffix) {
+  auto view = sorted_view();
+  auto it = std::partition_point(
+      view->entries.begin(), view->entries.end(),
+      [&](const MemTableRepEntry *e) {
+        return e->key_ < preffix || e->key_.starts_with(preffix);
+      });
+  return MemTableIterator(std::make_shared<SortedViewIterator>(
+      view, it - view->entries.begin()));
+}
+
+std::optional<std::pair<MemTableIterator, MemTableIterator>>
+SortedViewRep::iters_monotony_predicate(
+    std::function<int(const std::string &)> predicate) {
+  auto view = sorted_view();
+  auto first = std::partition_point(
+      view->entries.begin(), view->entries.end(),
+      [&](const MemTableRepEntry *e) { return predicate(e->key_) > 0; });
+  if (first == view->entries.end() || predicate((*first)->key_) != 0) {
+    return std::nullopt;
+  }
+  auto last = std::partition_point(
+      first, view->entries.end(),
+      [&](const MemTableRepEntry *e) { return predicate(e->key_) == 0; });
+  return std::make_pair(
+      MemTableIterator(std::make_shared<SortedViewIterator>(
+          view, first - view->entries.begin())),
+      MemTableIterator(std::make_shared<SortedViewIterator>(
+          view, last - view->entries.begin())));
+}
+
+void SortedViewRep::freeze() {
+  // 冻结后不再有写入, 提前构建好视图, 之后的读取不再需要排序
+  sorted_view();
+}
+
+// ************************ SortedVectorRep ************************
+
+void SortedVectorRep::put(const std::string &key, const std::string &value,
+                          uint64_t tranc_id) {
+  append_(key, value, tranc_id);
+}
+
+// ************************ HashLinkListRep ************************
+
+HashLinkListRep::HashLinkListRep()
+    : HashLinkListRep(static_cast<size_t>(std::max<long long>(
+          TomlConfig::getInstance().getLsmMemtableHashBucketCount(), 1))) {}
+
+HashLinkListRep::HashLinkListRep(size_t bucket_count)
+    : buckets_(bucket_count == 0 ? 1 : bucket_count, nullptr) {}
+
+void HashLinkListRep::put(const std::string &key, const std::string &value,
+                          uint64_t tranc_id) {
+  auto entry = append_(key, value, tranc_id);
+  auto &bucket = buckets_[std::hash<std::string>{}(key) % buckets_.size()];
+  entry->next_ = bucket;
+  bucket = entry;
+}
+
+size_t HashLinkListRep::memory_usage() {
+  return SortedViewRep::memory_usage() +
+         buckets_.capacity() * sizeof(MemTableRepEntry *);
+}
+
+MemTableIterator HashLinkListRep::get(const std::string &key,
+                                      uint64_t tranc_id) {
+  if (!may_contain(key)) {
+    return MemTableIterator{};
+  }
+  uint64_t visible_id = tranc_id == 0 ? UINT64_MAX : tranc_id;
+  const MemTableRepEntry *best = nullptr;
+  // 链表中越靠前越新, tranc_id 相同时保留先遇到的记录
+  for (auto e = buckets_[std::hash<std::string>{}(key) % buckets_.size()];
+       e != nullptr; e = e->next_) {
+    if (e->key_ != key || e->tranc_id_ > visible_id) {
+      continue;
+    }
+    if (!best || e->tranc_id_ > best->tranc_id_) {
+      best = e;
+    }
+  }
+  return make_entry_iter_(best);
+}
+} // namespace tiny_lsm
@@ -225,10 +225,7 @@ bool RedisWrapper::expire_zset_clean(
     lsm->remove(key);
     lsm->remove(expire_key);
     auto preffix = get_zset_key_preffix(key);
-    auto result_elem = this->lsm->lsm_iters_monotony_predicate(
-        0, [&preffix](const std::string &elem) {
-          return -elem.compare(0, preffix.size(), preffix);
-        });
+    auto result_elem = this->lsm->prefix_iter(preffix);
     if (result_elem.has_value()) {
       auto [elem_begin, elem_end] = result_elem.value();
       std::vector<std::string> remove_vec;
@@ -254,10 +251,7 @@ bool RedisWrapper::expire_set_clean(
     lsm->remove(key);
     lsm->remove(expire_key);
     auto preffix = get_set_key_preffix(key);
-    auto result_elem = this->lsm->lsm_iters_monotony_predicate(
-        0, [&preffix](const std::string &elem) {
-          return -elem.compare(0, preffix.size(), preffix);
-        });
+    auto result_elem = this->lsm->prefix_iter(preffix);
     if (result_elem.has_value()) {
       auto [elem_begin, elem_end] = result_elem.value();
       std::vector<std::string> remove_vec;
@@ -1003,10 +997,7 @@ std::string RedisWrapper::redis_zrange(std::vector<std::string> &args) {
 
   // 范围查询: 按照 score 查询就能满足 zrange 的顺序
   std::string preffix_score = get_zset_score_preffix(key);
-  auto result_elem = this->lsm->lsm_iters_monotony_predicate(
-      0, [&preffix_score](const std::string &elem) {
-        return -elem.compare(0, preffix_score.size(), preffix_score);
-      });
+  auto result_elem = this->lsm->prefix_iter(preffix_score);
 
   if (!result_elem.has_value()) {
     return "*0\r\n";
@@ -1051,10 +1042,7 @@ std::string RedisWrapper::redis_zcard(const std::string &key) {
 
   // key_score 和 key_elem 是一对, 所以只需要一个即可
   std::string preffix = get_zset_score_preffix(key);
-  auto result_elem = this->lsm->lsm_iters_monotony_predicate(
-      0, [&preffix](const std::string &elem) {
-        return -elem.compare(0, preffix.size(), preffix);
-      });
+  auto result_elem = this->lsm->prefix_iter(preffix);
 
   if (!result_elem.has_value()) {
     return ":0\r\n";
@@ -1146,10 +1134,7 @@ std::string RedisWrapper::redis_zrank(const std::string &key,
 
   // 获取有序集合的前缀
   std::string preffix_score = get_zset_key_preffix(key);
-  auto result_elem = this->lsm->lsm_iters_monotony_predicate(
-      0, [&preffix_score](const std::string &elem) {
-        return -elem.compare(0, preffix_score.size(), preffix_score);
-      });
+  auto result_elem = this->lsm->prefix_iter(preffix_score);
 
   if (!result_elem.has_value()) {
     return "$-1\r\n";
@@ -1283,10 +1268,7 @@ std::string RedisWrapper::redis_smembers(const std::string &key) {
   }
 
   std::string prefix = get_set_member_prefix(key);
-  auto result_elem = this->lsm->lsm_iters_monotony_predicate(
-      0, [&prefix](const std::string &elem) {
-        return -elem.compare(0, prefix.size(), prefix);
-      });
+  auto result_elem = this->lsm->prefix_iter(prefix);
 
   if (!result_elem.has_value()) {
     return "*0\r\n"; // 空数组
@@ -0,0 +1,55 @@
+#include "skiplist/arena.h"
+#include <mutex>
+
+namespace tiny_lsm {
+
+static size_t align_up(size_t bytes, size_t align) {
+  return (bytes + align - 1) & ~(align - 1);
+}
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size), current_(nullptr), memory_usage_(0) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  current_.store(new_block_(block_size_), std::memory_order_release);
+}
+
+Arena::~Arena() = default;
+
+char *Arena::allocate(size_t bytes) {
+  bytes = align_up(bytes == 0 ? 1 : bytes, kAlignment);
+
+  if (bytes > block_size_ / 4) {
+    // 大对象单独分配一个块, 不替换当前块, 避免浪费当前块的剩余空间
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto blk = new_block_(bytes);
+    blk->used.store(bytes, std::memory_order_relaxed);
+    return blk->data.get();
+  }
+
+  while (true) {
+    ArenaBlock *blk = current_.load(std::memory_order_acquire);
+    size_t offset = blk->used.fetch_add(bytes, std::memory_order_relaxed);
+    if (offset + bytes <= blk->size) {
+      return blk->data.get() + offset;
+    }
+
+    // 当前块已耗尽, 只让一个线程完成换块, 其余线程重试
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (current_.load(std::memory_order_relaxed) == blk) {
+      current_.store(new_block_(block_size_), std::memory_order_release);
+    }
+  }
+}
+
+size_t Arena::memory_usage() const {
+  return memory_usage_.load(std::memory_order_relaxed);
+}
+
+Arena::ArenaBlock *Arena::new_block_(size_t size) {
+  blocks_.push_back(std::make_unique<ArenaBlock>(size));
+  memory_usage_.fetch_add(size + sizeof(ArenaBlock) +
+                              sizeof(std::unique_ptr<ArenaBlock>),
+                          std::memory_order_relaxed);
+  return blocks_.back().get();
+}
+} // namespace tiny_lsm
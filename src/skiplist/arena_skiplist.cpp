@@ -0,0 +1,267 @@
+#include "skiplist/arena_skiplist.h"
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+// ************************ ArenaSkipListIterator ************************
+BaseIterator &ArenaSkipListIterator::operator++() {
+  if (!current) {
+    return *this;
+  }
+  // 跳过被遮蔽的旧版本 (key 和 tranc_id 都相同, seq 更小)
+  auto prev = current;
+  current = current->next(0);
+  while (current && current->tranc_id_ == prev->tranc_id_ &&
+         current->key() == prev->key()) {
+    current = current->next(0);
+  }
+  return *this;
+}
+
+bool ArenaSkipListIterator::operator==(const BaseIterator &other) const {
+  if (other.get_type() != IteratorType::ArenaSkipListIterator) {
+    return false;
+  }
+  auto other2 = dynamic_cast<const ArenaSkipListIterator &>(other);
+  return current == other2.current;
+}
+
+bool ArenaSkipListIterator::operator!=(const BaseIterator &other) const {
+  return !(*this == other);
+}
+
+ArenaSkipListIterator::value_type ArenaSkipListIterator::operator*() const {
+  if (!current) {
+    throw std::runtime_error("Dereferencing invalid iterator");
+  }
+  return {std::string(current->key()), std::string(current->value())};
+}
+
+IteratorType ArenaSkipListIterator::get_type() const {
+  return IteratorType::ArenaSkipListIterator;
+}
+
+bool ArenaSkipListIterator::is_valid() const {
+  return current && current->key_len_ > 0;
+}
+bool ArenaSkipListIterator::is_end() const { return current == nullptr; }
+
+std::string ArenaSkipListIterator::get_key() const {
+  return std::string(current->key());
+}
+std::string ArenaSkipListIterator::get_value() const {
+  return std::string(current->value());
+}
+uint64_t ArenaSkipListIterator::get_tranc_id() const {
+  return current->tranc_id_;
+}
+
+// ************************ ArenaSkipList ************************
+ArenaSkipList::ArenaSkipList(int max_lvl, size_t arena_block_size)
+    : arena_(std::make_shared<Arena>(arena_block_size)), max_level(max_lvl),
+      current_level(1), size_bytes(0), next_seq(1) {
+  head = new_node("", "", 0, 0, max_level);
+}
+
+int ArenaSkipList::random_level() const {
+  // 每个写线程独立的随机数生成器, 避免并发 put 时竞争
+  thread_local std::mt19937 gen(std::random_device{}());
+  thread_local std::uniform_int_distribution<> dis_01(0, 1);
+  int level = 1;
+  while (level < max_level && dis_01(gen)) {
+    level++;
+  }
+  return level;
+}
+
+ArenaSkipListNode *ArenaSkipList::new_node(const std::string &key,
+                                           const std::string &value,
+                                           uint64_t tranc_id, uint64_t seq,
+                                           int height) {
+  char *mem = arena_->allocate(
+      ArenaSkipListNode::alloc_size(height, key.size(), value.size()));
+  auto node = reinterpret_cast<ArenaSkipListNode *>(mem);
+  node->tranc_id_ = tranc_id;
+  node->seq_ = seq;
+  node->key_len_ = static_cast<uint32_t>(key.size());
+  node->value_len_ = static_cast<uint32_t>(value.size());
+  node->height_ = height;
+  for (int i = 0; i < height; i++) {
+    new (&node->next_[i]) std::atomic<ArenaSkipListNode *>(nullptr);
+  }
+  char *payload = reinterpret_cast<char *>(&node->next_[height]);
+  memcpy(payload, key.data(), key.size());
+  memcpy(payload + key.size(), value.data(), value.size());
+  return node;
+}
+
+bool ArenaSkipList::node_less(const ArenaSkipListNode *node,
+                              std::string_view key, uint64_t tranc_id,
+                              uint64_t seq) {
+  int cmp = node->key().compare(key);
+  if (cmp != 0) {
+    return cmp < 0;
+  }
+  if (node->tranc_id_ != tranc_id) {
+    // key 相等时，tranc_id 更大的排在前面
+    return node->tranc_id_ > tranc_id;
+  }
+  return node->seq_ > seq;
+}
+
+void ArenaSkipList::find_splice_for_level(const ArenaSkipListNode *node,
+                                          int level, ArenaSkipListNode *start,
+                                          ArenaSkipListNode **out_prev,
+                                          ArenaSkipListNode **out_next) const {
+  auto prev = start;
+  auto next = prev->next(level);
+  while (next &&
+         node_less(next, node->key(), node->tranc_id_, node->seq_)) {
+    prev = next;
+    next = prev->next(level);
+  }
+  *out_prev = prev;
+  *out_next = next;
+}
+
+void ArenaSkipList::put(const std::string &key, const std::string &value,
+                        uint64_t tranc_id) {
+  spdlog::trace("ArenaSkipList--put({}, {}, {})", key, value, tranc_id);
+
+  int height = random_level();
+  uint64_t seq = next_seq.fetch_add(1, std::memory_order_relaxed);
+  auto node = new_node(key, value, tranc_id, seq, height);
+
+  // 提升当前层数
+  int cur_level = current_level.load(std::memory_order_relaxed);
+  while (height > cur_level &&
+         !current_level.compare_exchange_weak(cur_level, height,
+                                              std::memory_order_relaxed)) {
+  }
+
+  // 自顶向下计算每一层的前驱和后继
+  std::vector<ArenaSkipListNode *> prev(max_level), next(max_level);
+  auto start = head;
+  for (int i = max_level - 1; i >= 0; i--) {
+    find_splice_for_level(node, i, start, &prev[i], &next[i]);
+    start = prev[i];
+  }
+
+  // 自底向上通过 CAS 链接各层, 失败说明有并发插入, 从前驱处重新定位
+  for (int i = 0; i < height; i++) {
+    while (true) {
+      node->next_[i].store(next[i], std::memory_order_relaxed);
+      if (prev[i]->cas_next(i, next[i], node)) {
+        break;
+      }
+      find_splice_for_level(node, i, prev[i], &prev[i], &next[i]);
+    }
+  }
+
+  size_bytes.fetch_add(key.size() + value.size() + sizeof(uint64_t),
+                       std::memory_order_relaxed);
+}
+
+ArenaSkipListNode *ArenaSkipList::find_first(
+    const std::function<bool(const ArenaSkipListNode *)> &before) const {
+  auto cur = head;
+  for (int i = current_level.load(std::memory_order_relaxed) - 1; i >= 0;
+       i--) {
+    auto next = cur->next(i);
+    while (next && before(next)) {
+      cur = next;
+      next = cur->next(i);
+    }
+  }
+  return cur->next(0);
+}
+
+ArenaSkipListIterator ArenaSkipList::get(const std::string &key,
+                                         uint64_t tranc_id) const {
+  spdlog::trace("ArenaSkipList--get({}) called", key);
+
+  // tranc_id 为 0 时定位到 key 的最新版本, 否则定位到第一个可见的版本
+  uint64_t visible_id = tranc_id == 0 ? UINT64_MAX : tranc_id;
+  auto node = find_first([&](const ArenaSkipListNode *n) {
+    return node_less(n, key, visible_id, UINT64_MAX);
+  });
+  if (node && node->key() == key) {
+    return ArenaSkipListIterator(node, arena_);
+  }
+  return ArenaSkipListIterator{};
+}
+
+std::vector<std::tuple<std::string, std::string, uint64_t>>
+ArenaSkipList::flush() const {
+  spdlog::debug("ArenaSkipList--flush(): Starting to flush skiplist data");
+
+  std::vector<std::tuple<std::string, std::string, uint64_t>> data;
+  flush_to([&data](const std::string &key, const std::string &value,
+                   uint64_t tranc_id) {
+    data.emplace_back(key, value, tranc_id);
+  });
+
+  spdlog::debug("ArenaSkipList--flush(): Flushed {} entries", data.size());
+
+  return data;
+}
+
+void ArenaSkipList::flush_to(
+    const std::function<void(const std::string &, const std::string &,
+                             uint64_t)> &visit) const {
+  for (auto it = begin(); !it.is_end(); ++it) {
+    visit(it.get_key(), it.get_value(), it.get_tranc_id());
+  }
+}
+
+size_t ArenaSkipList::get_size() const {
+  return size_bytes.load(std::memory_order_relaxed);
+}
+
+size_t ArenaSkipList::memory_usage() const { return arena_->memory_usage(); }
+
+ArenaSkipListIterator ArenaSkipList::begin() const {
+  return ArenaSkipListIterator(head->next(0), arena_);
+}
+
+ArenaSkipListIterator ArenaSkipList::end() const {
+  return ArenaSkipListIterator();
+}
+
+ArenaSkipListIterator
+ArenaSkipList::begin_preffix(const std::string &preffix) const {
+  auto node = find_first(
+      [&](const ArenaSkipListNode *n) { return n->key() < preffix; });
+  return ArenaSkipListIterator(node, arena_);
+}
+
+ArenaSkipListIterator
+ArenaSkipList::end_preffix(const std::string &preffix) const {
+  auto node = find_first([&](const ArenaSkipListNode *n) {
+    return n->key() < preffix || n->key().starts_with(preffix);
+  });
+  return ArenaSkipListIterator(node, arena_);
+}
+
+std::optional<std::pair<ArenaSkipListIterator, ArenaSkipListIterator>>
+ArenaSkipList::iters_monotony_predicate(
+    std::function<int(const std::string &)> predicate) const {
+  // predicate 需要 std::string 参数, 这里只在比较路径上构造临时 key
+  auto first = find_first([&](const ArenaSkipListNode *n) {
+    return predicate(std::string(n->key())) > 0;
+  });
+  if (!first || predicate(std::string(first->key())) != 0) {
+    return std::nullopt;
+  }
+  auto last = find_first([&](const ArenaSkipListNode *n) {
+    return predicate(std::string(n->key())) >= 0;
+  });
+  return std::make_pair(ArenaSkipListIterator(first, arena_),
+                        ArenaSkipListIterator(last, arena_));
+}
+} // namespace tiny_lsm
@@ -65,6 +65,18 @@ int SkipList::random_level() {
   return 0;
 }
 
+int SkipList::hint_level_() {
+  // dis_level 在 [0, 2^max_level) 内均匀分布, 其最低位连续 1 的个数服从
+  // 参数为 1/2 的几何分布, 与"抛硬币"得到的层数分布相同
+  int bits = dis_level(gen);
+  int level = 1;
+  while (level < max_level && (bits & 1)) {
+    ++level;
+    bits >>= 1;
+  }
+  return level;
+}
+
 // 插入或更新键值对
 void SkipList::put(const std::string &key, const std::string &value,
                    uint64_t tranc_id) {
@@ -76,6 +88,111 @@ void SkipList::put(const std::string &key, const std::string &value,
   // ? tranc_id 为事务id, 直接将其传递到 SkipListNode 的构造函数中即可
   // ? 若key存在且tranc_id相同, 仅更新value; 否则插入新节点
   // ? 注意维护 size_bytes
+  // ? 也可以直接调用 put_hint(key, value, tranc_id, hint) 并传入一个空的提示
+}
+
+// (key, tranc_id) 的排序规则与 SkipListNode::operator< 一致
+static bool node_before(const std::shared_ptr<SkipListNode> &node,
+                        const std::string &key, uint64_t tranc_id) {
+  int cmp = node->key_.compare(key);
+  return cmp < 0 || (cmp == 0 && node->tranc_id_ > tranc_id);
+}
+
+void SkipList::put_hint(const std::string &key, const std::string &value,
+                        uint64_t tranc_id, InsertHint &hint) {
+  spdlog::trace("SkipList--put_hint({}, {}, {})", key, value, tranc_id);
+
+  auto &update = hint.prev_;
+  bool usable = hint.owner_ == this && hint.epoch_ == epoch_ &&
+                update.size() == static_cast<size_t>(max_level) &&
+                (update[0] == head || node_before(update[0], key, tranc_id));
+
+  if (!usable) {
+    // 提示不可用 (首次插入、跳表有删除或 key 比上一次小), 从 head 开始查找
+    update.assign(max_level, head);
+    auto x = head;
+    for (int i = current_level - 1; i >= 0; --i) {
+      while (x->forward_[i] && node_before(x->forward_[i], key, tranc_id)) {
+        x = x->forward_[i];
+      }
+      update[i] = x;
+    }
+    hint.owner_ = this;
+    hint.epoch_ = epoch_;
+  } else {
+    // 1. 自底向上找到第一个前驱仍然有效的层 h, h 及以上的层不需要移动
+    //    (低层前驱有效时, 高层前驱一定有效)
+    int h = 0;
+    while (h < current_level) {
+      auto next = update[h]->forward_[h];
+      if (!next || !node_before(next, key, tranc_id)) {
+        break;
+      }
+      ++h;
+    }
+    // 2. 自顶向下, 从本层旧前驱和上一层新前驱中靠后的一个继续向前查找
+    for (int i = h - 1; i >= 0; --i) {
+      auto x = update[i];
+      if (i + 1 < current_level && update[i + 1] != head &&
+          (x == head || *x < *update[i + 1])) {
+        x = update[i + 1];
+      }
+      while (x->forward_[i] && node_before(x->forward_[i], key, tranc_id)) {
+        x = x->forward_[i];
+      }
+      update[i] = x;
+    }
+  }
+
+  // key 和 tranc_id 都相同时仅更新 value
+  auto next = update[0]->forward_[0];
+  if (next && next->key_ == key && next->tranc_id_ == tranc_id) {
+    size_bytes = size_bytes - next->value_.size() + value.size();
+    next->value_ = value;
+    return;
+  }
+
+  int level = hint_level_();
+  if (level > current_level) {
+    for (int i = current_level; i < level; ++i) {
+      update[i] = head;
+    }
+    current_level = level;
+  }
+
+  auto node = std::make_shared<SkipListNode>(key, value, level, tranc_id);
+  for (int i = 0; i < level; ++i) {
+    node->forward_[i] = update[i]->forward_[i];
+    if (node->forward_[i]) {
+      node->forward_[i]->set_backward(i, node);
+    }
+    update[i]->forward_[i] = node;
+    node->set_backward(i, update[i]);
+    // 新节点就是下一个更大的 key 在这些层的前驱
+    update[i] = node;
+  }
+  size_bytes += key.size() + value.size() + sizeof(uint64_t);
+}
+
+bool SkipList::overwrite(const std::string &key, const std::string &value,
+                         uint64_t tranc_id) {
+  spdlog::trace("SkipList--overwrite({}, {}, {})", key, value, tranc_id);
+
+  // 找到第一个 key 不小于目标的节点, 即 key 的最新版本
+  auto x = head;
+  for (int i = current_level - 1; i >= 0; --i) {
+    while (x->forward_[i] && x->forward_[i]->key_ < key) {
+      x = x->forward_[i];
+    }
+  }
+  auto node = x->forward_[0];
+  if (!node || node->key_ != key || node->tranc_id_ >= tranc_id) {
+    return false;
+  }
+  size_bytes = size_bytes - node->value_.size() + value.size();
+  node->value_ = value;
+  node->tranc_id_ = tranc_id;
+  return true;
 }
 
 // 查找键值对
@@ -96,6 +213,7 @@ void SkipList::remove(const std::string &key) {
   // TODO: Lab1.1 任务：实现删除键值对
   // ? 从最高层开始查找目标节点并更新各层指针
   // ? 注意同时维护 backward_ 指针和 size_bytes
+  // ? 删除节点后需要 ++epoch_, 使 put_hint 中记录的前驱失效
 }
 
 // 刷盘时可以直接遍历最底层链表
@@ -104,17 +222,26 @@ std::vector<std::tuple<std::string, std::string, uint64_t>> SkipList::flush() {
   spdlog::debug("SkipList--flush(): Starting to flush skiplist data");
 
   std::vector<std::tuple<std::string, std::string, uint64_t>> data;
-  auto node = head->forward_[0];
-  while (node) {
-    data.emplace_back(node->key_, node->value_, node->tranc_id_);
-    node = node->forward_[0];
-  }
+  flush_to([&data](const std::string &key, const std::string &value,
+                   uint64_t tranc_id) {
+    data.emplace_back(key, value, tranc_id);
+  });
 
   spdlog::debug("SkipList--flush(): Flushed {} entries", data.size());
 
   return data;
 }
 
+void SkipList::flush_to(
+    const std::function<void(const std::string &, const std::string &,
+                             uint64_t)> &visit) {
+  auto node = head->forward_[0];
+  while (node) {
+    visit(node->key_, node->value_, node->tranc_id_);
+    node = node->forward_[0];
+  }
+}
+
 size_t SkipList::get_size() {
   // std::shared_lock<std::shared_mutex> slock(rw_mutex);
   return size_bytes;
@@ -125,6 +252,7 @@ void SkipList::clear() {
   // std::unique_lock<std::shared_mutex> lock(rw_mutex);
   head = std::make_shared<SkipListNode>("", "", max_level, 0);
   size_bytes = 0;
+  epoch_++;
 }
 
 SkipListIterator SkipList::begin() {
@@ -1,4 +1,5 @@
 #include "sst/concact_iterator.h"
+#include "config/config.h"
 
 namespace tiny_lsm {
 
@@ -11,6 +12,23 @@ ConcactIterator::ConcactIterator(std::vector<std::shared_ptr<SST>> ssts,
   }
 }
 
+ConcactIterator::ConcactIterator(std::vector<std::shared_ptr<SST>> ssts,
+                                 const std::string &key, uint64_t tranc_id,
+                                 bool keep_all_versions)
+    : ssts(ssts), cur_iter(nullptr, tranc_id), cur_idx(0),
+      max_tranc_id_(tranc_id), keep_all_versions_(keep_all_versions) {
+  // 跳过所有 key 都小于 key 的 SST
+  while (cur_idx < this->ssts.size() &&
+         this->ssts[cur_idx]->get_last_key() < key) {
+    cur_idx++;
+  }
+  if (cur_idx < this->ssts.size()) {
+    // 不能用 SstIterator(sst, key, ...): 它是点查, key 不在该 SST 中时直接为 end
+    cur_iter = SstIterator::lower_bound(this->ssts[cur_idx], key, max_tranc_id_,
+                                        keep_all_versions_);
+  }
+}
+
 BaseIterator &ConcactIterator::operator++() {
   ++cur_iter;
 
@@ -18,6 +36,7 @@ BaseIterator &ConcactIterator::operator++() {
     cur_idx++;
     if (cur_idx < ssts.size()) {
       cur_iter = ssts[cur_idx]->begin(max_tranc_id_, keep_all_versions_);
+      prefetch_next_sst_();
     } else {
       cur_iter = SstIterator(nullptr, max_tranc_id_);
     }
@@ -25,6 +44,27 @@ BaseIterator &ConcactIterator::operator++() {
   return *this;
 }
 
+void ConcactIterator::prefetch_next_sst_() {
+  auto &config = TomlConfig::getInstance();
+  // 预读的 block 只能通过块缓存交给下一个 SstIterator
+  if (cur_idx + 1 >= ssts.size() || keep_all_versions_ ||
+      config.getLsmIoReadaheadMaxBlocks() <= 0 ||
+      !config.getLsmIoReadaheadFillCache()) {
+    return;
+  }
+  if (next_sst_prefetch_ && next_sst_prefetch_->valid()) {
+    next_sst_prefetch_->wait();
+  }
+  next_sst_prefetch_ = std::make_shared<std::future<void>>(
+      std::async(std::launch::async, [sst = ssts[cur_idx + 1]] {
+        try {
+          sst->read_blocks({0});
+        } catch (const std::exception &) {
+          // 预读失败不影响扫描, 之后由 SstIterator 同步读取
+        }
+      }));
+}
+
 bool ConcactIterator::operator==(const BaseIterator &other) const {
   if (other.get_type() != IteratorType::ConcactIterator) {
     return false;
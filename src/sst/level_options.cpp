@@ -0,0 +1,107 @@
+#include "sst/level_options.h"
+#include "config/config.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tiny_lsm {
+
+std::vector<double> monkey_bits_per_key(const std::vector<double> &level_keys,
+                                        double avg_bits_per_key,
+                                        const std::vector<double> &fixed_bits,
+                                        double min_bits) {
+  const double ln2_sq = std::log(2.0) * std::log(2.0);
+  std::vector<double> bits(level_keys.size(), 0);
+  std::vector<bool> active(level_keys.size());
+  double total_bits = 0;
+  for (size_t i = 0; i < level_keys.size(); i++) {
+    double keys = std::max(level_keys[i], 0.0);
+    total_bits += keys * avg_bits_per_key;
+    if (i < fixed_bits.size() && fixed_bits[i] >= 0) {
+      // 大小固定的过滤器: 直接扣除它占用的位数
+      bits[i] = fixed_bits[i];
+      total_bits -= keys * fixed_bits[i];
+      active[i] = false;
+    } else {
+      active[i] = keys > 0;
+    }
+  }
+
+  while (true) {
+    // 在 active 的层之间求 c: sum(n_i * bits_i) = total_bits
+    double keys = 0, keys_log_keys = 0;
+    for (size_t i = 0; i < level_keys.size(); i++) {
+      if (active[i]) {
+        keys += level_keys[i];
+        keys_log_keys += level_keys[i] * std::log(level_keys[i]);
+      }
+    }
+    if (keys == 0) {
+      return bits;
+    }
+    double log_c = -(total_bits * ln2_sq + keys_log_keys) / keys;
+
+    bool changed = false;
+    for (size_t i = 0; i < level_keys.size(); i++) {
+      if (!active[i]) {
+        continue;
+      }
+      bits[i] = -(log_c + std::log(level_keys[i])) / ln2_sq;
+      if (bits[i] < min_bits) {
+        // 钳制到下限, 多用的位数从剩余的预算中扣除
+        bits[i] = min_bits;
+        total_bits -= level_keys[i] * min_bits;
+        active[i] = false;
+        changed = true;
+      }
+    }
+    if (!changed) {
+      return bits;
+    }
+  }
+}
+
+double fixed_filter_bits_per_key(FilterFormat format) {
+  // binary fuse 约 1.125 个槽位/key
+  switch (format) {
+  case FilterFormat::BinaryFuse8:
+    return 1.125 * 8;
+  case FilterFormat::BinaryFuse16:
+    return 1.125 * 16;
+  default:
+    return -1;
+  }
+}
+
+LevelOptions LevelOptions::for_level(size_t level, size_t num_levels) {
+  const auto &config = TomlConfig::getInstance();
+  LevelOptions options;
+  options.block_size = config.getLsmBlockSizeForLevel(level);
+  options.restart_interval = config.getLsmBlockRestartIntervalForLevel(level);
+  options.compression =
+      compression_type_from_string(config.getLsmCompressionForLevel(level));
+  options.filter =
+      filter_format_from_string(config.getBloomFilterTypeForLevel(level));
+
+  if (config.getBloomFilterMonkey()) {
+    // 各层的容量按 LSM_SST_LEVEL_RATIO 递增
+    num_levels = std::max(num_levels, level + 1);
+    std::vector<double> level_keys(num_levels);
+    std::vector<double> fixed_bits(num_levels);
+    double keys = 1;
+    for (size_t i = 0; i < num_levels; i++) {
+      level_keys[i] = keys;
+      keys *= std::max(config.getLsmSstLevelRatio(), 2);
+      fixed_bits[i] = fixed_filter_bits_per_key(
+          filter_format_from_string(config.getBloomFilterTypeForLevel(i)));
+    }
+    // 布隆过滤器至少 1 bit/key, 钳制后在其余布隆层之间重新分配
+    options.bits_per_key =
+        monkey_bits_per_key(level_keys, config.getBloomFilterBitsPerKey(),
+                            fixed_bits, 1.0)[level];
+  } else {
+    options.bits_per_key = config.getBloomFilterBitsPerKeyForLevel(level);
+  }
+  options.bits_per_key = std::max(options.bits_per_key, 1.0);
+  return options;
+}
+} // namespace tiny_lsm
@@ -2,6 +2,7 @@
 #include "config/config.h"
 #include "consts.h"
 #include "sst/sst_iterator.h"
+#include "utils/async_io.h"
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
@@ -19,6 +20,41 @@ static constexpr size_t OLD_FOOTER_SIZE =
     sizeof(uint32_t) * 2 + sizeof(uint64_t) * 2;
 // New WiscKey footer size (26 bytes)
 static constexpr size_t WISCKEY_FOOTER_SIZE = OLD_FOOTER_SIZE + 2;
+// Magic byte identifying the versioned footer, 新字段追加在 footer 中, 不再新增 magic
+static constexpr uint8_t VERSIONED_MAGIC = 0x4C;
+// 当前写入的 versioned footer 大小 (39 bytes), 读取时以 footer 中记录的大小为准
+static constexpr size_t VERSIONED_FOOTER_SIZE =
+    OLD_FOOTER_SIZE + 7 + sizeof(uint32_t) * 2;
+// versioned footer 的 sections 字节: 过滤器中还有 key 的前缀, 提取器的名字在过滤器之后
+static constexpr uint8_t SECTION_PREFIX_EXTRACTOR = 0x01;
+// versioned footer 的 sections 字节: Filter Section 末尾带有范围过滤器
+static constexpr uint8_t SECTION_RANGE_FILTER = 0x02;
+// versioned footer 的 sections 字节: 带有 Properties Section (TableProperties),
+// 位置由 footer 中的 properties_offset / properties_size 给出
+static constexpr uint8_t SECTION_PROPERTIES = 0x04;
+
+static BlockFormat configured_block_format() {
+  return TomlConfig::getInstance().getLsmBlockFormatVersion() == 1
+             ? BlockFormat::V1
+             : BlockFormat::V2;
+}
+
+// 所有 SST 共用的异步读引擎, 第一次批量读取时按配置创建
+// LSM_IO_ENGINE 为 sync 时返回空: 逐个读取没有并发, 映射的文件直接从映射中复制,
+// 否则引擎优先于映射 (见 FileObj::read_batch)
+static AsyncIoEngine *sst_io_engine() {
+  static std::unique_ptr<AsyncIoEngine> engine = []()
+      -> std::unique_ptr<AsyncIoEngine> {
+    auto &config = TomlConfig::getInstance();
+    if (config.getLsmIoEngine() == "sync") {
+      return nullptr;
+    }
+    return AsyncIoEngine::create(config.getLsmIoEngine(),
+                                 config.getLsmIoQueueDepth(),
+                                 config.getLsmIoThreads());
+  }();
+  return engine.get();
+}
 
 // **************************************************
 // SST
@@ -29,15 +65,36 @@ std::shared_ptr<SST> SST::open(size_t sst_id, FileObj file,
                                std::shared_ptr<VLog> vlog) {
   // TODO: Lab 3.6 打开一个SST文件, 返回一个描述类
   // ? 步骤:
-  // ?   0. 检测文件末尾 magic byte 判断是否为 WiscKey 格式 (WISCKEY_MAGIC = 0x4B)
-  // ?      footer 共 24 字节 (老格式) 或 26 字节 (WiscKey, 末尾多 storage_mode + magic)
-  // ?   1. 从文件末尾读取 footer: meta_block_offset, bloom_offset, min_tranc_id, max_tranc_id
-  // ?      如为 WiscKey 格式, 还需读取 storage_mode_
-  // ?   2. 读取并解码 Bloom Filter (bloom_offset ~ meta_block_offset 之间)
-  // ?   3. 读取并解码元数据块 (meta_block_offset ~ bloom_offset 之间)
-  // ?      调用 BlockMeta::decode_meta_from_slice
-  // ?   4. 设置 first_key 和 last_key
+  // ?   0. 检测文件末尾 magic byte 判断 footer 格式:
+  // ?      VERSIONED_MAGIC = 0x4C: 倒数第二个字节为 footer_size, footer 起点为
+  // ?      size - footer_size, 各字段按 sst.h 中的偏移读取, 不认识的尾部字段忽略
+  // ?      WISCKEY_MAGIC = 0x4B: 26 字节, 末尾为 storage_mode + magic
+  // ?      否则为 24 字节的老格式
+  // ?   1. 从 footer 读取: meta_block_offset, bloom_offset, min_tranc_id, max_tranc_id
+  // ?      WiscKey 和 versioned 格式还需读取 storage_mode_
+  // ?      versioned 格式读取 block_format_, index_type, filter_format_ 和 sections,
+  // ?      并设置 block_trailer_ = true; 带有 SECTION_PROPERTIES 时再读取
+  // ?      properties_offset / properties_size
+  // ?      其余格式的 block_format_ 为 BlockFormat::V1, block 没有压缩 trailer,
+  // ?      filter_format_ 为 FilterFormat::LegacyBloom, sections 为 0
+  // ?   2. 带有 SECTION_PROPERTIES 时读取 Properties Section,
+  // ?      properties_ = make_shared<TableProperties>(TableProperties::decode(...))
+  // ?      读取并解码 Bloom Filter (bloom_offset ~ Filter Section 末尾之间,
+  // ?      末尾为 properties_offset, 没有 Properties Section 时为 footer 起点)
+  // ?      带有 SECTION_RANGE_FILTER 时先从末尾取出 [range_filter][len:uint32],
+  // ?      range_filter_ = make_shared<RangeFilter>(RangeFilter::decode(...))
+  // ?      带有 SECTION_PREFIX_EXTRACTOR 时先从末尾取出 [extractor_name][name_len:uint16],
+  // ?      prefix_extractor_ = PrefixExtractor::create(extractor_name)
+  // ?      KeyFilter::decode(data, filter_format_), 按格式得到布隆或 binary fuse 过滤器
+  // ?   3. 读取元数据块 (meta_block_offset ~ bloom_offset 之间):
+  // ?      index_type 为 SstIndexType::Partitioned 时调用 PartitionedIndex::open,
+  // ?      传入读取文件的回调和 block_cache, 结果保存到 index_, meta_entries 留空
+  // ?      否则调用 BlockMeta::decode_meta_from_slice
+  // ?   4. 设置 first_key 和 last_key (分区索引时取 index_->first_key() / last_key())
+  // ?   5. 调用 sst->advise(FileAccess::Random): 点查不需要内核预读
   // ?   注: vlog 用于 WiscKey 模式下的 value 读取, 直接赋值给 sst->vlog_
+  // ?   注: file 由调用方打开, LSM_IO_MMAP_READS 开启时为 FileObj::open_mmap,
+  // ?       此时 file.read_to_slice 直接从映射中复制, 不需要系统调用
   return nullptr;
 }
 
@@ -46,20 +103,98 @@ void SST::del_sst() { file.del_file(); }
 std::shared_ptr<Block> SST::read_block(int64_t block_idx) {
   // TODO: Lab 3.6 根据 block 的 id 读取一个 Block
   // ? 先从 block_cache 查找; 未命中则计算该 block 的偏移和大小
-  // ? 读取数据后调用 Block::decode(data, true) 解码
+  // ? 读取数据后, 若 block_trailer_ 为 true 先调用 decompress_block 去掉压缩 trailer,
+  // ? 再调用 Block::decode(std::move(data), true, block_format_) 解码
+  // ? 两步都传右值, 未压缩的 block 从读取到解码只有一次拷贝 (文件 -> data)
+  // ? block 大小按磁盘上 (压缩后) 的大小计算
   // ? 解码后存入 block_cache 并返回
   // ? block 大小: 相邻 meta_entries 的 offset 差值; 最后一个 block 到 meta_block_offset
+  // ? 分区索引时 block 的位置和大小由 index_->block_handle(block_idx) 给出
+  // ? 可以直接使用 block_handle_(block_idx) 和 decode_block_(std::move(data))
   return nullptr;
 }
 
+std::vector<std::shared_ptr<Block>>
+SST::read_blocks(const std::vector<size_t> &block_idxs, bool fill_cache) {
+  std::vector<std::shared_ptr<Block>> blocks(block_idxs.size());
+  // 缓存未命中的 block 合并成一批读请求
+  std::vector<size_t> missing;
+  std::vector<std::pair<size_t, size_t>> ranges;
+  for (size_t i = 0; i < block_idxs.size(); i++) {
+    if (block_idxs[i] >= num_blocks()) {
+      throw std::out_of_range("Block index out of range");
+    }
+    if (block_cache) {
+      blocks[i] = block_cache->get(sst_id, block_idxs[i]);
+      if (blocks[i]) {
+        continue;
+      }
+    }
+    auto handle = block_handle_(block_idxs[i]);
+    missing.push_back(i);
+    ranges.emplace_back(handle.offset, handle.size);
+  }
+  if (missing.empty()) {
+    return blocks;
+  }
+
+  auto stored = file.read_batch(ranges, sst_io_engine());
+  for (size_t j = 0; j < missing.size(); j++) {
+    size_t i = missing[j];
+    blocks[i] = decode_block_(std::move(stored[j]));
+    if (block_cache && fill_cache) {
+      block_cache->put(sst_id, block_idxs[i], blocks[i]);
+    }
+  }
+  return blocks;
+}
+
+BlockHandle SST::block_handle_(size_t block_idx) {
+  if (index_) {
+    return index_->block_handle(block_idx);
+  }
+  if (block_idx >= meta_entries.size()) {
+    throw std::out_of_range("Block index out of range");
+  }
+  size_t end = block_idx + 1 < meta_entries.size()
+                   ? meta_entries[block_idx + 1].offset
+                   : meta_block_offset;
+  uint32_t offset = meta_entries[block_idx].offset;
+  return {offset, static_cast<uint32_t>(end - offset)};
+}
+
+std::shared_ptr<Block> SST::decode_block_(std::vector<uint8_t> &&stored) const {
+  if (block_trailer_) {
+    return Block::decode(decompress_block(std::move(stored)), true,
+                         block_format_);
+  }
+  return Block::decode(std::move(stored), true, block_format_);
+}
+
 int64_t SST::find_block_idx(const std::string &key) {
   // TODO: Lab 3.6 二分查找
   // ? 先用布隆过滤器快速排除 (bloom_filter->possibly_contains(key))
   // ? 再在 meta_entries 上二分查找: first_key <= key <= last_key
+  // ? 分区索引时直接返回 index_->find_block_idx(key), 只需读取一个 partition
   // ? 若未找到合适 block 返回 -1
   return 0;
 }
 
+int64_t SST::lower_bound_block_idx(const std::string &key) {
+  if (index_) {
+    return index_->find_block_idx(key);
+  }
+  auto it = std::lower_bound(
+      meta_entries.begin(), meta_entries.end(), key,
+      [](const BlockMeta &meta, const std::string &k) {
+        return meta.last_key < k;
+      });
+  if (it == meta_entries.end()) {
+    return -1;
+  }
+  return it - meta_entries.begin();
+}
+
 SstIterator SST::get(const std::string &key, uint64_t tranc_id) {
   // TODO: Lab 3.6 根据查询 key 返回一个迭代器
   // ? 先检查 key 是否在 [first_key, last_key] 范围内, 否则返回 end()
@@ -68,7 +203,56 @@ SstIterator SST::get(const std::string &key, uint64_t tranc_id) {
   throw std::runtime_error("Not implemented");
 }
 
-size_t SST::num_blocks() const { return meta_entries.size(); }
+bool SST::may_contain_prefix(const std::string &prefix) const {
+  // [first_key, last_key] 与以 prefix 开头的 key 的范围不相交
+  if (last_key.compare(0, prefix.size(), prefix) < 0 ||
+      first_key.compare(0, prefix.size(), prefix) > 0) {
+    return false;
+  }
+  if (bloom_filter == nullptr || prefix_extractor_ == nullptr) {
+    return true;
+  }
+  auto filter_prefix = prefix_extractor_->transform_prefix(prefix);
+  if (!filter_prefix.has_value()) {
+    return true;
+  }
+  return bloom_filter->possibly_contains(std::string(*filter_prefix));
+}
+
+bool SST::may_match(
+    const std::function<int(const std::string &)> &predicate) const {
+  if (predicate(last_key) > 0 || predicate(first_key) < 0) {
+    return false;
+  }
+  return range_filter_ == nullptr || range_filter_->may_match(predicate);
+}
+
+size_t SST::num_blocks() const {
+  return index_ ? index_->num_blocks() : meta_entries.size();
+}
+
+std::vector<std::string> SST::sample_block_keys(size_t max_samples) {
+  std::vector<std::string> keys;
+  size_t blocks = num_blocks();
+  if (blocks == 0 || max_samples == 0) {
+    return keys;
+  }
+  size_t samples = (std::min)(blocks, max_samples);
+  keys.reserve(samples);
+  for (size_t i = 0; i < samples; i++) {
+    size_t block_idx = i * blocks / samples;
+    if (index_) {
+      keys.push_back(index_->block_separator(block_idx));
+    } else {
+      keys.push_back(meta_entries[block_idx].first_key);
+    }
+  }
+  return keys;
+}
+
+std::shared_ptr<const TableProperties> SST::get_table_properties() const {
+  return properties_;
+}
 
 std::string SST::get_first_key() const { return first_key; }
 
@@ -99,6 +283,21 @@ std::string SST::resolve_value(const std::string &raw_value) const {
 
 bool SST::is_wisckey() const { return storage_mode_ == 1; }
 
+BlockFormat SST::get_block_format() const { return block_format_; }
+
+void SST::advise(FileAccess access) { file.advise(access); }
+
+size_t SST::index_memory_usage() const {
+  if (index_) {
+    return index_->memory_usage();
+  }
+  size_t usage = meta_entries.capacity() * sizeof(BlockMeta);
+  for (auto &meta : meta_entries) {
+    usage += meta.first_key.capacity() + meta.last_key.capacity();
+  }
+  return usage;
+}
+
 SstIterator SST::begin(uint64_t tranc_id, bool keep_all_versions) {
   // TODO: Lab 3.6 返回起始位置迭代器
   // ? 返回 SstIterator(shared_from_this(), tranc_id, keep_all_versions)
@@ -119,12 +318,29 @@ std::pair<uint64_t, uint64_t> SST::get_tranc_id_range() const {
 // SSTBuilder
 // **************************************************
 
-SSTBuilder::SSTBuilder(size_t block_size, bool has_bloom) : block(block_size) {
-  // 初始化第一个block
-  if (has_bloom) {
-    bloom_filter = std::make_shared<BloomFilter>(
-        TomlConfig::getInstance().getBloomFilterExpectedSize(),
-        TomlConfig::getInstance().getBloomFilterExpectedErrorRate());
+SSTBuilder::SSTBuilder(size_t block_size, bool has_bloom)
+    : block(block_size, configured_block_format(),
+            TomlConfig::getInstance().getLsmBlockRestartInterval(),
+            TomlConfig::getInstance().getLsmBlockHashIndexUtilRatio()) {
+  this->block_size = block_size;
+  block_format_ = block.get_format();
+  restart_interval_ = TomlConfig::getInstance().getLsmBlockRestartInterval();
+  hash_util_ratio_ =
+      TomlConfig::getInstance().getLsmBlockHashIndexUtilRatio();
+  compression_ = compression_for_level(0);
+  compression_max_ratio_ = TomlConfig::getInstance().getLsmCompressionMaxRatio();
+  if (TomlConfig::getInstance().getLsmIndexPartitioned()) {
+    index_builder_.emplace(TomlConfig::getInstance().getLsmIndexPartitionSize());
+  }
+  // 过滤器在 build 时按实际的 key 数创建
+  has_bloom_ = has_bloom;
+  bloom_bits_per_key_ = TomlConfig::getInstance().getBloomFilterBitsPerKey();
+  filter_format_ = filter_for_level(0);
+  prefix_extractor_ = PrefixExtractor::create(
+      TomlConfig::getInstance().getBloomFilterPrefixExtractor());
+  if (TomlConfig::getInstance().getLsmIndexRangeFilter()) {
+    range_filter_builder_.emplace(
+        TomlConfig::getInstance().getLsmIndexRangeFilterSuffixBytes());
   }
   meta_entries.clear();
   data.clear();
@@ -135,25 +351,23 @@ SSTBuilder::SSTBuilder(size_t block_size, bool has_bloom) : block(block_size) {
 SSTBuilder::SSTBuilder(size_t block_size, bool has_bloom,
                        std::shared_ptr<VLog> vlog,
                        size_t wisckey_threshold)
-    : block(block_size), vlog_(std::move(vlog)),
-      wisckey_threshold_(wisckey_threshold), storage_mode_(1) {
+    : SSTBuilder(block_size, has_bloom) {
   // WiscKey 模式构造函数: vlog 用于大 value 分离存储
-  if (has_bloom) {
-    bloom_filter = std::make_shared<BloomFilter>(
-        TomlConfig::getInstance().getBloomFilterExpectedSize(),
-        TomlConfig::getInstance().getBloomFilterExpectedErrorRate());
-  }
-  meta_entries.clear();
-  data.clear();
-  first_key.clear();
-  last_key.clear();
+  vlog_ = std::move(vlog);
+  wisckey_threshold_ = wisckey_threshold;
+  storage_mode_ = 1;
 }
 
 void SSTBuilder::add(const std::string &key, const std::string &value,
                      uint64_t tranc_id) {
   // TODO: Lab 3.5 添加键值对
   // ? 记录 first_key (第一次调用时)
-  // ? 向 bloom_filter 中 add key
+  // ? 若 has_bloom_ 且 key != last_key, 记录 BloomFilter::key_hash(key) 到 key_hashes_
+  // ?   若 prefix_extractor_ 非空, prefix_extractor_->transform(key) 有值且与
+  // ?   last_prefix_ 不同, 同时记录前缀的 key_hash 并更新 last_prefix_
+  // ? 若 range_filter_builder_ 非空, 调用 range_filter_builder_->add(key)
+  // ? 调用 properties_.add(key, value.size(), 是否为第一条或 key != last_key,
+  // ?   value 是否写入了 vlog), value.size() 为写入 vlog 之前的大小
   // ? 更新 max_tranc_id_ / min_tranc_id_
   // ? WiscKey 模式下: 若 value 非空且超过 wisckey_threshold_, 将 value 写入 vlog
   // ?   并将 vlog 引用 [offset:8][size:4] 作为 actual_value
@@ -162,15 +376,59 @@ void SSTBuilder::add(const std::string &key, const std::string &value,
   // ? 更新 last_key
 }
 
-size_t SSTBuilder::real_size() const { return data.size() + block.cur_size(); }
+void SSTBuilder::set_compression(CompressionType type) { compression_ = type; }
+
+CompressionType SSTBuilder::compression_for_level(size_t level) {
+  return compression_type_from_string(
+      TomlConfig::getInstance().getLsmCompressionForLevel(level));
+}
+
+void SSTBuilder::set_filter_format(FilterFormat format) {
+  filter_format_ = format;
+}
+
+FilterFormat SSTBuilder::filter_for_level(size_t level) {
+  return filter_format_from_string(
+      TomlConfig::getInstance().getBloomFilterTypeForLevel(level));
+}
+
+void SSTBuilder::open(const std::string &path) {
+  if (data_size_() != 0 || !block.is_empty()) {
+    throw std::logic_error("open must be called before add");
+  }
+  writer_ = std::make_unique<BufferedFileWriter>(path);
+}
+
+void SSTBuilder::set_level_options(const LevelOptions &options) {
+  if (data_size_() != 0 || !block.is_empty()) {
+    throw std::logic_error("set_level_options must be called before add");
+  }
+  block_size = options.block_size;
+  restart_interval_ = options.restart_interval;
+  block = Block(block_size, block_format_, restart_interval_, hash_util_ratio_);
+  bloom_bits_per_key_ = options.bits_per_key;
+  compression_ = options.compression;
+  filter_format_ = options.filter;
+}
+
+size_t SSTBuilder::data_size_() const {
+  return writer_ ? writer_->offset() : data.size();
+}
+
+size_t SSTBuilder::real_size() const { return data_size_() + block.cur_size(); }
 
-size_t SSTBuilder::estimated_size() const { return data.size(); }
+size_t SSTBuilder::estimated_size() const { return data_size_(); }
 
 void SSTBuilder::finish_block() {
   // TODO: Lab 3.5 构建块
-  // ? 将当前 block 编码并追加到 data, 同时向 meta_entries 添加元数据
-  // ? 然后重置 block 为新的空 Block
-  // ? meta_entries 记录: (当前data起始偏移, first_key, last_key)
+  // ? 将当前 block 编码, 调用 compress_block(encoded, compression_, compression_max_ratio_)
+  // ? 加上压缩 trailer 后追加到 data (writer_ 非空时改为 writer_->append, 不经过 data),
+  // ? 同时向 meta_entries 添加元数据
+  // ? 然后重置 block 为新的空
+  // ? Block(block_size, block_format_, restart_interval_, hash_util_ratio_)
+  // ? meta_entries 记录: (data_size_() 即 block 的起始偏移, first_key, last_key)
+  // ? 若 index_builder_ 非空, 同时调用 index_builder_->add_block(first_key, last_key,
+  // ? {block 的起始偏移, block 在磁盘上的大小})
 }
 
 std::shared_ptr<SST>
@@ -180,12 +438,31 @@ SSTBuilder::build(size_t sst_id, const std::string &path,
   // ? 1. 若 block 非空则调用 finish_block()
   // ? 2. 若 meta_entries 为空则抛出异常
   // ? 3. 编码元数据块并追加到 data (BlockMeta::encode_meta_to_slice)
-  // ? 4. 追加 Bloom Filter 编码
-  // ? 5. 写入 footer (老格式 24B 或 WiscKey 26B):
+  // ?    若 index_builder_ 非空, 改为调用 index_builder_->finish(data, base) 写入分区索引
+  // ?    流式构建时 data 为空, 3~5 步的内容同样先追加到 data 中, 文件中的偏移为
+  // ?    writer_->offset() + data.size() (base 即 writer_->offset()),
+  // ?    写完 footer 后一次 writer_->append(data)
+  // ? 4. 若 has_bloom_, 用 KeyFilter::build(filter_format_, key_hashes_, bloom_bits_per_key_)
+  // ?    创建过滤器 (大小由实际的 key 数决定), 追加其编码
+  // ?    若 prefix_extractor_ 非空, 在过滤器之后追加 [name][name_len:uint16],
+  // ?    sections 加上 SECTION_PREFIX_EXTRACTOR
+  // ?    若 range_filter_builder_ 非空, 再追加 [range_filter_builder_->finish()][len:uint32],
+  // ?    sections 加上 SECTION_RANGE_FILTER
+  // ?    Filter Section 之后追加 properties_.encode() 作为 Properties Section,
+  // ?    记下 properties_offset / properties_size, sections 加上 SECTION_PROPERTIES
+  // ? 5. 写入 versioned footer (VERSIONED_FOOTER_SIZE 字节):
   // ?    [meta_offset:uint32][bloom_offset:uint32][min_tranc_id:uint64][max_tranc_id:uint64]
-  // ?    WiscKey 额外: [storage_mode_:uint8][WISCKEY_MAGIC:uint8]
+  // ?    [storage_mode_:uint8][block_format_:uint8][index_type:uint8]
+  // ?    [filter_format_:uint8][sections:uint8]
+  // ?    [properties_offset:uint32][properties_size:uint32]
+  // ?    [footer_size:uint8][VERSIONED_MAGIC:uint8]
   // ? 6. 调用 FileObj::create_and_write 写文件
-  // ? 7. 构造并返回 SST 对象
+  // ?    流式构建时 (writer_ 非空, 要求 writer_->path() == path) 改为调用 writer_->finish(),
+  // ?    再用 FileObj::open(path, false) 打开
+  // ?    若 LSM_IO_MMAP_READS 开启, 写完后用 FileObj::open_mmap(path) 重新只读打开
+  // ? 7. 构造并返回 SST 对象 (同时设置 block_format_, bloom_filter, filter_format_, prefix_extractor_,
+  // ?    range_filter_ 和 properties_,
+  // ?    分区索引时通过 PartitionedIndex::open 设置 index_)
   return nullptr;
 }
 } // namespace tiny_lsm
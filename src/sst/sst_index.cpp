@@ -0,0 +1,276 @@
+#include "sst/sst_index.h"
+#include "utils/crc32c.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+std::string shortest_separator(const std::string &a, const std::string &b) {
+  size_t n = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < n && a[i] == b[i]) {
+    i++;
+  }
+  if (i == n) {
+    // a 是 b 的前缀, 无法更短
+    return a;
+  }
+
+  uint8_t ca = static_cast<uint8_t>(a[i]);
+  uint8_t cb = static_cast<uint8_t>(b[i]);
+  if (ca + 1 < cb) {
+    // 公共前缀 + (a[i] + 1) 严格位于 a 和 b 之间
+    std::string sep = a.substr(0, i);
+    sep.push_back(static_cast<char>(ca + 1));
+    return sep;
+  }
+  // a[i] + 1 == b[i]: 保留 a[i], 之后第一个不是 0xff 的字节加一后截断
+  for (size_t j = i + 1; j + 1 < a.size(); j++) {
+    uint8_t c = static_cast<uint8_t>(a[j]);
+    if (c != 0xff) {
+      std::string sep = a.substr(0, j);
+      sep.push_back(static_cast<char>(c + 1));
+      return sep;
+    }
+  }
+  return a;
+}
+
+// **************************************************
+// PartitionedIndexBuilder
+// **************************************************
+
+PartitionedIndexBuilder::PartitionedIndexBuilder(size_t partition_size)
+    : partition_size_(partition_size),
+      current_(partition_size, BlockFormat::V2) {}
+
+void PartitionedIndexBuilder::add_block(const std::string &first_key,
+                                        const std::string &last_key,
+                                        BlockHandle handle) {
+  if (pending_.has_value()) {
+    add_separator_(shortest_separator(pending_->first, first_key),
+                   pending_->second);
+  } else {
+    first_key_ = first_key;
+  }
+  pending_.emplace(last_key, handle);
+  num_blocks_++;
+}
+
+size_t PartitionedIndexBuilder::num_blocks() const { return num_blocks_; }
+
+void PartitionedIndexBuilder::add_separator_(const std::string &separator,
+                                             BlockHandle handle) {
+  std::string value(2 * sizeof(uint32_t), '\0');
+  memcpy(value.data(), &handle.offset, sizeof(uint32_t));
+  memcpy(value.data() + sizeof(uint32_t), &handle.size, sizeof(uint32_t));
+  if (!current_.add_entry(separator, value, 0, false)) {
+    cut_partition_();
+    current_.add_entry(separator, value, 0, true);
+  }
+  current_last_ = separator;
+}
+
+void PartitionedIndexBuilder::cut_partition_() {
+  Partition partition;
+  partition.encoded = current_.encode();
+  partition.last_separator = current_last_;
+  partition.first_block = current_first_block_;
+  current_first_block_ += current_.size();
+  partitions_.push_back(std::move(partition));
+  current_ = Block(partition_size_, BlockFormat::V2);
+}
+
+void PartitionedIndexBuilder::finish(std::vector<uint8_t> &out,
+                                     size_t base_offset) {
+  if (!pending_.has_value()) {
+    throw std::runtime_error("Cannot build an empty index");
+  }
+  add_separator_(pending_->first, pending_->second);
+  pending_.reset();
+  cut_partition_();
+
+  // 1. partitions
+  std::vector<BlockHandle> handles;
+  for (auto &partition : partitions_) {
+    handles.push_back({static_cast<uint32_t>(base_offset + out.size()),
+                       static_cast<uint32_t>(partition.encoded.size())});
+    out.insert(out.end(), partition.encoded.begin(), partition.encoded.end());
+  }
+
+  // 2. top-level index
+  size_t top_offset = out.size();
+  auto put = [&out](const void *src, size_t len) {
+    auto ptr = static_cast<const uint8_t *>(src);
+    out.insert(out.end(), ptr, ptr + len);
+  };
+  uint32_t num_blocks = static_cast<uint32_t>(num_blocks_);
+  put(&num_blocks, sizeof(uint32_t));
+  uint16_t first_key_len = static_cast<uint16_t>(first_key_.size());
+  put(&first_key_len, sizeof(uint16_t));
+  put(first_key_.data(), first_key_.size());
+  uint32_t num_partitions = static_cast<uint32_t>(partitions_.size());
+  put(&num_partitions, sizeof(uint32_t));
+  for (size_t i = 0; i < partitions_.size(); i++) {
+    auto &sep = partitions_[i].last_separator;
+    uint16_t sep_len = static_cast<uint16_t>(sep.size());
+    put(&sep_len, sizeof(uint16_t));
+    put(sep.data(), sep.size());
+    put(&handles[i].offset, sizeof(uint32_t));
+    put(&handles[i].size, sizeof(uint32_t));
+    put(&partitions_[i].first_block, sizeof(uint32_t));
+  }
+  uint32_t crc = crc32c(out.data() + top_offset, out.size() - top_offset);
+  put(&crc, sizeof(uint32_t));
+
+  uint32_t top_offset32 = static_cast<uint32_t>(base_offset + top_offset);
+  put(&top_offset32, sizeof(uint32_t));
+  partitions_.clear();
+}
+
+// **************************************************
+// PartitionedIndex
+// **************************************************
+
+std::shared_ptr<PartitionedIndex>
+PartitionedIndex::open(ReadFn read, size_t begin, size_t end, size_t sst_id,
+                       std::shared_ptr<BlockCache> block_cache) {
+  if (end < begin + sizeof(uint32_t)) {
+    throw std::runtime_error("Invalid partitioned index section");
+  }
+  auto tail = read(end - sizeof(uint32_t), sizeof(uint32_t));
+  uint32_t top_offset;
+  memcpy(&top_offset, tail.data(), sizeof(uint32_t));
+  if (top_offset < begin || top_offset + sizeof(uint32_t) * 3 + sizeof(uint16_t) >
+                                end - sizeof(uint32_t)) {
+    throw std::runtime_error("Invalid partitioned index offset");
+  }
+
+  auto top = read(top_offset, end - sizeof(uint32_t) - top_offset);
+  size_t body_size = top.size() - sizeof(uint32_t);
+  uint32_t stored_crc;
+  memcpy(&stored_crc, top.data() + body_size, sizeof(uint32_t));
+  if (crc32c(top.data(), body_size) != stored_crc) {
+    throw std::runtime_error("Partitioned index checksum verification failed");
+  }
+
+  auto index = std::make_shared<PartitionedIndex>();
+  index->read_ = std::move(read);
+  index->sst_id_ = sst_id;
+  index->block_cache_ = std::move(block_cache);
+
+  size_t pos = 0;
+  auto get = [&](void *dst, size_t len) {
+    if (pos + len > body_size) {
+      throw std::runtime_error("Invalid partitioned index entry");
+    }
+    memcpy(dst, top.data() + pos, len);
+    pos += len;
+  };
+  auto get_string = [&](std::string &dst) {
+    uint16_t len;
+    get(&len, sizeof(uint16_t));
+    dst.resize(len);
+    get(dst.data(), len);
+  };
+  get(&index->num_blocks_, sizeof(uint32_t));
+  get_string(index->first_key_);
+  uint32_t num_partitions;
+  get(&num_partitions, sizeof(uint32_t));
+  index->top_.resize(num_partitions);
+  for (auto &entry : index->top_) {
+    get_string(entry.separator);
+    get(&entry.handle.offset, sizeof(uint32_t));
+    get(&entry.handle.size, sizeof(uint32_t));
+    get(&entry.first_block, sizeof(uint32_t));
+  }
+  if (index->top_.empty() || index->top_.front().first_block != 0) {
+    throw std::runtime_error("Invalid partitioned index entry");
+  }
+  return index;
+}
+
+size_t PartitionedIndex::num_blocks() const { return num_blocks_; }
+
+size_t PartitionedIndex::num_partitions() const { return top_.size(); }
+
+const std::string &PartitionedIndex::first_key() const { return first_key_; }
+
+const std::string &PartitionedIndex::last_key() const {
+  return top_.back().separator;
+}
+
+int64_t PartitionedIndex::find_block_idx(const std::string &key) {
+  auto it = std::lower_bound(
+      top_.begin(), top_.end(), key,
+      [](const TopEntry &entry, const std::string &k) {
+        return entry.separator < k;
+      });
+  if (it == top_.end()) {
+    return -1;
+  }
+  auto partition = read_partition_(it - top_.begin());
+  size_t idx = partition->lower_bound(key);
+  if (idx >= partition->size()) {
+    return -1;
+  }
+  return it->first_block + idx;
+}
+
+BlockHandle PartitionedIndex::block_handle(size_t block_idx) {
+  size_t p = partition_of_(block_idx);
+  auto partition = read_partition_(p);
+  auto value =
+      partition->get_value_view_by_idx(block_idx - top_[p].first_block);
+  if (value.size() != 2 * sizeof(uint32_t)) {
+    throw std::runtime_error("Invalid partitioned index entry");
+  }
+  BlockHandle handle;
+  memcpy(&handle.offset, value.data(), sizeof(uint32_t));
+  memcpy(&handle.size, value.data() + sizeof(uint32_t), sizeof(uint32_t));
+  return handle;
+}
+
+std::string PartitionedIndex::block_separator(size_t block_idx) {
+  size_t p = partition_of_(block_idx);
+  return read_partition_(p)->get_key_by_idx(block_idx - top_[p].first_block);
+}
+
+size_t PartitionedIndex::memory_usage() const {
+  size_t usage = sizeof(PartitionedIndex) + first_key_.capacity() +
+                 top_.capacity() * sizeof(TopEntry);
+  for (auto &entry : top_) {
+    usage += entry.separator.capacity();
+  }
+  return usage;
+}
+
+size_t PartitionedIndex::partition_of_(size_t block_idx) const {
+  if (block_idx >= num_blocks_) {
+    throw std::out_of_range("block index out of range");
+  }
+  auto it = std::upper_bound(
+      top_.begin(), top_.end(), block_idx,
+      [](size_t idx, const TopEntry &entry) { return idx < entry.first_block; });
+  return (it - top_.begin()) - 1;
+}
+
+std::shared_ptr<Block> PartitionedIndex::read_partition_(size_t partition_idx) {
+  // partition 与 data block 共用块缓存, 使用负数的 block_id 区分
+  int cache_id = -1 - static_cast<int>(partition_idx);
+  if (block_cache_) {
+    auto cached = block_cache_->get(sst_id_, cache_id);
+    if (cached) {
+      return cached;
+    }
+  }
+  auto &handle = top_[partition_idx].handle;
+  auto partition = Block::decode(read_(handle.offset, handle.size), true,
+                                 BlockFormat::V2);
+  if (block_cache_) {
+    block_cache_->put(sst_id_, cache_id, partition);
+  }
+  return partition;
+}
+} // namespace tiny_lsm
@@ -1,4 +1,5 @@
 #include "sst/sst_iterator.h"
+#include "config/config.h"
 #include "sst/sst.h"
 #include <cstddef>
 #include <optional>
@@ -13,19 +14,35 @@ namespace tiny_lsm {
 std::optional<std::pair<SstIterator, SstIterator>> sst_iters_monotony_predicate(
     std::shared_ptr<SST> sst, uint64_t tranc_id,
     std::function<int(const std::string &)> predicate) {
+  // key 范围和范围过滤器都可以排除时, 不读取任何 block
+  if (!sst->may_match(predicate)) {
+    return std::nullopt;
+  }
   std::optional<SstIterator> final_begin = std::nullopt;
   std::optional<SstIterator> final_end = std::nullopt;
-  for (int block_idx = 0; block_idx < sst->meta_entries.size(); block_idx++) {
-    auto block = sst->read_block(block_idx);
-
-    BlockMeta &meta_i = sst->meta_entries[block_idx];
-    if (predicate(meta_i.first_key) < 0) {
-      break;
-    }
-    if (predicate(meta_i.last_key) > 0) {
-      continue;
+  std::string prev_separator;
+  for (int block_idx = 0; block_idx < sst->num_blocks(); block_idx++) {
+    if (sst->index_) {
+      // 分区索引只保存分隔符: block 中的 key 位于 (上一个分隔符, 分隔符] 之间
+      auto separator = sst->index_->block_separator(block_idx);
+      if (block_idx > 0 && predicate(prev_separator) < 0) {
+        break;
+      }
+      prev_separator = separator;
+      if (predicate(separator) > 0) {
+        continue;
+      }
+    } else {
+      BlockMeta &meta_i = sst->meta_entries[block_idx];
+      if (predicate(meta_i.first_key) < 0) {
+        break;
+      }
+      if (predicate(meta_i.last_key) > 0) {
+        continue;
+      }
     }
 
+    auto block = sst->read_block(block_idx);
     auto result_i = block->get_monotony_predicate_iters(tranc_id, predicate);
     if (result_i.has_value()) {
       auto [i_begin, i_end] = result_i.value();
@@ -80,6 +97,7 @@ void SstIterator::seek_first() {
   }
 
   m_block_idx = 0;
+  readahead_.reset();
   auto block = m_sst->read_block(m_block_idx);
   m_block_it = std::make_shared<BlockIterator>(block, 0, max_tranc_id_,
                                                keep_all_versions_);
@@ -91,6 +109,7 @@ void SstIterator::seek(const std::string &key) {
     return;
   }
 
+  readahead_.reset();
   try {
     m_block_idx = m_sst->find_block_idx(key);
     if (m_block_idx == -1 || m_block_idx >= m_sst->num_blocks()) {
@@ -119,6 +138,46 @@ void SstIterator::seek(const std::string &key) {
   }
 }
 
+SstIterator SstIterator::lower_bound(std::shared_ptr<SST> sst,
+                                     const std::string &key,
+                                     uint64_t tranc_id,
+                                     bool keep_all_versions) {
+  // 先构造空的迭代器, 避免构造函数中的 seek_first 读取第一个 block
+  SstIterator it(nullptr, tranc_id, keep_all_versions);
+  it.m_sst = std::move(sst);
+  it.seek_lower_bound(key);
+  return it;
+}
+
+void SstIterator::seek_lower_bound(const std::string &key) {
+  if (!m_sst) {
+    m_block_it = nullptr;
+    return;
+  }
+
+  readahead_.reset();
+  int64_t block_idx = m_sst->lower_bound_block_idx(key);
+  if (block_idx < 0) {
+    m_block_idx = m_sst->num_blocks();
+    m_block_it = nullptr;
+    return;
+  }
+  m_block_idx = block_idx;
+  auto block = m_sst->read_block(m_block_idx);
+  m_block_it = std::make_shared<BlockIterator>(
+      block, block->lower_bound(key), max_tranc_id_, keep_all_versions_);
+  // 当前 block 中剩余的记录都不可见时移动到后面的 block
+  while (m_block_it->is_end()) {
+    m_block_idx++;
+    if (m_block_idx >= static_cast<int64_t>(m_sst->num_blocks())) {
+      m_block_it = nullptr;
+      return;
+    }
+    m_block_it = std::make_shared<BlockIterator>(
+        m_sst->read_block(m_block_idx), 0, max_tranc_id_, keep_all_versions_);
+  }
+}
+
 std::string SstIterator::key() {
   if (!m_block_it) {
     throw std::runtime_error("Iterator is invalid");
@@ -142,7 +201,7 @@ BaseIterator &SstIterator::operator++() {
     m_block_idx++;
     if (m_block_idx < m_sst->num_blocks()) {
       // 读取下一个block
-      auto next_block = m_sst->read_block(m_block_idx);
+      auto next_block = read_next_block_();
       BlockIterator new_blk_it(next_block, 0, max_tranc_id_,
                                keep_all_versions_);
       (*m_block_it) = new_blk_it;
@@ -154,6 +213,25 @@ BaseIterator &SstIterator::operator++() {
   return *this;
 }
 
+std::shared_ptr<Block> SstIterator::read_next_block_() {
+  auto &config = TomlConfig::getInstance();
+  if (config.getLsmIoReadaheadMaxBlocks() <= 0) {
+    return m_sst->read_block(m_block_idx);
+  }
+  if (!readahead_) {
+    // compaction 的输入 (keep_all_versions) 只会被读一遍, 不放入块缓存
+    auto sst = m_sst;
+    readahead_ = std::make_shared<BlockReadahead>(
+        [sst](const std::vector<size_t> &block_idxs, bool fill_cache) {
+          return sst->read_blocks(block_idxs, fill_cache);
+        },
+        m_sst->num_blocks(), m_block_idx - 1, config.getLsmIoReadaheadInitialBlocks(),
+        config.getLsmIoReadaheadMaxBlocks(),
+        config.getLsmIoReadaheadFillCache() && !keep_all_versions_);
+  }
+  return readahead_->get(m_block_idx);
+}
+
 bool SstIterator::operator==(const BaseIterator &other) const {
   if (other.get_type() != IteratorType::SstIterator) {
     return false;
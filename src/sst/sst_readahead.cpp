@@ -0,0 +1,108 @@
+#include "sst/sst_readahead.h"
+#include <algorithm>
+#include <chrono>
+
+namespace tiny_lsm {
+
+BlockReadahead::BlockReadahead(ReadFn read, size_t num_blocks,
+                               int64_t last_block_idx, size_t initial_blocks,
+                               size_t max_blocks, bool fill_cache)
+    : read_(std::move(read)), num_blocks_(num_blocks), initial_blocks_(std::max<size_t>(initial_blocks, 1)),
+      max_blocks_(max_blocks), fill_cache_(fill_cache),
+      last_block_idx_(last_block_idx),
+      window_(std::min(initial_blocks_, std::max<size_t>(max_blocks, 1))),
+      next_prefetch_(last_block_idx + 1) {}
+
+BlockReadahead::~BlockReadahead() {
+  // 后台线程使用 read_, 等它结束
+  if (inflight_.valid()) {
+    inflight_.wait();
+  }
+}
+
+std::shared_ptr<Block> BlockReadahead::get(size_t block_idx) {
+  if (static_cast<int64_t>(block_idx) == last_block_idx_ + 1) {
+    sequential_++;
+  } else {
+    reset_(block_idx);
+  }
+  last_block_idx_ = block_idx;
+
+  // 需要的 block 正在预读时等待这一批完成, 否则只收集已经完成的
+  collect_(inflight_.valid() && block_idx >= inflight_begin_ &&
+           block_idx < inflight_end_);
+
+  std::shared_ptr<Block> block;
+  auto it = buffer_.find(block_idx);
+  if (it != buffer_.end()) {
+    block = it->second;
+    hits_++;
+  }
+  buffer_.erase(buffer_.begin(), buffer_.upper_bound(block_idx));
+  if (!block) {
+    block = read_({block_idx}, fill_cache_).front();
+  }
+
+  next_prefetch_ = std::max(next_prefetch_, block_idx + 1);
+  maybe_prefetch_(block_idx);
+  return block;
+}
+
+size_t BlockReadahead::window() const { return window_; }
+
+size_t BlockReadahead::hits() const { return hits_; }
+
+void BlockReadahead::reset_(size_t block_idx) {
+  // 在途的预读无法取消, 它的结果仍然正确, 完成后照常放入缓冲区,
+  // 之后若不再被访问会随缓冲区的清理丢弃
+  buffer_.clear();
+  sequential_ = 0;
+  window_ = std::min(initial_blocks_, std::max<size_t>(max_blocks_, 1));
+  next_prefetch_ = block_idx + 1;
+}
+
+void BlockReadahead::collect_(bool wait) {
+  if (!inflight_.valid()) {
+    return;
+  }
+  if (!wait && inflight_.wait_for(std::chrono::seconds(0)) !=
+                   std::future_status::ready) {
+    return;
+  }
+  try {
+    auto blocks = inflight_.get();
+    for (size_t i = 0; i < blocks.size(); i++) {
+      buffer_[inflight_begin_ + i] = std::move(blocks[i]);
+    }
+  } catch (const std::exception &) {
+    // 预读失败时不报错, 需要的 block 之后由 get 同步读取
+  }
+}
+
+void BlockReadahead::maybe_prefetch_(size_t block_idx) {
+  if (max_blocks_ == 0 || sequential_ < kSequentialTrigger ||
+      inflight_.valid()) {
+    return;
+  }
+  if (next_prefetch_ >= num_blocks_ ||
+      next_prefetch_ - (block_idx + 1) > window_ / 2) {
+    return;
+  }
+
+  size_t begin = next_prefetch_;
+  size_t end = std::min(num_blocks_, begin + window_);
+  std::vector<size_t> block_idxs;
+  for (size_t i = begin; i < end; i++) {
+    block_idxs.push_back(i);
+  }
+  inflight_ = std::async(
+      std::launch::async,
+      [read = read_, block_idxs = std::move(block_idxs), fill = fill_cache_] {
+        return read(block_idxs, fill);
+      });
+  inflight_begin_ = begin;
+  inflight_end_ = end;
+  next_prefetch_ = end;
+  window_ = std::min(window_ * 2, max_blocks_);
+}
+} // namespace tiny_lsm
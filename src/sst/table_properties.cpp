@@ -0,0 +1,152 @@
+#include "sst/table_properties.h"
+#include "utils/crc32c.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+namespace {
+constexpr size_t kNumFields = 6;
+
+void put_u64(std::vector<uint8_t> &out, uint64_t value) {
+  auto p = reinterpret_cast<const uint8_t *>(&value);
+  out.insert(out.end(), p, p + sizeof(uint64_t));
+}
+
+uint64_t get_u64(const std::vector<uint8_t> &data, size_t &offset) {
+  uint64_t value;
+  memcpy(&value, data.data() + offset, sizeof(uint64_t));
+  offset += sizeof(uint64_t);
+  return value;
+}
+} // namespace
+
+void TableProperties::add(const std::string &key, size_t value_size,
+                          bool new_key, bool wisckey) {
+  num_entries++;
+  if (value_size == 0 && !key.empty()) {
+    num_tombstones++;
+  }
+  raw_key_bytes += key.size();
+  raw_value_bytes += value_size;
+  if (new_key) {
+    num_distinct_keys++;
+  }
+  if (wisckey) {
+    num_wisckey_values++;
+  }
+  key_size_histogram[key_size_bucket(key.size())]++;
+}
+
+void TableProperties::merge(const TableProperties &other) {
+  num_entries += other.num_entries;
+  num_tombstones += other.num_tombstones;
+  raw_key_bytes += other.raw_key_bytes;
+  raw_value_bytes += other.raw_value_bytes;
+  num_distinct_keys += other.num_distinct_keys;
+  num_wisckey_values += other.num_wisckey_values;
+  for (size_t i = 0; i < kKeySizeBuckets; i++) {
+    key_size_histogram[i] += other.key_size_histogram[i];
+  }
+}
+
+size_t TableProperties::key_size_bucket(size_t key_size) {
+  return (std::min)(static_cast<size_t>(std::bit_width(key_size)),
+                    kKeySizeBuckets - 1);
+}
+
+double TableProperties::average_key_size() const {
+  return num_entries == 0 ? 0 : static_cast<double>(raw_key_bytes) / num_entries;
+}
+
+double TableProperties::average_value_size() const {
+  return num_entries == 0 ? 0
+                          : static_cast<double>(raw_value_bytes) / num_entries;
+}
+
+std::vector<uint8_t> TableProperties::encode() const {
+  std::vector<uint8_t> out;
+  out.reserve(2 + (kNumFields + kKeySizeBuckets) * sizeof(uint64_t) +
+              sizeof(uint32_t));
+  out.push_back(static_cast<uint8_t>(kNumFields));
+  for (uint64_t field : {num_entries, num_tombstones, raw_key_bytes,
+                         raw_value_bytes, num_distinct_keys,
+                         num_wisckey_values}) {
+    put_u64(out, field);
+  }
+  out.push_back(static_cast<uint8_t>(kKeySizeBuckets));
+  for (uint64_t count : key_size_histogram) {
+    put_u64(out, count);
+  }
+  uint32_t crc = crc32c(out.data(), out.size());
+  auto p = reinterpret_cast<const uint8_t *>(&crc);
+  out.insert(out.end(), p, p + sizeof(uint32_t));
+  return out;
+}
+
+TableProperties TableProperties::decode(const std::vector<uint8_t> &data) {
+  if (data.size() < 2 + sizeof(uint32_t)) {
+    throw std::runtime_error("Table properties too small");
+  }
+  size_t body = data.size() - sizeof(uint32_t);
+  uint32_t crc;
+  memcpy(&crc, data.data() + body, sizeof(uint32_t));
+  if (crc != crc32c(data.data(), body)) {
+    throw std::runtime_error("Table properties checksum mismatch");
+  }
+
+  size_t offset = 0;
+  size_t num_fields = data[offset++];
+  if (offset + num_fields * sizeof(uint64_t) + 1 > body) {
+    throw std::runtime_error("Corrupted table properties");
+  }
+  uint64_t fields[kNumFields] = {};
+  for (size_t i = 0; i < num_fields; i++) {
+    uint64_t value = get_u64(data, offset);
+    if (i < kNumFields) {
+      fields[i] = value;
+    }
+  }
+  size_t num_buckets = data[offset++];
+  if (offset + num_buckets * sizeof(uint64_t) != body) {
+    throw std::runtime_error("Corrupted table properties");
+  }
+
+  TableProperties props;
+  props.num_entries = fields[0];
+  props.num_tombstones = fields[1];
+  props.raw_key_bytes = fields[2];
+  props.raw_value_bytes = fields[3];
+  props.num_distinct_keys = fields[4];
+  props.num_wisckey_values = fields[5];
+  for (size_t i = 0; i < num_buckets; i++) {
+    uint64_t count = get_u64(data, offset);
+    // 桶数变少时, 多出的长度都计入最后一个桶
+    props.key_size_histogram[(std::min)(i, kKeySizeBuckets - 1)] += count;
+  }
+  return props;
+}
+
+std::string TableProperties::to_string() const {
+  std::string hist;
+  for (size_t i = 0; i < kKeySizeBuckets; i++) {
+    if (key_size_histogram[i] == 0) {
+      continue;
+    }
+    size_t lower = i == 0 ? 0 : (size_t{1} << (i - 1));
+    if (!hist.empty()) {
+      hist += ' ';
+    }
+    hist += std::to_string(lower) + "+:" + std::to_string(key_size_histogram[i]);
+  }
+  return "entries=" + std::to_string(num_entries) +
+         " tombstones=" + std::to_string(num_tombstones) +
+         " distinct_keys=" + std::to_string(num_distinct_keys) +
+         " raw_key_bytes=" + std::to_string(raw_key_bytes) +
+         " raw_value_bytes=" + std::to_string(raw_value_bytes) +
+         " wisckey_values=" + std::to_string(num_wisckey_values) +
+         " key_sizes=[" + hist + "]";
+}
+} // namespace tiny_lsm
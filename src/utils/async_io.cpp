@@ -0,0 +1,515 @@
+// src/utils/async_io.cpp
+
+#include "utils/async_io.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TINY_LSM_IO_URING 1
+#endif
+#endif
+
+namespace tiny_lsm {
+
+namespace {
+// 读满 len 字节, 返回 0 或 errno
+int pread_full(int fd, uint8_t *buf, size_t len, uint64_t offset) {
+#ifdef _WIN32
+  return ENOSYS;
+#else
+  size_t done = 0;
+  while (done < len) {
+    ssize_t n = ::pread(fd, buf + done, len - done,
+                        static_cast<off_t>(offset + done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno;
+    }
+    if (n == 0) {
+      return EIO;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return 0;
+#endif
+}
+
+void run_request(ReadRequest &request) {
+  request.data.resize(request.length);
+  request.error = pread_full(request.fd, request.data.data(), request.length,
+                             request.offset);
+}
+
+// **************************************************
+// SyncIoEngine: 逐个 pread, 用于对比和调试
+// **************************************************
+
+class SyncIoEngine : public AsyncIoEngine {
+public:
+  void read_batch(std::vector<ReadRequest> &requests) override {
+    for (auto &request : requests) {
+      run_request(request);
+    }
+  }
+
+  std::string name() const override { return "sync"; }
+};
+
+// **************************************************
+// ThreadPoolIoEngine: 固定数量的线程执行 pread
+// **************************************************
+
+class ThreadPoolIoEngine : public AsyncIoEngine {
+public:
+  explicit ThreadPoolIoEngine(size_t threads) {
+    for (size_t i = 0; i < std::max<size_t>(threads, 1); i++) {
+      workers_.emplace_back([this] { worker_loop_(); });
+    }
+  }
+
+  ~ThreadPoolIoEngine() override {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void read_batch(std::vector<ReadRequest> &requests) override {
+    if (requests.empty()) {
+      return;
+    }
+    // 每个批次有自己的计数器, 多个批次可以在线程池中交错执行
+    std::mutex batch_mutex;
+    std::condition_variable batch_cv;
+    size_t remaining = requests.size();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto &request : requests) {
+        tasks_.emplace_back([&, req = &request] {
+          run_request(*req);
+          std::lock_guard<std::mutex> batch_lock(batch_mutex);
+          if (--remaining == 0) {
+            batch_cv.notify_one();
+          }
+        });
+      }
+    }
+    cv_.notify_all();
+    std::unique_lock<std::mutex> batch_lock(batch_mutex);
+    batch_cv.wait(batch_lock, [&] { return remaining == 0; });
+  }
+
+  std::string name() const override { return "threadpool"; }
+
+private:
+  void worker_loop_() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+
+#ifdef TINY_LSM_IO_URING
+// **************************************************
+// IoUringEngine: 直接使用 io_uring 系统调用, 不依赖 liburing
+// **************************************************
+
+// 一个 io_uring 实例, 同一时间只被一个批次使用
+class IoUring {
+public:
+  // 内核不支持时返回 nullptr
+  static std::unique_ptr<IoUring> create(unsigned entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring());
+    ring->fd_ = fd;
+    if (!ring->map_(params)) {
+      return nullptr;
+    }
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_len_);
+    }
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_len_);
+    }
+    if (sq_ptr_ != MAP_FAILED) {
+      munmap(sq_ptr_, sq_len_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  void read_batch(std::vector<ReadRequest> &requests) {
+    // 短读的请求从已读到的位置重新提交
+    std::vector<size_t> done(requests.size(), 0);
+    std::vector<iovec> iovs(requests.size());
+    std::vector<char> in_flight(requests.size(), 0);
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < requests.size(); i++) {
+      requests[i].data.resize(requests[i].length);
+      requests[i].error = 0;
+      if (requests[i].length > 0) {
+        pending.push_back(i);
+      }
+    }
+
+    size_t next = 0;
+    unsigned inflight = 0;
+    // 收割所有已完成的 CQE, 短读和可重试的错误重新加入 pending
+    auto reap = [&]() {
+      unsigned head = *cq_head_;
+      unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      while (head != cq_tail) {
+        const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+        size_t idx = static_cast<size_t>(cqe.user_data);
+        inflight--;
+        in_flight[idx] = 0;
+        if (cqe.res < 0) {
+          if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+            pending.push_back(idx);
+          } else {
+            requests[idx].error = -cqe.res;
+          }
+        } else if (cqe.res == 0) {
+          requests[idx].error = EIO;
+        } else {
+          done[idx] += static_cast<size_t>(cqe.res);
+          if (done[idx] < requests[idx].length) {
+            pending.push_back(idx);
+          }
+        }
+        head++;
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    };
+
+    while (next < pending.size() || inflight > 0) {
+      // 1. 填充 SQE, 在途请求数不超过队列深度
+      unsigned tail = *sq_tail_;
+      while (next < pending.size() && inflight < sq_entries_) {
+        size_t idx = pending[next++];
+        auto &request = requests[idx];
+        iovs[idx].iov_base = request.data.data() + done[idx];
+        iovs[idx].iov_len = request.length - done[idx];
+
+        unsigned slot = tail & *sq_mask_;
+        io_uring_sqe &sqe = sqes_[slot];
+        memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = request.fd;
+        sqe.off = request.offset + done[idx];
+        sqe.addr = reinterpret_cast<uint64_t>(&iovs[idx]);
+        sqe.len = 1;
+        sqe.user_data = idx;
+        sq_array_[slot] = slot;
+        tail++;
+        inflight++;
+        in_flight[idx] = 1;
+      }
+      __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+      // 2. 提交尚未被内核取走的 SQE, 并等待至少一个完成
+      while (true) {
+        unsigned to_submit = tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        int ret = enter_(to_submit, 1);
+        if (ret >= 0) {
+          break;
+        }
+        int err = errno;
+        if (err == EINTR) {
+          continue;
+        }
+        if (err != EAGAIN && err != EBUSY) {
+          abandon_(requests, done, iovs, in_flight, inflight, reap);
+          throw std::runtime_error(std::string("io_uring_enter failed: ") +
+                                   strerror(err));
+        }
+        // 内核暂时没有资源 (EAGAIN) 或完成队列已满 (EBUSY):
+        // 先收割已有的完成, 否则等待内核中的请求完成, 都没有时短暂退避
+        if (*cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+          break;
+        }
+        if (inflight > to_submit) {
+          enter_(0, 1);
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+
+      // 3. 收割 CQE
+      reap();
+    }
+  }
+
+  // 出错后 ring 中可能仍有请求, 不能再复用, 也不能释放
+  bool broken() const { return broken_; }
+
+private:
+  IoUring() = default;
+
+  int enter_(unsigned to_submit, unsigned min_complete) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd_, to_submit,
+                                    min_complete, IORING_ENTER_GETEVENTS,
+                                    nullptr, 0));
+  }
+
+  // io_uring_enter 出现不可重试的错误后, 在抛出异常前处理在途的请求:
+  // 撤回内核尚未取走的 SQE, 等待已提交的请求全部完成并收割,
+  // 保证返回后内核不会再写入 iovs 和请求的缓冲区
+  template <typename Reap>
+  void abandon_(std::vector<ReadRequest> &requests,
+                const std::vector<size_t> &done, std::vector<iovec> &iovs,
+                std::vector<char> &in_flight, unsigned &inflight, Reap &reap) {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    unsigned tail = *sq_tail_;
+    for (unsigned i = head; i != tail; i++) {
+      const io_uring_sqe &sqe = sqes_[sq_array_[i & *sq_mask_]];
+      size_t idx = static_cast<size_t>(sqe.user_data);
+      in_flight[idx] = 0;
+      inflight--;
+    }
+    __atomic_store_n(sq_tail_, head, __ATOMIC_RELEASE);
+
+    while (inflight > 0) {
+      if (enter_(0, 1) < 0 && errno != EINTR && errno != EAGAIN &&
+          errno != EBUSY) {
+        break;
+      }
+      reap();
+    }
+
+    for (size_t idx = 0; idx < requests.size(); idx++) {
+      // 没有读完的请求都视为失败
+      if (requests[idx].error == 0 && done[idx] < requests[idx].length) {
+        requests[idx].error = EIO;
+      }
+      if (in_flight[idx]) {
+        // 仍无法收割: 缓冲区交给一块永不释放的内存, 调用方得到新的缓冲区
+        new std::vector<uint8_t>(std::move(requests[idx].data));
+        requests[idx].data.assign(requests[idx].length, 0);
+        broken_ = true;
+      }
+    }
+    if (broken_) {
+      spdlog::error("IoUring--abandon_(): {} reads could not be reaped, "
+                    "leaking their buffers and the ring",
+                    inflight);
+      new std::vector<iovec>(std::move(iovs));
+    }
+  }
+
+
+  bool map_(const io_uring_params &params) {
+    sq_entries_ = params.sq_entries;
+    sq_len_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_len_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_len_ = cq_len_ = std::max(sq_len_, cq_len_);
+    }
+
+    sq_ptr_ = mmap(nullptr, sq_len_, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+    if (single_mmap) {
+      cq_ptr_ = sq_ptr_;
+    } else {
+      cq_ptr_ = mmap(nullptr, cq_len_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+      if (cq_ptr_ == MAP_FAILED) {
+        return false;
+      }
+    }
+    sqes_len_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      return false;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    auto sq = static_cast<uint8_t *>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto cq = static_cast<uint8_t *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  int fd_ = -1;
+  bool broken_ = false;
+  unsigned sq_entries_ = 0;
+  void *sq_ptr_ = MAP_FAILED;
+  void *cq_ptr_ = MAP_FAILED;
+  size_t sq_len_ = 0;
+  size_t cq_len_ = 0;
+  io_uring_sqe *sqes_ = static_cast<io_uring_sqe *>(MAP_FAILED);
+  size_t sqes_len_ = 0;
+  unsigned *sq_head_ = nullptr;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  io_uring_cqe *cqes_ = nullptr;
+};
+
+class IoUringEngine : public AsyncIoEngine {
+public:
+  // 创建第一个 ring 以确认内核支持, 失败时返回 nullptr
+  static std::unique_ptr<IoUringEngine> create(unsigned queue_depth) {
+    auto ring = IoUring::create(queue_depth);
+    if (!ring) {
+      return nullptr;
+    }
+    std::unique_ptr<IoUringEngine> engine(new IoUringEngine(queue_depth));
+    engine->idle_.push_back(std::move(ring));
+    return engine;
+  }
+
+  void read_batch(std::vector<ReadRequest> &requests) override {
+    if (requests.empty()) {
+      return;
+    }
+    // ring 的提交和收割不是线程安全的, 每个并发的批次独占一个 ring,
+    // 用完后放回空闲列表, ring 的数量等于历史上的最大并发批次数
+    std::unique_ptr<IoUring> ring;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_.empty()) {
+        ring = std::move(idle_.back());
+        idle_.pop_back();
+      }
+    }
+    if (!ring) {
+      ring = IoUring::create(queue_depth_);
+    }
+    if (!ring) {
+      // 达到了 io_uring 实例数量的限制
+      for (auto &request : requests) {
+        run_request(request);
+      }
+      return;
+    }
+    try {
+      ring->read_batch(requests);
+    } catch (...) {
+      release_(std::move(ring));
+      throw;
+    }
+    release_(std::move(ring));
+  }
+
+  std::string name() const override { return "io_uring"; }
+
+private:
+  explicit IoUringEngine(unsigned queue_depth) : queue_depth_(queue_depth) {}
+
+  void release_(std::unique_ptr<IoUring> ring) {
+    if (ring->broken()) {
+      // 内核可能仍在使用 ring 的内存, 故意泄漏
+      ring.release();
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_.push_back(std::move(ring));
+  }
+
+  unsigned queue_depth_;
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<IoUring>> idle_;
+};
+#endif
+} // namespace
+
+bool io_uring_supported() {
+#ifdef TINY_LSM_IO_URING
+  static const bool supported = IoUring::create(1) != nullptr;
+  return supported;
+#else
+  return false;
+#endif
+}
+
+std::unique_ptr<AsyncIoEngine>
+AsyncIoEngine::create(const std::string &kind, size_t queue_depth,
+                      size_t threads) {
+  if (kind == "sync") {
+    return std::make_unique<SyncIoEngine>();
+  }
+  if (kind == "io_uring") {
+#ifdef TINY_LSM_IO_URING
+    auto engine =
+        IoUringEngine::create(static_cast<unsigned>(std::max<size_t>(queue_depth, 1)));
+    if (engine) {
+      return engine;
+    }
+#endif
+    spdlog::warn("io_uring is not available, falling back to a pread thread "
+                 "pool with {} threads",
+                 threads);
+    return std::make_unique<ThreadPoolIoEngine>(threads);
+  }
+  if (kind == "threadpool") {
+    return std::make_unique<ThreadPoolIoEngine>(threads);
+  }
+  throw std::invalid_argument("unknown async io engine: " + kind);
+}
+} // namespace tiny_lsm
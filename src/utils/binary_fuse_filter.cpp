@@ -0,0 +1,278 @@
+// src/utils/binary_fuse_filter.cpp
+
+#include "utils/binary_fuse_filter.h"
+#include "utils/crc32c.h"
+#include "utils/hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+namespace {
+constexpr uint32_t kMaxSegmentLength = 1 << 18;
+constexpr int kMaxAttempts = 100;
+constexpr size_t kHeaderSize =
+    sizeof(uint64_t) + sizeof(uint32_t) * 3;
+
+// 构建时更换 seed 使用的序列
+uint64_t splitmix64(uint64_t &state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// key_hash 与 seed 混合, 换 seed 即换一组哈希函数
+uint64_t mix(uint64_t key_hash, uint64_t seed) {
+  uint64_t h = key_hash + seed;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+uint64_t mulhi(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+  return static_cast<uint64_t>((static_cast<__uint128_t>(a) * b) >> 64);
+#else
+  uint64_t a_lo = static_cast<uint32_t>(a), a_hi = a >> 32;
+  uint64_t b_lo = static_cast<uint32_t>(b), b_hi = b >> 32;
+  uint64_t lo_lo = a_lo * b_lo;
+  uint64_t hi_lo = a_hi * b_lo;
+  uint64_t lo_hi = a_lo * b_hi;
+  uint64_t cross = (lo_lo >> 32) + static_cast<uint32_t>(hi_lo) + lo_hi;
+  return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+#endif
+}
+
+inline uint8_t mod3(uint8_t x) { return x > 2 ? x - 3 : x; }
+} // namespace
+
+BinaryFuseFilter::BinaryFuseFilter(FilterFormat format)
+    : format_(format),
+      fingerprint_bytes_(format == FilterFormat::BinaryFuse16 ? 2 : 1) {
+  if (format != FilterFormat::BinaryFuse8 &&
+      format != FilterFormat::BinaryFuse16) {
+    throw std::invalid_argument("not a binary fuse filter format");
+  }
+}
+
+void BinaryFuseFilter::init_layout_(size_t num_keys) {
+  // 参数取自论文作者的参考实现 (3 路)
+  double n = static_cast<double>(num_keys);
+  segment_length_ =
+      num_keys == 0
+          ? 4
+          : 1U << static_cast<int>(std::floor(std::log(n) / std::log(3.33) +
+                                              2.25));
+  segment_length_ = std::min(segment_length_, kMaxSegmentLength);
+  double size_factor =
+      num_keys <= 1
+          ? 0
+          : std::max(1.125, 0.875 + 0.25 * std::log(1000000.0) / std::log(n));
+  size_t capacity = static_cast<size_t>(std::round(n * size_factor));
+  size_t segments = (capacity + segment_length_ - 1) / segment_length_;
+  segment_count_ = segments > 3 ? static_cast<uint32_t>(segments - 2) : 1;
+  num_keys_ = static_cast<uint32_t>(num_keys);
+}
+
+void BinaryFuseFilter::slots_(uint64_t hash, uint32_t slots[3]) const {
+  uint64_t segment_count_length =
+      static_cast<uint64_t>(segment_count_) * segment_length_;
+  uint32_t mask = segment_length_ - 1;
+  slots[0] = static_cast<uint32_t>(mulhi(hash, segment_count_length));
+  slots[1] = (slots[0] + segment_length_) ^
+             (static_cast<uint32_t>(hash >> 18) & mask);
+  slots[2] = (slots[0] + 2 * segment_length_) ^
+             (static_cast<uint32_t>(hash) & mask);
+}
+
+uint32_t BinaryFuseFilter::fingerprint_(uint64_t hash) const {
+  uint64_t f = hash ^ (hash >> 32);
+  return fingerprint_bytes_ == 1 ? static_cast<uint8_t>(f)
+                                 : static_cast<uint16_t>(f);
+}
+
+uint32_t BinaryFuseFilter::get_(size_t slot) const {
+  if (fingerprint_bytes_ == 1) {
+    return fingerprints_[slot];
+  }
+  uint16_t value;
+  memcpy(&value, fingerprints_.data() + slot * 2, sizeof(uint16_t));
+  return value;
+}
+
+void BinaryFuseFilter::set_(size_t slot, uint32_t value) {
+  if (fingerprint_bytes_ == 1) {
+    fingerprints_[slot] = static_cast<uint8_t>(value);
+    return;
+  }
+  uint16_t v = static_cast<uint16_t>(value);
+  memcpy(fingerprints_.data() + slot * 2, &v, sizeof(uint16_t));
+}
+
+bool BinaryFuseFilter::populate_(const std::vector<uint64_t> &hashes) {
+  size_t array_length =
+      static_cast<size_t>(segment_count_ + 2) * segment_length_;
+  size_t n = hashes.size();
+  fingerprints_.assign(array_length * fingerprint_bytes_, 0);
+
+  // t2count: 高 6 位为使用该槽位的 key 数, 低 2 位为这些 key 在各自
+  // 三个槽位中的序号 (0/1/2) 的异或; t2hash: 这些 key 的哈希的异或
+  // 只剩一个 key 时, 两者恰好是这个 key 的序号和哈希
+  std::vector<uint8_t> t2count(array_length, 0);
+  std::vector<uint64_t> t2hash(array_length, 0);
+  for (auto key_hash : hashes) {
+    uint64_t h = mix(key_hash, seed_);
+    uint32_t s[3];
+    slots_(h, s);
+    for (uint8_t i = 0; i < 3; i++) {
+      if (t2count[s[i]] >= 0xfc) {
+        return false; // 计数溢出
+      }
+      t2count[s[i]] += 4;
+      t2count[s[i]] ^= i;
+      t2hash[s[i]] ^= h;
+    }
+  }
+
+  // 剥离: 反复取出只被一个 key 使用的槽位, 把这个 key 从另外两个槽位中删除
+  std::vector<uint32_t> alone;
+  for (size_t i = 0; i < array_length; i++) {
+    if ((t2count[i] >> 2) == 1) {
+      alone.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  std::vector<uint64_t> reverse_order;
+  std::vector<uint8_t> reverse_found;
+  reverse_order.reserve(n);
+  reverse_found.reserve(n);
+  while (!alone.empty()) {
+    uint32_t idx = alone.back();
+    alone.pop_back();
+    if ((t2count[idx] >> 2) != 1) {
+      continue;
+    }
+    uint64_t h = t2hash[idx];
+    uint8_t found = t2count[idx] & 3;
+    reverse_order.push_back(h);
+    reverse_found.push_back(found);
+
+    uint32_t s[5];
+    slots_(h, s);
+    s[3] = s[0];
+    s[4] = s[1];
+    for (uint8_t k = 1; k <= 2; k++) {
+      uint32_t other = s[found + k];
+      if ((t2count[other] >> 2) == 2) {
+        alone.push_back(other);
+      }
+      t2count[other] -= 4;
+      t2count[other] ^= mod3(found + k);
+      t2hash[other] ^= h;
+    }
+  }
+  if (reverse_order.size() != n) {
+    return false;
+  }
+
+  // 按剥离的相反顺序赋值: 每个 key 的槽位在它之后剥离的 key 中不会再被使用
+  for (size_t i = n; i-- > 0;) {
+    uint64_t h = reverse_order[i];
+    uint8_t found = reverse_found[i];
+    uint32_t s[5];
+    slots_(h, s);
+    s[3] = s[0];
+    s[4] = s[1];
+    set_(s[found], fingerprint_(h) ^ get_(s[found + 1]) ^ get_(s[found + 2]));
+  }
+  return true;
+}
+
+BinaryFuseFilter BinaryFuseFilter::build(const std::vector<uint64_t> &key_hashes,
+                                         FilterFormat format) {
+  BinaryFuseFilter filter(format);
+  // 重复的 key 会让剥离无法完成
+  std::vector<uint64_t> hashes(key_hashes);
+  std::sort(hashes.begin(), hashes.end());
+  hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+  filter.init_layout_(hashes.size());
+
+  uint64_t state = 0x726b2b9d438b9d4dULL;
+  for (int attempt = 0; attempt < kMaxAttempts; attempt++) {
+    filter.seed_ = splitmix64(state);
+    if (filter.populate_(hashes)) {
+      return filter;
+    }
+    if (attempt % 10 == 9) {
+      // key 很少时布局的余量不足, 逐步增加 segment
+      filter.segment_count_++;
+    }
+  }
+  throw std::runtime_error("Failed to build binary fuse filter");
+}
+
+FilterFormat BinaryFuseFilter::format() const { return format_; }
+
+bool BinaryFuseFilter::possibly_contains(const std::string &key) const {
+  return possibly_contains_hash(hash64(key));
+}
+
+bool BinaryFuseFilter::possibly_contains_hash(uint64_t hash) const {
+  uint64_t h = mix(hash, seed_);
+  uint32_t s[3];
+  slots_(h, s);
+  return (fingerprint_(h) ^ get_(s[0]) ^ get_(s[1]) ^ get_(s[2])) == 0;
+}
+
+size_t BinaryFuseFilter::size_bytes() const { return fingerprints_.size(); }
+
+std::vector<uint8_t> BinaryFuseFilter::encode() {
+  std::vector<uint8_t> data(kHeaderSize);
+  uint8_t *p = data.data();
+  memcpy(p, &seed_, sizeof(uint64_t));
+  memcpy(p + 8, &segment_length_, sizeof(uint32_t));
+  memcpy(p + 12, &segment_count_, sizeof(uint32_t));
+  memcpy(p + 16, &num_keys_, sizeof(uint32_t));
+  data.insert(data.end(), fingerprints_.begin(), fingerprints_.end());
+  uint32_t crc = crc32c(data.data(), data.size());
+  auto crc_bytes = reinterpret_cast<const uint8_t *>(&crc);
+  data.insert(data.end(), crc_bytes, crc_bytes + sizeof(uint32_t));
+  return data;
+}
+
+BinaryFuseFilter BinaryFuseFilter::decode(const std::vector<uint8_t> &data,
+                                          FilterFormat format) {
+  BinaryFuseFilter filter(format);
+  if (data.size() < kHeaderSize + sizeof(uint32_t)) {
+    throw std::runtime_error("Binary fuse filter too small");
+  }
+  const uint8_t *p = data.data();
+  memcpy(&filter.seed_, p, sizeof(uint64_t));
+  memcpy(&filter.segment_length_, p + 8, sizeof(uint32_t));
+  memcpy(&filter.segment_count_, p + 12, sizeof(uint32_t));
+  memcpy(&filter.num_keys_, p + 16, sizeof(uint32_t));
+  if (filter.segment_length_ == 0 ||
+      (filter.segment_length_ & (filter.segment_length_ - 1)) != 0 ||
+      filter.segment_length_ > kMaxSegmentLength ||
+      filter.segment_count_ == 0) {
+    throw std::runtime_error("Invalid binary fuse filter layout");
+  }
+  size_t array_bytes = static_cast<size_t>(filter.segment_count_ + 2) *
+                       filter.segment_length_ * filter.fingerprint_bytes_;
+  if (data.size() != kHeaderSize + array_bytes + sizeof(uint32_t)) {
+    throw std::runtime_error("Invalid binary fuse filter size");
+  }
+  uint32_t stored_crc;
+  memcpy(&stored_crc, p + data.size() - sizeof(uint32_t), sizeof(uint32_t));
+  if (crc32c(p, data.size() - sizeof(uint32_t)) != stored_crc) {
+    throw std::runtime_error("Binary fuse filter checksum verification failed");
+  }
+  filter.fingerprints_.assign(p + kHeaderSize, p + kHeaderSize + array_bytes);
+  return filter;
+}
+} // namespace tiny_lsm
@@ -1,42 +1,133 @@
 // include/utils/bloom_filter.cpp
 
 #include "utils/bloom_filter.h"
+#include "utils/crc32c.h"
+#include "utils/hash.h"
+#include <algorithm>
 #include <cstring>
 #include <functional>
 #include <cmath>
+#include <stdexcept>
 #include <string>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
 namespace tiny_lsm {
 
 BloomFilter::BloomFilter() {};
 
+namespace {
+// 每个 lane 的哈希乘数 (奇数), 与 Parquet 的 split block bloom filter 相同
+alignas(32) constexpr uint32_t kSalts[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+inline uint32_t lane_mask(uint32_t key, size_t lane) {
+  return 1U << ((key * kSalts[lane]) >> 27);
+}
+
+bool block_contains_portable(const uint32_t *block, uint32_t key) {
+  // 不提前返回, 8 个 lane 的计算可以被编译器向量化
+  uint32_t missing = 0;
+  for (size_t i = 0; i < 8; i++) {
+    missing |= ~block[i] & lane_mask(key, i);
+  }
+  return missing == 0;
+}
+
+#if defined(__x86_64__) || defined(_M_X64)
+__attribute__((target("avx2"))) bool block_contains_avx2(const uint32_t *block,
+                                                        uint32_t key) {
+  __m256i salts = _mm256_load_si256(reinterpret_cast<const __m256i *>(kSalts));
+  __m256i shifts =
+      _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(key), salts), 27);
+  __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), shifts);
+  __m256i bits = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+  // (~bits & mask) == 0
+  return _mm256_testc_si256(bits, mask);
+}
+
+bool detect_avx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+#endif
+
+inline bool block_contains(const uint32_t *block, uint32_t key) {
+#if defined(__x86_64__) || defined(_M_X64)
+  static const bool avx2 = detect_avx2();
+  if (avx2) {
+    return block_contains_avx2(block, key);
+  }
+#endif
+  return block_contains_portable(block, key);
+}
+
+// 假阳性率为 p 时每个 key 需要的位数
+// 每个 lane 32 位, 每个 key 在其中置一位: p ~= (1 - e^(-8 / bits_per_key))^8,
+// 再多分配 10% 抵消各 block 中 key 数不均匀带来的损失
+double bits_per_key_for(double p) {
+  p = std::min(std::max(p, 1e-9), 0.5);
+  return 1.1 * -8.0 / std::log(1.0 - std::pow(p, 1.0 / 8));
+}
+} // namespace
+
 // 构造函数，初始化布隆过滤器
 // expected_elements: 预期插入的元素数量
 // false_positive_rate: 允许的假阳性率
 BloomFilter::BloomFilter(size_t expected_elements, double false_positive_rate)
     : expected_elements_(expected_elements),
       false_positive_rate_(false_positive_rate) {
-  // 计算布隆过滤器的位数组大小
-  double m = -static_cast<double>(expected_elements) *
-             std::log(false_positive_rate) / std::pow(std::log(2), 2);
+  init_blocks_(static_cast<size_t>(std::ceil(
+      std::max<size_t>(expected_elements, 1) *
+      bits_per_key_for(false_positive_rate))));
+}
+
+BloomFilter BloomFilter::build(const std::vector<uint64_t> &key_hashes,
+                               double bits_per_key) {
+  BloomFilter bf;
+  bf.init_blocks_(static_cast<size_t>(
+      std::ceil(std::max<size_t>(key_hashes.size(), 1) * bits_per_key)));
+  for (auto h : key_hashes) {
+    bf.insert_hash_(h);
+  }
+  return bf;
+}
 
-  num_bits_ = static_cast<size_t>(std::ceil(m));
+uint64_t BloomFilter::key_hash(std::string_view key) { return hash64(key); }
 
-  // 计算哈希函数的数量
-  num_hashes_ =
-      static_cast<size_t>(std::ceil(m / expected_elements * std::log(2)));
+void BloomFilter::init_blocks_(size_t num_bits) {
+  format_ = FilterFormat::BlockedBloom;
+  num_blocks_ = std::max<size_t>(1, (num_bits + kBitsPerBlock - 1) /
+                                        kBitsPerBlock);
+  blocks_.assign(num_blocks_ * kLanes, 0);
+  num_keys_ = 0;
+}
 
-  // #ifdef LSM_DEBUG
-  //   std::cout << "Calculated m: " << m << std::endl;
-  //   std::cout << "Calculated num_bits_: " << num_bits_ << std::endl;
-  //   std::cout << "Calculated num_hashes_: " << num_hashes_ << std::endl;
-  // #endif
+void BloomFilter::insert_hash_(uint64_t hash) {
+  // 高 32 位映射到 [0, num_blocks_), 避免取模
+  size_t block = ((hash >> 32) * num_blocks_) >> 32;
+  uint32_t key = static_cast<uint32_t>(hash);
+  uint32_t *words = blocks_.data() + block * kLanes;
+  for (size_t i = 0; i < kLanes; i++) {
+    words[i] |= lane_mask(key, i);
+  }
+  num_keys_++;
+}
 
-  // 初始化位数组
-  bits_.resize(num_bits_, false);
+bool BloomFilter::possibly_contains_hash(uint64_t hash) const {
+  size_t block = ((hash >> 32) * num_blocks_) >> 32;
+  return block_contains(blocks_.data() + block * kLanes,
+                        static_cast<uint32_t>(hash));
 }
 
 void BloomFilter::add(const std::string &key) {
+  if (format_ == FilterFormat::BlockedBloom) {
+    insert_hash_(key_hash(key));
+    return;
+  }
   // 对每个哈希函数计算哈希值，并将对应位置的位设置为true
   for (size_t i = 0; i < num_hashes_; ++i) {
     bits_[hash(key, i)] = true;
@@ -45,6 +136,9 @@ void BloomFilter::add(const std::string &key) {
 
 //  如果key可能存在于布隆过滤器中，返回true；否则返回false
 bool BloomFilter::possibly_contains(const std::string &key) const {
+  if (format_ == FilterFormat::BlockedBloom) {
+    return possibly_contains_hash(key_hash(key));
+  }
   // 对每个哈希函数计算哈希值，检查对应位置的位是否都为true
   for (size_t i = 0; i < num_hashes_; ++i) {
     auto bit_idx = hash(key, i);
@@ -56,7 +150,20 @@ bool BloomFilter::possibly_contains(const std::string &key) const {
 }
 
 // 清空布隆过滤器
-void BloomFilter::clear() { bits_.assign(bits_.size(), false); }
+void BloomFilter::clear() {
+  blocks_.assign(blocks_.size(), 0);
+  num_keys_ = 0;
+  bits_.assign(bits_.size(), false);
+}
+
+FilterFormat BloomFilter::format() const { return format_; }
+
+size_t BloomFilter::size_bytes() const {
+  if (format_ == FilterFormat::BlockedBloom) {
+    return blocks_.size() * sizeof(uint32_t);
+  }
+  return (num_bits_ + 7) / 8;
+}
 
 size_t BloomFilter::hash1(const std::string &key) const {
   std::hash<std::string> hasher;
@@ -78,6 +185,20 @@ size_t BloomFilter::hash(const std::string &key, size_t idx) const {
 std::vector<uint8_t> BloomFilter::encode() {
   std::vector<uint8_t> data;
 
+  if (format_ == FilterFormat::BlockedBloom) {
+    uint32_t header[2] = {static_cast<uint32_t>(num_blocks_),
+                          static_cast<uint32_t>(num_keys_)};
+    auto header_bytes = reinterpret_cast<const uint8_t *>(header);
+    data.insert(data.end(), header_bytes, header_bytes + sizeof(header));
+    auto block_bytes = reinterpret_cast<const uint8_t *>(blocks_.data());
+    data.insert(data.end(), block_bytes,
+                block_bytes + blocks_.size() * sizeof(uint32_t));
+    uint32_t crc = crc32c(data.data(), data.size());
+    auto crc_bytes = reinterpret_cast<const uint8_t *>(&crc);
+    data.insert(data.end(), crc_bytes, crc_bytes + sizeof(uint32_t));
+    return data;
+  }
+
   // 编码 expected_elements_
   data.insert(data.end(),
               reinterpret_cast<const uint8_t *>(&expected_elements_),
@@ -116,7 +237,38 @@ std::vector<uint8_t> BloomFilter::encode() {
 }
 
 // 从 std::vector<uint8_t> 解码布隆过滤器
-BloomFilter BloomFilter::decode(const std::vector<uint8_t> &data) {
+BloomFilter BloomFilter::decode(const std::vector<uint8_t> &data,
+                                FilterFormat format) {
+  if (format == FilterFormat::BlockedBloom) {
+    uint32_t header[2];
+    if (data.size() < sizeof(header) + sizeof(uint32_t)) {
+      throw std::runtime_error("Bloom filter too small");
+    }
+    memcpy(header, data.data(), sizeof(header));
+    size_t blocks_size = static_cast<size_t>(header[0]) * kLanes *
+                         sizeof(uint32_t);
+    if (header[0] == 0 ||
+        data.size() != sizeof(header) + blocks_size + sizeof(uint32_t)) {
+      throw std::runtime_error("Invalid bloom filter size");
+    }
+    uint32_t stored_crc;
+    memcpy(&stored_crc, data.data() + data.size() - sizeof(uint32_t),
+           sizeof(uint32_t));
+    if (crc32c(data.data(), data.size() - sizeof(uint32_t)) != stored_crc) {
+      throw std::runtime_error("Bloom filter checksum verification failed");
+    }
+    BloomFilter bf;
+    bf.num_blocks_ = header[0];
+    bf.num_keys_ = header[1];
+    bf.blocks_.resize(bf.num_blocks_ * kLanes);
+    memcpy(bf.blocks_.data(), data.data() + sizeof(header), blocks_size);
+    return bf;
+  }
+  if (format != FilterFormat::LegacyBloom) {
+    throw std::runtime_error("Unknown filter format " +
+                             std::to_string(static_cast<int>(format)));
+  }
+
   size_t index = 0;
 
   // 解码 expected_elements_
@@ -152,6 +304,7 @@ BloomFilter BloomFilter::decode(const std::vector<uint8_t> &data) {
   }
 
   BloomFilter bf;
+  bf.format_ = FilterFormat::LegacyBloom;
   bf.expected_elements_ = expected_elements;
   bf.false_positive_rate_ = false_positive_rate;
   bf.num_bits_ = num_bits;
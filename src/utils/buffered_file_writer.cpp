@@ -0,0 +1,89 @@
+// src/utils/buffered_file_writer.cpp
+
+#include "utils/buffered_file_writer.h"
+#include "config/config.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+BufferedFileWriter::BufferedFileWriter(const std::string &path,
+                                       size_t buffer_size)
+    : path_(path), file_(std::make_unique<StdFile>()) {
+  if (buffer_size == 0) {
+    buffer_size = static_cast<size_t>(
+        TomlConfig::getInstance().getLsmIoWriteBufferSize());
+  }
+  // 至少为一个页, 避免太小的配置退化为每次 append 一次写入
+  buffer_size_ = (std::max)(buffer_size, static_cast<size_t>(4096));
+  if (!file_->open(path, true)) {
+    throw std::runtime_error("Failed to create file: " + path);
+  }
+  buffer_.reserve(buffer_size_);
+}
+
+BufferedFileWriter::~BufferedFileWriter() {
+  if (!finished_) {
+    // 没有 finish 的文件是不完整的, 不能留在磁盘上被当作 SST 打开
+    file_->close();
+    file_->remove();
+  }
+}
+
+void BufferedFileWriter::append(const uint8_t *data, size_t size) {
+  if (finished_) {
+    throw std::logic_error("append after finish: " + path_);
+  }
+  if (buffer_.size() + size > buffer_size_) {
+    flush_();
+  }
+  if (size >= buffer_size_) {
+    // 大块数据不经过缓冲区
+    if (!file_->write(file_offset_, data, size)) {
+      throw std::runtime_error("Failed to write file: " + path_);
+    }
+    file_offset_ += size;
+    return;
+  }
+  buffer_.insert(buffer_.end(), data, data + size);
+}
+
+void BufferedFileWriter::append(const std::vector<uint8_t> &buf) {
+  append(buf.data(), buf.size());
+}
+
+size_t BufferedFileWriter::offset() const {
+  return file_offset_ + buffer_.size();
+}
+
+const std::string &BufferedFileWriter::path() const { return path_; }
+
+void BufferedFileWriter::finish() {
+  if (finished_) {
+    return;
+  }
+  flush_();
+  if (!file_->sync()) {
+    throw std::runtime_error("Failed to write file: " + path_);
+  }
+  file_->close();
+  finished_ = true;
+  spdlog::debug("BufferedFileWriter--finish(): Wrote {} bytes to '{}'",
+                file_offset_, path_);
+}
+
+bool BufferedFileWriter::finished() const { return finished_; }
+
+void BufferedFileWriter::flush_() {
+  if (buffer_.empty()) {
+    return;
+  }
+  if (!file_->write(file_offset_, buffer_.data(), buffer_.size())) {
+    // 缓冲区保持不变, offset() 仍然是已经 append 的字节数
+    throw std::runtime_error("Failed to write file: " + path_);
+  }
+  file_offset_ += buffer_.size();
+  buffer_.clear();
+}
+} // namespace tiny_lsm
@@ -0,0 +1,281 @@
+// src/utils/compression.cpp
+
+#include "utils/compression.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+// **************************************************
+// LZCodec
+// **************************************************
+// 数据由若干序列组成, 每个序列为:
+// | token (8) | literal_len 扩展 | literals | offset (16) | match_len 扩展 |
+// token 高 4 位为 literal 长度, 低 4 位为 match 长度 - 4, 取值 15 时
+// 后面跟若干字节的扩展 (每个字节累加, 直到遇到小于 255 的字节)
+// 最后一个序列只有 literals, 没有 offset 和 match
+
+namespace {
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 65535;
+constexpr size_t kHashBits = 12;
+
+inline uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(uint32_t));
+  return v;
+}
+
+inline uint32_t hash32(uint32_t v) {
+  return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+void write_length(size_t len, std::vector<uint8_t> &out) {
+  while (len >= 255) {
+    out.push_back(255);
+    len -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(len));
+}
+
+bool read_length(const uint8_t *src, size_t len, size_t &ip, size_t &value) {
+  uint8_t b;
+  do {
+    if (ip >= len) {
+      return false;
+    }
+    b = src[ip++];
+    value += b;
+  } while (b == 255);
+  return true;
+}
+
+void emit_sequence(const uint8_t *literals, size_t literal_len,
+                   size_t offset, size_t match_len,
+                   std::vector<uint8_t> &out) {
+  size_t ml = match_len == 0 ? 0 : match_len - kMinMatch;
+  uint8_t token = static_cast<uint8_t>((std::min<size_t>(literal_len, 15) << 4) |
+                                       std::min<size_t>(ml, 15));
+  out.push_back(token);
+  if (literal_len >= 15) {
+    write_length(literal_len - 15, out);
+  }
+  out.insert(out.end(), literals, literals + literal_len);
+  if (match_len == 0) {
+    return;
+  }
+  out.push_back(static_cast<uint8_t>(offset & 0xff));
+  out.push_back(static_cast<uint8_t>(offset >> 8));
+  if (ml >= 15) {
+    write_length(ml - 15, out);
+  }
+}
+} // namespace
+
+CompressionType LZCodec::type() const { return CompressionType::LZ; }
+
+std::string LZCodec::name() const { return "lz"; }
+
+void LZCodec::compress(const uint8_t *src, size_t len,
+                       std::vector<uint8_t> &out) const {
+  // 哈希表记录最近出现的 4 字节序列的位置 + 1, 0 表示空
+  std::array<uint32_t, 1 << kHashBits> table{};
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + kMinMatch <= len) {
+    uint32_t seq = read32(src + i);
+    uint32_t h = hash32(seq);
+    size_t cand = table[h];
+    table[h] = static_cast<uint32_t>(i + 1);
+    if (cand == 0 || i - (cand - 1) > kMaxOffset ||
+        read32(src + cand - 1) != seq) {
+      i++;
+      continue;
+    }
+    cand--;
+    size_t match_len = kMinMatch;
+    while (i + match_len < len && src[cand + match_len] == src[i + match_len]) {
+      match_len++;
+    }
+    emit_sequence(src + anchor, i - anchor, i - cand, match_len, out);
+    i += match_len;
+    anchor = i;
+  }
+  emit_sequence(src + anchor, len - anchor, 0, 0, out);
+}
+
+bool LZCodec::decompress(const uint8_t *src, size_t len, size_t raw_size,
+                         std::vector<uint8_t> &out) const {
+  size_t base = out.size();
+  out.resize(base + raw_size);
+  uint8_t *dst = out.data() + base;
+  size_t ip = 0;
+  size_t op = 0;
+  while (true) {
+    if (ip >= len) {
+      return false;
+    }
+    uint8_t token = src[ip++];
+    size_t literal_len = token >> 4;
+    if (literal_len == 15 && !read_length(src, len, ip, literal_len)) {
+      return false;
+    }
+    if (literal_len > len - ip || literal_len > raw_size - op) {
+      return false;
+    }
+    memcpy(dst + op, src + ip, literal_len);
+    ip += literal_len;
+    op += literal_len;
+    if (ip == len) {
+      // 最后一个序列
+      break;
+    }
+
+    if (len - ip < 2) {
+      return false;
+    }
+    size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+    ip += 2;
+    size_t match_len = token & 0x0f;
+    if (match_len == 15 && !read_length(src, len, ip, match_len)) {
+      return false;
+    }
+    match_len += kMinMatch;
+    if (offset == 0 || offset > op || match_len > raw_size - op) {
+      return false;
+    }
+    // 匹配可能与输出重叠, 逐字节复制
+    for (size_t k = 0; k < match_len; k++) {
+      dst[op + k] = dst[op - offset + k];
+    }
+    op += match_len;
+  }
+  if (op != raw_size) {
+    out.resize(base);
+    return false;
+  }
+  return true;
+}
+
+// **************************************************
+// 编解码器注册
+// **************************************************
+
+static std::array<std::shared_ptr<CompressionCodec>, 256> &codec_registry() {
+  static std::array<std::shared_ptr<CompressionCodec>, 256> registry = [] {
+    std::array<std::shared_ptr<CompressionCodec>, 256> r;
+    r[static_cast<uint8_t>(CompressionType::LZ)] = std::make_shared<LZCodec>();
+    return r;
+  }();
+  return registry;
+}
+
+void register_compression_codec(std::shared_ptr<CompressionCodec> codec) {
+  if (!codec || codec->type() == CompressionType::None) {
+    throw std::invalid_argument("invalid compression codec");
+  }
+  codec_registry()[static_cast<uint8_t>(codec->type())] = std::move(codec);
+}
+
+std::shared_ptr<CompressionCodec> get_compression_codec(CompressionType type) {
+  return codec_registry()[static_cast<uint8_t>(type)];
+}
+
+std::string compression_type_to_string(CompressionType type) {
+  auto codec = get_compression_codec(type);
+  return codec ? codec->name() : "none";
+}
+
+CompressionType compression_type_from_string(const std::string &name) {
+  if (name == "none") {
+    return CompressionType::None;
+  }
+  for (auto &codec : codec_registry()) {
+    if (codec && codec->name() == name) {
+      return codec->type();
+    }
+  }
+  throw std::invalid_argument("Unknown compression codec: " + name);
+}
+
+// **************************************************
+// Block trailer
+// **************************************************
+
+static constexpr size_t kTrailerSize = sizeof(uint32_t) + sizeof(uint8_t);
+
+std::vector<uint8_t> compress_block(const std::vector<uint8_t> &raw,
+                                    CompressionType type, double max_ratio) {
+  std::vector<uint8_t> stored;
+  auto codec = get_compression_codec(type);
+  if (codec) {
+    stored.reserve(raw.size() + kTrailerSize);
+    codec->compress(raw.data(), raw.size(), stored);
+    if (stored.size() > raw.size() * max_ratio) {
+      // 压缩收益太小, 读取时解压的开销不划算
+      stored.clear();
+      codec = nullptr;
+    }
+  }
+  if (!codec) {
+    type = CompressionType::None;
+    stored.assign(raw.begin(), raw.end());
+  }
+
+  uint32_t raw_size = static_cast<uint32_t>(raw.size());
+  size_t pos = stored.size();
+  stored.resize(pos + kTrailerSize);
+  memcpy(stored.data() + pos, &raw_size, sizeof(uint32_t));
+  stored[pos + sizeof(uint32_t)] = static_cast<uint8_t>(type);
+  return stored;
+}
+
+CompressionType block_compression_type(const std::vector<uint8_t> &stored) {
+  if (stored.size() < kTrailerSize) {
+    throw std::runtime_error("Compressed block too small");
+  }
+  return static_cast<CompressionType>(stored.back());
+}
+
+std::vector<uint8_t> decompress_block(const std::vector<uint8_t> &stored) {
+  auto type = block_compression_type(stored);
+  size_t payload_size = stored.size() - kTrailerSize;
+  uint32_t raw_size;
+  memcpy(&raw_size, stored.data() + payload_size, sizeof(uint32_t));
+
+  if (type == CompressionType::None) {
+    if (payload_size != raw_size) {
+      throw std::runtime_error("Uncompressed block size mismatch");
+    }
+    return std::vector<uint8_t>(stored.begin(), stored.begin() + payload_size);
+  }
+
+  auto codec = get_compression_codec(type);
+  if (!codec) {
+    throw std::runtime_error("Unknown block compression codec " +
+                             std::to_string(static_cast<int>(type)));
+  }
+  std::vector<uint8_t> raw;
+  raw.reserve(raw_size);
+  if (!codec->decompress(stored.data(), payload_size, raw_size, raw)) {
+    throw std::runtime_error("Block decompression failed");
+  }
+  return raw;
+}
+
+std::vector<uint8_t> decompress_block(std::vector<uint8_t> &&stored) {
+  if (block_compression_type(stored) != CompressionType::None) {
+    return decompress_block(static_cast<const std::vector<uint8_t> &>(stored));
+  }
+  size_t payload_size = stored.size() - kTrailerSize;
+  uint32_t raw_size;
+  memcpy(&raw_size, stored.data() + payload_size, sizeof(uint32_t));
+  if (payload_size != raw_size) {
+    throw std::runtime_error("Uncompressed block size mismatch");
+  }
+  stored.resize(payload_size);
+  return std::move(stored);
+}
+} // namespace tiny_lsm
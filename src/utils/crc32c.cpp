@@ -0,0 +1,125 @@
+// src/utils/crc32c.cpp
+
+#include "utils/crc32c.h"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <nmmintrin.h>
+#define TINY_LSM_CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define TINY_LSM_CRC32C_ARM 1
+#endif
+
+namespace tiny_lsm {
+
+namespace {
+constexpr uint32_t kPoly = 0x82F63B78; // 0x1EDC6F41 的反转形式
+
+// slicing-by-8 的查找表, tables[k][b] 为字节 b 之后再经过 k 个零字节的结果
+constexpr std::array<std::array<uint32_t, 256>, 8> make_tables() {
+  std::array<std::array<uint32_t, 256>, 8> tables{};
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int j = 0; j < 8; j++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? kPoly : 0);
+    }
+    tables[0][i] = crc;
+  }
+  for (uint32_t i = 0; i < 256; i++) {
+    for (int k = 1; k < 8; k++) {
+      uint32_t prev = tables[k - 1][i];
+      tables[k][i] = (prev >> 8) ^ tables[0][prev & 0xff];
+    }
+  }
+  return tables;
+}
+
+constexpr auto kTables = make_tables();
+
+#if defined(TINY_LSM_CRC32C_X86)
+__attribute__((target("sse4.2"))) uint32_t
+crc32c_extend_sse42(uint32_t crc, const uint8_t *data, size_t len) {
+  uint64_t c = crc;
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(uint64_t));
+    c = _mm_crc32_u64(c, word);
+    data += 8;
+    len -= 8;
+  }
+  uint32_t c32 = static_cast<uint32_t>(c);
+  while (len > 0) {
+    c32 = _mm_crc32_u8(c32, *data++);
+    len--;
+  }
+  return c32;
+}
+
+bool detect_sse42() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(TINY_LSM_CRC32C_ARM)
+uint32_t crc32c_extend_arm(uint32_t crc, const uint8_t *data, size_t len) {
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(uint64_t));
+    crc = __crc32cd(crc, word);
+    data += 8;
+    len -= 8;
+  }
+  while (len > 0) {
+    crc = __crc32cb(crc, *data++);
+    len--;
+  }
+  return crc;
+}
+#endif
+} // namespace
+
+uint32_t crc32c_extend_portable(uint32_t crc, const uint8_t *data,
+                                size_t len) {
+  crc = ~crc;
+  while (len >= 8) {
+    uint32_t lo, hi;
+    memcpy(&lo, data, sizeof(uint32_t));
+    memcpy(&hi, data + 4, sizeof(uint32_t));
+    lo ^= crc; // 按小端序处理
+    crc = kTables[7][lo & 0xff] ^ kTables[6][(lo >> 8) & 0xff] ^
+          kTables[5][(lo >> 16) & 0xff] ^ kTables[4][lo >> 24] ^
+          kTables[3][hi & 0xff] ^ kTables[2][(hi >> 8) & 0xff] ^
+          kTables[1][(hi >> 16) & 0xff] ^ kTables[0][hi >> 24];
+    data += 8;
+    len -= 8;
+  }
+  while (len > 0) {
+    crc = (crc >> 8) ^ kTables[0][(crc ^ *data++) & 0xff];
+    len--;
+  }
+  return ~crc;
+}
+
+bool crc32c_hw_accelerated() {
+#if defined(TINY_LSM_CRC32C_X86)
+  static const bool supported = detect_sse42();
+  return supported;
+#elif defined(TINY_LSM_CRC32C_ARM)
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint32_t crc32c_extend(uint32_t crc, const uint8_t *data, size_t len) {
+#if defined(TINY_LSM_CRC32C_X86)
+  if (crc32c_hw_accelerated()) {
+    return ~crc32c_extend_sse42(~crc, data, len);
+  }
+#elif defined(TINY_LSM_CRC32C_ARM)
+  return ~crc32c_extend_arm(~crc, data, len);
+#endif
+  return crc32c_extend_portable(crc, data, len);
+}
+} // namespace tiny_lsm
@@ -0,0 +1,73 @@
+// src/utils/dynamic_bloom.cpp
+
+#include "utils/dynamic_bloom.h"
+#include <algorithm>
+#include <functional>
+
+namespace tiny_lsm {
+
+DynamicBloom::DynamicBloom(size_t total_bits, uint32_t num_probes)
+    : num_blocks_(std::max<size_t>(
+          1, (total_bits + kBitsPerBlock - 1) / kBitsPerBlock)),
+      num_probes_(std::max<uint32_t>(1, num_probes)),
+      blocks_(new Block[num_blocks_]) {
+  for (size_t i = 0; i < num_blocks_; ++i) {
+    for (auto &word : blocks_[i].words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+uint64_t DynamicBloom::hash(std::string_view key) {
+  // std::hash 的低位质量一般, 再做一次 64 位混合 (splitmix64 的终结步骤)
+  uint64_t h = std::hash<std::string_view>{}(key);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+size_t DynamicBloom::block_index(uint64_t h) const {
+  // 高 32 位选块, 低 32 位用于块内探测
+  return (h >> 32) % num_blocks_;
+}
+
+void DynamicBloom::add(std::string_view key) {
+  uint64_t h = hash(key);
+  Block &block = blocks_[block_index(h)];
+  uint32_t h32 = static_cast<uint32_t>(h);
+  const uint32_t delta = (h32 >> 17) | (h32 << 15);
+  for (uint32_t i = 0; i < num_probes_; ++i) {
+    uint32_t bit = h32 % kBitsPerBlock;
+    uint64_t mask = 1ULL << (bit % 64);
+    auto &word = block.words[bit / 64];
+    // 已经置位时跳过写入, 避免缓存行在多个写线程间来回失效
+    if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+      word.fetch_or(mask, std::memory_order_release);
+    }
+    h32 += delta;
+  }
+}
+
+bool DynamicBloom::may_contain(std::string_view key) const {
+  uint64_t h = hash(key);
+  const Block &block = blocks_[block_index(h)];
+  uint32_t h32 = static_cast<uint32_t>(h);
+  const uint32_t delta = (h32 >> 17) | (h32 << 15);
+  for (uint32_t i = 0; i < num_probes_; ++i) {
+    uint32_t bit = h32 % kBitsPerBlock;
+    if ((block.words[bit / 64].load(std::memory_order_acquire) &
+         (1ULL << (bit % 64))) == 0) {
+      return false;
+    }
+    h32 += delta;
+  }
+  return true;
+}
+
+size_t DynamicBloom::memory_usage() const {
+  return sizeof(DynamicBloom) + num_blocks_ * sizeof(Block);
+}
+} // namespace tiny_lsm
@@ -1,29 +1,100 @@
 #include "utils/files.h"
+#include "utils/async_io.h"
 #include "utils/cursor.h"
 #include <cstring>
+#include <filesystem>
 #include <stdexcept>
 
 namespace tiny_lsm {
 FileObj::FileObj() : m_file(std::make_unique<StdFile>()) {}
 
-FileObj::~FileObj() = default;
+FileObj::~FileObj() {
+#ifndef _WIN32
+  close_read_fd_();
+#endif
+}
 
 // 实现移动语义
-FileObj::FileObj(FileObj &&other) noexcept : m_file(std::move(other.m_file)) {}
+FileObj::FileObj(FileObj &&other) noexcept
+    : m_file(std::move(other.m_file)),
+#ifndef _WIN32
+      m_mmap(std::move(other.m_mmap)), m_read_fd(other.m_read_fd.exchange(-1)),
+#endif
+      m_path(std::move(other.m_path)) {
+}
 
 FileObj &FileObj::operator=(FileObj &&other) noexcept {
   if (this != &other) {
     m_file = std::move(other.m_file);
+#ifndef _WIN32
+    m_mmap = std::move(other.m_mmap);
+    close_read_fd_();
+    m_read_fd = other.m_read_fd.exchange(-1);
+#endif
+    m_path = std::move(other.m_path);
   }
   return *this;
 }
 
-size_t FileObj::size() const { return m_file->size(); }
+#ifndef _WIN32
+int FileObj::read_fd_() {
+  int fd = m_read_fd.load();
+  if (fd >= 0 || m_path.empty()) {
+    return fd;
+  }
+  // 打开失败时 read_batch 退化为逐个读取
+  fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  int expected = -1;
+  if (!m_read_fd.compare_exchange_strong(expected, fd)) {
+    // 其他线程已经打开
+    ::close(fd);
+    return expected;
+  }
+  return fd;
+}
+
+void FileObj::close_read_fd_() {
+  int fd = m_read_fd.exchange(-1);
+  if (fd >= 0) {
+    ::close(fd);
+  }
+}
+#endif
 
-void FileObj::del_file() { m_file->remove(); }
+size_t FileObj::size() const {
+#ifndef _WIN32
+  if (m_mmap) {
+    return m_mmap->size();
+  }
+#endif
+  return m_file->size();
+}
+
+void FileObj::del_file() {
+#ifndef _WIN32
+  close_read_fd_();
+  if (m_mmap) {
+    // 映射的文件没有打开 fstream, 按路径删除
+    m_mmap->close();
+    m_mmap.reset();
+    std::error_code ec;
+    std::filesystem::remove(m_path, ec);
+    return;
+  }
+#endif
+  m_file->remove();
+}
+
+bool FileObj::writable_() const { return !is_mmapped(); }
 
 #ifndef _WIN32
 bool FileObj::truncate(size_t offset) {
+  if (!writable_()) {
+    return false;
+  }
   if (offset > m_file->size()) {
     throw std::out_of_range("Truncate offset beyond file size");
   }
@@ -42,6 +113,7 @@ FileObj FileObj::create_and_write(const std::string &path,
 
   // 同步到磁盘
   file_obj.m_file->sync();
+  file_obj.m_path = path;
 
   return std::move(file_obj);
 }
@@ -53,27 +125,138 @@ FileObj FileObj::open(const std::string &path, bool create) {
   if (!file_obj.m_file->open(path, create)) {
     throw std::runtime_error("Failed to open file: " + path);
   }
+  file_obj.m_path = path;
 
   return std::move(file_obj);
 }
 
+FileObj FileObj::open_mmap(const std::string &path) {
+#ifdef _WIN32
+  return open(path, false);
+#else
+  FileObj file_obj;
+  // 不打开 fstream: 读取全部走映射, 删除时按路径删除
+  file_obj.m_mmap = std::make_unique<MmapFile>();
+  if (!file_obj.m_mmap->open_readonly(path)) {
+    throw std::runtime_error("Failed to mmap file: " + path);
+  }
+  file_obj.m_path = path;
+  return file_obj;
+#endif
+}
+
+bool FileObj::is_mmapped() const {
+#ifndef _WIN32
+  return m_mmap != nullptr;
+#else
+  return false;
+#endif
+}
+
+void FileObj::advise(FileAccess access) {
+#ifndef _WIN32
+  if (!m_mmap) {
+    return;
+  }
+  switch (access) {
+  case FileAccess::Normal:
+    m_mmap->advise(MADV_NORMAL);
+    break;
+  case FileAccess::Random:
+    m_mmap->advise(MADV_RANDOM);
+    break;
+  case FileAccess::Sequential:
+    m_mmap->advise(MADV_SEQUENTIAL);
+    break;
+  }
+#endif
+}
+
+const uint8_t *FileObj::mapped_data(size_t offset, size_t length) const {
+#ifndef _WIN32
+  if (m_mmap && offset + length <= m_mmap->size()) {
+    return m_mmap->view(offset);
+  }
+#endif
+  return nullptr;
+}
+
 std::vector<uint8_t> FileObj::read_to_slice(size_t offset, size_t length) {
   // 检查边界
-  if (offset + length > m_file->size()) {
+  if (offset + length > size()) {
     throw std::out_of_range("Read beyond file size");
   }
 
+#ifndef _WIN32
+  if (m_mmap) {
+    return m_mmap->read(offset, length);
+  }
+#endif
   // 从w文件复制数据
   auto result = m_file->read(offset, length);
 
   return result;
 }
 
+std::vector<std::vector<uint8_t>>
+FileObj::read_batch(const std::vector<std::pair<size_t, size_t>> &ranges,
+                    AsyncIoEngine *engine) {
+  for (auto &[offset, length] : ranges) {
+    if (offset + length > size()) {
+      throw std::out_of_range("Read beyond file size");
+    }
+  }
+
+  std::vector<std::vector<uint8_t>> results;
+  results.reserve(ranges.size());
+#ifndef _WIN32
+  int fd = engine && ranges.size() > 1 ? read_fd_() : -1;
+  if (fd >= 0) {
+    std::vector<ReadRequest> requests(ranges.size());
+    for (size_t i = 0; i < ranges.size(); i++) {
+      requests[i].fd = fd;
+      requests[i].offset = ranges[i].first;
+      requests[i].length = ranges[i].second;
+    }
+    engine->read_batch(requests);
+    for (auto &request : requests) {
+      if (request.error != 0) {
+        throw std::runtime_error(std::string("Batch read failed: ") +
+                                 strerror(request.error));
+      }
+      results.push_back(std::move(request.data));
+    }
+    return results;
+  }
+
+  if (m_mmap) {
+    for (auto &[offset, length] : ranges) {
+      m_mmap->advise(MADV_WILLNEED, offset, length);
+    }
+    for (auto &[offset, length] : ranges) {
+      results.push_back(m_mmap->read(offset, length));
+    }
+    return results;
+  }
+#endif
+  for (auto &[offset, length] : ranges) {
+    results.push_back(m_file->read(offset, length));
+  }
+  return results;
+}
+
 uint8_t FileObj::read_uint8(size_t offset) {
   // 检查边界
-  if (offset + sizeof(uint8_t) > m_file->size()) {
+  if (offset + sizeof(uint8_t) > size()) {
     throw std::out_of_range("Read beyond file size");
   }
+#ifndef _WIN32
+  if (m_mmap) {
+    uint8_t value;
+    memcpy(&value, m_mmap->view(offset), sizeof(uint8_t));
+    return value;
+  }
+#endif
 
   // 从w文件复制数据
   auto result = m_file->read(offset, sizeof(uint8_t));
@@ -84,18 +267,32 @@ uint8_t FileObj::read_uint8(size_t offset) {
 
 uint16_t FileObj::read_uint16(size_t offset) {
   // 检查边界
-  if (offset + sizeof(uint16_t) > m_file->size()) {
+  if (offset + sizeof(uint16_t) > size()) {
     throw std::out_of_range("Read beyond file size");
   }
+#ifndef _WIN32
+  if (m_mmap) {
+    uint16_t value;
+    memcpy(&value, m_mmap->view(offset), sizeof(uint16_t));
+    return value;
+  }
+#endif
   auto result = m_file->read(offset, sizeof(uint16_t));
   return *(uint16_t *)result.data();
 }
 
 uint32_t FileObj::read_uint32(size_t offset) {
   // 检查边界
-  if (offset + sizeof(uint32_t) > m_file->size()) {
+  if (offset + sizeof(uint32_t) > size()) {
     throw std::out_of_range("Read beyond file size");
   }
+#ifndef _WIN32
+  if (m_mmap) {
+    uint32_t value;
+    memcpy(&value, m_mmap->view(offset), sizeof(uint32_t));
+    return value;
+  }
+#endif
 
   // 从w文件复制数据
   auto result = m_file->read(offset, sizeof(uint32_t));
@@ -106,9 +303,16 @@ uint32_t FileObj::read_uint32(size_t offset) {
 
 uint64_t FileObj::read_uint64(size_t offset) {
   // 检查边界
-  if (offset + sizeof(uint64_t) > m_file->size()) {
+  if (offset + sizeof(uint64_t) > size()) {
     throw std::out_of_range("Read beyond file size");
   }
+#ifndef _WIN32
+  if (m_mmap) {
+    uint64_t value;
+    memcpy(&value, m_mmap->view(offset), sizeof(uint64_t));
+    return value;
+  }
+#endif
 
   // 从w文件复制数据
   auto result = m_file->read(offset, sizeof(uint64_t));
@@ -119,11 +323,17 @@ uint64_t FileObj::read_uint64(size_t offset) {
 
 // 写入到文件
 bool FileObj::write(size_t offset, std::vector<uint8_t> &buf) {
+  if (!writable_()) {
+    return false;
+  }
   return m_file->write(offset, buf.data(), buf.size());
 }
 
 // 追加到文件
 bool FileObj::append(std::vector<uint8_t> &buf) {
+  if (!writable_()) {
+    return false;
+  }
   // 获取文件大小
   size_t file_size = m_file->size();
 
@@ -136,59 +346,92 @@ bool FileObj::append(std::vector<uint8_t> &buf) {
 }
 
 bool FileObj::write_int(size_t offset, int value) {
+  if (!writable_()) {
+    return false;
+  }
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(int));
 }
 
 bool FileObj::write_uint8(size_t offset, uint8_t value) {
+  if (!writable_()) {
+    return false;
+  }
   return m_file->write(offset, &value, sizeof(uint8_t));
 }
 
 bool FileObj::write_uint16(size_t offset, uint16_t value) {
+  if (!writable_()) {
+    return false;
+  }
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(uint16_t));
 }
 
 bool FileObj::write_uint32(size_t offset, uint32_t value) {
+  if (!writable_()) {
+    return false;
+  }
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(uint32_t));
 }
 
 bool FileObj::write_uint64(size_t offset, uint64_t value) {
+  if (!writable_()) {
+    return false;
+  }
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(uint64_t));
 }
 
 bool FileObj::append_int(int value) {
+  if (!writable_()) {
+    return false;
+  }
   size_t offset = m_file->size();
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(int));
 }
 
 bool FileObj::append_uint8(uint8_t value) {
+  if (!writable_()) {
+    return false;
+  }
   size_t offset = m_file->size();
   return m_file->write(offset, &value, sizeof(uint8_t));
 }
 
 bool FileObj::append_uint16(uint16_t value) {
+  if (!writable_()) {
+    return false;
+  }
   size_t offset = m_file->size();
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(uint16_t));
 }
 
 bool FileObj::append_uint32(uint32_t value) {
+  if (!writable_()) {
+    return false;
+  }
   size_t offset = m_file->size();
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(uint32_t));
 }
 
 bool FileObj::append_uint64(uint64_t value) {
+  if (!writable_()) {
+    return false;
+  }
   size_t offset = m_file->size();
   return m_file->write(offset, reinterpret_cast<const uint8_t *>(&value),
                        sizeof(uint64_t));
 }
 
-bool FileObj::sync() { return m_file->sync(); }
+bool FileObj::sync() {
+  // 只读映射没有需要同步的写入
+  return is_mmapped() || m_file->sync();
+}
 
 Cursor FileObj::get_cursor(FileObj &file_obj) {
   return Cursor(&file_obj, 0);
@@ -196,6 +439,13 @@ Cursor FileObj::get_cursor(FileObj &file_obj) {
 
 // 添加 close 函数
 void FileObj::close() {
+#ifndef _WIN32
+  close_read_fd_();
+  if (m_mmap) {
+    m_mmap->close();
+    m_mmap.reset();
+  }
+#endif
   m_file->close();
 }
 
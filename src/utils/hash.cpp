@@ -0,0 +1,56 @@
+// src/utils/hash.cpp
+
+#include "utils/hash.h"
+#include <cstring>
+
+namespace tiny_lsm {
+
+namespace {
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t round(uint64_t acc, uint64_t input) {
+  acc += input * kPrime2;
+  acc = rotl(acc, 31);
+  return acc * kPrime1;
+}
+} // namespace
+
+uint64_t hash64(const uint8_t *data, size_t len, uint64_t seed) {
+  // key 通常只有几十字节, 省去 XXH64 的 4 路并行累加, 逐个 8 字节混合
+  uint64_t h = seed + kPrime5 + static_cast<uint64_t>(len);
+  while (len >= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(uint64_t));
+    h ^= round(0, word);
+    h = rotl(h, 27) * kPrime1 + kPrime4;
+    data += 8;
+    len -= 8;
+  }
+  if (len >= 4) {
+    uint32_t word;
+    memcpy(&word, data, sizeof(uint32_t));
+    h ^= static_cast<uint64_t>(word) * kPrime1;
+    h = rotl(h, 23) * kPrime2 + kPrime3;
+    data += 4;
+    len -= 4;
+  }
+  while (len > 0) {
+    h ^= (*data++) * kPrime5;
+    h = rotl(h, 11) * kPrime1;
+    len--;
+  }
+  // 最终的雪崩混合
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+} // namespace tiny_lsm
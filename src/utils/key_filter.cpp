@@ -0,0 +1,68 @@
+// src/utils/key_filter.cpp
+
+#include "utils/key_filter.h"
+#include "utils/binary_fuse_filter.h"
+#include "utils/bloom_filter.h"
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+std::shared_ptr<KeyFilter>
+KeyFilter::build(FilterFormat format, const std::vector<uint64_t> &key_hashes,
+                 double bits_per_key) {
+  switch (format) {
+  case FilterFormat::BlockedBloom:
+    return std::make_shared<BloomFilter>(
+        BloomFilter::build(key_hashes, bits_per_key));
+  case FilterFormat::BinaryFuse8:
+  case FilterFormat::BinaryFuse16:
+    return std::make_shared<BinaryFuseFilter>(
+        BinaryFuseFilter::build(key_hashes, format));
+  default:
+    // LegacyBloom 只用于读取旧 SST
+    throw std::invalid_argument("Unsupported filter format for build");
+  }
+}
+
+std::shared_ptr<KeyFilter> KeyFilter::decode(const std::vector<uint8_t> &data,
+                                             FilterFormat format) {
+  switch (format) {
+  case FilterFormat::LegacyBloom:
+  case FilterFormat::BlockedBloom:
+    return std::make_shared<BloomFilter>(BloomFilter::decode(data, format));
+  case FilterFormat::BinaryFuse8:
+  case FilterFormat::BinaryFuse16:
+    return std::make_shared<BinaryFuseFilter>(
+        BinaryFuseFilter::decode(data, format));
+  default:
+    throw std::runtime_error("Unknown filter format");
+  }
+}
+
+std::string filter_format_to_string(FilterFormat format) {
+  switch (format) {
+  case FilterFormat::LegacyBloom:
+    return "legacy_bloom";
+  case FilterFormat::BlockedBloom:
+    return "bloom";
+  case FilterFormat::BinaryFuse8:
+    return "fuse8";
+  case FilterFormat::BinaryFuse16:
+    return "fuse16";
+  }
+  return "unknown";
+}
+
+FilterFormat filter_format_from_string(const std::string &name) {
+  if (name == "bloom") {
+    return FilterFormat::BlockedBloom;
+  }
+  if (name == "fuse8") {
+    return FilterFormat::BinaryFuse8;
+  }
+  if (name == "fuse16") {
+    return FilterFormat::BinaryFuse16;
+  }
+  throw std::invalid_argument("Unknown filter type: " + name);
+}
+} // namespace tiny_lsm
@@ -0,0 +1,121 @@
+// src/utils/memory_budget.cpp
+
+#include "utils/memory_budget.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace tiny_lsm {
+
+MemoryBudget::MemoryBudget(size_t limit) : limit_(limit) {}
+
+std::shared_ptr<MemoryBudget> MemoryBudget::global() {
+  static std::shared_ptr<MemoryBudget> instance =
+      std::make_shared<MemoryBudget>();
+  return instance;
+}
+
+uint64_t MemoryBudget::add_consumer(const std::string &name,
+                                    ConsumerType type, UsageFn usage,
+                                    ReclaimFn reclaim) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t id = next_id_++;
+  consumers_[id] = Consumer{name, type, std::move(usage), std::move(reclaim)};
+  return id;
+}
+
+void MemoryBudget::remove_consumer(uint64_t id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  consumers_.erase(id);
+}
+
+size_t MemoryBudget::usage_locked_(const ConsumerType *type) const {
+  size_t total = 0;
+  for (auto &[id, consumer] : consumers_) {
+    if (type && consumer.type != *type) {
+      continue;
+    }
+    total += consumer.usage();
+  }
+  return total;
+}
+
+size_t MemoryBudget::usage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return usage_locked_(nullptr);
+}
+
+size_t MemoryBudget::usage(ConsumerType type) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return usage_locked_(&type);
+}
+
+size_t MemoryBudget::limit() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return limit_;
+}
+
+void MemoryBudget::set_limit(size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  limit_ = limit;
+}
+
+bool MemoryBudget::exceeded() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return limit_ != 0 && usage_locked_(nullptr) > limit_;
+}
+
+size_t MemoryBudget::reclaim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (limit_ == 0) {
+    return 0;
+  }
+
+  // 每个消费者只查询一次占用, 之后根据回收量估算
+  std::vector<std::pair<size_t, Consumer *>> caches, memtables;
+  size_t total = 0;
+  for (auto &[id, consumer] : consumers_) {
+    size_t used = consumer.usage();
+    total += used;
+    if (consumer.type == ConsumerType::BlockCache) {
+      caches.emplace_back(used, &consumer);
+    } else {
+      memtables.emplace_back(used, &consumer);
+    }
+  }
+  if (total <= limit_) {
+    return 0;
+  }
+  size_t excess = total - limit_;
+
+  auto by_usage_desc = [](auto &a, auto &b) { return a.first > b.first; };
+  std::sort(caches.begin(), caches.end(), by_usage_desc);
+  std::sort(memtables.begin(), memtables.end(), by_usage_desc);
+
+  // 1. 块缓存可以同步释放
+  for (auto &[used, consumer] : caches) {
+    if (excess == 0) {
+      break;
+    }
+    if (!consumer->reclaim) {
+      continue;
+    }
+    size_t freed = consumer->reclaim(std::min(excess, used));
+    excess -= std::min(excess, freed);
+  }
+
+  // 2. memtable 只能触发刷盘, 按预计释放量决定需要刷几个
+  size_t expected = excess;
+  for (auto &[used, consumer] : memtables) {
+    if (expected == 0) {
+      break;
+    }
+    if (!consumer->reclaim || used == 0) {
+      continue;
+    }
+    consumer->reclaim(std::min(expected, used));
+    expected -= std::min(expected, used);
+  }
+  return excess;
+}
+} // namespace tiny_lsm
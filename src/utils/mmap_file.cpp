@@ -1,5 +1,6 @@
 #ifndef _WIN32
 #include "utils/mmap_file.h"
+#include <algorithm>
 #include <cstdint>
 #include <errno.h>
 #include <stdexcept>
@@ -44,6 +45,43 @@ bool MmapFile::open(const std::string &filename, bool create) {
   return true;
 }
 
+bool MmapFile::open_readonly(const std::string &filename) {
+  filename_ = filename;
+  fd_ = ::open(filename.c_str(), O_RDONLY);
+  if (fd_ == -1) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd_, &st) == -1) {
+    close();
+    return false;
+  }
+  file_size_ = st.st_size;
+
+  if (file_size_ > 0) {
+    mapped_data_ = mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapped_data_ == MAP_FAILED) {
+      mapped_data_ = nullptr;
+      close();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MmapFile::advise(int advice, size_t offset, size_t length) {
+  if (mapped_data_ == nullptr || offset >= file_size_) {
+    return false;
+  }
+  // madvise 要求起始地址按页对齐
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin = offset / page_size * page_size;
+  size_t end = length == 0 ? file_size_ : std::min(offset + length, file_size_);
+  return madvise(static_cast<uint8_t *>(mapped_data_) + begin, end - begin,
+                 advice) == 0;
+}
+
 bool MmapFile::create(const std::string &filename, const std::vector<uint8_t> &buf) {
   // 创建文件，设置大小并映射到内存
   if (!create_and_map(filename, buf.size())) {
@@ -97,9 +135,7 @@ bool MmapFile::write(size_t offset, const void *data, size_t size) {
   return true;
 }
 
-std::vector<uint8_t> MmapFile::read(size_t offset, size_t length) {
-  // 从映射的内存中复制数据
-  // 创建结果vector
+std::vector<uint8_t> MmapFile::read(size_t offset, size_t length) const {
   // 创建结果vector
   std::vector<uint8_t> result(length);
 
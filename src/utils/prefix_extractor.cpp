@@ -0,0 +1,125 @@
+// src/utils/prefix_extractor.cpp
+
+#include "utils/prefix_extractor.h"
+#include "config/config.h"
+#include <stdexcept>
+#include <vector>
+
+namespace tiny_lsm {
+
+namespace {
+
+class FixedPrefixExtractor : public PrefixExtractor {
+public:
+  FixedPrefixExtractor(size_t length, bool capped)
+      : length_(length), capped_(capped) {}
+
+  std::string name() const override {
+    return (capped_ ? "capped:" : "fixed:") + std::to_string(length_);
+  }
+
+  std::optional<std::string_view>
+  transform(std::string_view key) const override {
+    if (key.size() < length_) {
+      if (capped_) {
+        return key;
+      }
+      return std::nullopt;
+    }
+    return key.substr(0, length_);
+  }
+
+  std::optional<std::string_view>
+  transform_prefix(std::string_view prefix) const override {
+    // 短于 length_ 时以它开头的 key 的前缀各不相同
+    if (prefix.size() < length_) {
+      return std::nullopt;
+    }
+    return prefix.substr(0, length_);
+  }
+
+private:
+  size_t length_;
+  bool capped_;
+};
+
+class RedisPrefixExtractor : public PrefixExtractor {
+public:
+  RedisPrefixExtractor() {
+    const auto &config = TomlConfig::getInstance();
+    markers_ = {config.getRedisSetPrefix(), config.getRedisSortedSetPrefix()};
+  }
+
+  std::string name() const override { return "redis"; }
+
+  std::optional<std::string_view>
+  transform(std::string_view key) const override {
+    for (const auto &marker : markers_) {
+      if (key.substr(0, marker.size()) == marker) {
+        return until_separator_(key, marker.size());
+      }
+    }
+    return std::nullopt;
+  }
+
+  std::optional<std::string_view>
+  transform_prefix(std::string_view prefix) const override {
+    for (const auto &marker : markers_) {
+      // prefix 还不足以确定以它开头的 key 匹配哪个类型前缀
+      if (marker.size() > prefix.size() &&
+          std::string_view(marker).substr(0, prefix.size()) == prefix) {
+        return std::nullopt;
+      }
+    }
+    for (const auto &marker : markers_) {
+      if (prefix.substr(0, marker.size()) == marker) {
+        return until_separator_(prefix, marker.size());
+      }
+    }
+    return std::nullopt;
+  }
+
+private:
+  static std::optional<std::string_view> until_separator_(std::string_view key,
+                                                          size_t from) {
+    auto pos = key.find('_', from);
+    if (pos == std::string_view::npos) {
+      return std::nullopt;
+    }
+    return key.substr(0, pos + 1);
+  }
+
+  std::vector<std::string> markers_;
+};
+
+size_t parse_length(const std::string &spec, size_t colon) {
+  size_t length = 0;
+  try {
+    length = std::stoul(spec.substr(colon + 1));
+  } catch (...) {
+    throw std::invalid_argument("Invalid prefix extractor: " + spec);
+  }
+  if (length == 0) {
+    throw std::invalid_argument("Invalid prefix extractor: " + spec);
+  }
+  return length;
+}
+} // namespace
+
+std::shared_ptr<PrefixExtractor>
+PrefixExtractor::create(const std::string &spec) {
+  if (spec.empty() || spec == "none") {
+    return nullptr;
+  }
+  if (spec == "redis") {
+    return std::make_shared<RedisPrefixExtractor>();
+  }
+  auto colon = spec.find(':');
+  auto kind = spec.substr(0, colon);
+  if (colon != std::string::npos && (kind == "fixed" || kind == "capped")) {
+    return std::make_shared<FixedPrefixExtractor>(parse_length(spec, colon),
+                                                  kind == "capped");
+  }
+  throw std::invalid_argument("Invalid prefix extractor: " + spec);
+}
+} // namespace tiny_lsm
@@ -0,0 +1,248 @@
+// src/utils/range_filter.cpp
+
+#include "utils/range_filter.h"
+#include "utils/crc32c.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace tiny_lsm {
+
+namespace {
+constexpr uint8_t kLongHeader = 0xF0;
+// num_restarts, num_entries, crc32c
+constexpr size_t kTrailerSize = sizeof(uint32_t) * 3;
+
+void put_varint(std::vector<uint8_t> &out, size_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+size_t get_varint(const std::vector<uint8_t> &data, size_t &offset,
+                  size_t end) {
+  size_t value = 0;
+  for (int shift = 0; shift < 64 && offset < end; shift += 7) {
+    uint8_t byte = data[offset++];
+    value |= static_cast<size_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  throw std::runtime_error("Corrupted range filter entry");
+}
+
+void put_u32(std::vector<uint8_t> &out, uint32_t value) {
+  auto p = reinterpret_cast<const uint8_t *>(&value);
+  out.insert(out.end(), p, p + sizeof(uint32_t));
+}
+
+uint32_t get_u32(const std::vector<uint8_t> &data, size_t offset) {
+  uint32_t value;
+  memcpy(&value, data.data() + offset, sizeof(uint32_t));
+  return value;
+}
+
+// 大于所有以 prefix 开头的字符串的最小字符串, 不存在 (全为 0xff) 时返回空
+std::string successor(std::string prefix) {
+  while (!prefix.empty() && static_cast<uint8_t>(prefix.back()) == 0xff) {
+    prefix.pop_back();
+  }
+  if (!prefix.empty()) {
+    prefix.back() = static_cast<char>(static_cast<uint8_t>(prefix.back()) + 1);
+  }
+  return prefix;
+}
+} // namespace
+
+// **************************************************
+// RangeFilterBuilder
+// **************************************************
+
+RangeFilterBuilder::RangeFilterBuilder(size_t suffix_bytes)
+    : suffix_bytes_(suffix_bytes) {}
+
+void RangeFilterBuilder::add(std::string_view key) {
+  if (!has_cur_) {
+    cur_key_ = key;
+    has_cur_ = true;
+    lcp_prev_ = 0;
+    return;
+  }
+  if (key == cur_key_) {
+    return;
+  }
+  size_t lcp = 0;
+  size_t max_lcp = std::min(key.size(), cur_key_.size());
+  while (lcp < max_lcp && key[lcp] == cur_key_[lcp]) {
+    lcp++;
+  }
+  emit_(cur_key_, std::max(lcp_prev_, lcp));
+  lcp_prev_ = lcp;
+  cur_key_ = key;
+}
+
+void RangeFilterBuilder::emit_(const std::string &key, size_t lcp) {
+  // 区分相邻 key 需要 lcp + 1 个字节
+  size_t len = std::min(key.size(), lcp + 1 + suffix_bytes_);
+  bool truncated = len < key.size();
+
+  size_t shared = 0;
+  if (num_entries_ % RangeFilter::kRestartInterval == 0) {
+    restarts_.push_back(static_cast<uint32_t>(data_.size()));
+  } else {
+    size_t max_shared = std::min(len, last_entry_.size());
+    while (shared < max_shared && key[shared] == last_entry_[shared]) {
+      shared++;
+    }
+  }
+  size_t unshared = len - shared;
+  if (shared < 15 && unshared < 8) {
+    data_.push_back(static_cast<uint8_t>(shared << 4 | unshared << 1 |
+                                         (truncated ? 1 : 0)));
+  } else {
+    data_.push_back(static_cast<uint8_t>(kLongHeader | (truncated ? 1 : 0)));
+    put_varint(data_, shared);
+    put_varint(data_, unshared);
+  }
+  data_.insert(data_.end(), key.begin() + shared, key.begin() + len);
+  last_entry_.assign(key, 0, len);
+  num_entries_++;
+}
+
+std::vector<uint8_t> RangeFilterBuilder::finish() {
+  if (has_cur_) {
+    emit_(cur_key_, lcp_prev_);
+    has_cur_ = false;
+  }
+  std::vector<uint8_t> out = std::move(data_);
+  for (auto restart : restarts_) {
+    put_u32(out, restart);
+  }
+  put_u32(out, static_cast<uint32_t>(restarts_.size()));
+  put_u32(out, num_entries_);
+  put_u32(out, crc32c(out.data(), out.size()));
+  return out;
+}
+
+// **************************************************
+// RangeFilter
+// **************************************************
+
+size_t RangeFilter::decode_entry_(size_t offset, const std::string &prev,
+                                  Entry &entry) const {
+  if (offset >= entries_end_) {
+    throw std::runtime_error("Corrupted range filter entry");
+  }
+  uint8_t header = data_[offset++];
+  size_t shared, unshared;
+  if ((header & kLongHeader) == kLongHeader) {
+    shared = get_varint(data_, offset, entries_end_);
+    unshared = get_varint(data_, offset, entries_end_);
+  } else {
+    shared = header >> 4;
+    unshared = (header >> 1) & 7;
+  }
+  if (shared > prev.size() || unshared > entries_end_ - offset) {
+    throw std::runtime_error("Corrupted range filter entry");
+  }
+  entry.key.assign(prev, 0, shared);
+  entry.key.append(reinterpret_cast<const char *>(data_.data() + offset),
+                   unshared);
+  entry.truncated = header & 1;
+  return offset + unshared;
+}
+
+bool RangeFilter::before_(
+    const Entry &entry,
+    const std::function<int(const std::string &)> &predicate) {
+  if (!entry.truncated) {
+    return predicate(entry.key) > 0;
+  }
+  // 以 entry.key 开头的 key 都小于 successor
+  auto upper = successor(entry.key);
+  return !upper.empty() && predicate(upper) > 0;
+}
+
+bool RangeFilter::may_match(
+    const std::function<int(const std::string &)> &predicate) const {
+  if (num_entries_ == 0) {
+    return false;
+  }
+  // 重启点处的 entry 保存完整的前缀, 找到第一个不在范围之前的重启点
+  std::string empty;
+  Entry entry;
+  size_t lo = 0, hi = restarts_.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    decode_entry_(restarts_[mid], empty, entry);
+    if (before_(entry, predicate)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  // 第一个不在范围之前的 entry 在上一个重启点的组内或就是这个重启点
+  size_t offset = restarts_[lo == 0 ? 0 : lo - 1];
+  std::string prev;
+  while (offset < entries_end_) {
+    offset = decode_entry_(offset, prev, entry);
+    if (!before_(entry, predicate)) {
+      // entry 的下界也在范围之后时, 之后的 entry 都不会命中
+      return predicate(entry.key) >= 0;
+    }
+    prev = entry.key;
+  }
+  return false;
+}
+
+bool RangeFilter::may_contain_range(const std::string &lower,
+                                    const std::string &upper) const {
+  if (lower >= upper) {
+    return false;
+  }
+  return may_match([&lower, &upper](const std::string &key) {
+    if (key < lower) {
+      return 1;
+    }
+    return key < upper ? 0 : -1;
+  });
+}
+
+size_t RangeFilter::num_entries() const { return num_entries_; }
+
+size_t RangeFilter::size_bytes() const { return data_.size(); }
+
+const std::vector<uint8_t> &RangeFilter::encode() const { return data_; }
+
+RangeFilter RangeFilter::decode(std::vector<uint8_t> data) {
+  if (data.size() < kTrailerSize) {
+    throw std::runtime_error("Range filter too small");
+  }
+  size_t crc_offset = data.size() - sizeof(uint32_t);
+  if (crc32c(data.data(), crc_offset) != get_u32(data, crc_offset)) {
+    throw std::runtime_error("Range filter checksum verification failed");
+  }
+  RangeFilter filter;
+  uint32_t num_restarts = get_u32(data, crc_offset - 2 * sizeof(uint32_t));
+  filter.num_entries_ = get_u32(data, crc_offset - sizeof(uint32_t));
+  size_t restarts_bytes = static_cast<size_t>(num_restarts) * sizeof(uint32_t);
+  if (restarts_bytes > crc_offset - 2 * sizeof(uint32_t) ||
+      num_restarts != (filter.num_entries_ + kRestartInterval - 1) /
+                          kRestartInterval) {
+    throw std::runtime_error("Invalid range filter layout");
+  }
+  filter.entries_end_ = crc_offset - 2 * sizeof(uint32_t) - restarts_bytes;
+  for (size_t i = 0; i < num_restarts; i++) {
+    uint32_t restart = get_u32(data, filter.entries_end_ + i * sizeof(uint32_t));
+    if (restart >= filter.entries_end_) {
+      throw std::runtime_error("Invalid range filter layout");
+    }
+    filter.restarts_.push_back(restart);
+  }
+  filter.data_ = std::move(data);
+  return filter;
+}
+} // namespace tiny_lsm
@@ -0,0 +1,51 @@
+// src/utils/snapshot_list.cpp
+
+#include "utils/snapshot_list.h"
+#include <utility>
+
+namespace tiny_lsm {
+
+Snapshot::Snapshot(std::weak_ptr<SnapshotList> list, uint64_t tranc_id,
+                   std::multiset<uint64_t>::iterator pos)
+    : list_(std::move(list)), tranc_id_(tranc_id), pos_(pos) {}
+
+Snapshot::~Snapshot() {
+  if (auto list = list_.lock()) {
+    list->release_(pos_);
+  }
+}
+
+uint64_t Snapshot::tranc_id() const { return tranc_id_; }
+
+std::shared_ptr<Snapshot> SnapshotList::acquire(uint64_t tranc_id) {
+  return acquire([tranc_id]() { return tranc_id; });
+}
+
+std::shared_ptr<Snapshot>
+SnapshotList::acquire(const std::function<uint64_t()> &allocate_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t tranc_id = allocate_id();
+  auto pos = ids_.insert(tranc_id);
+  // 构造函数是私有的, 不能使用 make_shared
+  return std::shared_ptr<Snapshot>(
+      new Snapshot(weak_from_this(), tranc_id, pos));
+}
+
+std::optional<uint64_t> SnapshotList::oldest() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (ids_.empty()) {
+    return std::nullopt;
+  }
+  return *ids_.begin();
+}
+
+size_t SnapshotList::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ids_.size();
+}
+
+void SnapshotList::release_(std::multiset<uint64_t>::iterator pos) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ids_.erase(pos);
+}
+} // namespace tiny_lsm
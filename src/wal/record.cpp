@@ -1,6 +1,7 @@
 // src/wal/record.cpp
 
 #include "wal/record.h"
+#include "utils/crc32c.h"
 #include <cstddef>
 #include <cstring>
 
@@ -10,21 +11,24 @@ Record Record::createRecord(uint64_t tranc_id) {
   Record record;
   record.operation_type_ = OperationType::OP_CREATE;
   record.tranc_id_ = tranc_id;
-  record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t);
+  record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) +
+                       CHECKSUM_SIZE;
   return record;
 }
 Record Record::commitRecord(uint64_t tranc_id) {
   Record record;
   record.operation_type_ = OperationType::OP_COMMIT;
   record.tranc_id_ = tranc_id;
-  record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t);
+  record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) +
+                       CHECKSUM_SIZE;
   return record;
 }
 Record Record::rollbackRecord(uint64_t tranc_id) {
   Record record;
   record.operation_type_ = OperationType::OP_ROLLBACK;
   record.tranc_id_ = tranc_id;
-  record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t);
+  record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) +
+                       CHECKSUM_SIZE;
   return record;
 }
 Record Record::putRecord(uint64_t tranc_id, const std::string &key,
@@ -36,7 +40,7 @@ Record Record::putRecord(uint64_t tranc_id, const std::string &key,
   record.value_ = value;
   record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) +
                        sizeof(uint16_t) + key.size() + sizeof(uint16_t) +
-                       value.size();
+                       value.size() + CHECKSUM_SIZE;
   return record;
 }
 Record Record::deleteRecord(uint64_t tranc_id, const std::string &key) {
@@ -45,7 +49,7 @@ Record Record::deleteRecord(uint64_t tranc_id, const std::string &key) {
   record.tranc_id_ = tranc_id;
   record.key_ = key;
   record.record_len_ = sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) +
-                       sizeof(uint16_t) + key.size();
+                       sizeof(uint16_t) + key.size() + CHECKSUM_SIZE;
   return record;
 }
 
@@ -64,8 +68,8 @@ std::vector<uint8_t> Record::encode() const {
   // 编码 tranc_id
   std::memcpy(record.data() + sizeof(uint16_t), &tranc_id_, sizeof(uint64_t));
 
-  // 编码 operation_type
-  auto type_byte = static_cast<uint8_t>(operation_type_);
+  // 编码 operation_type, 最高位标记记录末尾带有校验和
+  auto type_byte = static_cast<uint8_t>(operation_type_) | CHECKSUM_FLAG;
   std::memcpy(record.data() + sizeof(uint16_t) + sizeof(uint64_t), &type_byte,
               sizeof(uint8_t));
 
@@ -88,6 +92,10 @@ std::vector<uint8_t> Record::encode() const {
                 key_.size());
   }
 
+  // 校验和覆盖记录中除自身之外的所有字节
+  uint32_t crc = crc32c(record.data(), record_len_ - CHECKSUM_SIZE);
+  std::memcpy(record.data() + record_len_ - CHECKSUM_SIZE, &crc,
+              sizeof(uint32_t));
   return record;
 }
 
@@ -100,13 +108,18 @@ std::vector<Record> Record::decode(const std::vector<uint8_t> &data) {
   size_t pos = 0;
 
   while (pos < data.size()) {
+    size_t record_start = pos;
+    if (data.size() - pos < sizeof(uint16_t)) {
+      throw std::runtime_error("Data length does not match record length");
+    }
     // 读取 record_len
     uint16_t record_len;
     std::memcpy(&record_len, data.data() + pos, sizeof(uint16_t));
     pos += sizeof(uint16_t);
 
     // 检查数据长度是否足够
-    if (data.size() < record_len) {
+    if (record_len < sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) ||
+        data.size() - record_start < record_len) {
       throw std::runtime_error("Data length does not match record length");
     }
 
@@ -117,7 +130,33 @@ std::vector<Record> Record::decode(const std::vector<uint8_t> &data) {
 
     // 读取 operation_type
     uint8_t op_type = data[pos++];
+    // 旧版本写入的记录没有校验和标记, 不做校验
+    bool has_checksum = op_type & CHECKSUM_FLAG;
+    if (has_checksum) {
+      if (record_len < sizeof(uint16_t) + sizeof(uint64_t) + sizeof(uint8_t) +
+                           CHECKSUM_SIZE) {
+        throw std::runtime_error("Data length does not match record length");
+      }
+      uint32_t stored_crc;
+      std::memcpy(&stored_crc,
+                  data.data() + record_start + record_len - CHECKSUM_SIZE,
+                  sizeof(uint32_t));
+      if (crc32c(data.data() + record_start, record_len - CHECKSUM_SIZE) !=
+          stored_crc) {
+        throw std::runtime_error("Record checksum mismatch");
+      }
+      op_type &= ~CHECKSUM_FLAG;
+    }
     OperationType operation_type = static_cast<OperationType>(op_type);
+    // key / value 必须完整地落在本条记录 (不含校验和) 之内,
+    // 旧版本的记录没有校验和, 损坏的长度字段只能靠这里发现
+    size_t payload_end =
+        record_start + record_len - (has_checksum ? CHECKSUM_SIZE : 0);
+    auto require = [&](size_t n) {
+      if (pos > payload_end || payload_end - pos < n) {
+        throw std::runtime_error("Data length does not match record length");
+      }
+    };
 
     Record record;
     record.tranc_id_ = tranc_id;
@@ -126,36 +165,43 @@ std::vector<Record> Record::decode(const std::vector<uint8_t> &data) {
 
     if (operation_type == OperationType::OP_PUT) {
       // 读取 key_len
+      require(sizeof(uint16_t));
       uint16_t key_len;
       std::memcpy(&key_len, data.data() + pos, sizeof(uint16_t));
       pos += sizeof(uint16_t);
 
       // 读取 key
+      require(key_len);
       record.key_ = std::string(
           reinterpret_cast<const char *>(data.data() + pos), key_len);
       pos += key_len;
 
       // 读取 value_len
+      require(sizeof(uint16_t));
       uint16_t value_len;
       std::memcpy(&value_len, data.data() + pos, sizeof(uint16_t));
       pos += sizeof(uint16_t);
 
       // 读取 value
+      require(value_len);
       record.value_ = std::string(
           reinterpret_cast<const char *>(data.data() + pos), value_len);
       pos += value_len;
     } else if (operation_type == OperationType::OP_DELETE) {
       // 读取 key_len
+      require(sizeof(uint16_t));
       uint16_t key_len;
       std::memcpy(&key_len, data.data() + pos, sizeof(uint16_t));
       pos += sizeof(uint16_t);
 
       // 读取 key
+      require(key_len);
       record.key_ = std::string(
           reinterpret_cast<const char *>(data.data() + pos), key_len);
       pos += key_len;
     }
 
+    pos = record_start + record_len;
     records.push_back(record);
   }
   return records;
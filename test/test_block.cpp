@@ -2,6 +2,10 @@
 #include "block/block_iterator.h"
 #include "config/config.h"
 #include "logger/logger.h"
+#include "utils/compression.h"
+#include "utils/crc32c.h"
+#include <algorithm>
+#include <cstring>
 #include <gtest/gtest.h>
 #include <iomanip>
 #include <memory>
@@ -413,6 +417,168 @@ TEST_F(BlockTest, TrancPredicateTest) {
   EXPECT_EQ(results, expected);
 }
 
+// 前缀压缩的 v2 格式
+TEST_F(BlockTest, PrefixCompressedV2Test) {
+  const std::string preffix = "REDIS_SORTED_SET_user_profile_SCORE_";
+  const int n = 200;
+  auto make_key = [&](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%05d", i);
+    return preffix + buf;
+  };
+
+  Block block(32 * 1024, BlockFormat::V2, 16);
+  size_t raw_size = 0;
+  for (int i = 0; i < n; i++) {
+    // 同一个 key 的多个版本跨越重启点
+    if (i == 31) {
+      EXPECT_TRUE(block.add_entry(make_key(i), "v31_new", 5, false));
+      raw_size += make_key(i).size() + 7 + 12;
+    }
+    EXPECT_TRUE(block.add_entry(make_key(i), "value" + std::to_string(i), 1,
+                                false));
+    raw_size += make_key(i).size() + 5 + std::to_string(i).size() + 12;
+  }
+  EXPECT_EQ(block.get_format(), BlockFormat::V2);
+  // 重复的前缀只在重启点保存
+  EXPECT_LT(block.cur_size(), raw_size / 2);
+
+  auto encoded = block.encode();
+  EXPECT_EQ(encoded.size(), block.cur_size() + sizeof(uint32_t));
+  auto decoded = Block::decode(encoded, true, BlockFormat::V2);
+  EXPECT_EQ(decoded->size(), n + 1);
+  EXPECT_EQ(decoded->get_first_key(), make_key(0));
+
+  for (int i = 0; i < n; i++) {
+    SCOPED_TRACE(i);
+    auto expected = i == 31 ? "v31_new" : "value" + std::to_string(i);
+    EXPECT_EQ(decoded->get_value_binary(make_key(i), 0).value(), expected);
+  }
+  EXPECT_EQ(decoded->get_value_binary(make_key(31), 1).value(), "value31");
+  EXPECT_FALSE(decoded->get_value_binary(preffix, 0).has_value());
+  EXPECT_FALSE(decoded->get_value_binary(make_key(n), 0).has_value());
+  EXPECT_FALSE(decoded->get_value_binary("A", 0).has_value());
+
+  // 损坏的数据
+  encoded[10] ^= 0xff;
+  EXPECT_THROW(Block::decode(encoded, true, BlockFormat::V2),
+               std::runtime_error);
+  std::vector<uint8_t> too_short = {1};
+  EXPECT_THROW(Block::decode(too_short, false, BlockFormat::V2),
+               std::runtime_error);
+}
+
+// 右值解码复用缓冲区, 迭代器通过视图访问 key 和 value
+TEST_F(BlockTest, ZeroCopyViewTest) {
+  Block block(4096, BlockFormat::V2, 4);
+  for (int i = 0; i < 20; i++) {
+    std::string key = "key" + std::to_string(100 + i);
+    // 每个 key 两个版本, 迭代时只返回最新的版本
+    EXPECT_TRUE(block.add_entry(key, "new" + std::to_string(i), 2, false));
+    EXPECT_TRUE(block.add_entry(key, "old" + std::to_string(i), 1, false));
+  }
+
+  // 未压缩的 block 解压时直接截断, 不重新分配
+  auto stored = compress_block(block.encode(), CompressionType::None, 0.875);
+  const uint8_t *buffer = stored.data();
+  auto raw = decompress_block(std::move(stored));
+  EXPECT_EQ(raw.data(), buffer);
+
+  auto decoded = Block::decode(std::move(raw), true, BlockFormat::V2);
+  ASSERT_EQ(decoded->size(), 40);
+
+  BlockIterator it(decoded, 0, 0);
+  BlockIterator end(decoded, decoded->size(), 0);
+  int i = 0;
+  for (; it != end; ++it, i++) {
+    SCOPED_TRACE(i);
+    std::string key = "key" + std::to_string(100 + i);
+    EXPECT_EQ(it.key_view(), key);
+    EXPECT_EQ(it.value_view(), "new" + std::to_string(i));
+    EXPECT_EQ((*it).first, key);
+  }
+  EXPECT_EQ(i, 20);
+  EXPECT_THROW(end.key_view(), std::out_of_range);
+}
+
+// v2 block 的哈希索引定位到正确的版本, 空 bucket 直接返回不存在
+TEST_F(BlockTest, HashIndexV2Test) {
+  Block indexed(8192, BlockFormat::V2, 8, 0.75);
+  Block plain(8192, BlockFormat::V2, 8);
+  for (int i = 0; i < 100; i++) {
+    std::string key = "user:" + std::to_string(1000 + i * 2);
+    // 部分 key 有多个版本, 可能跨越重启点
+    for (uint64_t t = (i % 3 == 0 ? 3 : 1); t >= 1; t--) {
+      std::string value = "v" + std::to_string(i) + "_" + std::to_string(t);
+      EXPECT_TRUE(indexed.add_entry(key, value, t, false));
+      EXPECT_TRUE(plain.add_entry(key, value, t, false));
+    }
+  }
+  EXPECT_TRUE(indexed.has_hash_index());
+  EXPECT_FALSE(plain.has_hash_index());
+
+  auto encoded = indexed.encode();
+  EXPECT_EQ(encoded.size(), indexed.cur_size() + sizeof(uint32_t));
+  EXPECT_GT(encoded.size(), plain.encode().size());
+  auto with_index = Block::decode(encoded, true, BlockFormat::V2);
+  auto without_index = Block::decode(plain.encode(), true, BlockFormat::V2);
+  EXPECT_TRUE(with_index->has_hash_index());
+  // 解码后再编码得到相同的字节
+  EXPECT_EQ(with_index->encode(), encoded);
+
+  for (int i = 0; i < 200; i++) {
+    SCOPED_TRACE(i);
+    std::string key = "user:" + std::to_string(1000 + i);
+    for (auto &block : {with_index, without_index}) {
+      if (i % 2 == 1) {
+        // 奇数的 key 不存在
+        for (uint64_t t : {0, 1, 2, 3}) {
+          EXPECT_FALSE(block->get_value_binary(key, t).has_value());
+        }
+        continue;
+      }
+      int j = i / 2;
+      std::string newest = j % 3 == 0 ? "_3" : "_1";
+      EXPECT_EQ(block->get_value_binary(key, 0),
+                "v" + std::to_string(j) + newest);
+      for (uint64_t t : {1, 2, 3}) {
+        // 只有 j % 3 == 0 的 key 有 2, 3 两个版本
+        uint64_t visible = j % 3 == 0 ? t : 1;
+        EXPECT_EQ(block->get_value_binary(key, t),
+                  "v" + std::to_string(j) + "_" + std::to_string(visible));
+      }
+    }
+  }
+  EXPECT_FALSE(with_index->get_value_binary("user:0", 0).has_value());
+  EXPECT_FALSE(with_index->get_value_binary("zzz", 0).has_value());
+
+  // 把所有 bucket 改为空并重新计算校验和: 即使 key 存在, 查找也在 bucket 处
+  // 直接返回, 说明点查确实经过了哈希索引
+  auto emptied = encoded;
+  size_t tail = emptied.size() - sizeof(uint32_t) - 3 * sizeof(uint16_t);
+  uint16_t num_buckets;
+  memcpy(&num_buckets, emptied.data() + tail, sizeof(uint16_t));
+  std::fill(emptied.begin() + tail - num_buckets, emptied.begin() + tail, 255);
+  uint32_t crc = crc32c(emptied.data(), emptied.size() - sizeof(uint32_t));
+  memcpy(emptied.data() + emptied.size() - sizeof(uint32_t), &crc,
+         sizeof(uint32_t));
+  auto short_circuit = Block::decode(emptied, true, BlockFormat::V2);
+  EXPECT_TRUE(short_circuit->has_hash_index());
+  EXPECT_FALSE(short_circuit->get_value_binary("user:1000", 0).has_value());
+  EXPECT_EQ(without_index->get_value_binary("user:1000", 0), "v0_3");
+
+  // 重启点太多时不生成索引
+  Block many_restarts(16384, BlockFormat::V2, 1, 0.75);
+  for (int i = 0; i < 300; i++) {
+    EXPECT_TRUE(many_restarts.add_entry("k" + std::to_string(1000 + i), "v",
+                                        1, false));
+  }
+  EXPECT_FALSE(many_restarts.has_hash_index());
+  auto decoded = Block::decode(many_restarts.encode(), true, BlockFormat::V2);
+  EXPECT_FALSE(decoded->has_hash_index());
+  EXPECT_EQ(decoded->size(), 300);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
@@ -95,6 +95,40 @@ TEST_F(BlockCacheTest, HitRate) {
   EXPECT_EQ(cache->hit_rate(), 2.0 / 3.0);
 }
 
+TEST(BlockCacheBytesTest, ByteCapacityAndShrink) {
+  // 先测出单个空块的计费字节数
+  BlockCache probe(10, 2);
+  probe.put(1, 1, std::make_shared<Block>());
+  size_t charge = probe.memory_usage();
+  ASSERT_GT(charge, sizeof(Block));
+
+  // 块数上限很大, 字节上限只能容纳3个块
+  BlockCache cache(100, 2, charge * 3);
+  std::vector<std::shared_ptr<Block>> blocks;
+  for (int i = 0; i < 4; i++) {
+    blocks.push_back(std::make_shared<Block>());
+  }
+  cache.put(1, 1, blocks[0]);
+  cache.put(1, 2, blocks[1]);
+  cache.put(1, 3, blocks[2]);
+  EXPECT_EQ(cache.memory_usage(), charge * 3);
+
+  // 插入第4个块时按字节数淘汰最久未使用的 block1
+  cache.get(1, 2);
+  cache.get(1, 3);
+  cache.put(1, 4, blocks[3]);
+  EXPECT_EQ(cache.memory_usage(), charge * 3);
+  EXPECT_EQ(cache.get(1, 1), nullptr);
+  EXPECT_EQ(cache.get(1, 4), blocks[3]);
+
+  // shrink 至少释放请求的字节数
+  EXPECT_EQ(cache.shrink(charge + 1), charge * 2);
+  EXPECT_EQ(cache.memory_usage(), charge);
+  EXPECT_EQ(cache.shrink(charge * 10), charge);
+  EXPECT_EQ(cache.memory_usage(), 0);
+  EXPECT_EQ(cache.shrink(1), 0);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
@@ -2,14 +2,18 @@
 #include "consts.h"
 #include "logger/logger.h"
 #include "lsm/engine.h"
+#include "lsm/subcompaction.h"
 #include "lsm/transaction.h"
+#include "sst/concact_iterator.h"
 #include <cstdlib>
 #include <filesystem>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 
 using namespace ::tiny_lsm;
 
@@ -407,6 +411,129 @@ TEST_F(CompactTest, TombstoneDefaultConfig) {
   }
 }
 
+TEST(SubcompactionTest, RangesAndBoundedIterator) {
+  auto ranges = ranges_from_boundaries({"c", "f"});
+  ASSERT_EQ(ranges.size(), 3);
+  EXPECT_FALSE(ranges[0].lower.has_value());
+  EXPECT_EQ(*ranges[0].upper, "c");
+  EXPECT_EQ(*ranges[1].lower, "c");
+  EXPECT_EQ(*ranges[1].upper, "f");
+  EXPECT_FALSE(ranges[2].upper.has_value());
+  EXPECT_TRUE(ranges[1].contains("c"));
+  EXPECT_FALSE(ranges[1].contains("f"));
+  EXPECT_TRUE(ranges[1].overlaps("a", "c"));
+  EXPECT_FALSE(ranges[1].overlaps("f", "z"));
+  EXPECT_EQ(ranges_from_boundaries({}).size(), 1);
+
+  // 每个 key 两个版本, 区间的并集应恰好为全部记录, 且同一个 key 的版本不被拆开
+  std::vector<SearchItem> items;
+  for (char c = 'a'; c <= 'h'; c++) {
+    std::string key(1, c);
+    items.emplace_back(key, key + "_2", 0, 0, 2);
+    items.emplace_back(key, key + "_1", 0, 0, 1);
+  }
+  std::vector<std::pair<std::string, std::string>> merged;
+  for (auto &range : ranges) {
+    auto heap = std::make_shared<HeapIterator>(items, 0, false, true);
+    BoundedIterator it(heap, range);
+    for (; !it.is_end(); ++it) {
+      EXPECT_TRUE(range.contains((*it).first));
+      merged.push_back(*it);
+    }
+    EXPECT_FALSE(it.is_valid());
+  }
+  ASSERT_EQ(merged.size(), items.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    EXPECT_EQ(merged[i].first, items[i].key_);
+    EXPECT_EQ(merged[i].second, items[i].value_);
+  }
+}
+
+// 切分点来自其它输入 SST, 通常不在当前 SST 中; 每个区间必须从第一个 >= lower 的
+// key 开始读取, 否则该 SST 在这个区间的数据会丢失
+TEST_F(CompactTest, SubcompactionBoundariesMissingFromInputs) {
+  auto cache = std::make_shared<BlockCache>(64, 2);
+  auto key_of = [](size_t i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key%06zu", i);
+    return std::string(buf);
+  };
+  // sst 0 只有偶数 key, sst 1 只有奇数 key, 因此任何切分点都至少缺失于其中一个
+  std::vector<std::shared_ptr<SST>> inputs;
+  for (size_t parity = 0; parity < 2; parity++) {
+    SSTBuilder builder(256, true);
+    for (size_t i = parity; i < 2000; i += 2) {
+      builder.add(key_of(i), "value" + std::to_string(i), 0);
+    }
+    inputs.push_back(builder.build(
+        parity, test_dir + "/" + std::to_string(parity) + ".sst", cache));
+  }
+
+  auto boundaries = plan_subcompactions(inputs, 4, 0);
+  ASSERT_FALSE(boundaries.empty());
+  auto ranges = ranges_from_boundaries(boundaries);
+
+  for (auto &sst : inputs) {
+    SCOPED_TRACE(sst->get_sst_id());
+    std::vector<std::string> keys;
+    for (auto &range : ranges) {
+      std::shared_ptr<BaseIterator> inner;
+      if (range.lower) {
+        inner = std::make_shared<SstIterator>(
+            SstIterator::lower_bound(sst, *range.lower, 0, true));
+      } else {
+        inner = std::make_shared<SstIterator>(sst, 0, true);
+      }
+      for (BoundedIterator it(inner, range); !it.is_end(); ++it) {
+        keys.push_back((*it).first);
+      }
+      // 通过 ConcactIterator 从 lower 开始也得到相同的结果
+      if (range.lower) {
+        auto concat = std::make_shared<ConcactIterator>(
+            std::vector<std::shared_ptr<SST>>{sst}, *range.lower, 0, true);
+        BoundedIterator it(concat, range);
+        if (!it.is_end()) {
+          EXPECT_GE((*it).first, *range.lower);
+        }
+      }
+    }
+    ASSERT_EQ(keys.size(), 1000);
+    for (size_t i = 0; i < keys.size(); i++) {
+      EXPECT_EQ(keys[i], key_of(2 * i + sst->get_sst_id()));
+    }
+  }
+
+  // 大于所有 key 的 lower 得到 end
+  EXPECT_TRUE(SstIterator::lower_bound(inputs[0], "zzz", 0).is_end());
+}
+
+TEST(SubcompactionTest, RunInParallel) {
+  auto ranges = ranges_from_boundaries({"b", "d", "f"});
+  std::mutex mtx;
+  std::vector<std::string> seen;
+  auto result = run_subcompactions(
+      ranges, [&](const KeyRange &range) -> std::vector<std::shared_ptr<SST>> {
+        std::lock_guard<std::mutex> lock(mtx);
+        seen.push_back(range.lower.value_or(""));
+        return {};
+      });
+  EXPECT_TRUE(result.empty());
+  std::sort(seen.begin(), seen.end());
+  EXPECT_EQ(seen, (std::vector<std::string>{"", "b", "d", "f"}));
+
+  // 任意一个区间失败时整个 compaction 失败
+  EXPECT_THROW(run_subcompactions(ranges,
+                                  [](const KeyRange &range)
+                                      -> std::vector<std::shared_ptr<SST>> {
+                                    if (range.lower == "d") {
+                                      throw std::runtime_error("disk full");
+                                    }
+                                    return {};
+                                  }),
+               std::runtime_error);
+  EXPECT_TRUE(run_subcompactions({}, nullptr).empty());
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
@@ -2,11 +2,13 @@
 #include "logger/logger.h"
 #include "lsm/engine.h"
 #include "lsm/level_iterator.h"
+#include <atomic>
 #include <cstdlib>
 #include <filesystem>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 using namespace ::tiny_lsm;
@@ -500,6 +502,86 @@ TEST_F(LSMTest, SmallConfigLargeDataPersistent) {
   }
 }
 
+TEST_F(LSMTest, SnapshotWatermark) {
+  auto manager = std::make_shared<TranManager>(test_dir);
+
+  // 没有进行中的事务时, 水位是下一个将要分配的 id
+  auto write_id = manager->getNextTransactionId();
+  EXPECT_GT(manager->get_oldest_snapshot_tranc_id(), write_id);
+
+  // 活跃事务持有快照, 水位不超过最老的活跃事务
+  auto t1 = manager->new_tranc(IsolationLevel::REPEATABLE_READ);
+  auto t2 = manager->new_tranc(IsolationLevel::REPEATABLE_READ);
+  EXPECT_EQ(manager->get_oldest_snapshot_tranc_id(), t1->tranc_id_);
+  t1->abort();
+  EXPECT_EQ(manager->get_oldest_snapshot_tranc_id(), t2->tranc_id_);
+
+  // 不开启事务的读操作的快照在释放前一直有效
+  {
+    auto read = manager->begin_read();
+    auto t3 = manager->new_tranc(IsolationLevel::REPEATABLE_READ);
+    t2->abort();
+    EXPECT_EQ(manager->get_oldest_snapshot_tranc_id(), read->tranc_id());
+    // 迭代器在同一张表中登记调用方指定的 id
+    auto iter = manager->get_snapshot_list()->acquire(write_id);
+    EXPECT_EQ(manager->get_oldest_snapshot_tranc_id(), write_id);
+    // t3 既未提交也未终止, 丢弃后不再占用水位
+  }
+  EXPECT_GT(manager->get_oldest_snapshot_tranc_id(), t2->tranc_id_);
+  EXPECT_EQ(manager->get_snapshot_list()->size(), 0);
+}
+
+TEST_F(LSMTest, BackgroundFlushWriteStall) {
+  auto &&config = const_cast<TomlConfig &>(TomlConfig::getInstance());
+  // 配置是全局的, 断言失败提前返回时也要恢复, 否则影响之后的测试
+  struct ConfigRestorer {
+    TomlConfig &config;
+    long long tol_limit = config.getLsmTolMemSizeLimit();
+    long long per_limit = config.getLsmPerMemSizeLimit();
+    int stop_trigger = config.getLsmStopImmutableMemtables();
+    ~ConfigRestorer() {
+      config.modify_lsm_tol_mem_size_limit(tol_limit);
+      config.modify_lsm_per_mem_size_limit(per_limit);
+      config.modify_lsm_stop_immutable_memtables(stop_trigger);
+    }
+  } restorer{config};
+  // 冻结表达到2张就阻塞写入, 让写线程频繁进入减速和阻塞状态
+  config.modify_lsm_tol_mem_size_limit(65536);
+  config.modify_lsm_per_mem_size_limit(4096);
+  config.modify_lsm_stop_immutable_memtables(2);
+
+  int num = 20000;
+  {
+    LSM lsm(test_dir);
+    std::atomic<bool> done{false};
+    // 读线程与后台刷盘并发, 已写入的数据在刷盘前后都必须可见
+    std::thread reader([&]() {
+      while (!done) {
+        auto res = lsm.get("key0");
+        if (res.has_value()) {
+          EXPECT_EQ(res.value(), "value0");
+        }
+      }
+    });
+    for (int i = 0; i < num; ++i) {
+      lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    done = true;
+    reader.join();
+
+    for (int i = 0; i < num; ++i) {
+      std::string key = "key" + std::to_string(i);
+      ASSERT_EQ(lsm.get(key).value(), "value" + std::to_string(i));
+    }
+  }
+
+  LSM lsm(test_dir);
+  for (int i = 0; i < num; i += 7) {
+    std::string key = "key" + std::to_string(i);
+    ASSERT_EQ(lsm.get(key).value(), "value" + std::to_string(i));
+  }
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
@@ -1,9 +1,16 @@
+#include "config/config.h"
 #include "consts.h"
 #include "iterator/iterator.h"
 #include "logger/logger.h"
 #include "memtable/memtable.h"
+#include "memtable/memtable_merge_iterator.h"
+#include "memtable/memtable_rep.h"
+#include <algorithm>
 #include <gtest/gtest.h>
 #include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <utility>
@@ -511,6 +518,409 @@ TEST(MemTableTest, ItersPredicate_Large) {
   EXPECT_TRUE(range_begin_iter.is_end());
 }
 
+// 除 SkipList 以外的存储结构, SkipList 由上面的 MemTableTest 覆盖
+static std::vector<MemTableRepType> extra_rep_types() {
+  return {MemTableRepType::ArenaSkipList, MemTableRepType::SortedVector,
+          MemTableRepType::HashLinkList, MemTableRepType::ART};
+}
+
+TEST(MemTableRepTest, BasicOperations) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    EXPECT_EQ(rep->get_type(), type);
+
+    rep->put("key1", "value1", 0);
+    rep->put("key2", "value2", 0);
+    EXPECT_EQ(rep->get("key1", 0).get_value(), "value1");
+
+    // 相同 key 和 tranc_id 的写入覆盖旧值
+    rep->put("key1", "new_value", 0);
+    EXPECT_EQ(rep->get("key1", 0).get_value(), "new_value");
+
+    // 删除即写入空值
+    rep->put("key2", "", 0);
+    auto res = rep->get("key2", 0);
+    EXPECT_TRUE(res.is_valid());
+    EXPECT_EQ(res.get_value(), "");
+
+    EXPECT_FALSE(rep->get("nonexistent", 0).is_valid());
+    EXPECT_FALSE(rep->get("key", 0).is_valid());
+    EXPECT_FALSE(rep->get("key10", 0).is_valid());
+  }
+}
+
+TEST(MemTableRepTest, TransactionId) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    rep->put("key", "v1", 1);
+    rep->put("key", "v5", 5);
+    rep->put("key", "v3", 3);
+
+    EXPECT_EQ(rep->get("key", 0).get_value(), "v5");
+    EXPECT_EQ(rep->get("key", 4).get_value(), "v3");
+    EXPECT_EQ(rep->get("key", 4).get_tranc_id(), 3);
+    EXPECT_EQ(rep->get("key", 1).get_value(), "v1");
+    EXPECT_FALSE(rep->get("key", 0).is_end());
+
+    // 只能看到 tranc_id 更大的版本时查询失败
+    rep->put("other", "v9", 9);
+    EXPECT_FALSE(rep->get("other", 8).is_valid());
+  }
+}
+
+TEST(MemTableRepTest, FlushOrder) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    std::vector<std::tuple<std::string, std::string, uint64_t>> expected;
+    // 乱序写入, 并包含长公共前缀和互为前缀的 key
+    std::vector<std::string> keys = {"user:1000:name", "user:1000",
+                                     "user:10",        "user:2000:age",
+                                     "a",              "user:1000:age",
+                                     "",               "user:\xff"};
+    for (auto &key : keys) {
+      rep->put(key, key + "_old", 1);
+      rep->put(key, key + "_v2", 2);
+      rep->put(key, key + "_v1", 1);
+      expected.emplace_back(key, key + "_v2", 2);
+      expected.emplace_back(key, key + "_v1", 1);
+    }
+    std::sort(expected.begin(), expected.end(), [](auto &a, auto &b) {
+      if (std::get<0>(a) != std::get<0>(b)) {
+        return std::get<0>(a) < std::get<0>(b);
+      }
+      return std::get<2>(a) > std::get<2>(b);
+    });
+
+    EXPECT_EQ(rep->flush(), expected);
+
+    size_t idx = 0;
+    for (auto it = rep->begin(); !it.is_end(); ++it, ++idx) {
+      ASSERT_LT(idx, expected.size());
+      EXPECT_EQ(it.get_key(), std::get<0>(expected[idx]));
+      EXPECT_EQ(it.get_value(), std::get<1>(expected[idx]));
+      EXPECT_EQ(it.get_tranc_id(), std::get<2>(expected[idx]));
+    }
+    EXPECT_EQ(idx, expected.size());
+  }
+}
+
+TEST(MemTableRepTest, PreffixAndPredicate) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    for (int i = 0; i < 100; i++) {
+      std::ostringstream oss;
+      oss << "key" << std::setw(3) << std::setfill('0') << i;
+      rep->put(oss.str(), "value" + std::to_string(i), 0);
+    }
+    rep->put("prefix", "p", 0);
+
+    int count = 0;
+    for (auto it = rep->begin_preffix("key05"); it != rep->end_preffix("key05");
+         ++it) {
+      EXPECT_TRUE(it.get_key().starts_with("key05"));
+      count++;
+    }
+    EXPECT_EQ(count, 10);
+    EXPECT_TRUE(rep->begin_preffix("nonexistent") ==
+                rep->end_preffix("nonexistent"));
+
+    // key020 ~ key039
+    auto res = rep->iters_monotony_predicate([](const std::string &key) {
+      if (key < "key020") {
+        return 1;
+      }
+      if (key >= "key040") {
+        return -1;
+      }
+      return 0;
+    });
+    ASSERT_TRUE(res.has_value());
+    count = 0;
+    for (auto it = res->first; it != res->second; ++it) {
+      EXPECT_EQ(it.get_key().substr(0, 4), "key0");
+      count++;
+    }
+    EXPECT_EQ(count, 20);
+
+    EXPECT_FALSE(rep->iters_monotony_predicate([](const std::string &key) {
+                       return key < "zzz" ? 1 : -1;
+                     })
+                     .has_value());
+  }
+}
+
+TEST(MemTableRepTest, IteratorSurvivesWrites) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    for (int i = 0; i < 10; i++) {
+      rep->put("key" + std::to_string(i), "value", 0);
+    }
+    auto it = rep->begin();
+    // 迭代器创建后的写入不会使其失效
+    for (int i = 0; i < 1000; i++) {
+      rep->put("new" + std::to_string(i), "value", 0);
+    }
+    rep->freeze();
+    int count = 0;
+    for (; !it.is_end(); ++it) {
+      count++;
+    }
+    // 跳表迭代器可以看到新写入, 有序视图迭代器看到的是创建时的快照
+    if (type == MemTableRepType::ArenaSkipList) {
+      EXPECT_EQ(count, 1010);
+    } else {
+      EXPECT_EQ(count, 10);
+    }
+    EXPECT_EQ(rep->flush().size(), 1010);
+  }
+}
+
+TEST(MemTableRepTest, LargeScaleRandom) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    std::map<std::pair<std::string, uint64_t>, std::string> expected;
+    std::mt19937 gen(42);
+    size_t bytes = 0;
+    for (int i = 0; i < 20000; i++) {
+      std::string key = "k" + std::to_string(gen() % 5000);
+      uint64_t tranc_id = gen() % 4;
+      std::string value = "v" + std::to_string(i);
+      rep->put(key, value, tranc_id);
+      expected[{key, tranc_id}] = value;
+      bytes += key.size() + value.size() + sizeof(uint64_t);
+      // 穿插读取, 触发有序视图的增量构建 (tranc_id 为 0 时会读到最新版本)
+      if (i % 997 == 0 && tranc_id != 0) {
+        EXPECT_EQ(rep->get(key, tranc_id).get_value(), value);
+      }
+    }
+    EXPECT_EQ(rep->get_size(), bytes);
+
+    auto data = rep->flush();
+    EXPECT_EQ(data.size(), expected.size());
+    for (auto &[k, v, t] : data) {
+      EXPECT_EQ((expected[{k, t}]), v);
+    }
+    for (auto &[kt, v] : expected) {
+      auto res = rep->get(kt.first, kt.second == 0 ? 0 : kt.second);
+      ASSERT_TRUE(res.is_valid());
+      EXPECT_EQ(res.get_key(), kt.first);
+      EXPECT_LE(res.get_tranc_id(), kt.second == 0 ? UINT64_MAX : kt.second);
+    }
+  }
+}
+
+TEST(MemTableRepTest, MemoryUsage) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    size_t empty_usage = rep->memory_usage();
+    for (int i = 0; i < 1000; i++) {
+      rep->put("key" + std::to_string(i), std::string(100, 'v'), 0);
+    }
+    // 实际占用包括节点和分配器的开销, 一定大于键值对本身的大小
+    EXPECT_GT(rep->memory_usage() - empty_usage, rep->get_size());
+  }
+}
+
+TEST(MemTableRepTest, BloomFilterSkipsAbsentKeys) {
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto rep = new_memtable_rep(type);
+    for (int i = 0; i < 1000; i++) {
+      rep->put("key" + std::to_string(i), "value" + std::to_string(i), 0);
+    }
+    rep->put("", "", 7); // 事务提交标记同样需要被过滤器记录
+
+    // 写入过的 key 一定不会被过滤掉
+    for (int i = 0; i < 1000; i++) {
+      EXPECT_TRUE(rep->may_contain("key" + std::to_string(i)));
+      EXPECT_TRUE(rep->get("key" + std::to_string(i), 0).is_valid());
+    }
+    EXPECT_TRUE(rep->may_contain(""));
+
+    // 绝大多数不存在的 key 只需查询过滤器
+    int false_positives = 0;
+    for (int i = 1000; i < 11000; i++) {
+      auto key = "key" + std::to_string(i);
+      if (rep->may_contain(key)) {
+        false_positives++;
+      }
+      EXPECT_FALSE(rep->get(key, 0).is_valid());
+    }
+    EXPECT_LT(false_positives, 100);
+  }
+}
+
+TEST(MemTableRepTest, MergeIterator) {
+  using Source = MemTableMergeIterator::Source;
+  for (auto type : extra_rep_types()) {
+    SCOPED_TRACE(memtable_rep_type_to_string(type));
+    auto newer = new_memtable_rep(type);
+    auto older = new_memtable_rep(type);
+    older->put("a", "a1", 1);
+    older->put("b", "b1", 1);
+    older->put("c", "c1", 1);
+    older->put("", "", 1); // 提交标记
+    newer->put("a", "a3", 3);
+    newer->put("b", "", 3); // 删除
+    newer->put("d", "d5", 5);
+    newer->put("pre1", "p1", 2);
+    older->put("pre2", "p2", 2);
+
+    auto sources = [&]() {
+      return std::vector<Source>{{newer, newer->begin(), newer->end()},
+                                 {older, older->begin(), older->end()}};
+    };
+    auto collect = [](MemTableMergeIterator iter) {
+      std::vector<std::pair<std::string, std::string>> res;
+      for (; !iter.is_end(); ++iter) {
+        res.push_back(*iter);
+      }
+      return res;
+    };
+    using KVs = std::vector<std::pair<std::string, std::string>>;
+
+    // 新表优先, 删除的 key 被跳过
+    EXPECT_EQ(collect(MemTableMergeIterator(sources(), 0)),
+              (KVs{{"a", "a3"}, {"c", "c1"}, {"d", "d5"}, {"pre1", "p1"},
+                   {"pre2", "p2"}}));
+    // 事务 2 看不到之后的写入
+    EXPECT_EQ(collect(MemTableMergeIterator(sources(), 2)),
+              (KVs{{"a", "a1"}, {"b", "b1"}, {"c", "c1"}, {"pre1", "p1"},
+                   {"pre2", "p2"}}));
+    // 保留所有版本
+    EXPECT_EQ(collect(MemTableMergeIterator(sources(), 0, false, true)),
+              (KVs{{"a", "a3"}, {"a", "a1"}, {"b", ""}, {"b", "b1"},
+                   {"c", "c1"}, {"d", "d5"}, {"pre1", "p1"}, {"pre2", "p2"}}));
+
+    // 前缀范围
+    std::vector<Source> preffix_sources{
+        {newer, newer->begin_preffix("pre"), newer->end_preffix("pre")},
+        {older, older->begin_preffix("pre"), older->end_preffix("pre")}};
+    EXPECT_EQ(collect(MemTableMergeIterator(preffix_sources, 0)),
+              (KVs{{"pre1", "p1"}, {"pre2", "p2"}}));
+
+    // 拷贝出的迭代器独立推进
+    MemTableMergeIterator iter(sources(), 0);
+    ++iter;
+    MemTableMergeIterator copy = iter;
+    ++iter;
+    EXPECT_EQ((*copy).first, "c");
+    EXPECT_EQ((*iter).first, "d");
+    EXPECT_TRUE(copy != iter);
+    ++copy;
+    EXPECT_TRUE(copy == iter);
+    EXPECT_TRUE(MemTableMergeIterator{} == MemTableMergeIterator(
+                                               std::vector<Source>{}, 0));
+
+    // 迭代器持有表的引用, 表被释放后仍可遍历
+    MemTableMergeIterator pinned(sources(), 0);
+    newer.reset();
+    older.reset();
+    EXPECT_EQ(collect(pinned).size(), 5);
+  }
+}
+
+// SkipList 的 put_batch 通过 put_hint 复用插入位置, 有序与无序的批次结果一致
+TEST(MemTableRepTest, SkipListPutBatch) {
+  std::vector<std::pair<std::string, std::string>> sorted_kvs;
+  for (int i = 0; i < 1000; i++) {
+    std::ostringstream oss;
+    oss << "key" << std::setw(4) << std::setfill('0') << i;
+    sorted_kvs.emplace_back(oss.str(), "value" + std::to_string(i));
+  }
+  auto shuffled_kvs = sorted_kvs;
+  std::shuffle(shuffled_kvs.begin(), shuffled_kvs.end(), std::mt19937(42));
+
+  for (auto *kvs : {&sorted_kvs, &shuffled_kvs}) {
+    auto rep = new_memtable_rep(MemTableRepType::SkipList);
+    rep->put_batch(*kvs, 5);
+    // 同一批次内的重复 key 以最后一次为准, 新事务的版本排在旧版本之前
+    rep->put_batch({{"key0500", "a"}, {"key0500", "b"}}, 5);
+    rep->put_batch({{"key0001", "new"}, {"key0002", "new"}}, 6);
+
+    auto data = rep->flush();
+    ASSERT_EQ(data.size(), 1002);
+    for (size_t i = 1; i < data.size(); i++) {
+      auto &[pk, pv, pt] = data[i - 1];
+      auto &[k, v, t] = data[i];
+      EXPECT_TRUE(pk < k || (pk == k && pt > t));
+    }
+    EXPECT_EQ(std::get<1>(data[1]), "new");
+    EXPECT_EQ(std::get<2>(data[1]), 6);
+    EXPECT_EQ(std::get<1>(data[2]), "value1");
+    EXPECT_EQ(std::get<1>(data[502]), "b");
+  }
+}
+
+// 读写交替时点查扫描未排序的记录, 不必每次都构建有序视图
+TEST(MemTableRepTest, SortedVectorUnsortedTail) {
+  auto rep = std::dynamic_pointer_cast<SortedViewRep>(
+      new_memtable_rep(MemTableRepType::SortedVector));
+  ASSERT_NE(rep, nullptr);
+  // 每个 key 的最新版本: tranc_id 最大, 相同时后写入的胜出
+  std::map<std::string, std::pair<uint64_t, std::string>> newest;
+  for (int i = 0; i < 100; i++) {
+    auto key = "key" + std::to_string(i % 10);
+    auto value = "v" + std::to_string(i);
+    uint64_t tranc_id = i % 3;
+    rep->put(key, value, tranc_id);
+    if (!newest.count(key) || tranc_id >= newest[key].first) {
+      newest[key] = {tranc_id, value};
+    }
+    auto res = rep->get(key, 0);
+    ASSERT_TRUE(res.is_valid());
+    EXPECT_EQ(res.get_tranc_id(), newest[key].first);
+    EXPECT_EQ(res.get_value(), newest[key].second);
+  }
+  EXPECT_EQ(rep->sorted_view()->entries.size(), 30);
+
+  // 视图与未归并的记录中都有相同的 (key, tranc_id) 时, 后写入的胜出
+  rep->put("key1", "newest", 1);
+  EXPECT_EQ(rep->get("key1", 1).get_value(), "newest");
+  EXPECT_EQ(rep->get("key1", 0).get_tranc_id(), 2);
+  for (size_t i = 0; i <= SortedViewRep::kMaxUnsortedTail; i++) {
+    rep->put("bulk" + std::to_string(i), "b", 0);
+  }
+  EXPECT_EQ(rep->get("bulk0", 0).get_value(), "b");
+  EXPECT_EQ(rep->get("key1", 1).get_value(), "newest");
+}
+
+TEST(MemTableRepTest, HashLinkListBucketCount) {
+  auto &config = const_cast<TomlConfig &>(TomlConfig::getInstance());
+  auto saved = config.getLsmMemtableHashBucketCount();
+  config.modify_lsm_memtable_hash_bucket_count(16);
+  auto small = new_memtable_rep(MemTableRepType::HashLinkList);
+  config.modify_lsm_memtable_hash_bucket_count(1024);
+  auto large = new_memtable_rep(MemTableRepType::HashLinkList);
+  config.modify_lsm_memtable_hash_bucket_count(saved);
+
+  EXPECT_EQ(large->memory_usage() - small->memory_usage(),
+            (1024 - 16) * sizeof(MemTableRepEntry *));
+  for (int i = 0; i < 200; i++) {
+    small->put("key" + std::to_string(i), std::to_string(i), 0);
+  }
+  for (int i = 0; i < 200; i++) {
+    EXPECT_EQ(small->get("key" + std::to_string(i), 0).get_value(),
+              std::to_string(i));
+  }
+}
+
+TEST(MemTableRepTest, ConfigName) {
+  for (auto type : extra_rep_types()) {
+    EXPECT_EQ(memtable_rep_type_from_string(memtable_rep_type_to_string(type)),
+              type);
+  }
+  EXPECT_EQ(memtable_rep_type_from_string("unknown"),
+            MemTableRepType::SkipList);
+}
+
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
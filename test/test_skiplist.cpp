@@ -1,4 +1,5 @@
 #include "logger/logger.h"
+#include "skiplist/arena_skiplist.h"
 #include "skiplist/skiplist.h"
 #include <algorithm>
 #include <atomic>
@@ -486,6 +487,220 @@ TEST(SkipListTest, TransactionId) {
 //             num_writers * num_operations); // 跳表大小不应超过最大可能值
 // }
 
+// ************************ ArenaSkipList ************************
+
+TEST(SkipListTest, PutHint) {
+  SkipList skipList;
+  SkipList::InsertHint hint;
+
+  // 有序批量插入, 中间穿插不带提示的插入和乱序的 key
+  for (int i = 0; i < 2000; i += 2) {
+    std::ostringstream oss;
+    oss << "key" << std::setw(5) << std::setfill('0') << i;
+    skipList.put_hint(oss.str(), "value" + std::to_string(i), 10, hint);
+  }
+  skipList.put_hint("key00001", "value1", 10, hint); // 比上一次小, 退化为普通查找
+  for (int i = 3; i < 2000; i += 2) {
+    std::ostringstream oss;
+    oss << "key" << std::setw(5) << std::setfill('0') << i;
+    skipList.put_hint(oss.str(), "value" + std::to_string(i), 10, hint);
+  }
+  // 同一个 key 的新版本排在旧版本之前, 相同版本只更新 value
+  skipList.put_hint("key01000", "new_value", 20, hint);
+  skipList.put_hint("key01000", "updated", 20, hint);
+
+  auto data = skipList.flush();
+  ASSERT_EQ(data.size(), 2001);
+  for (size_t i = 1; i < data.size(); i++) {
+    auto &[pk, pv, pt] = data[i - 1];
+    auto &[k, v, t] = data[i];
+    EXPECT_TRUE(pk < k || (pk == k && pt > t));
+  }
+  EXPECT_EQ(std::get<1>(data[1000]), "updated");
+  EXPECT_EQ(std::get<2>(data[1000]), 20);
+  EXPECT_EQ(std::get<1>(data[1001]), "value1000");
+
+  // 清空后旧的提示失效
+  skipList.clear();
+  skipList.put_hint("a", "1", 0, hint);
+  EXPECT_EQ(skipList.flush().size(), 1);
+}
+
+TEST(SkipListTest, Overwrite) {
+  SkipList skipList;
+  skipList.put("counter", "1", 1);
+  skipList.put("other", "x", 2);
+  size_t size_before = skipList.get_size();
+
+  // 覆盖最新版本: 不增加节点, tranc_id 随之更新
+  EXPECT_TRUE(skipList.overwrite("counter", "22", 3));
+  EXPECT_EQ(skipList.get_size(), size_before + 1);
+  auto data = skipList.flush();
+  ASSERT_EQ(data.size(), 2);
+  EXPECT_EQ(std::get<1>(data[0]), "22");
+  EXPECT_EQ(std::get<2>(data[0]), 3);
+
+  // 不能用更旧或相同的 tranc_id 覆盖, key 不存在时也不会插入
+  EXPECT_FALSE(skipList.overwrite("counter", "0", 3));
+  EXPECT_FALSE(skipList.overwrite("missing", "0", 10));
+  EXPECT_EQ(skipList.flush().size(), 2);
+
+  // 存在多个版本时只覆盖最新的一个
+  skipList.put("counter", "333", 5);
+  EXPECT_TRUE(skipList.overwrite("counter", "4444", 6));
+  data = skipList.flush();
+  ASSERT_EQ(data.size(), 3);
+  EXPECT_EQ(std::get<1>(data[0]), "4444");
+  EXPECT_EQ(std::get<2>(data[0]), 6);
+  EXPECT_EQ(std::get<1>(data[1]), "22");
+  EXPECT_EQ(std::get<2>(data[1]), 3);
+}
+
+TEST(ArenaSkipListTest, BasicOperations) {
+  ArenaSkipList skipList;
+
+  skipList.put("key1", "value1", 0);
+  EXPECT_EQ(skipList.get("key1", 0).get_value(), "value1");
+
+  // 重复写入相同的 key 和 tranc_id, 新版本遮蔽旧版本
+  skipList.put("key1", "new_value", 0);
+  EXPECT_EQ(skipList.get("key1", 0).get_value(), "new_value");
+
+  EXPECT_FALSE(skipList.get("nonexistent", 0).is_valid());
+
+  std::vector<std::pair<std::string, std::string>> result;
+  for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+    result.push_back(*it);
+  }
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0].second, "new_value");
+}
+
+TEST(ArenaSkipListTest, TransactionId) {
+  ArenaSkipList skipList;
+  skipList.put("key1", "value1", 1);
+  skipList.put("key1", "value2", 2);
+
+  EXPECT_EQ((skipList.get("key1", 0).get_value()), "value2");
+  EXPECT_EQ((skipList.get("key1", 1).get_value()), "value1");
+  EXPECT_EQ((skipList.get("key1", 2).get_value()), "value2");
+
+  // flush 时同一个 key 的不同事务版本都需要保留, 且事务 id 大的在前
+  auto data = skipList.flush();
+  ASSERT_EQ(data.size(), 2);
+  EXPECT_EQ(std::get<2>(data[0]), 2);
+  EXPECT_EQ(std::get<2>(data[1]), 1);
+}
+
+TEST(ArenaSkipListTest, PreffixAndPredicate) {
+  ArenaSkipList skipList;
+  skipList.put("apple", "0", 0);
+  skipList.put("apple2", "1", 0);
+  skipList.put("apricot", "2", 0);
+  skipList.put("banana", "3", 0);
+  skipList.put("berry", "4", 0);
+  skipList.put("cherry", "5", 0);
+
+  auto it = skipList.begin_preffix("ap");
+  EXPECT_EQ(it.get_key(), "apple");
+  auto end = skipList.end_preffix("ap");
+  EXPECT_EQ(end.get_key(), "banana");
+  int count = 0;
+  for (; it != end; ++it) {
+    count++;
+  }
+  EXPECT_EQ(count, 3);
+  EXPECT_EQ(skipList.begin_preffix("not exist"),
+            skipList.end_preffix("not exist"));
+
+  auto result = skipList.iters_monotony_predicate([](const std::string &key) {
+    if (key < "b") {
+      return 1;
+    } else if (key >= "c") {
+      return -1;
+    }
+    return 0;
+  });
+  ASSERT_TRUE(result.has_value());
+  auto [range_begin, range_end] = result.value();
+  EXPECT_EQ(range_begin.get_key(), "banana");
+  EXPECT_EQ(range_end.get_key(), "cherry");
+
+  EXPECT_FALSE(skipList
+                   .iters_monotony_predicate([](const std::string &key) {
+                     return -key.compare(0, 1, "z");
+                   })
+                   .has_value());
+}
+
+TEST(ArenaSkipListTest, MemorySizeTracking) {
+  ArenaSkipList skipList;
+  skipList.put("key1", "value1", 0);
+  skipList.put("key2", "value2", 0);
+
+  size_t expected_size = sizeof("key1") - 1 + sizeof("value1") - 1 +
+                         sizeof(uint64_t) + sizeof("key2") - 1 +
+                         sizeof("value2") - 1 + sizeof(uint64_t);
+  EXPECT_EQ(skipList.get_size(), expected_size);
+  EXPECT_GE(skipList.memory_usage(), expected_size);
+
+  // 超过内存块 1/4 的大 value 单独分配
+  skipList.put("big", std::string(Arena::kDefaultBlockSize, 'x'), 0);
+  EXPECT_EQ(skipList.get("big", 0).get_value().size(),
+            Arena::kDefaultBlockSize);
+  EXPECT_GE(skipList.memory_usage(), 2 * Arena::kDefaultBlockSize);
+}
+
+// 多个写线程并发插入, 同时有读线程无锁遍历
+TEST(ArenaSkipListTest, ConcurrentPut) {
+  ArenaSkipList skipList;
+  const int num_writers = 4;
+  const int num_per_writer = 5000;
+  std::atomic<bool> writers_done{false};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_writers; ++t) {
+    threads.emplace_back([&skipList, t]() {
+      for (int i = 0; i < num_per_writer; ++i) {
+        std::ostringstream oss;
+        oss << "key" << std::setw(6) << std::setfill('0')
+            << i * num_writers + t;
+        skipList.put(oss.str(), "value" + std::to_string(t), 0);
+      }
+    });
+  }
+  std::thread reader([&]() {
+    while (!writers_done.load()) {
+      std::string prev;
+      for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+        auto key = it.get_key();
+        EXPECT_LT(prev, key);
+        prev = key;
+      }
+    }
+  });
+  for (auto &th : threads) {
+    th.join();
+  }
+  writers_done = true;
+  reader.join();
+
+  int count = 0;
+  std::string prev;
+  for (auto it = skipList.begin(); it != skipList.end(); ++it) {
+    EXPECT_LT(prev, it.get_key());
+    prev = it.get_key();
+    count++;
+  }
+  EXPECT_EQ(count, num_writers * num_per_writer);
+  for (int i = 0; i < num_writers * num_per_writer; ++i) {
+    std::ostringstream oss;
+    oss << "key" << std::setw(6) << std::setfill('0') << i;
+    EXPECT_EQ(skipList.get(oss.str(), 0).get_value(),
+              "value" + std::to_string(i % num_writers));
+  }
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
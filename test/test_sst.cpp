@@ -1,10 +1,17 @@
 #include "config/config.h"
 #include "consts.h"
+#include "sst/level_options.h"
 #include "logger/logger.h"
 #include "sst/sst.h"
+#include "sst/sst_index.h"
 #include "sst/sst_iterator.h"
+#include "sst/sst_readahead.h"
+#include "sst/table_properties.h"
+#include <cmath>
+#include <cstdio>
 #include <filesystem>
 #include <gtest/gtest.h>
+#include <mutex>
 
 using namespace ::tiny_lsm;
 
@@ -242,6 +249,302 @@ TEST_F(SSTTest, LargeSSTPredicate) {
   EXPECT_EQ(iter_end.key(), "key501");
 }
 
+TEST(SSTIndexTest, ShortestSeparator) {
+  EXPECT_EQ(shortest_separator("abc", "abz"), "abd");
+  EXPECT_EQ(shortest_separator("abcdef", "abd"), "abce");
+  EXPECT_EQ(shortest_separator("abc", "abd"), "abc");
+  EXPECT_EQ(shortest_separator("a", "abc"), "a");
+  EXPECT_EQ(shortest_separator(std::string("ab\xff\x01\x05", 5), "ac"),
+            std::string("ab\xff\x02", 4));
+}
+
+// 分区索引只有 top-level 常驻内存, partition 通过块缓存按需读取
+TEST(SSTIndexTest, PartitionedIndex) {
+  const size_t num_blocks = 2000;
+  const size_t block_size = 100;
+  auto key_of = [](size_t i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user:profile:%08zu", i);
+    return std::string(buf);
+  };
+
+  // 第 i 个 block 保存 key_of(10 * i) ~ key_of(10 * i + 5)
+  std::vector<uint8_t> file(num_blocks * block_size);
+  PartitionedIndexBuilder builder(4096);
+  std::vector<BlockMeta> flat;
+  for (size_t i = 0; i < num_blocks; i++) {
+    builder.add_block(key_of(10 * i), key_of(10 * i + 5),
+                      {static_cast<uint32_t>(i * block_size),
+                       static_cast<uint32_t>(block_size)});
+    flat.emplace_back(i * block_size, key_of(10 * i), key_of(10 * i + 5));
+  }
+  size_t index_begin = file.size();
+  builder.finish(file);
+
+  size_t reads = 0;
+  auto read = [&](size_t offset, size_t length) {
+    reads++;
+    return std::vector<uint8_t>(file.begin() + offset,
+                                file.begin() + offset + length);
+  };
+  auto cache = std::make_shared<BlockCache>(64, 2);
+  auto index =
+      PartitionedIndex::open(read, index_begin, file.size(), 1, cache);
+  EXPECT_EQ(index->num_blocks(), num_blocks);
+  EXPECT_GT(index->num_partitions(), 1);
+  EXPECT_EQ(index->first_key(), key_of(0));
+  EXPECT_EQ(index->last_key(), key_of(10 * (num_blocks - 1) + 5));
+
+  for (size_t i = 0; i < num_blocks; i += 7) {
+    SCOPED_TRACE(i);
+    int64_t idx = static_cast<int64_t>(i);
+    EXPECT_EQ(index->find_block_idx(key_of(10 * i)), idx);
+    EXPECT_EQ(index->find_block_idx(key_of(10 * i + 5)), idx);
+    // 两个 block 之间的 key 落在前一个 block (读取后找不到)
+    // 或后一个 block, 不会落到更远的 block
+    auto gap = index->find_block_idx(key_of(10 * i + 7));
+    EXPECT_TRUE(gap == idx || gap == idx + 1 ||
+                (i + 1 == num_blocks && gap == -1));
+
+    auto handle = index->block_handle(i);
+    EXPECT_EQ(handle.offset, i * block_size);
+    EXPECT_EQ(handle.size, block_size);
+    auto separator = index->block_separator(i);
+    EXPECT_GE(separator, key_of(10 * i + 5));
+    if (i + 1 < num_blocks) {
+      EXPECT_LT(separator, key_of(10 * (i + 1)));
+    }
+  }
+  EXPECT_EQ(index->find_block_idx(""), 0);
+  EXPECT_EQ(index->find_block_idx("zzz"), -1);
+
+  // partition 已经在缓存中, 不再读取文件
+  size_t reads_before = reads;
+  index->find_block_idx(key_of(10 * 123));
+  index->block_handle(123);
+  EXPECT_EQ(reads, reads_before);
+
+  // 常驻内存比完整的 BlockMeta 数组小一个数量级以上
+  size_t flat_usage = flat.capacity() * sizeof(BlockMeta);
+  for (auto &meta : flat) {
+    flat_usage += meta.first_key.capacity() + meta.last_key.capacity();
+  }
+  EXPECT_LT(index->memory_usage() * 10, flat_usage);
+
+  // top-level 损坏
+  file[file.size() - 8] ^= 0xff;
+  EXPECT_THROW(
+      PartitionedIndex::open(read, index_begin, file.size(), 2, nullptr),
+      std::runtime_error);
+}
+
+TEST(SSTReadaheadTest, AdaptiveWindow) {
+  const size_t num_blocks = 40;
+  std::vector<std::shared_ptr<Block>> blocks;
+  for (size_t i = 0; i < num_blocks; i++) {
+    auto block = std::make_shared<Block>(4096, BlockFormat::V2);
+    block->add_entry("block_" + std::to_string(i), "value", 1, false);
+    blocks.push_back(block);
+  }
+
+  // 记录每次读取的 block, 预读在后台线程中调用
+  std::mutex mutex;
+  std::vector<std::vector<size_t>> batches;
+  bool always_fill = true;
+  auto read = [&](const std::vector<size_t> &idxs, bool fill_cache) {
+    std::lock_guard<std::mutex> lock(mutex);
+    batches.push_back(idxs);
+    always_fill = always_fill && fill_cache;
+    std::vector<std::shared_ptr<Block>> result;
+    for (auto idx : idxs) {
+      result.push_back(blocks[idx]);
+    }
+    return result;
+  };
+
+  BlockReadahead readahead(read, num_blocks, 0, 2, 8, true);
+  for (size_t i = 1; i < num_blocks; i++) {
+    auto block = readahead.get(i);
+    ASSERT_EQ(block->get_key_by_idx(0), "block_" + std::to_string(i));
+  }
+  EXPECT_TRUE(always_fill);
+  EXPECT_EQ(readahead.window(), 8u);
+  // 只有开始预读前的两个 block 是同步读取的
+  EXPECT_EQ(readahead.hits(), num_blocks - 3);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_GE(batches.size(), 4u);
+    EXPECT_EQ(batches[0], std::vector<size_t>{1});
+    EXPECT_EQ(batches[1], std::vector<size_t>{2});
+    EXPECT_EQ(batches[2], (std::vector<size_t>{3, 4}));
+    EXPECT_EQ(batches[3], (std::vector<size_t>{5, 6, 7, 8}));
+    for (auto &batch : batches) {
+      EXPECT_LE(batch.size(), 8u);
+    }
+    batches.clear();
+  }
+
+  // 不连续的访问重置窗口, 需要重新检测顺序访问
+  auto block = readahead.get(10);
+  EXPECT_EQ(block->get_key_by_idx(0), "block_10");
+  EXPECT_EQ(readahead.window(), 2u);
+  readahead.get(11);
+  readahead.get(12);
+  readahead.get(13);
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(batches.size(), 4u);
+  EXPECT_EQ(batches[0], std::vector<size_t>{10});
+  EXPECT_EQ(batches[3], (std::vector<size_t>{13, 14}));
+}
+
+// 测试会修改全局配置, 结束后恢复为原来的值, 避免影响后面的测试
+class LevelOptionsTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    block_size_per_level_ = cfg.getLsmBlockSizePerLevel();
+    bits_per_key_per_level_ = cfg.getBloomFilterBitsPerKeyPerLevel();
+    filter_type_per_level_ = cfg.getBloomFilterTypePerLevel();
+    monkey_ = cfg.getBloomFilterMonkey();
+  }
+
+  void TearDown() override {
+    cfg.modify_lsm_block_size_per_level(block_size_per_level_);
+    cfg.modify_bloom_filter_bits_per_key_per_level(bits_per_key_per_level_);
+    cfg.modify_bloom_filter_type_per_level(filter_type_per_level_);
+    cfg.modify_bloom_filter_monkey(monkey_);
+  }
+
+  TomlConfig &cfg = const_cast<TomlConfig &>(TomlConfig::getInstance());
+
+private:
+  std::vector<int> block_size_per_level_;
+  std::vector<double> bits_per_key_per_level_;
+  std::vector<std::string> filter_type_per_level_;
+  bool monkey_ = false;
+};
+
+TEST_F(LevelOptionsTest, PerLevelAndMonkey) {
+  cfg.modify_lsm_block_size_per_level({4096, 16384, 65536});
+  cfg.modify_bloom_filter_bits_per_key_per_level({14, 10, 6});
+  cfg.modify_bloom_filter_monkey(false);
+
+  auto l0 = LevelOptions::for_level(0, 4);
+  auto l5 = LevelOptions::for_level(5, 4);
+  EXPECT_EQ(l0.block_size, 4096u);
+  EXPECT_EQ(l5.block_size, 65536u); // 超出列表使用最后一项
+  EXPECT_DOUBLE_EQ(l0.bits_per_key, 14);
+  EXPECT_DOUBLE_EQ(l5.bits_per_key, 6);
+  EXPECT_EQ(l0.compression, SSTBuilder::compression_for_level(0));
+  EXPECT_EQ(l5.filter, SSTBuilder::filter_for_level(5));
+
+  // Monkey: 总位数不变, 越小的层位数越多, 假阳性率之和低于平均分配
+  std::vector<double> level_keys = {1, 4, 16, 64, 256};
+  auto bits = monkey_bits_per_key(level_keys, 10);
+  double total = 0, monkey_fpr = 0, uniform_fpr = 0;
+  const double ln2_sq = std::log(2.0) * std::log(2.0);
+  for (size_t i = 0; i < bits.size(); ++i) {
+    total += bits[i] * level_keys[i];
+    monkey_fpr += std::exp(-bits[i] * ln2_sq);
+    uniform_fpr += std::exp(-10 * ln2_sq);
+    if (i > 0) {
+      EXPECT_GT(bits[i - 1], bits[i]);
+    }
+  }
+  EXPECT_NEAR(total, 10 * 341, 1e-6);
+  EXPECT_LT(monkey_fpr, uniform_fpr * 0.6);
+
+  // 预算很小时最大的层不分配过滤器, 位数集中在小的层
+  auto tight = monkey_bits_per_key({1, 10, 100, 10000}, 0.05);
+  EXPECT_DOUBLE_EQ(tight.back(), 0);
+  EXPECT_NEAR(tight[0] + tight[1] * 10 + tight[2] * 100, 0.05 * 10111, 1e-6);
+
+  // 钳制到下限后在其余层之间重新分配, 总位数仍然不变
+  auto floored = monkey_bits_per_key({1, 10, 100, 10000}, 0.05, {}, 1.0);
+  double floored_total = 0;
+  for (size_t i = 0; i < floored.size(); ++i) {
+    EXPECT_GE(floored[i], 1.0);
+    floored_total += floored[i] * std::vector<double>{1, 10, 100, 10000}[i];
+  }
+  EXPECT_NEAR(floored_total, std::max(0.05, 1.0) * 10111, 1e-6);
+  auto roomy = monkey_bits_per_key({1, 4, 16, 64}, 1.5, {}, 1.0);
+  double roomy_total = roomy[0] + roomy[1] * 4 + roomy[2] * 16 + roomy[3] * 64;
+  EXPECT_DOUBLE_EQ(roomy.back(), 1.0);
+  EXPECT_NEAR(roomy_total, 1.5 * 85, 1e-6);
+
+  // 使用 fuse8 的最后一层不参与分配, 它的固定大小从预算中扣除
+  double fuse8 = fixed_filter_bits_per_key(FilterFormat::BinaryFuse8);
+  EXPECT_DOUBLE_EQ(fuse8, 9);
+  EXPECT_LT(fixed_filter_bits_per_key(FilterFormat::BlockedBloom), 0);
+  auto mixed = monkey_bits_per_key({1, 4, 16, 64}, 10, {-1, -1, -1, fuse8});
+  EXPECT_DOUBLE_EQ(mixed[3], fuse8);
+  EXPECT_NEAR(mixed[0] + mixed[1] * 4 + mixed[2] * 16, 10 * 85 - fuse8 * 64,
+              1e-6);
+  EXPECT_GT(mixed[0], mixed[1]);
+
+  cfg.modify_bloom_filter_monkey(true);
+  cfg.modify_bloom_filter_type_per_level({"bloom"});
+  auto m0 = LevelOptions::for_level(0, 3);
+  auto m2 = LevelOptions::for_level(2, 3);
+  EXPECT_GT(m0.bits_per_key, cfg.getBloomFilterBitsPerKey());
+  EXPECT_LT(m2.bits_per_key, cfg.getBloomFilterBitsPerKey());
+  // 最后一层换成 fuse8 后, 布隆层分到的位数随之变化
+  cfg.modify_bloom_filter_type_per_level({"bloom", "bloom", "fuse8"});
+  auto f0 = LevelOptions::for_level(0, 3);
+  EXPECT_NE(f0.bits_per_key, m0.bits_per_key);
+  EXPECT_GE(f0.bits_per_key, 1.0);
+
+  cfg.modify_bloom_filter_monkey(false);
+  cfg.modify_lsm_block_size_per_level({});
+  cfg.modify_bloom_filter_bits_per_key_per_level({});
+  EXPECT_EQ(LevelOptions::for_level(3, 4).block_size,
+            static_cast<size_t>(cfg.getLsmBlockSize()));
+}
+
+TEST(TablePropertiesTest, CollectEncodeDecode) {
+  TableProperties props;
+  // 事务标记: 空 key 和空 value, 不算删除标记
+  props.add("", 0, true, false);
+  props.add("apple", 10, true, false);
+  props.add("apple", 0, false, false);
+  props.add("banana", 4096, true, true);
+  props.add(std::string(300, 'k'), 0, true, false);
+
+  EXPECT_EQ(props.num_entries, 5);
+  EXPECT_EQ(props.num_tombstones, 2);
+  EXPECT_EQ(props.num_distinct_keys, 4);
+  EXPECT_EQ(props.num_wisckey_values, 1);
+  EXPECT_EQ(props.raw_key_bytes, 5 + 5 + 6 + 300);
+  EXPECT_EQ(props.raw_value_bytes, 10 + 4096);
+  EXPECT_EQ(props.key_size_histogram[0], 1);
+  // 5 和 6 都在 [4, 8) 中
+  EXPECT_EQ(TableProperties::key_size_bucket(5), 3);
+  EXPECT_EQ(props.key_size_histogram[3], 3);
+  EXPECT_EQ(TableProperties::key_size_bucket(300), 9);
+  EXPECT_EQ(TableProperties::key_size_bucket(1 << 20),
+            TableProperties::kKeySizeBuckets - 1);
+
+  auto encoded = props.encode();
+  auto decoded = TableProperties::decode(encoded);
+  EXPECT_EQ(decoded.num_entries, props.num_entries);
+  EXPECT_EQ(decoded.num_tombstones, props.num_tombstones);
+  EXPECT_EQ(decoded.raw_key_bytes, props.raw_key_bytes);
+  EXPECT_EQ(decoded.raw_value_bytes, props.raw_value_bytes);
+  EXPECT_EQ(decoded.num_distinct_keys, props.num_distinct_keys);
+  EXPECT_EQ(decoded.num_wisckey_values, props.num_wisckey_values);
+  EXPECT_EQ(decoded.key_size_histogram, props.key_size_histogram);
+  EXPECT_NE(decoded.to_string().find("tombstones=2"), std::string::npos);
+
+  TableProperties total;
+  total.merge(props);
+  total.merge(decoded);
+  EXPECT_EQ(total.num_entries, 10);
+  EXPECT_DOUBLE_EQ(total.average_key_size(), props.average_key_size());
+
+  encoded[3] ^= 0xff;
+  EXPECT_THROW(TableProperties::decode(encoded), std::runtime_error);
+  EXPECT_THROW(TableProperties::decode({1, 2}), std::runtime_error);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
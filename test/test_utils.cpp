@@ -1,10 +1,26 @@
 #include "logger/logger.h"
+#include "utils/async_io.h"
+#include "utils/binary_fuse_filter.h"
 #include "utils/bloom_filter.h"
+#include "utils/buffered_file_writer.h"
+#include "utils/compression.h"
+#include "utils/crc32c.h"
 #include "utils/cursor.h"
+#include "utils/dynamic_bloom.h"
 #include "utils/files.h"
+#include "utils/key_filter.h"
+#include "utils/memory_budget.h"
+#include "utils/prefix_extractor.h"
+#include "utils/range_filter.h"
+#include "utils/snapshot_list.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <filesystem>
 #include <gtest/gtest.h>
 #include <random>
+#include <thread>
+#include <vector>
 
 using namespace ::tiny_lsm;
 
@@ -238,6 +254,192 @@ TEST_F(FileTest, CursorReadWrite) {
   EXPECT_EQ(read_back[1], 50);
 }
 
+// 只读映射: 读取结果与 fstream 一致, 可以并发读取, 拒绝写入
+TEST_F(FileTest, MmapReadOnly) {
+  const std::string path = "test_data/mmap.dat";
+  auto data = generate_random_data(64 * 1024 + 123);
+  FileObj::create_and_write(path, data).close();
+
+  auto file = FileObj::open_mmap(path);
+  ASSERT_TRUE(file.is_mmapped());
+  EXPECT_EQ(file.size(), data.size());
+  file.advise(FileAccess::Random);
+
+  uint32_t u32;
+  memcpy(&u32, data.data() + 1001, sizeof(uint32_t));
+  EXPECT_EQ(file.read_uint32(1001), u32);
+  uint64_t u64;
+  memcpy(&u64, data.data() + data.size() - 8, sizeof(uint64_t));
+  EXPECT_EQ(file.read_uint64(data.size() - 8), u64);
+  EXPECT_THROW(file.read_to_slice(data.size() - 4, 8), std::out_of_range);
+
+  const uint8_t *mapped = file.mapped_data(100, 50);
+  ASSERT_NE(mapped, nullptr);
+  EXPECT_TRUE(std::equal(mapped, mapped + 50, data.begin() + 100));
+  EXPECT_EQ(file.mapped_data(data.size() - 1, 2), nullptr);
+
+  file.advise(FileAccess::Sequential);
+  std::vector<std::thread> readers;
+  std::atomic<int> mismatches{0};
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&, t] {
+      for (size_t off = t * 97; off + 4096 <= data.size(); off += 4096) {
+        auto slice = file.read_to_slice(off, 4096);
+        if (!std::equal(slice.begin(), slice.end(), data.begin() + off)) {
+          mismatches++;
+        }
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(mismatches, 0);
+
+  std::vector<uint8_t> buf = {1, 2, 3};
+  EXPECT_FALSE(file.write(0, buf));
+  EXPECT_FALSE(file.append(buf));
+  EXPECT_EQ(file.read_to_slice(0, 3),
+            std::vector<uint8_t>(data.begin(), data.begin() + 3));
+
+  file.del_file();
+  EXPECT_FALSE(std::filesystem::exists(path));
+
+  // 普通打开的文件没有映射
+  FileObj::create_and_write(path, data).close();
+  auto plain = FileObj::open(path, false);
+  EXPECT_FALSE(plain.is_mmapped());
+  EXPECT_EQ(plain.mapped_data(0, 1), nullptr);
+}
+
+TEST_F(FileTest, AsyncBatchRead) {
+  const std::string path = "test_data/batch.dat";
+  auto data = generate_random_data(256 * 1024 + 17);
+  FileObj::create_and_write(path, data).close();
+
+  std::mt19937 gen(42);
+  std::vector<std::pair<size_t, size_t>> ranges;
+  for (int i = 0; i < 300; i++) {
+    size_t len = gen() % 8192 + 1;
+    size_t off = gen() % (data.size() - len);
+    ranges.emplace_back(off, len);
+  }
+  ranges.emplace_back(data.size() - 5, 5);
+  auto check = [&](const std::vector<std::vector<uint8_t>> &results) {
+    ASSERT_EQ(results.size(), ranges.size());
+    for (size_t i = 0; i < ranges.size(); i++) {
+      auto [off, len] = ranges[i];
+      ASSERT_EQ(results[i].size(), len);
+      EXPECT_TRUE(std::equal(results[i].begin(), results[i].end(),
+                             data.begin() + off))
+          << "range " << i;
+    }
+  };
+
+  // io_uring 不可用时 create 退化为线程池
+  for (std::string kind : {"sync", "threadpool", "io_uring"}) {
+    SCOPED_TRACE(kind);
+    auto engine = AsyncIoEngine::create(kind, 16, 4);
+    if (kind == "io_uring") {
+      EXPECT_EQ(engine->name(), io_uring_supported() ? "io_uring" : "threadpool");
+    } else {
+      EXPECT_EQ(engine->name(), kind);
+    }
+
+    auto file = FileObj::open(path);
+    check(file.read_batch(ranges, engine.get()));
+    EXPECT_THROW(file.read_batch({{data.size() - 4, 8}}, engine.get()),
+                 std::out_of_range);
+
+    // 多个线程同时提交批次
+    std::vector<std::thread> readers;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; t++) {
+      readers.emplace_back([&] {
+        auto results = file.read_batch(ranges, engine.get());
+        for (size_t i = 0; i < ranges.size(); i++) {
+          if (!std::equal(results[i].begin(), results[i].end(),
+                          data.begin() + ranges[i].first)) {
+            mismatches++;
+          }
+        }
+      });
+    }
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    EXPECT_EQ(mismatches, 0);
+
+    // 单个请求失败不影响同一批次的其他请求
+    std::vector<ReadRequest> requests(2);
+    requests[0].fd = -1;
+    requests[0].length = 16;
+    requests[1].fd = ::open(path.c_str(), O_RDONLY);
+    requests[1].offset = 100;
+    requests[1].length = 16;
+    engine->read_batch(requests);
+    ::close(requests[1].fd);
+    EXPECT_EQ(requests[0].error, EBADF);
+    EXPECT_EQ(requests[1].error, 0);
+    EXPECT_TRUE(std::equal(requests[1].data.begin(), requests[1].data.end(),
+                           data.begin() + 100));
+  }
+
+  auto mapped = FileObj::open_mmap(path);
+  check(mapped.read_batch(ranges, nullptr));
+  auto plain = FileObj::open(path);
+  check(plain.read_batch(ranges, nullptr));
+
+  // 只读 fd 在第一次通过引擎批量读取时才打开; 映射的文件也优先使用引擎
+  auto count_fds = [] {
+    return std::distance(std::filesystem::directory_iterator("/proc/self/fd"),
+                         std::filesystem::directory_iterator{});
+  };
+  auto engine = AsyncIoEngine::create("threadpool", 16, 2);
+  auto before = count_fds();
+  auto lazy = FileObj::open_mmap(path);
+  auto opened = count_fds();
+  check(lazy.read_batch(ranges, nullptr));
+  EXPECT_EQ(count_fds(), opened);
+  check(lazy.read_batch(ranges, engine.get()));
+  EXPECT_EQ(count_fds(), opened + 1);
+  lazy.close();
+  EXPECT_LE(count_fds(), before);
+}
+
+TEST_F(FileTest, BufferedWriter) {
+  const std::string path = "test_data/buffered.dat";
+  auto data = generate_random_data(64 * 1024);
+
+  {
+    BufferedFileWriter writer(path, 4096);
+    // 小块写入经过缓冲区, 超过缓冲区的写入直接落盘
+    size_t pos = 0;
+    for (size_t len : {100, 3000, 5000, 1, 20000, 4096}) {
+      writer.append(data.data() + pos, len);
+      pos += len;
+      EXPECT_EQ(writer.offset(), pos);
+    }
+    std::vector<uint8_t> rest(data.begin() + pos, data.end());
+    writer.append(rest);
+    EXPECT_EQ(writer.offset(), data.size());
+    writer.finish();
+    EXPECT_TRUE(writer.finished());
+    EXPECT_THROW(writer.append(rest), std::logic_error);
+  }
+  auto file = FileObj::open(path, false);
+  EXPECT_EQ(file.size(), data.size());
+  EXPECT_EQ(file.read_to_slice(0, data.size()), data);
+
+  // 没有 finish 的文件被删除
+  const std::string partial = "test_data/partial_build.dat";
+  {
+    BufferedFileWriter writer(partial, 4096);
+    writer.append(data);
+  }
+  EXPECT_FALSE(std::filesystem::exists(partial));
+}
+
 // 综合测试布隆过滤器的功能
 TEST(BloomFilterTest, ComprehensiveTest) {
   // 创建布隆过滤器，预期插入1000个元素，假阳性率为0.01
@@ -273,6 +475,475 @@ TEST(BloomFilterTest, ComprehensiveTest) {
 // 输出假阳性率
 }
 
+TEST(BloomFilterTest, BlockedBuildAndFormats) {
+  // 按实际 key 数分配: 100 个 key, 10 bits/key -> 4 个 256 bit 的 block
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 100; ++i) {
+    hashes.push_back(BloomFilter::key_hash("small" + std::to_string(i)));
+  }
+  auto small = BloomFilter::build(hashes, 10);
+  EXPECT_EQ(small.format(), FilterFormat::BlockedBloom);
+  EXPECT_EQ(small.size_bytes(), 4u * 32);
+
+  hashes.clear();
+  for (int i = 0; i < 100000; ++i) {
+    hashes.push_back(BloomFilter::key_hash("key" + std::to_string(i)));
+  }
+  auto bf = BloomFilter::build(hashes, 10);
+  for (int i = 0; i < 100000; ++i) {
+    ASSERT_TRUE(bf.possibly_contains("key" + std::to_string(i)));
+  }
+  int false_positives = 0;
+  for (int i = 100000; i < 200000; ++i) {
+    if (bf.possibly_contains("key" + std::to_string(i))) {
+      ++false_positives;
+    }
+  }
+  EXPECT_LE(false_positives, 2000); // 理论约 1%
+
+  auto encoded = bf.encode();
+  auto decoded = BloomFilter::decode(encoded);
+  EXPECT_EQ(decoded.size_bytes(), bf.size_bytes());
+  for (int i = 0; i < 200000; i += 7) {
+    auto key = "key" + std::to_string(i);
+    EXPECT_EQ(decoded.possibly_contains(key), bf.possibly_contains(key));
+  }
+  encoded[100] ^= 0x10;
+  EXPECT_THROW(BloomFilter::decode(encoded), std::runtime_error);
+
+  // 旧格式: 全 1 的位数组对任何 key 都返回 true, 全 0 则都返回 false
+  auto legacy = [](uint8_t fill) {
+    std::vector<uint8_t> data;
+    auto put = [&data](const void *src, size_t len) {
+      auto p = static_cast<const uint8_t *>(src);
+      data.insert(data.end(), p, p + len);
+    };
+    size_t expected = 100, num_bits = 960, num_hashes = 7;
+    double rate = 0.01;
+    put(&expected, sizeof(size_t));
+    put(&rate, sizeof(double));
+    put(&num_bits, sizeof(size_t));
+    put(&num_hashes, sizeof(size_t));
+    data.insert(data.end(), num_bits / 8, fill);
+    return data;
+  };
+  auto ones = BloomFilter::decode(legacy(0xff), FilterFormat::LegacyBloom);
+  auto zeros = BloomFilter::decode(legacy(0x00), FilterFormat::LegacyBloom);
+  EXPECT_EQ(ones.format(), FilterFormat::LegacyBloom);
+  EXPECT_TRUE(ones.possibly_contains("anything"));
+  EXPECT_FALSE(zeros.possibly_contains("anything"));
+  EXPECT_EQ(BloomFilter::decode(ones.encode(), FilterFormat::LegacyBloom)
+                .size_bytes(),
+            960u / 8);
+}
+
+TEST(BinaryFuseFilterTest, BuildQueryAndFactory) {
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 100000; ++i) {
+    hashes.push_back(BloomFilter::key_hash("key" + std::to_string(i)));
+  }
+  // 重复的 key 只计一次
+  hashes.push_back(hashes.front());
+
+  auto fuse8 = BinaryFuseFilter::build(hashes, FilterFormat::BinaryFuse8);
+  auto fuse16 = BinaryFuseFilter::build(hashes, FilterFormat::BinaryFuse16);
+  EXPECT_EQ(fuse8.format(), FilterFormat::BinaryFuse8);
+  // 约 1.13 个槽位/key, 比同样假阳性率的布隆过滤器小得多
+  EXPECT_LE(fuse8.size_bytes() * 8, 100000u * 10);
+  EXPECT_EQ(fuse16.size_bytes(), fuse8.size_bytes() * 2);
+
+  int fp8 = 0, fp16 = 0;
+  for (int i = 0; i < 100000; ++i) {
+    auto key = "key" + std::to_string(i);
+    ASSERT_TRUE(fuse8.possibly_contains(key));
+    ASSERT_TRUE(fuse16.possibly_contains(key));
+  }
+  for (int i = 100000; i < 300000; ++i) {
+    auto key = "key" + std::to_string(i);
+    fp8 += fuse8.possibly_contains(key);
+    fp16 += fuse16.possibly_contains(key);
+  }
+  EXPECT_LE(fp8, 1200); // 理论约 0.39%
+  EXPECT_LE(fp16, 20);  // 理论约 0.0015%
+
+  auto encoded = fuse8.encode();
+  auto decoded = BinaryFuseFilter::decode(encoded, FilterFormat::BinaryFuse8);
+  EXPECT_EQ(decoded.size_bytes(), fuse8.size_bytes());
+  for (int i = 0; i < 300000; i += 7) {
+    auto key = "key" + std::to_string(i);
+    EXPECT_EQ(decoded.possibly_contains(key), fuse8.possibly_contains(key));
+  }
+  EXPECT_THROW(BinaryFuseFilter::decode(encoded, FilterFormat::BinaryFuse16),
+               std::runtime_error);
+  encoded[100] ^= 0x10;
+  EXPECT_THROW(BinaryFuseFilter::decode(encoded, FilterFormat::BinaryFuse8),
+               std::runtime_error);
+
+  // key 很少时也能构建
+  for (int n = 0; n < 20; ++n) {
+    std::vector<uint64_t> few(hashes.begin(), hashes.begin() + n);
+    auto small = BinaryFuseFilter::build(few, FilterFormat::BinaryFuse16);
+    for (auto h : few) {
+      ASSERT_TRUE(small.possibly_contains_hash(h));
+    }
+  }
+
+  // 通过 KeyFilter 按格式构建和解码, SST 只依赖这个接口
+  for (auto format : {FilterFormat::BlockedBloom, FilterFormat::BinaryFuse8,
+                      FilterFormat::BinaryFuse16}) {
+    auto filter = KeyFilter::build(format, hashes, 10);
+    EXPECT_EQ(filter->format(), format);
+    auto restored = KeyFilter::decode(filter->encode(), format);
+    EXPECT_EQ(restored->size_bytes(), filter->size_bytes());
+    EXPECT_TRUE(restored->possibly_contains("key42"));
+    EXPECT_EQ(filter_format_from_string(filter_format_to_string(format)),
+              format);
+  }
+  EXPECT_THROW(KeyFilter::build(FilterFormat::LegacyBloom, hashes, 10),
+               std::invalid_argument);
+  EXPECT_THROW(filter_format_from_string("ribbon"), std::invalid_argument);
+}
+
+TEST(PrefixExtractorTest, TransformAndPrefixFilter) {
+  EXPECT_EQ(PrefixExtractor::create("none"), nullptr);
+  EXPECT_THROW(PrefixExtractor::create("fixed:"), std::invalid_argument);
+  EXPECT_THROW(PrefixExtractor::create("delimited:_"), std::invalid_argument);
+
+  auto fixed = PrefixExtractor::create("fixed:4");
+  auto capped = PrefixExtractor::create("capped:4");
+  auto redis = PrefixExtractor::create("redis");
+  EXPECT_EQ(fixed->name(), "fixed:4");
+  EXPECT_EQ(fixed->transform("abcdef"), "abcd");
+  EXPECT_FALSE(fixed->transform("abc").has_value());
+  EXPECT_EQ(capped->transform("abc"), "abc");
+  EXPECT_FALSE(capped->transform_prefix("abc").has_value());
+  EXPECT_EQ(redis->transform("REDIS_SET_user_alice"), "REDIS_SET_user_");
+  EXPECT_EQ(redis->transform("REDIS_SORTED_SET_rank_SCORE_0001"),
+            "REDIS_SORTED_SET_rank_");
+  EXPECT_FALSE(redis->transform("plain_key").has_value());
+  // 哈希表字段不做前缀扫描
+  EXPECT_FALSE(redis->transform("REDIS_FIELD_h_f").has_value());
+  EXPECT_EQ(redis->transform_prefix("REDIS_SORTED_SET_rank_SCORE_"),
+            "REDIS_SORTED_SET_rank_");
+  // 还不能确定类型前缀
+  EXPECT_FALSE(redis->transform_prefix("REDIS_S").has_value());
+
+  // 以 prefix 开头的任何 key 的 transform 都必须等于 transform_prefix(prefix),
+  // 否则前缀过滤器会漏掉 key
+  std::vector<std::string> keys = {
+      "REDIS_SET_a_1",        "REDIS_SET_a_b_2",     "REDIS_SET_ab_3",
+      "REDIS_FIELD_h_f",      "REDIS_SORTED_SET_z_", "REDIS_SORTED_SET_z_ELEM_x",
+      "REDIS_SET_",           "abcdefgh",            "abc"};
+  for (const auto &extractor : {fixed, capped, redis}) {
+    for (const auto &key : keys) {
+      for (size_t len = 0; len <= key.size(); ++len) {
+        auto prefix = key.substr(0, len);
+        auto expected = extractor->transform_prefix(prefix);
+        if (expected.has_value()) {
+          EXPECT_EQ(extractor->transform(key), expected)
+              << extractor->name() << " " << key << " " << len;
+        }
+      }
+    }
+  }
+
+  // 前缀和完整的 key 放在同一个过滤器中
+  std::vector<uint64_t> hashes;
+  for (int i = 0; i < 1000; ++i) {
+    auto key = "REDIS_SET_s" + std::to_string(i) + "_member";
+    hashes.push_back(BloomFilter::key_hash(key));
+    hashes.push_back(
+        BloomFilter::key_hash(std::string(*redis->transform(key))));
+  }
+  auto filter = KeyFilter::build(FilterFormat::BinaryFuse16, hashes, 10);
+  for (int i = 0; i < 1000; ++i) {
+    auto prefix = "REDIS_SET_s" + std::to_string(i) + "_";
+    ASSERT_TRUE(filter->possibly_contains(
+        std::string(*redis->transform_prefix(prefix))));
+  }
+  int false_positives = 0;
+  for (int i = 1000; i < 2000; ++i) {
+    auto prefix = "REDIS_SET_s" + std::to_string(i) + "_";
+    false_positives += filter->possibly_contains(
+        std::string(*redis->transform_prefix(prefix)));
+  }
+  EXPECT_LE(false_positives, 5);
+}
+
+TEST(RangeFilterTest, RangesAndPredicates) {
+  // 稀疏的 key: 相邻 key 之间有大量不存在的短范围
+  std::vector<std::string> keys;
+  for (int i = 0; i < 20000; ++i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%08d", i * 97);
+    keys.push_back(buf);
+  }
+  // 一个 key 是另一个 key 的前缀, 以及不可见字符
+  keys.push_back("user");
+  keys.push_back(std::string("user\xff\xff", 6));
+  std::sort(keys.begin(), keys.end());
+
+  RangeFilterBuilder builder(1);
+  for (const auto &key : keys) {
+    builder.add(key);
+    builder.add(key); // 重复的 key 被忽略
+  }
+  auto filter = RangeFilter::decode(builder.finish());
+  EXPECT_EQ(filter.num_entries(), keys.size());
+  EXPECT_LE(filter.size_bytes(), keys.size() * 5);
+
+  auto key_of = [](int n) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "user%08d", n);
+    return std::string(buf);
+  };
+  // 包含 key 的范围一定返回 true
+  for (const auto &key : keys) {
+    ASSERT_TRUE(filter.may_contain_range(key, key + '\0')) << key;
+  }
+  for (int i = 0; i < 20000 * 97; i += 1013) {
+    auto lower = key_of(i), upper = key_of(i + 200);
+    bool expected = std::lower_bound(keys.begin(), keys.end(), lower) !=
+                    std::lower_bound(keys.begin(), keys.end(), upper);
+    if (expected) {
+      ASSERT_TRUE(filter.may_contain_range(lower, upper)) << lower;
+    }
+  }
+  // 落在两个 key 之间的短范围大多可以排除
+  int false_positives = 0, empty_ranges = 0;
+  for (int i = 0; i < 20000; ++i) {
+    auto lower = key_of(i * 97 + 10), upper = key_of(i * 97 + 20);
+    ++empty_ranges;
+    false_positives += filter.may_contain_range(lower, upper);
+  }
+  EXPECT_LE(false_positives, empty_ranges / 5);
+  EXPECT_FALSE(filter.may_contain_range("a", "b"));
+  EXPECT_FALSE(filter.may_contain_range("zzz", "zzzz"));
+  EXPECT_TRUE(filter.may_contain_range("a", "z"));
+
+  // 前缀谓词
+  auto prefix_predicate = [](const std::string &prefix) {
+    return [prefix](const std::string &key) {
+      return -key.compare(0, prefix.size(), prefix);
+    };
+  };
+  EXPECT_TRUE(filter.may_match(prefix_predicate(key_of(97 * 5))));
+  EXPECT_TRUE(filter.may_match(prefix_predicate("user\xff")));
+  EXPECT_FALSE(filter.may_match(prefix_predicate("usez")));
+  EXPECT_FALSE(filter.may_match(prefix_predicate("user00000001")));
+
+  auto empty = RangeFilter::decode(RangeFilterBuilder(1).finish());
+  EXPECT_FALSE(empty.may_contain_range("", "\xff"));
+
+  auto corrupted = filter.encode();
+  corrupted[10] ^= 0x01;
+  EXPECT_THROW(RangeFilter::decode(corrupted), std::runtime_error);
+}
+
+TEST(DynamicBloomTest, ConcurrentAddAndFalsePositive) {
+  // 10 bit/key, 6 次探测, 理论假阳性率约 1%
+  DynamicBloom bloom(40000 * 10);
+
+  // 多个线程并发写入不同的 key
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&bloom, t]() {
+      for (int i = t * 10000; i < (t + 1) * 10000; ++i) {
+        bloom.add("key" + std::to_string(i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < 40000; ++i) {
+    EXPECT_TRUE(bloom.may_contain("key" + std::to_string(i)));
+  }
+
+  int false_positives = 0;
+  for (int i = 40000; i < 80000; ++i) {
+    if (bloom.may_contain("key" + std::to_string(i))) {
+      ++false_positives;
+    }
+  }
+  EXPECT_LE(static_cast<double>(false_positives) / 40000, 0.03);
+  EXPECT_GE(bloom.memory_usage(), 40000 * 10 / 8);
+}
+
+TEST(MemoryBudgetTest, UsageAndReclaim) {
+  MemoryBudget budget(1000);
+  size_t cache1 = 300, cache2 = 200, mem1 = 400, mem2 = 600;
+  std::vector<std::string> flushed;
+
+  auto shrink = [](size_t &used) {
+    return [&used](size_t bytes) {
+      size_t freed = std::min(bytes, used);
+      used -= freed;
+      return freed;
+    };
+  };
+  budget.add_consumer("cache1", MemoryBudget::ConsumerType::BlockCache,
+                      [&]() { return cache1; }, shrink(cache1));
+  budget.add_consumer("cache2", MemoryBudget::ConsumerType::BlockCache,
+                      [&]() { return cache2; }, shrink(cache2));
+  budget.add_consumer(
+      "mem1", MemoryBudget::ConsumerType::MemTable, [&]() { return mem1; },
+      [&](size_t) -> size_t {
+        flushed.push_back("mem1");
+        return 0;
+      });
+  auto mem2_id = budget.add_consumer(
+      "mem2", MemoryBudget::ConsumerType::MemTable, [&]() { return mem2; },
+      [&](size_t) -> size_t {
+        flushed.push_back("mem2");
+        return 0;
+      });
+
+  EXPECT_EQ(budget.usage(), 1500);
+  EXPECT_EQ(budget.usage(MemoryBudget::ConsumerType::BlockCache), 500);
+  EXPECT_TRUE(budget.exceeded());
+
+  // 超出 500: 块缓存全部释放即可满足, 不需要刷盘
+  EXPECT_EQ(budget.reclaim(), 0);
+  EXPECT_EQ(cache1 + cache2, 0);
+  EXPECT_TRUE(flushed.empty());
+  EXPECT_FALSE(budget.exceeded());
+
+  // 超出 150: 块缓存已空, 只需要刷占用最大的 mem2
+  mem1 = 550;
+  EXPECT_EQ(budget.reclaim(), 150);
+  ASSERT_EQ(flushed.size(), 1);
+  EXPECT_EQ(flushed[0], "mem2");
+
+  // 注销后不再回调
+  budget.remove_consumer(mem2_id);
+  EXPECT_EQ(budget.usage(), 550);
+  EXPECT_FALSE(budget.exceeded());
+
+  // limit 为 0 表示不限制
+  budget.set_limit(0);
+  mem1 = 1 << 30;
+  EXPECT_FALSE(budget.exceeded());
+  EXPECT_EQ(budget.reclaim(), 0);
+}
+
+TEST(CompressionTest, LZRoundTripAndTrailer) {
+  std::mt19937 rng(42);
+  // 大量重复前缀的数据, 与 Redis 类型的 key 相似
+  std::vector<uint8_t> redundant;
+  for (int i = 0; i < 2000; i++) {
+    std::string entry = "REDIS_SORTED_SET_leaderboard_SCORE_" +
+                        std::to_string(i) + "_member" + std::to_string(i % 7);
+    redundant.insert(redundant.end(), entry.begin(), entry.end());
+  }
+  std::vector<uint8_t> random_data(4096);
+  for (auto &b : random_data) {
+    b = static_cast<uint8_t>(rng());
+  }
+  std::vector<uint8_t> run(70000, 'a'); // 超长匹配和长度扩展
+  std::vector<std::vector<uint8_t>> inputs = {
+      {}, {1, 2, 3}, redundant, random_data, run};
+
+  auto codec = get_compression_codec(CompressionType::LZ);
+  ASSERT_NE(codec, nullptr);
+  for (auto &input : inputs) {
+    std::vector<uint8_t> compressed;
+    codec->compress(input.data(), input.size(), compressed);
+    std::vector<uint8_t> output;
+    ASSERT_TRUE(codec->decompress(compressed.data(), compressed.size(),
+                                  input.size(), output));
+    EXPECT_EQ(output, input);
+
+    auto stored = compress_block(input, CompressionType::LZ, 0.875);
+    EXPECT_EQ(decompress_block(stored), input);
+  }
+
+  // 可压缩的数据使用 LZ, 随机数据压缩收益太小时保存原始数据
+  auto stored = compress_block(redundant, CompressionType::LZ, 0.875);
+  EXPECT_EQ(block_compression_type(stored), CompressionType::LZ);
+  EXPECT_LT(stored.size(), redundant.size() / 3);
+  stored = compress_block(random_data, CompressionType::LZ, 0.875);
+  EXPECT_EQ(block_compression_type(stored), CompressionType::None);
+  EXPECT_EQ(stored.size(), random_data.size() + 5);
+
+  // 损坏的数据
+  stored = compress_block(redundant, CompressionType::LZ, 0.875);
+  stored[stored.size() - 2] ^= 0x01; // raw_size
+  EXPECT_THROW(decompress_block(stored), std::runtime_error);
+  stored.back() = 200; // 未注册的编解码器
+  EXPECT_THROW(decompress_block(stored), std::runtime_error);
+  EXPECT_THROW(decompress_block({1, 2}), std::runtime_error);
+
+  EXPECT_EQ(compression_type_from_string("lz"), CompressionType::LZ);
+  EXPECT_EQ(compression_type_from_string("none"), CompressionType::None);
+  EXPECT_THROW(compression_type_from_string("lz4"), std::invalid_argument);
+  EXPECT_EQ(compression_type_to_string(CompressionType::LZ), "lz");
+}
+
+TEST(Crc32cTest, KnownValuesAndAcceleration) {
+  EXPECT_EQ(crc32c(std::string_view("")), 0u);
+  EXPECT_EQ(crc32c(std::string_view("123456789")), 0xE3069283u);
+  std::vector<uint8_t> zeros(32, 0);
+  EXPECT_EQ(crc32c(zeros.data(), zeros.size()), 0x8A9136AAu);
+  std::vector<uint8_t> ones(32, 0xff);
+  EXPECT_EQ(crc32c(ones.data(), ones.size()), 0x62A8AB43u);
+
+  // 硬件实现与查表实现一致, 分段计算与整体计算一致
+  std::mt19937 rng(7);
+  std::vector<uint8_t> data(4099);
+  for (auto &b : data) {
+    b = static_cast<uint8_t>(rng());
+  }
+  for (size_t len : {0, 1, 7, 8, 9, 63, 64, 1000, 4099}) {
+    SCOPED_TRACE(len);
+    uint32_t expected = crc32c_extend_portable(0, data.data(), len);
+    EXPECT_EQ(crc32c(data.data(), len), expected);
+    size_t split = len / 3;
+    EXPECT_EQ(crc32c_extend(crc32c(data.data(), split), data.data() + split,
+                            len - split),
+              expected);
+  }
+}
+
+TEST(SnapshotListTest, AcquireAndRelease) {
+  auto list = std::make_shared<SnapshotList>();
+  EXPECT_FALSE(list->oldest().has_value());
+
+  uint64_t next_id = 10;
+  auto s10 = list->acquire([&]() { return next_id++; });
+  auto s5 = list->acquire(5);
+  auto s5_again = list->acquire(5);
+  EXPECT_EQ(s10->tranc_id(), 10);
+  EXPECT_EQ(*list->oldest(), 5);
+  EXPECT_EQ(list->size(), 3);
+
+  // 相同 id 的快照分别注销
+  s5.reset();
+  EXPECT_EQ(*list->oldest(), 5);
+  s5_again.reset();
+  EXPECT_EQ(*list->oldest(), 10);
+
+  // 并发登记和注销
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&list]() {
+      for (int i = 0; i < 1000; i++) {
+        auto snapshot = list->acquire(100 + i);
+        EXPECT_LE(*list->oldest(), snapshot->tranc_id());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(list->size(), 1);
+
+  // 登记表先销毁时快照仍可以安全释放
+  list.reset();
+  s10.reset();
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
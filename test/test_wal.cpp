@@ -2,6 +2,7 @@
 #include "wal/record.h"
 #include "lsm/engine.h"
 #include "wal/wal.h"
+#include <cstring>
 #include <filesystem>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -353,6 +354,64 @@ TEST_F(WALTest, MixedTransactionCommitAbortAndCrashRecovery) {
   EXPECT_FALSE(lsm.get("k3").has_value());
 }
 
+TEST(RecordTest, ChecksumDetectsCorruption) {
+  std::vector<Record> records = {
+      Record::createRecord(1), Record::putRecord(1, "key", "value"),
+      Record::deleteRecord(1, "key"), Record::commitRecord(1)};
+  std::vector<uint8_t> data;
+  for (auto &record : records) {
+    auto encoded = record.encode();
+    data.insert(data.end(), encoded.begin(), encoded.end());
+  }
+  EXPECT_EQ(Record::decode(data), records);
+
+  // 任意一个字节损坏都会被发现
+  for (size_t i = 0; i < data.size(); i++) {
+    auto corrupted = data;
+    corrupted[i] ^= 0x10;
+    EXPECT_THROW(Record::decode(corrupted), std::runtime_error) << i;
+  }
+  // 写入一半的记录
+  data.resize(data.size() - 3);
+  EXPECT_THROW(Record::decode(data), std::runtime_error);
+}
+
+// 旧版本的记录没有校验和, 长度字段超出记录时同样报错而不是越界读取
+TEST(RecordTest, LegacyRecordBounds) {
+  auto legacy_put = [](const std::string &key, const std::string &value) {
+    std::vector<uint8_t> out(sizeof(uint16_t) + sizeof(uint64_t) + 1);
+    uint16_t record_len = out.size() + 2 * sizeof(uint16_t) + key.size() +
+                          value.size();
+    uint64_t tranc_id = 7;
+    memcpy(out.data(), &record_len, sizeof(uint16_t));
+    memcpy(out.data() + sizeof(uint16_t), &tranc_id, sizeof(uint64_t));
+    out.back() = static_cast<uint8_t>(OperationType::OP_PUT);
+    for (auto &field : {key, value}) {
+      uint16_t len = field.size();
+      auto p = reinterpret_cast<const uint8_t *>(&len);
+      out.insert(out.end(), p, p + sizeof(uint16_t));
+      out.insert(out.end(), field.begin(), field.end());
+    }
+    return out;
+  };
+
+  auto data = legacy_put("key", "value");
+  auto decoded = Record::decode(data);
+  ASSERT_EQ(decoded.size(), 1);
+  EXPECT_EQ(decoded[0], Record::putRecord(7, "key", "value"));
+
+  // key_len 超出记录
+  auto bad_key = data;
+  bad_key[11] = 0xff;
+  EXPECT_THROW(Record::decode(bad_key), std::runtime_error);
+  // value_len 超出记录, 即使后面还有其他记录的字节
+  auto bad_value = data;
+  bad_value[11 + sizeof(uint16_t) + 3] = 60;
+  auto next = legacy_put("other", std::string(100, 'v'));
+  bad_value.insert(bad_value.end(), next.begin(), next.end());
+  EXPECT_THROW(Record::decode(bad_value), std::runtime_error);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   init_spdlog_file();
@@ -69,7 +69,7 @@ target("memtable")
 
 target("block")
     set_kind("static")
-    add_deps("config")
+    add_deps("config", "utils")
     add_files("src/block/*.cpp")
     add_packages("toml11", "spdlog")
     add_includedirs("include", {public = true})